@@ -105,23 +105,64 @@ ParseResult parse_args(int argc, char* argv[]) {
     } else if (cmd == "ui-test-multi") {
       UiTestMultiCommand multi_cmd;
 
+      // Split off the flags; the rest are cluster definitions
+      std::vector<std::string> numbers;
+      for (; i < argc; ++i) {
+        std::string multi_arg = argv[i];
+        if (multi_arg == "--script" || multi_arg == "--dump") {
+          if (i + 1 >= argc) {
+            return make_error(multi_arg + " requires a filepath");
+          }
+          (multi_arg == "--script" ? multi_cmd.script : multi_cmd.dump) = argv[++i];
+        } else if (multi_arg == "--stress" || multi_arg == "--monitors" ||
+                   multi_arg == "--rate") {
+          if (i + 1 >= argc) {
+            return make_error(multi_arg + " requires a value");
+          }
+          std::string value = argv[++i];
+          try {
+            if (multi_arg == "--rate") {
+              multi_cmd.rate = std::stod(value);
+            } else {
+              auto count = static_cast<size_t>(std::stoul(value));
+              (multi_arg == "--stress" ? multi_cmd.stress : multi_cmd.monitors) = count;
+            }
+          } catch (const std::exception&) {
+            return make_error("Invalid " + multi_arg + " value: " + value);
+          }
+          if ((multi_cmd.rate && *multi_cmd.rate < 0.0) ||
+              (multi_cmd.monitors && *multi_cmd.monitors == 0)) {
+            return make_error("Invalid " + multi_arg + " value: " + value);
+          }
+        } else {
+          numbers.push_back(multi_arg);
+        }
+      }
+      if (multi_cmd.dump && !multi_cmd.script) {
+        return make_error("--dump requires --script");
+      }
+      if ((multi_cmd.monitors || multi_cmd.rate) && !multi_cmd.stress) {
+        return make_error("--monitors and --rate require --stress");
+      }
+      if (multi_cmd.stress && multi_cmd.script) {
+        return make_error("--stress and --script cannot be combined");
+      }
+
       // Parse optional cluster definitions (groups of 4: x y w h)
-      int remaining = argc - i;
-      if (remaining > 0 && remaining % 4 != 0) {
+      if (numbers.size() % 4 != 0) {
         return make_error("ui-test-multi requires 4 numbers per cluster (x y width height). "
                           "Got " +
-                          std::to_string(remaining) + " arguments.");
+                          std::to_string(numbers.size()) + " arguments.");
       }
 
-      while (i + 3 < argc) {
+      for (size_t n = 0; n + 3 < numbers.size(); n += 4) {
         try {
           UiTestMultiCommand::ClusterDef cluster;
-          cluster.x = std::stof(argv[i]);
-          cluster.y = std::stof(argv[i + 1]);
-          cluster.width = std::stof(argv[i + 2]);
-          cluster.height = std::stof(argv[i + 3]);
+          cluster.x = std::stof(numbers[n]);
+          cluster.y = std::stof(numbers[n + 1]);
+          cluster.width = std::stof(numbers[n + 2]);
+          cluster.height = std::stof(numbers[n + 3]);
           multi_cmd.clusters.push_back(cluster);
-          i += 4;
         } catch (const std::exception&) {
           return make_error("Invalid number in ui-test-multi arguments");
         }
@@ -129,7 +170,34 @@ ParseResult parse_args(int argc, char* argv[]) {
 
       args.command = multi_cmd;
     } else if (cmd == "track-windows") {
-      args.command = TrackWindowsCommand{};
+      TrackWindowsCommand track_cmd;
+      while (i < argc) {
+        std::string track_arg = argv[i];
+        if (track_arg == "--interval") {
+          if (i + 1 >= argc) {
+            return make_error("--interval requires a value in milliseconds");
+          }
+          ++i;
+          try {
+            track_cmd.interval_ms = std::stoi(argv[i]);
+          } catch (const std::exception&) {
+            return make_error("Invalid --interval value: " + std::string(argv[i]));
+          }
+          if (*track_cmd.interval_ms <= 0) {
+            return make_error("--interval must be positive");
+          }
+        } else if (track_arg == "--events") {
+          track_cmd.events = true;
+        } else if (track_arg == "--profile") {
+          track_cmd.profile = true;
+        } else if (track_arg[0] != '-' && !track_cmd.filepath) {
+          track_cmd.filepath = track_arg;
+        } else {
+          return make_error("Unknown track-windows argument: " + track_arg);
+        }
+        ++i;
+      }
+      args.command = track_cmd;
     } else if (cmd == "init-config") {
       InitConfigCommand init_cmd;
       if (i < argc && argv[i][0] != '-') {
@@ -138,6 +206,20 @@ ParseResult parse_args(int argc, char* argv[]) {
         ++i;
       }
       args.command = init_cmd;
+    } else if (cmd == "dump-recorder") {
+      DumpRecorderCommand dump_cmd;
+      while (i < argc) {
+        std::string dump_arg = argv[i];
+        if (dump_arg == "--json") {
+          dump_cmd.json = true;
+        } else if (dump_arg[0] != '-' && !dump_cmd.filepath) {
+          dump_cmd.filepath = dump_arg;
+        } else {
+          return make_error("Unknown dump-recorder argument: " + dump_arg);
+        }
+        ++i;
+      }
+      args.command = dump_cmd;
     } else {
       return make_error("Unknown command: " + cmd);
     }
@@ -161,13 +243,25 @@ void print_usage() {
             << "  ui-test-monitor         Launch UI visualizer with monitor data\n"
             << "  ui-test-multi [x y w h] Launch UI with custom cluster dimensions\n"
             << "                          (groups of 4 numbers, defaults to dual 1920x1080)\n"
-            << "  track-windows           Track and log windows per monitor in a loop\n"
+            << "                          --script <file>: run a scenario headless and report\n"
+            << "                          per-step latency; --dump <file|->: final state JSON\n"
+            << "                          --stress <windows> [--monitors <n>] [--rate <n/s>]:\n"
+            << "                          spawn and kill synthetic processes, graph frame time\n"
+            << "  track-windows [--interval <ms>] [--events] [--profile] [filepath]\n"
+            << "                          Stream window changes as JSON Lines\n"
+            << "                          (every 1000ms by default, or on window events)\n"
+            << "                          --profile: report enumeration cost per process/API\n"
+            << "                          and suggest ignore rules instead\n"
             << "  init-config [filepath]  Create default configuration TOML file\n"
             << "                          (defaults to win-tiler.toml next to executable)\n"
+            << "  dump-recorder [--json] [filepath]\n"
+            << "                          Dump the running loop's flight recorder over IPC\n"
             << "\n"
             << "Examples:\n"
             << "  win-tiler --logmode debug loop\n"
             << "  win-tiler ui-test-multi 0 0 1920 1080 1920 0 1920 1080\n"
+            << "  win-tiler ui-test-multi --script scenario.txt --dump -\n"
+            << "  win-tiler ui-test-multi --stress 500 --monitors 8 --rate 20\n"
             << "  win-tiler init-config config.toml\n"
             << "  win-tiler --config config.toml loop\n";
 }
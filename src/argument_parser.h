@@ -19,18 +19,35 @@ struct UiTestMultiCommand {
   struct ClusterDef {
     float x, y, width, height;
   };
-  std::vector<ClusterDef> clusters; // Empty = use defaults
+  std::vector<ClusterDef> clusters;   // Empty = use defaults
+  std::optional<std::string> script; // --script <file>: run headless, no raylib window
+  std::optional<std::string> dump;   // --dump <file>: final state as JSON (- = stdout)
+  std::optional<size_t> stress;      // --stress <windows>: synthetic spawn/kill workload
+  std::optional<size_t> monitors;    // --monitors <n>: stress grid size when no clusters given
+  std::optional<double> rate;        // --rate <per second>: stress churn rate
 };
 
-struct TrackWindowsCommand {};
+struct TrackWindowsCommand {
+  static constexpr int kDefaultIntervalMs = 1000;
+  std::optional<int> interval_ms;      // --interval <ms>, default kDefaultIntervalMs
+  bool events = false;                 // --events, pass after window events instead
+  bool profile = false;                // --profile, time enumeration queries instead of diffing
+  std::optional<std::string> filepath; // Empty = print to stdout
+};
 
 struct InitConfigCommand {
   std::optional<std::string> filepath; // Empty = use default (win-tiler.toml next to exe)
 };
 
+struct DumpRecorderCommand {
+  bool json = false;                   // --json, default is text
+  std::optional<std::string> filepath; // Empty = print to stdout
+};
+
 // Variant holding all possible commands
 using Command = std::variant<HelpCommand, VersionCommand, LoopCommand, UiTestMonitorCommand,
-                             UiTestMultiCommand, TrackWindowsCommand, InitConfigCommand>;
+                             UiTestMultiCommand, TrackWindowsCommand, InitConfigCommand,
+                             DumpRecorderCommand>;
 
 // ===== CLI Options =====
 enum class LogLevel { Trace, Debug, Info, Warn, Err, Off };
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+namespace wintiler {
+
+// Cache line size used to keep producer and consumer indices apart
+constexpr size_t kCacheLineSize = 64;
+
+// ============================================================================
+// Single-Producer / Single-Consumer Queue
+// ============================================================================
+
+// Bounded lock-free ring buffer for exactly one producer thread and one consumer thread.
+// Capacity must be a power of two. try_push fails instead of blocking when the queue is full.
+template <typename T, size_t Capacity>
+class SpscQueue {
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                "SpscQueue capacity must be a power of two");
+
+public:
+  bool try_push(T value) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    size_t tail = tail_.load(std::memory_order_acquire);
+    if (head - tail == Capacity) {
+      return false;
+    }
+    slots_[head & (Capacity - 1)] = std::move(value);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  std::optional<T> try_pop() {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t head = head_.load(std::memory_order_acquire);
+    if (tail == head) {
+      return std::nullopt;
+    }
+    std::optional<T> value(std::move(slots_[tail & (Capacity - 1)]));
+    tail_.store(tail + 1, std::memory_order_release);
+    return value;
+  }
+
+  [[nodiscard]] bool empty() const {
+    return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+  }
+
+private:
+  std::array<T, Capacity> slots_{};
+  alignas(kCacheLineSize) std::atomic<size_t> head_{0};
+  alignas(kCacheLineSize) std::atomic<size_t> tail_{0};
+};
+
+// ============================================================================
+// Multi-Producer / Single-Consumer Queue
+// ============================================================================
+
+// Bounded lock-free ring buffer for any number of producer threads and one consumer thread.
+// Each slot carries a sequence number (Vyukov's bounded queue), so producers only contend on
+// the head index and never wait for each other. Capacity must be a power of two.
+template <typename T, size_t Capacity>
+class MpscQueue {
+  static_assert(Capacity > 1 && (Capacity & (Capacity - 1)) == 0,
+                "MpscQueue capacity must be a power of two");
+
+public:
+  MpscQueue() {
+    for (size_t i = 0; i < Capacity; ++i) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  bool try_push(T value) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot& slot = slots_[head & (Capacity - 1)];
+      size_t sequence = slot.sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(head);
+      if (diff == 0) {
+        if (head_.compare_exchange_weak(head, head + 1, std::memory_order_relaxed)) {
+          slot.value = std::move(value);
+          slot.sequence.store(head + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false; // Full: the consumer has not released this slot yet
+      } else {
+        head = head_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  std::optional<T> try_pop() {
+    Slot& slot = slots_[tail_ & (Capacity - 1)];
+    size_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence != tail_ + 1) {
+      return std::nullopt; // Empty, or the producer that claimed this slot is still writing
+    }
+    std::optional<T> value(std::move(slot.value));
+    slot.sequence.store(tail_ + Capacity, std::memory_order_release);
+    ++tail_;
+    return value;
+  }
+
+  // Consumer side only
+  [[nodiscard]] bool empty() const {
+    return slots_[tail_ & (Capacity - 1)].sequence.load(std::memory_order_acquire) != tail_ + 1;
+  }
+
+private:
+  struct alignas(kCacheLineSize) Slot {
+    std::atomic<size_t> sequence{0};
+    T value{};
+  };
+
+  std::array<Slot, Capacity> slots_;
+  alignas(kCacheLineSize) std::atomic<size_t> head_{0};
+  alignas(kCacheLineSize) size_t tail_ = 0; // Only touched by the consumer
+};
+
+// ============================================================================
+// Triple Buffer
+// ============================================================================
+
+// Lock-free "latest value" handoff between one producer and one consumer. The producer fills
+// write_buffer() and publishes it; the consumer always sees the newest published value and
+// older unread values are dropped. Neither side ever waits or copies: the producer's back
+// buffer and the shared middle buffer swap indices on publish, the consumer swaps its front
+// buffer with the middle one on update.
+template <typename T>
+class TripleBuffer {
+public:
+  // Producer: buffer to fill before the next publish()
+  T& write_buffer() {
+    return buffers_[back_];
+  }
+
+  // Producer: hand the write buffer to the consumer
+  void publish() {
+    uint8_t previous = middle_.exchange(back_ | kFreshBit, std::memory_order_acq_rel);
+    back_ = previous & kIndexMask;
+  }
+
+  // Consumer: returns true if a value was published since the last update; read() then
+  // returns it
+  bool update() {
+    if ((middle_.load(std::memory_order_relaxed) & kFreshBit) == 0) {
+      return false;
+    }
+    uint8_t previous = middle_.exchange(front_, std::memory_order_acq_rel);
+    front_ = previous & kIndexMask;
+    return true;
+  }
+
+  // Consumer: last value taken by update()
+  [[nodiscard]] const T& read() const {
+    return buffers_[front_];
+  }
+
+private:
+  static constexpr uint8_t kIndexMask = 0x3;
+  static constexpr uint8_t kFreshBit = 0x4;
+
+  std::array<T, 3> buffers_{};
+  alignas(kCacheLineSize) std::atomic<uint8_t> middle_{1};
+  alignas(kCacheLineSize) uint8_t back_ = 0; // Only touched by the producer
+  alignas(kCacheLineSize) uint8_t front_ = 2; // Only touched by the consumer
+};
+
+} // namespace wintiler
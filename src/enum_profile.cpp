@@ -0,0 +1,312 @@
+#include "enum_profile.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cctype>
+
+namespace wintiler {
+
+namespace {
+
+// A process whose costliest title accounts for this share of its cost gets a process/title
+// pair suggested instead of the whole process
+constexpr int64_t kTitleSharePercent = 80;
+
+bool iequals(const std::string& a, const std::string& b) {
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](char x, char y) {
+    return std::tolower(static_cast<unsigned char>(x)) ==
+           std::tolower(static_cast<unsigned char>(y));
+  });
+}
+
+double to_ms(int64_t ns) {
+  return static_cast<double>(ns) / 1e6;
+}
+
+double to_us(int64_t ns) {
+  return static_cast<double>(ns) / 1e3;
+}
+
+std::string toml_string(const std::string& value) {
+  std::string out = "\"";
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+    }
+    out += c;
+  }
+  return out + "\"";
+}
+
+std::string join(const std::vector<std::string>& items) {
+  std::string out;
+  for (const auto& item : items) {
+    out += out.empty() ? item : ", " + item;
+  }
+  return out;
+}
+
+std::string display_process(const std::string& process) {
+  return process.empty() ? "<unknown>" : process;
+}
+
+std::optional<IgnoreSuggestion> suggest_ignore(const EnumProcessStats& stats,
+                                               const IgnoreOptions& ignore_options) {
+  auto reason = fmt::format("{}: {:.2f}ms per pass, slowest {} took {:.2f}ms on \"{}\"",
+                            display_process(stats.process), to_ms(stats.ns_per_pass),
+                            enum_api_to_string(stats.worst_api), to_ms(stats.worst_ns),
+                            stats.worst_title);
+
+  // Without a process name only the title can be matched
+  if (stats.process.empty()) {
+    const auto& titles = ignore_options.ignored_window_titles;
+    if (stats.costliest_title.empty() ||
+        std::find(titles.begin(), titles.end(), stats.costliest_title) != titles.end()) {
+      return std::nullopt;
+    }
+    return IgnoreSuggestion{IgnoreSuggestion::Kind::WindowTitle, "", stats.costliest_title,
+                            std::move(reason)};
+  }
+
+  const auto& processes = ignore_options.ignored_processes;
+  if (std::find(processes.begin(), processes.end(), stats.process) != processes.end()) {
+    return std::nullopt;
+  }
+
+  bool one_title = stats.titles > 1 && !stats.costliest_title.empty() &&
+                   stats.costliest_title_ns * 100 >= stats.total_ns * kTitleSharePercent;
+  if (!one_title) {
+    return IgnoreSuggestion{IgnoreSuggestion::Kind::Process, stats.process, "",
+                            std::move(reason)};
+  }
+  for (const auto& [process, title] : ignore_options.ignored_process_title_pairs) {
+    if (iequals(process, stats.process) && iequals(title, stats.costliest_title)) {
+      return std::nullopt;
+    }
+  }
+  return IgnoreSuggestion{IgnoreSuggestion::Kind::ProcessTitlePair, stats.process,
+                          stats.costliest_title, std::move(reason)};
+}
+
+} // namespace
+
+const char* enum_api_to_string(EnumApi api) {
+  switch (api) {
+  case EnumApi::IsWindowVisible:
+    return "IsWindowVisible";
+  case EnumApi::DwmGetWindowAttribute:
+    return "DwmGetWindowAttribute";
+  case EnumApi::GetWindowText:
+    return "GetWindowTextA";
+  case EnumApi::GetClassName:
+    return "GetClassNameA";
+  case EnumApi::GetWindowLong:
+    return "GetWindowLong";
+  case EnumApi::IsHungAppWindow:
+    return "IsHungAppWindow";
+  case EnumApi::GetWindowThreadProcessId:
+    return "GetWindowThreadProcessId";
+  case EnumApi::OpenProcess:
+    return "OpenProcess";
+  case EnumApi::GetModuleBaseName:
+    return "GetModuleBaseNameA";
+  case EnumApi::GetWindowRect:
+    return "GetWindowRect";
+  case EnumApi::GetWindowOwner:
+    return "GetWindow/GetParent";
+  case EnumApi::Count:
+    break;
+  }
+  return "unknown";
+}
+
+int64_t WindowQuerySample::total_ns() const {
+  int64_t total = 0;
+  for (const auto& [api, ns] : timings_ns) {
+    total += ns;
+  }
+  return total;
+}
+
+// ============================================================================
+// EnumProfiler
+// ============================================================================
+
+void EnumProfiler::add_pass(const std::vector<WindowQuerySample>& samples, int64_t pass_ns) {
+  ++passes_;
+  total_ns_ += pass_ns;
+  max_pass_ns_ = std::max(max_pass_ns_, pass_ns);
+  windows_visited_ += samples.size();
+
+  for (const auto& sample : samples) {
+    auto& process = processes_[sample.process];
+    process.windows.insert(sample.hwnd);
+    ++process.samples;
+    if (sample.accepted) {
+      ++process.accepted;
+    }
+    int64_t sample_ns = 0;
+    for (const auto& [api, ns] : sample.timings_ns) {
+      auto& stats = apis_[static_cast<size_t>(api)];
+      stats.api = api;
+      ++stats.calls;
+      stats.total_ns += ns;
+      stats.max_ns = std::max(stats.max_ns, ns);
+      if (ns > process.worst_ns) {
+        process.worst_api = api;
+        process.worst_ns = ns;
+        process.worst_title = sample.title;
+      }
+      sample_ns += ns;
+    }
+    process.total_ns += sample_ns;
+    process.ns_per_title[sample.title] += sample_ns;
+  }
+}
+
+EnumProfileReport EnumProfiler::report(const IgnoreOptions& ignore_options,
+                                       const EnumProfileThresholds& thresholds) const {
+  EnumProfileReport report;
+  report.passes = passes_;
+  report.total_ns = total_ns_;
+  report.max_pass_ns = max_pass_ns_;
+  report.windows_visited = windows_visited_;
+
+  for (const auto& stats : apis_) {
+    if (stats.calls > 0) {
+      report.apis.push_back(stats);
+    }
+  }
+  std::stable_sort(report.apis.begin(), report.apis.end(),
+                   [](const auto& a, const auto& b) { return a.total_ns > b.total_ns; });
+
+  for (const auto& [name, process] : processes_) {
+    EnumProcessStats stats;
+    stats.process = name;
+    stats.windows = process.windows.size();
+    stats.samples = process.samples;
+    stats.accepted = process.accepted;
+    stats.total_ns = process.total_ns;
+    stats.ns_per_pass = passes_ > 0 ? process.total_ns / static_cast<int64_t>(passes_) : 0;
+    stats.worst_api = process.worst_api;
+    stats.worst_ns = process.worst_ns;
+    stats.worst_title = process.worst_title;
+    stats.titles = process.ns_per_title.size();
+    for (const auto& [title, ns] : process.ns_per_title) {
+      if (ns > stats.costliest_title_ns) {
+        stats.costliest_title = title;
+        stats.costliest_title_ns = ns;
+      }
+    }
+    report.processes.push_back(std::move(stats));
+  }
+  std::stable_sort(report.processes.begin(), report.processes.end(),
+                   [](const auto& a, const auto& b) { return a.total_ns > b.total_ns; });
+
+  size_t offenders = 0;
+  for (auto& stats : report.processes) {
+    if (offenders == thresholds.max_offenders) {
+      break;
+    }
+    if (stats.ns_per_pass < thresholds.offender_pass_ns &&
+        stats.worst_ns < thresholds.slow_query_ns) {
+      continue;
+    }
+    stats.offender = true;
+    ++offenders;
+    if (auto suggestion = suggest_ignore(stats, ignore_options)) {
+      report.suggestions.push_back(std::move(*suggestion));
+    }
+  }
+  return report;
+}
+
+// ============================================================================
+// Report formatting
+// ============================================================================
+
+std::string format_enum_profile_report(const EnumProfileReport& report) {
+  std::string out;
+  auto line = [&out](const std::string& text) {
+    out += text;
+    out += '\n';
+  };
+
+  if (report.passes == 0) {
+    line("Enumeration profile: no passes recorded");
+    return out;
+  }
+  auto passes = static_cast<int64_t>(report.passes);
+  line(fmt::format("Enumeration profile: {} passes, {:.2f}ms avg, {:.2f}ms max, {:.1f} windows "
+                   "visited per pass",
+                   report.passes, to_ms(report.total_ns / passes), to_ms(report.max_pass_ns),
+                   static_cast<double>(report.windows_visited) / static_cast<double>(passes)));
+
+  int64_t query_ns = 0;
+  for (const auto& stats : report.apis) {
+    query_ns += stats.total_ns;
+  }
+  line("");
+  line("By API:");
+  line(fmt::format("  {:<26} {:>9} {:>10} {:>9} {:>10} {:>6}", "api", "calls", "total ms",
+                   "avg us", "max us", "share"));
+  for (const auto& stats : report.apis) {
+    line(fmt::format("  {:<26} {:>9} {:>10.2f} {:>9.1f} {:>10.1f} {:>5.1f}%",
+                     enum_api_to_string(stats.api), stats.calls, to_ms(stats.total_ns),
+                     to_us(stats.total_ns / static_cast<int64_t>(stats.calls)),
+                     to_us(stats.max_ns),
+                     query_ns > 0 ? 100.0 * static_cast<double>(stats.total_ns) /
+                                        static_cast<double>(query_ns)
+                                  : 0.0));
+  }
+
+  line("");
+  line("By process (! = worst offender):");
+  line(fmt::format("    {:<28} {:>7} {:>8} {:>9}  {}", "process", "windows", "accepted", "ms/pass",
+                   "slowest query"));
+  for (const auto& stats : report.processes) {
+    line(fmt::format("  {} {:<28} {:>7} {:>8} {:>9.3f}  {} {:.1f}us on \"{}\"",
+                     stats.offender ? '!' : ' ', display_process(stats.process), stats.windows,
+                     stats.accepted, to_ms(stats.ns_per_pass), enum_api_to_string(stats.worst_api),
+                     to_us(stats.worst_ns), stats.worst_title));
+  }
+
+  line("");
+  if (report.suggestions.empty()) {
+    line("No ignore rules suggested.");
+    return out;
+  }
+  line("Suggested ignore rules (add to [ignore] in win-tiler.toml):");
+  std::vector<std::string> processes;
+  std::vector<std::string> pairs;
+  std::vector<std::string> titles;
+  for (const auto& suggestion : report.suggestions) {
+    line("  # " + suggestion.reason);
+    switch (suggestion.kind) {
+    case IgnoreSuggestion::Kind::Process:
+      processes.push_back(toml_string(suggestion.process));
+      break;
+    case IgnoreSuggestion::Kind::ProcessTitlePair:
+      pairs.push_back(fmt::format("{{ process = {}, title = {} }}",
+                                  toml_string(suggestion.process),
+                                  toml_string(suggestion.title)));
+      break;
+    case IgnoreSuggestion::Kind::WindowTitle:
+      titles.push_back(toml_string(suggestion.title));
+      break;
+    }
+  }
+  if (!processes.empty()) {
+    line(fmt::format("  processes = [{}]", join(processes)));
+  }
+  if (!pairs.empty()) {
+    line(fmt::format("  process_title_pairs = [{}]", join(pairs)));
+  }
+  if (!titles.empty()) {
+    line(fmt::format("  window_titles = [{}]", join(titles)));
+  }
+  return out;
+}
+
+} // namespace wintiler
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "options.h"
+
+namespace wintiler {
+
+// Win32 queries made while enumerating windows
+enum class EnumApi {
+  IsWindowVisible,
+  DwmGetWindowAttribute,
+  GetWindowText,
+  GetClassName,
+  GetWindowLong,
+  IsHungAppWindow,
+  GetWindowThreadProcessId,
+  OpenProcess,
+  GetModuleBaseName,
+  GetWindowRect,
+  GetWindowOwner, // GetWindow(GW_OWNER) and GetParent
+  Count,
+};
+
+constexpr size_t kEnumApiCount = static_cast<size_t>(EnumApi::Count);
+
+const char* enum_api_to_string(EnumApi api);
+
+// Every query made for one window during one enumeration, in call order. process and title are
+// filled in even when the enumeration rejected the window before looking them up.
+struct WindowQuerySample {
+  size_t hwnd = 0;
+  std::string process; // Empty when the process could not be opened
+  std::string title;
+  bool accepted = false; // Window passed every filter and would be tiled
+  std::vector<std::pair<EnumApi, int64_t>> timings_ns;
+
+  void add(EnumApi api, int64_t ns) { timings_ns.emplace_back(api, ns); }
+  [[nodiscard]] int64_t total_ns() const;
+};
+
+struct EnumApiStats {
+  EnumApi api;
+  uint64_t calls = 0;
+  int64_t total_ns = 0;
+  int64_t max_ns = 0;
+};
+
+struct EnumProcessStats {
+  std::string process;
+  size_t windows = 0;          // Distinct windows seen over all passes
+  uint64_t samples = 0;        // Window visits over all passes
+  uint64_t accepted = 0;       // Visits that passed every filter
+  int64_t total_ns = 0;
+  int64_t ns_per_pass = 0;
+  EnumApi worst_api = EnumApi::IsWindowVisible; // Slowest single query
+  int64_t worst_ns = 0;
+  std::string worst_title;
+  std::string costliest_title; // Title whose windows cost the most in total
+  int64_t costliest_title_ns = 0;
+  size_t titles = 0;
+  bool offender = false;
+};
+
+struct IgnoreSuggestion {
+  enum class Kind { Process, ProcessTitlePair, WindowTitle };
+  Kind kind;
+  std::string process;
+  std::string title;
+  std::string reason;
+};
+
+// Processes costing at least offender_pass_ns per pass, or with a single query taking at least
+// slow_query_ns, are flagged
+struct EnumProfileThresholds {
+  int64_t offender_pass_ns = 1'000'000;
+  int64_t slow_query_ns = 10'000'000;
+  size_t max_offenders = 10;
+};
+
+struct EnumProfileReport {
+  uint64_t passes = 0;
+  int64_t total_ns = 0; // Whole enumeration passes, including time outside the queries
+  int64_t max_pass_ns = 0;
+  uint64_t windows_visited = 0;
+  std::vector<EnumApiStats> apis;           // Most expensive first, unused APIs left out
+  std::vector<EnumProcessStats> processes;  // Most expensive first
+  std::vector<IgnoreSuggestion> suggestions; // One per offender not already ignored
+};
+
+// Aggregates profiled enumeration passes per process and per API
+class EnumProfiler {
+public:
+  void add_pass(const std::vector<WindowQuerySample>& samples, int64_t pass_ns);
+
+  [[nodiscard]] uint64_t passes() const { return passes_; }
+
+  [[nodiscard]] EnumProfileReport report(const IgnoreOptions& ignore_options,
+                                         const EnumProfileThresholds& thresholds = {}) const;
+
+private:
+  struct ProcessAccumulator {
+    std::unordered_set<size_t> windows;
+    uint64_t samples = 0;
+    uint64_t accepted = 0;
+    int64_t total_ns = 0;
+    EnumApi worst_api = EnumApi::IsWindowVisible;
+    int64_t worst_ns = 0;
+    std::string worst_title;
+    std::map<std::string, int64_t> ns_per_title;
+  };
+
+  uint64_t passes_ = 0;
+  int64_t total_ns_ = 0;
+  int64_t max_pass_ns_ = 0;
+  uint64_t windows_visited_ = 0;
+  EnumApiStats apis_[kEnumApiCount]{};
+  std::map<std::string, ProcessAccumulator> processes_;
+};
+
+// Human readable report: per API and per process tables, then the suggested ignore rules as a
+// TOML snippet for the [ignore] section
+std::string format_enum_profile_report(const EnumProfileReport& report);
+
+} // namespace wintiler
@@ -0,0 +1,229 @@
+#include "executor.h"
+
+#include <cassert>
+#include <utility>
+
+namespace wintiler {
+namespace exec {
+
+// ============================================================================
+// Task
+// ============================================================================
+
+void Task::FinalAwaiter::await_suspend(Handle handle) noexcept {
+  // Destroying the frame from its own final suspend point is well-defined
+  handle.promise().executor->on_task_done(handle);
+}
+
+Task::Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {
+}
+
+Task& Task::operator=(Task&& other) noexcept {
+  if (this != &other) {
+    if (handle_) {
+      handle_.destroy();
+    }
+    handle_ = std::exchange(other.handle_, nullptr);
+  }
+  return *this;
+}
+
+Task::~Task() {
+  if (handle_) {
+    handle_.destroy();
+  }
+}
+
+Task::Handle Task::release() {
+  return std::exchange(handle_, nullptr);
+}
+
+// ============================================================================
+// Executor
+// ============================================================================
+
+Executor::Executor(Backend backend) : backend_(std::move(backend)) {
+}
+
+Executor::~Executor() {
+  for (void* address : live_) {
+    std::coroutine_handle<>::from_address(address).destroy();
+  }
+}
+
+void Executor::spawn(Task task, Priority priority) {
+  auto handle = task.release();
+  handle.promise().executor = this;
+  handle.promise().priority = priority;
+  live_.insert(handle.address());
+  schedule(handle);
+}
+
+void Executor::run() {
+  while (!stopped_ && !live_.empty()) {
+    fire_due_timers();
+    if (auto handle = pop_ready()) {
+      handle->resume();
+      if (backend_.poll) {
+        backend_.poll();
+      }
+      continue;
+    }
+
+    // A timed event wait that set() already satisfied must not set the backend deadline
+    drop_stale_timers();
+    std::optional<TimePoint> deadline;
+    if (!timers_.empty()) {
+      deadline = timers_.top().deadline;
+    }
+    backend_.wait(deadline);
+    if (backend_.poll) {
+      backend_.poll();
+    }
+  }
+}
+
+void Executor::stop() {
+  stopped_ = true;
+}
+
+bool Executor::is_stopped() const {
+  return stopped_;
+}
+
+TimePoint Executor::now() const {
+  return backend_.now();
+}
+
+size_t Executor::task_count() const {
+  return live_.size();
+}
+
+void Executor::set_poll(std::function<void()> poll) {
+  backend_.poll = std::move(poll);
+}
+
+Executor::SleepAwaiter Executor::sleep_for(Duration duration) {
+  return SleepAwaiter{*this, now() + duration};
+}
+
+Executor::SleepAwaiter Executor::sleep_until(TimePoint deadline) {
+  return SleepAwaiter{*this, deadline};
+}
+
+Executor::YieldAwaiter Executor::yield() {
+  return YieldAwaiter{*this};
+}
+
+void Executor::schedule(Task::Handle handle) {
+  ready_[static_cast<size_t>(handle.promise().priority)].push_back(handle);
+}
+
+void Executor::add_timer(TimePoint deadline, Task::Handle handle, Event* event,
+                         uint64_t wait_id) {
+  timers_.push(Timer{deadline, timer_sequence_++, handle, event, wait_id});
+}
+
+void Executor::fire_due_timers() {
+  auto current = now();
+  while (!timers_.empty() && timers_.top().deadline <= current) {
+    Timer timer = timers_.top();
+    timers_.pop();
+    if (timer.event == nullptr) {
+      schedule(timer.handle);
+      continue;
+    }
+    // Timed event wait: only fire if the same wait is still pending
+    if (is_stale(timer)) {
+      continue;
+    }
+    Event& event = *timer.event;
+    event.awaiter_->signaled = false;
+    event.awaiter_ = nullptr;
+    event.waiter_ = nullptr;
+    schedule(timer.handle);
+  }
+}
+
+void Executor::drop_stale_timers() {
+  while (!timers_.empty() && is_stale(timers_.top())) {
+    timers_.pop();
+  }
+}
+
+bool Executor::is_stale(const Timer& timer) const {
+  return timer.event != nullptr &&
+         (timer.event->awaiter_ == nullptr || timer.event->wait_id_ != timer.wait_id);
+}
+
+std::optional<Task::Handle> Executor::pop_ready() {
+  for (auto& queue : ready_) {
+    if (!queue.empty()) {
+      auto handle = queue.front();
+      queue.pop_front();
+      return handle;
+    }
+  }
+  return std::nullopt;
+}
+
+void Executor::on_task_done(Task::Handle handle) {
+  live_.erase(handle.address());
+  handle.destroy();
+}
+
+// ============================================================================
+// Event
+// ============================================================================
+
+void Event::set() {
+  if (awaiter_ == nullptr) {
+    signaled_ = true;
+    return;
+  }
+  awaiter_->signaled = true;
+  awaiter_ = nullptr;
+  executor_.schedule(std::exchange(waiter_, nullptr));
+}
+
+bool Event::is_set() const {
+  return signaled_;
+}
+
+Event::Awaiter Event::wait() {
+  return Awaiter{*this, std::nullopt};
+}
+
+Event::Awaiter Event::wait_for(Duration timeout) {
+  return Awaiter{*this, timeout};
+}
+
+bool Event::Awaiter::await_ready() {
+  if (event.signaled_) {
+    event.signaled_ = false;
+    signaled = true;
+    return true;
+  }
+  return false;
+}
+
+void Event::Awaiter::await_suspend(Task::Handle handle) {
+  assert(event.awaiter_ == nullptr && "Event supports a single waiter");
+  event.awaiter_ = this;
+  event.waiter_ = handle;
+  ++event.wait_id_;
+  if (timeout.has_value()) {
+    event.executor_.add_timer(event.executor_.now() + *timeout, handle, &event, event.wait_id_);
+  }
+}
+
+bool Event::Awaiter::await_resume() {
+  if (signaled) {
+    // set() calls made while this wakeup sat in the ready queue are part of it
+    event.signaled_ = false;
+  }
+  return signaled;
+}
+
+} // namespace exec
+} // namespace wintiler
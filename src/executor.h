@@ -0,0 +1,234 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <unordered_set>
+#include <vector>
+
+namespace wintiler {
+namespace exec {
+
+using Clock = std::chrono::steady_clock;
+using TimePoint = Clock::time_point;
+using Duration = Clock::duration;
+
+// Scheduling priority; ready tasks of a higher priority always resume first
+enum class Priority {
+  High,
+  Normal,
+  Low,
+};
+constexpr size_t kPriorityCount = 3;
+
+class Executor;
+class Event;
+
+// ============================================================================
+// Task
+// ============================================================================
+
+// Fire-and-forget coroutine. Created suspended; Executor::spawn takes ownership,
+// starts it and destroys the frame when it finishes.
+class Task {
+public:
+  struct promise_type;
+  using Handle = std::coroutine_handle<promise_type>;
+
+  struct FinalAwaiter {
+    bool await_ready() noexcept {
+      return false;
+    }
+    void await_suspend(Handle handle) noexcept;
+    void await_resume() noexcept {
+    }
+  };
+
+  struct promise_type {
+    Executor* executor = nullptr;
+    Priority priority = Priority::Normal;
+
+    Task get_return_object() {
+      return Task{Handle::from_promise(*this)};
+    }
+    std::suspend_always initial_suspend() noexcept {
+      return {};
+    }
+    FinalAwaiter final_suspend() noexcept {
+      return {};
+    }
+    void return_void() {
+    }
+    void unhandled_exception() {
+      std::terminate();
+    }
+  };
+
+  Task(Task&& other) noexcept;
+  Task& operator=(Task&& other) noexcept;
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+  ~Task();
+
+  // Hand the coroutine frame over to the caller
+  Handle release();
+
+private:
+  explicit Task(Handle handle) : handle_(handle) {
+  }
+  Handle handle_;
+};
+
+// ============================================================================
+// Executor
+// ============================================================================
+
+// Single-threaded cooperative scheduler. Tasks run until they await; between task steps
+// the backend is polled so external events are noticed without waiting for a full cycle.
+class Executor {
+public:
+  struct Backend {
+    std::function<TimePoint()> now;
+    // Block until external input may be available or the deadline passes (nullopt = no deadline)
+    std::function<void(std::optional<TimePoint> deadline)> wait;
+    // Non-blocking check of external sources; called after every task step and every wait
+    std::function<void()> poll;
+  };
+
+  explicit Executor(Backend backend);
+  ~Executor();
+
+  Executor(const Executor&) = delete;
+  Executor& operator=(const Executor&) = delete;
+
+  void spawn(Task task, Priority priority = Priority::Normal);
+
+  // Run until stop() is called or no tasks remain
+  void run();
+  void stop();
+
+  [[nodiscard]] bool is_stopped() const;
+  [[nodiscard]] TimePoint now() const;
+  [[nodiscard]] size_t task_count() const;
+
+  void set_poll(std::function<void()> poll);
+
+  struct SleepAwaiter {
+    Executor& executor;
+    TimePoint deadline;
+
+    bool await_ready() const {
+      return deadline <= executor.now();
+    }
+    void await_suspend(Task::Handle handle) {
+      executor.add_timer(deadline, handle, nullptr, 0);
+    }
+    void await_resume() const {
+    }
+  };
+
+  struct YieldAwaiter {
+    Executor& executor;
+
+    bool await_ready() const {
+      return false;
+    }
+    void await_suspend(Task::Handle handle) {
+      executor.schedule(handle);
+    }
+    void await_resume() const {
+    }
+  };
+
+  [[nodiscard]] SleepAwaiter sleep_for(Duration duration);
+  [[nodiscard]] SleepAwaiter sleep_until(TimePoint deadline);
+
+  // Let other ready tasks (same or higher priority) run before continuing
+  [[nodiscard]] YieldAwaiter yield();
+
+private:
+  friend struct Task::FinalAwaiter;
+  friend class Event;
+
+  struct Timer {
+    TimePoint deadline;
+    uint64_t sequence; // FIFO order for equal deadlines
+    Task::Handle handle;
+    Event* event; // set for timed event waits
+    uint64_t wait_id;
+
+    bool operator>(const Timer& other) const {
+      if (deadline != other.deadline) {
+        return deadline > other.deadline;
+      }
+      return sequence > other.sequence;
+    }
+  };
+
+  void schedule(Task::Handle handle);
+  void add_timer(TimePoint deadline, Task::Handle handle, Event* event, uint64_t wait_id);
+  void fire_due_timers();
+  void drop_stale_timers();
+  [[nodiscard]] bool is_stale(const Timer& timer) const;
+  std::optional<Task::Handle> pop_ready();
+  void on_task_done(Task::Handle handle);
+
+  Backend backend_;
+  std::array<std::deque<Task::Handle>, kPriorityCount> ready_;
+  std::priority_queue<Timer, std::vector<Timer>, std::greater<>> timers_;
+  std::unordered_set<void*> live_; // Frames owned by this executor
+  uint64_t timer_sequence_ = 0;
+  bool stopped_ = false;
+};
+
+// ============================================================================
+// Event
+// ============================================================================
+
+// Auto-reset signal awaited by a single task. set() before wait() is remembered, and
+// repeated set() calls before the waiter runs (including those made after its wakeup was
+// queued) coalesce into one wakeup.
+class Event {
+public:
+  explicit Event(Executor& executor) : executor_(executor) {
+  }
+
+  Event(const Event&) = delete;
+  Event& operator=(const Event&) = delete;
+
+  void set();
+  [[nodiscard]] bool is_set() const;
+
+  struct Awaiter {
+    Event& event;
+    std::optional<Duration> timeout;
+    bool signaled = true;
+
+    bool await_ready();
+    void await_suspend(Task::Handle handle);
+    bool await_resume();
+  };
+
+  // Resume once set; returns true
+  [[nodiscard]] Awaiter wait();
+
+  // Resume once set (returns true) or after timeout (returns false)
+  [[nodiscard]] Awaiter wait_for(Duration timeout);
+
+private:
+  friend class Executor;
+
+  Executor& executor_;
+  bool signaled_ = false;
+  Awaiter* awaiter_ = nullptr;
+  Task::Handle waiter_{};
+  uint64_t wait_id_ = 0; // Lets a timeout ignore waits that were already satisfied
+};
+
+} // namespace exec
+} // namespace wintiler
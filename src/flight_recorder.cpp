@@ -0,0 +1,238 @@
+#include "flight_recorder.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <fstream>
+
+namespace wintiler {
+
+namespace {
+
+// Field names for id and a..d per event type; nullptr = unused
+struct FieldNames {
+  const char* id;
+  std::array<const char*, 4> values;
+  bool id_is_handle; // Print id as hex (leaf ids are HWNDs)
+};
+
+FieldNames field_names(FlightEventType type) {
+  switch (type) {
+  case FlightEventType::TickStart:
+    return {"tick", {nullptr, nullptr, nullptr, nullptr}, false};
+  case FlightEventType::TickEnd:
+    return {"tick", {"duration_us", "tiles", "added", "removed"}, false};
+  case FlightEventType::LeafAdded:
+  case FlightEventType::LeafRemoved:
+    return {"leaf", {nullptr, nullptr, nullptr, nullptr}, true};
+  case FlightEventType::TileUpdate:
+    return {"leaf", {"x", "y", "width", "height"}, true};
+  case FlightEventType::Hotkey:
+    return {nullptr, {"action", nullptr, nullptr, nullptr}, false};
+  case FlightEventType::DropMove:
+    return {"leaf", {"cursor_x", "cursor_y", "exchange", "performed"}, true};
+  case FlightEventType::MonitorChange:
+    return {nullptr, {"monitors", nullptr, nullptr, nullptr}, false};
+  case FlightEventType::ConfigReload:
+    return {nullptr, {nullptr, nullptr, nullptr, nullptr}, false};
+  case FlightEventType::IpcBatch:
+    return {nullptr, {"commands", "ok", nullptr, nullptr}, false};
+  case FlightEventType::Invariant:
+    return {"cluster", {"cell", "violation", nullptr, nullptr}, false};
+  }
+  return {nullptr, {nullptr, nullptr, nullptr, nullptr}, false};
+}
+
+constexpr std::array kAllTypes = {
+    FlightEventType::TickStart,   FlightEventType::TickEnd,       FlightEventType::LeafAdded,
+    FlightEventType::LeafRemoved, FlightEventType::TileUpdate,    FlightEventType::Hotkey,
+    FlightEventType::DropMove,    FlightEventType::MonitorChange, FlightEventType::ConfigReload,
+    FlightEventType::IpcBatch,    FlightEventType::Invariant,
+};
+
+std::array<int32_t*, 4> value_fields(FlightEvent& event) {
+  return {&event.a, &event.b, &event.c, &event.d};
+}
+
+std::array<int32_t, 4> value_fields(const FlightEvent& event) {
+  return {event.a, event.b, event.c, event.d};
+}
+
+} // namespace
+
+const char* flight_event_type_to_string(FlightEventType type) {
+  switch (type) {
+  case FlightEventType::TickStart:
+    return "TickStart";
+  case FlightEventType::TickEnd:
+    return "TickEnd";
+  case FlightEventType::LeafAdded:
+    return "LeafAdded";
+  case FlightEventType::LeafRemoved:
+    return "LeafRemoved";
+  case FlightEventType::TileUpdate:
+    return "TileUpdate";
+  case FlightEventType::Hotkey:
+    return "Hotkey";
+  case FlightEventType::DropMove:
+    return "DropMove";
+  case FlightEventType::MonitorChange:
+    return "MonitorChange";
+  case FlightEventType::ConfigReload:
+    return "ConfigReload";
+  case FlightEventType::IpcBatch:
+    return "IpcBatch";
+  case FlightEventType::Invariant:
+    return "Invariant";
+  }
+  return "Unknown";
+}
+
+// ============================================================================
+// Recorder
+// ============================================================================
+
+FlightRecorder::FlightRecorder(size_t capacity)
+    : events_(std::bit_ceil(std::max<size_t>(capacity, 1))), mask_(events_.size() - 1),
+      epoch_(Clock::now()) {
+}
+
+size_t FlightRecorder::capacity() const {
+  return events_.size();
+}
+
+size_t FlightRecorder::size() const {
+  return static_cast<size_t>(std::min<uint64_t>(total_recorded(), events_.size()));
+}
+
+uint64_t FlightRecorder::total_recorded() const {
+  return head_.load(std::memory_order_acquire);
+}
+
+std::vector<FlightEvent> FlightRecorder::snapshot() const {
+  uint64_t head = total_recorded();
+  uint64_t count = std::min<uint64_t>(head, events_.size());
+  std::vector<FlightEvent> out;
+  out.reserve(static_cast<size_t>(count));
+  for (uint64_t i = head - count; i < head; ++i) {
+    out.push_back(events_[i & mask_]);
+  }
+  return out;
+}
+
+void FlightRecorder::clear() {
+  head_.store(0, std::memory_order_release);
+}
+
+// ============================================================================
+// Decoding
+// ============================================================================
+
+std::string format_flight_event(const FlightEvent& event) {
+  auto names = field_names(event.type);
+  std::string line = fmt::format("{:>12.6f} {}", static_cast<double>(event.time_us) / 1e6,
+                                 flight_event_type_to_string(event.type));
+  if (names.id != nullptr) {
+    if (names.id_is_handle) {
+      line += fmt::format(" {}={:#x}", names.id, event.id);
+    } else {
+      line += fmt::format(" {}={}", names.id, event.id);
+    }
+  }
+  auto values = value_fields(event);
+  for (size_t i = 0; i < values.size(); ++i) {
+    if (names.values[i] != nullptr) {
+      line += fmt::format(" {}={}", names.values[i], values[i]);
+    }
+  }
+  return line;
+}
+
+std::string format_flight_events(const std::vector<FlightEvent>& events) {
+  std::string out;
+  for (const auto& event : events) {
+    out += format_flight_event(event);
+    out += '\n';
+  }
+  return out;
+}
+
+nlohmann::json flight_events_to_json(const std::vector<FlightEvent>& events) {
+  auto out = nlohmann::json::array();
+  for (const auto& event : events) {
+    auto names = field_names(event.type);
+    nlohmann::json entry{{"t_us", event.time_us},
+                         {"type", flight_event_type_to_string(event.type)}};
+    if (names.id != nullptr) {
+      entry[names.id] = event.id;
+    }
+    auto values = value_fields(event);
+    for (size_t i = 0; i < values.size(); ++i) {
+      if (names.values[i] != nullptr) {
+        entry[names.values[i]] = values[i];
+      }
+    }
+    out.push_back(std::move(entry));
+  }
+  return out;
+}
+
+tl::expected<std::vector<FlightEvent>, std::string>
+flight_events_from_json(const nlohmann::json& json) {
+  if (!json.is_array()) {
+    return tl::unexpected("flight events must be an array");
+  }
+  std::vector<FlightEvent> events;
+  events.reserve(json.size());
+  for (size_t i = 0; i < json.size(); ++i) {
+    const auto& entry = json[i];
+    if (!entry.is_object() || !entry.contains("type") || !entry["type"].is_string() ||
+        !entry.contains("t_us") || !entry["t_us"].is_number_integer()) {
+      return tl::unexpected("event " + std::to_string(i) + ": missing 'type' or 't_us'");
+    }
+    auto type_name = entry["type"].get<std::string>();
+    auto type = std::find_if(kAllTypes.begin(), kAllTypes.end(), [&](FlightEventType t) {
+      return type_name == flight_event_type_to_string(t);
+    });
+    if (type == kAllTypes.end()) {
+      return tl::unexpected("event " + std::to_string(i) + ": unknown type " + type_name);
+    }
+
+    FlightEvent event{};
+    event.type = *type;
+    event.time_us = entry["t_us"].get<int64_t>();
+    auto names = field_names(event.type);
+    if (names.id != nullptr && entry.contains(names.id)) {
+      event.id = entry[names.id].get<uint64_t>();
+    }
+    auto values = value_fields(event);
+    for (size_t v = 0; v < values.size(); ++v) {
+      if (names.values[v] != nullptr && entry.contains(names.values[v])) {
+        *values[v] = entry[names.values[v]].get<int32_t>();
+      }
+    }
+    events.push_back(event);
+  }
+  return events;
+}
+
+bool write_flight_dump(const FlightRecorder& recorder, const std::string& path, bool as_json) {
+  std::ofstream file(path, std::ios::trunc);
+  if (!file) {
+    spdlog::error("Failed to open flight recorder dump file: {}", path);
+    return false;
+  }
+  auto events = recorder.snapshot();
+  if (as_json) {
+    file << flight_events_to_json(events).dump(1) << '\n';
+  } else {
+    file << "# " << events.size() << " of " << recorder.total_recorded()
+         << " recorded events, oldest first\n";
+    file << format_flight_events(events);
+  }
+  return static_cast<bool>(file);
+}
+
+} // namespace wintiler
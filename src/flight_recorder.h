@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <tl/expected.hpp>
+#include <vector>
+
+namespace wintiler {
+
+// ============================================================================
+// Event Model
+// ============================================================================
+
+enum class FlightEventType : uint8_t {
+  TickStart,     // id = tick number
+  TickEnd,       // id = tick number, a = duration us, b = tiles, c = added, d = removed
+  LeafAdded,     // id = leaf id
+  LeafRemoved,   // id = leaf id
+  TileUpdate,    // id = leaf id, a..d = x, y, width, height
+  Hotkey,        // a = hotkey action index
+  DropMove,      // id = dragged leaf, a/b = cursor, c = exchange, d = performed
+  MonitorChange, // a = monitor count
+  ConfigReload,  // no payload
+  IpcBatch,      // a = command count, b = ok
+  Invariant,     // id = cluster index, a = cell index, b = violation type
+};
+
+// Fixed-size binary record. The meaning of id and a..d depends on type (see above).
+struct FlightEvent {
+  int64_t time_us; // Since the recorder was created
+  uint64_t id;
+  int32_t a, b, c, d;
+  FlightEventType type;
+};
+
+const char* flight_event_type_to_string(FlightEventType type);
+
+// ============================================================================
+// Recorder
+// ============================================================================
+
+// Ring buffer of the most recent loop events. Recording is a handful of stores with no
+// allocation, formatting or locking, so it stays on in release builds. Meant for a single
+// writer (the loop thread); readers on other threads get a best-effort snapshot.
+class FlightRecorder {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr size_t kDefaultCapacity = 8192;
+
+  // capacity is rounded up to a power of two
+  explicit FlightRecorder(size_t capacity = kDefaultCapacity);
+
+  void record(FlightEventType type, uint64_t id = 0, int32_t a = 0, int32_t b = 0, int32_t c = 0,
+              int32_t d = 0) {
+    uint64_t index = head_.load(std::memory_order_relaxed);
+    auto& event = events_[index & mask_];
+    event.time_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - epoch_).count();
+    event.id = id;
+    event.a = a;
+    event.b = b;
+    event.c = c;
+    event.d = d;
+    event.type = type;
+    head_.store(index + 1, std::memory_order_release);
+  }
+
+  [[nodiscard]] size_t capacity() const;
+
+  // Events currently held (at most capacity)
+  [[nodiscard]] size_t size() const;
+
+  // Events recorded since creation, including overwritten ones
+  [[nodiscard]] uint64_t total_recorded() const;
+
+  // Held events, oldest first
+  [[nodiscard]] std::vector<FlightEvent> snapshot() const;
+
+  void clear();
+
+private:
+  std::vector<FlightEvent> events_;
+  uint64_t mask_;
+  std::atomic<uint64_t> head_{0};
+  Clock::time_point epoch_;
+};
+
+// ============================================================================
+// Decoding
+// ============================================================================
+
+// One line per event, e.g. "   12.345678 TileUpdate leaf=0x1a2b x=0 y=0 width=960 height=1040"
+std::string format_flight_event(const FlightEvent& event);
+std::string format_flight_events(const std::vector<FlightEvent>& events);
+
+// JSON array of objects with named fields: {"t_us": ..., "type": "TileUpdate", "leaf": ...}
+nlohmann::json flight_events_to_json(const std::vector<FlightEvent>& events);
+tl::expected<std::vector<FlightEvent>, std::string>
+flight_events_from_json(const nlohmann::json& json);
+
+// Write a snapshot as text (or JSON) to path. Used by the dump hotkey and the crash handler.
+bool write_flight_dump(const FlightRecorder& recorder, const std::string& path, bool as_json);
+
+} // namespace wintiler
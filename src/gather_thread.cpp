@@ -0,0 +1,97 @@
+#include "gather_thread.h"
+
+#include <utility>
+
+namespace wintiler {
+
+GatherThread::GatherThread(GatherFn gather, std::function<void()> on_publish)
+    : gather_(std::move(gather)), on_publish_(std::move(on_publish)) {
+}
+
+GatherThread::~GatherThread() {
+  stop();
+}
+
+void GatherThread::start() {
+  if (running_.exchange(true)) {
+    return;
+  }
+  {
+    std::lock_guard lock(mutex_);
+    stopping_ = false;
+  }
+  thread_ = std::thread([this] { run(); });
+}
+
+void GatherThread::stop() {
+  if (!running_.exchange(false)) {
+    return;
+  }
+  {
+    std::lock_guard lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_one();
+  thread_.join();
+}
+
+bool GatherThread::is_running() const {
+  return running_.load();
+}
+
+void GatherThread::request() {
+  {
+    std::lock_guard lock(mutex_);
+    requested_ = true;
+  }
+  wake_.notify_one();
+}
+
+void GatherThread::invalidate() {
+  epoch_.fetch_add(1, std::memory_order_acq_rel);
+  request();
+}
+
+const winapi::LoopInputState* GatherThread::take_latest() {
+  if (!snapshots_.update()) {
+    return nullptr;
+  }
+  const auto& snapshot = snapshots_.read();
+  if (snapshot.epoch != epoch_.load(std::memory_order_acquire)) {
+    return nullptr; // Gathered before an invalidate(); the gather it requested replaces it
+  }
+  ++consumed_;
+  return &snapshot.state;
+}
+
+uint64_t GatherThread::published() const {
+  return published_.load(std::memory_order_relaxed);
+}
+
+uint64_t GatherThread::consumed() const {
+  return consumed_;
+}
+
+void GatherThread::run() {
+  for (;;) {
+    {
+      std::unique_lock lock(mutex_);
+      wake_.wait(lock, [this] { return requested_ || stopping_; });
+      if (stopping_) {
+        return;
+      }
+      requested_ = false;
+    }
+
+    auto& snapshot = snapshots_.write_buffer();
+    snapshot.epoch = epoch_.load(std::memory_order_acquire);
+    snapshot.state = gather_();
+    snapshots_.publish();
+    published_.fetch_add(1, std::memory_order_relaxed);
+    if (on_publish_) {
+      on_publish_();
+    }
+  }
+}
+
+} // namespace wintiler
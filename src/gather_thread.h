@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "concurrent_queue.h"
+#include "winapi.h"
+
+namespace wintiler {
+
+// Runs window enumeration on its own thread so it overlaps with layout, apply and render on
+// the loop thread. Each gather is published as an immutable LoopInputState snapshot through a
+// lock-free triple buffer: the loop always takes the newest one and stale ones are dropped.
+class GatherThread {
+public:
+  using GatherFn = std::function<winapi::LoopInputState()>;
+
+  // gather runs on the worker thread; on_publish is called from it after each snapshot
+  explicit GatherThread(GatherFn gather, std::function<void()> on_publish = {});
+  ~GatherThread();
+
+  GatherThread(const GatherThread&) = delete;
+  GatherThread& operator=(const GatherThread&) = delete;
+
+  void start();
+  // Finish the gather in progress (if any) and join. Safe to call more than once.
+  void stop();
+  [[nodiscard]] bool is_running() const;
+
+  // Ask for a new snapshot. Requests made while a gather is pending coalesce.
+  void request();
+
+  // Loop side: the windows just changed under the loop's feet (a workspace hide/show). Every
+  // snapshot whose gather started before this call is dropped by take_latest, even one that is
+  // published afterwards, and a new gather is requested.
+  void invalidate();
+
+  // Loop side: newest snapshot published since the last call, or nullptr if there is none or
+  // it predates the last invalidate(). The pointer stays valid until the next call.
+  const winapi::LoopInputState* take_latest();
+
+  // Loop side stats; published - consumed is the number of snapshots dropped as stale or
+  // invalidated
+  [[nodiscard]] uint64_t published() const;
+  [[nodiscard]] uint64_t consumed() const;
+
+private:
+  // A gathered state tagged with the epoch current when its gather started
+  struct Snapshot {
+    winapi::LoopInputState state;
+    uint64_t epoch = 0;
+  };
+
+  void run();
+
+  GatherFn gather_;
+  std::function<void()> on_publish_;
+  TripleBuffer<Snapshot> snapshots_;
+  std::atomic<uint64_t> epoch_{0}; // Bumped by invalidate()
+
+  std::thread thread_;
+  std::mutex mutex_; // Guards the request/stop flags only, never the snapshots
+  std::condition_variable wake_;
+  bool requested_ = false;
+  bool stopping_ = false;
+
+  std::atomic<bool> running_{false};
+  std::atomic<uint64_t> published_{0};
+  uint64_t consumed_ = 0;
+};
+
+} // namespace wintiler
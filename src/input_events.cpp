@@ -0,0 +1,57 @@
+#include "input_events.h"
+
+#include <algorithm>
+
+namespace wintiler {
+
+void apply_input_event(InputEventState& state, const InputEvent& event) {
+  switch (event.type) {
+  case InputEventType::MoveSizeStart:
+    state.is_moving = true;
+    state.moving_hwnd = event.hwnd;
+    state.move_ended = false;
+    break;
+  case InputEventType::MoveSizeEnd:
+    state.is_moving = false;
+    state.move_ended = true;
+    state.drag_location_changed = false;
+    // Keep the window from the start event; fall back to the end event's window
+    if (!state.moving_hwnd.has_value()) {
+      state.moving_hwnd = event.hwnd;
+    }
+    break;
+  case InputEventType::Hotkey:
+    state.hotkey_ids.push_back(event.hotkey_id);
+    break;
+  case InputEventType::CursorMove:
+    state.cursor_pos = std::make_pair(event.x, event.y);
+    state.cursor_moved = true;
+    break;
+  case InputEventType::WindowLocation:
+    // Late events from a finished drag or of other windows are not interesting
+    if (state.is_moving && state.moving_hwnd == event.hwnd) {
+      state.drag_location_changed = true;
+    }
+    break;
+  }
+}
+
+size_t drain_input_events(InputEventQueue& queue, InputEventState& state,
+                          std::chrono::steady_clock::time_point now) {
+  size_t count = 0;
+  state.max_latency = {};
+  while (auto event = queue.try_pop()) {
+    apply_input_event(state, *event);
+    state.max_latency = std::max(state.max_latency, now - event->timestamp);
+    ++count;
+  }
+  state.last_drained = count;
+  return count;
+}
+
+void clear_drag_ended(InputEventState& state) {
+  state.move_ended = false;
+  state.moving_hwnd.reset();
+}
+
+} // namespace wintiler
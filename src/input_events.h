@@ -0,0 +1,64 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "concurrent_queue.h"
+
+namespace wintiler {
+
+// Events produced by the hook thread (WinEvent hooks and hotkeys)
+enum class InputEventType {
+  MoveSizeStart,
+  MoveSizeEnd,
+  Hotkey,
+  CursorMove,
+  WindowLocation, // Location change of the window being dragged (live resize)
+};
+
+struct InputEvent {
+  InputEventType type = InputEventType::Hotkey;
+  size_t hwnd = 0;   // Window for move/size and location events
+  int hotkey_id = 0; // Registered id for hotkey events
+  int x = 0;         // Screen position for cursor events
+  int y = 0;
+  std::chrono::steady_clock::time_point timestamp{};
+};
+
+constexpr size_t kInputEventQueueCapacity = 1024;
+using InputEventQueue = MpscQueue<InputEvent, kInputEventQueueCapacity>;
+
+// Loop-side view of the event stream, folded from drained events
+struct InputEventState {
+  // Drag tracking (replaces the polled move/size flags)
+  bool is_moving = false;
+  std::optional<size_t> moving_hwnd;
+  bool move_ended = false;            // One-shot, cleared by clear_drag_ended
+  bool drag_location_changed = false; // One-shot: the dragged window moved or resized
+
+  // Hotkey ids not yet handled, in arrival order
+  std::vector<int> hotkey_ids;
+
+  // Latest cursor position from mouse-move events (nullopt until the first one)
+  std::optional<std::pair<int, int>> cursor_pos;
+  bool cursor_moved = false; // One-shot, cleared by the loop once it used the position
+
+  // Stats for the last drain
+  size_t last_drained = 0;
+  std::chrono::steady_clock::duration max_latency{}; // Hook timestamp to drain
+};
+
+// Fold a single event into the state
+void apply_input_event(InputEventState& state, const InputEvent& event);
+
+// Pop every queued event and fold it into the state. Returns the number of events drained.
+size_t drain_input_events(InputEventQueue& queue, InputEventState& state,
+                          std::chrono::steady_clock::time_point now);
+
+// Acknowledge a finished drag so it is handled only once
+void clear_drag_ended(InputEventState& state);
+
+} // namespace wintiler
@@ -0,0 +1,196 @@
+#include "invariant_check.h"
+
+#include <algorithm>
+
+namespace wintiler {
+namespace cells {
+
+namespace {
+
+// Rects are recomputed in floats from ratios, so allow sub-pixel drift
+constexpr float kRectTolerance = 0.5f;
+
+bool is_live(const CellCluster& cluster, int cell_index) {
+  return cell_index >= 0 && static_cast<size_t>(cell_index) < cluster.cells.size() &&
+         !cluster.cells[static_cast<size_t>(cell_index)].is_dead;
+}
+
+bool contains(const Rect& outer, const Rect& inner) {
+  return inner.x >= outer.x - kRectTolerance && inner.y >= outer.y - kRectTolerance &&
+         inner.x + inner.width <= outer.x + outer.width + kRectTolerance &&
+         inner.y + inner.height <= outer.y + outer.height + kRectTolerance;
+}
+
+bool has_area(const Rect& rect) {
+  return rect.width > 0.0f && rect.height > 0.0f;
+}
+
+} // namespace
+
+const char* invariant_violation_type_to_string(InvariantViolation::Type type) {
+  switch (type) {
+  case InvariantViolation::Type::BrokenLink:
+    return "BrokenLink";
+  case InvariantViolation::Type::BadShape:
+    return "BadShape";
+  case InvariantViolation::Type::DuplicateLeafId:
+    return "DuplicateLeafId";
+  case InvariantViolation::Type::RectOutsideParent:
+    return "RectOutsideParent";
+  case InvariantViolation::Type::InvalidSelection:
+    return "InvalidSelection";
+  }
+  return "Unknown";
+}
+
+std::vector<InvariantViolation> InvariantChecker::check(System& system) {
+  ++passes_;
+  std::vector<InvariantViolation> violations;
+
+  if (system.clusters.size() != cluster_count_) {
+    cluster_count_ = system.clusters.size();
+    full_pass_ = true;
+  }
+  if (full_pass_) {
+    leaf_locations_.clear();
+  }
+
+  for (size_t ci = 0; ci < system.clusters.size(); ++ci) {
+    CellCluster& cluster = system.clusters[ci].cluster;
+    if (full_pass_ || cluster.all_cells_touched) {
+      for (int i = 0; i < static_cast<int>(cluster.cells.size()); ++i) {
+        check_cell(system, ci, i, violations);
+      }
+    } else if (!cluster.touched_cells.empty()) {
+      // A cell is usually touched more than once per mutation (links, then rects)
+      auto& touched = cluster.touched_cells;
+      std::sort(touched.begin(), touched.end());
+      touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+      for (int i : touched) {
+        check_cell(system, ci, i, violations);
+      }
+    }
+    cluster.touched_cells.clear();
+    cluster.all_cells_touched = false;
+  }
+  full_pass_ = false;
+
+  if (system.selection.has_value()) {
+    const auto& sel = *system.selection;
+    if (sel.cluster_index >= system.clusters.size() ||
+        !is_leaf(system.clusters[sel.cluster_index].cluster, sel.cell_index)) {
+      violations.push_back({InvariantViolation::Type::InvalidSelection, sel.cluster_index,
+                            sel.cell_index});
+    }
+  }
+
+  // Deleted leaves leave their entries behind; drop them once they outnumber the live ones
+  size_t live_leaves = 0;
+  for (const auto& pc : system.clusters) {
+    live_leaves += pc.cluster.leaf_fingerprint.count;
+  }
+  if (leaf_locations_.size() > 2 * live_leaves + 64) {
+    prune_index(system);
+  }
+
+  return violations;
+}
+
+void InvariantChecker::reset() {
+  full_pass_ = true;
+}
+
+uint64_t InvariantChecker::passes() const {
+  return passes_;
+}
+
+uint64_t InvariantChecker::cells_checked() const {
+  return cells_checked_;
+}
+
+void InvariantChecker::check_cell(const System& system, size_t cluster_index, int cell_index,
+                                  std::vector<InvariantViolation>& out) {
+  const PositionedCluster& pc = system.clusters[cluster_index];
+  const CellCluster& cluster = pc.cluster;
+  if (!is_live(cluster, cell_index)) {
+    return;
+  }
+  ++cells_checked_;
+  const Cell& cell = cluster.cells[static_cast<size_t>(cell_index)];
+  auto report = [&](InvariantViolation::Type type, size_t leaf_id = 0) {
+    out.push_back({type, cluster_index, cell_index, leaf_id});
+  };
+
+  // Only the root (index 0) is parentless
+  if (cell.parent.has_value() == (cell_index == 0)) {
+    report(InvariantViolation::Type::BadShape);
+  }
+  if (cell.leaf_id.has_value() != !cell.first_child.has_value() ||
+      cell.first_child.has_value() != cell.second_child.has_value()) {
+    report(InvariantViolation::Type::BadShape);
+  }
+
+  if (cell.parent.has_value()) {
+    int p = *cell.parent;
+    if (!is_live(cluster, p)) {
+      report(InvariantViolation::Type::BrokenLink);
+    } else {
+      const Cell& parent = cluster.cells[static_cast<size_t>(p)];
+      if (parent.first_child != cell_index && parent.second_child != cell_index) {
+        report(InvariantViolation::Type::BrokenLink);
+      } else if (has_area(cell.rect) && !contains(parent.rect, cell.rect)) {
+        report(InvariantViolation::Type::RectOutsideParent);
+      }
+    }
+  } else if (cell_index == 0 && has_area(cell.rect) && cluster.window_width > 0.0f &&
+             cluster.window_height > 0.0f &&
+             !contains(Rect{0.0f, 0.0f, cluster.window_width, cluster.window_height},
+                       cell.rect)) {
+    report(InvariantViolation::Type::RectOutsideParent);
+  }
+
+  for (const auto& child : {cell.first_child, cell.second_child}) {
+    if (child.has_value() &&
+        (!is_live(cluster, *child) ||
+         cluster.cells[static_cast<size_t>(*child)].parent != cell_index)) {
+      report(InvariantViolation::Type::BrokenLink);
+    }
+  }
+
+  if (!cell.leaf_id.has_value()) {
+    return;
+  }
+  size_t leaf_id = *cell.leaf_id;
+  Location here{cluster_index, cell_index};
+  auto [it, inserted] = leaf_locations_.try_emplace(leaf_id, here);
+  if (inserted || (it->second.cluster_index == cluster_index &&
+                   it->second.cell_index == cell_index)) {
+    return;
+  }
+  // The recorded place is stale unless a live leaf there still holds the id
+  const Location seen = it->second;
+  if (seen.cluster_index < system.clusters.size()) {
+    const CellCluster& other = system.clusters[seen.cluster_index].cluster;
+    if (is_leaf(other, seen.cell_index) &&
+        other.cells[static_cast<size_t>(seen.cell_index)].leaf_id == leaf_id) {
+      report(InvariantViolation::Type::DuplicateLeafId, leaf_id);
+      return;
+    }
+  }
+  it->second = here;
+}
+
+void InvariantChecker::prune_index(const System& system) {
+  for (auto it = leaf_locations_.begin(); it != leaf_locations_.end();) {
+    const Location& seen = it->second;
+    bool held = seen.cluster_index < system.clusters.size() &&
+                is_leaf(system.clusters[seen.cluster_index].cluster, seen.cell_index) &&
+                system.clusters[seen.cluster_index]
+                        .cluster.cells[static_cast<size_t>(seen.cell_index)]
+                        .leaf_id == it->first;
+    it = held ? std::next(it) : leaf_locations_.erase(it);
+  }
+}
+
+} // namespace cells
+} // namespace wintiler
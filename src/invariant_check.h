@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "multi_cells.h"
+
+namespace wintiler {
+namespace cells {
+
+struct InvariantViolation {
+  enum class Type {
+    BrokenLink,        // Parent/child pointers disagree or point at a dead or missing cell
+    BadShape,          // Leaf with children, split without both, or a parentless non-root
+    DuplicateLeafId,   // leaf_id is also held by another live leaf
+    RectOutsideParent, // Cell rect sticks out of its parent (root: out of its window)
+    InvalidSelection,  // Selection is not a live leaf
+  };
+  Type type;
+  size_t cluster_index;
+  int cell_index;     // Selected cell for InvalidSelection
+  size_t leaf_id = 0; // DuplicateLeafId only
+
+  bool operator==(const InvariantViolation&) const = default;
+};
+
+const char* invariant_violation_type_to_string(InvariantViolation::Type type);
+
+// Checks the cell tree invariants incrementally: each pass looks only at the cells the
+// mutations since the previous pass marked in CellCluster::touched_cells (plus the selection),
+// and clears the marks. Leaf-id uniqueness is checked through an index of where every leaf was
+// last seen rather than by collecting and sorting all ids. No logging, so it can run on every
+// loop tick in release builds.
+class InvariantChecker {
+public:
+  // Check the touched cells and clear their marks. The first pass, one after reset() and one
+  // after the cluster count changed check every cell.
+  std::vector<InvariantViolation> check(System& system);
+
+  // The system was replaced wholesale; forget the leaf index
+  void reset();
+
+  // Totals over all passes
+  [[nodiscard]] uint64_t passes() const;
+  [[nodiscard]] uint64_t cells_checked() const;
+
+private:
+  struct Location {
+    size_t cluster_index;
+    int cell_index;
+  };
+
+  void check_cell(const System& system, size_t cluster_index, int cell_index,
+                  std::vector<InvariantViolation>& out);
+  void prune_index(const System& system);
+
+  std::unordered_map<size_t, Location> leaf_locations_; // Last place each leaf id was seen
+  size_t cluster_count_ = 0;
+  bool full_pass_ = true;
+  uint64_t passes_ = 0;
+  uint64_t cells_checked_ = 0;
+};
+
+} // namespace cells
+} // namespace wintiler
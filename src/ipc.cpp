@@ -0,0 +1,545 @@
+#include "ipc.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "flight_recorder.h"
+
+namespace wintiler {
+namespace ipc {
+
+namespace {
+
+// ============================================================================
+// Parsing helpers
+// ============================================================================
+
+std::optional<cells::Direction> parse_direction(const std::string& str) {
+  if (str == "left") {
+    return cells::Direction::Left;
+  }
+  if (str == "right") {
+    return cells::Direction::Right;
+  }
+  if (str == "up") {
+    return cells::Direction::Up;
+  }
+  if (str == "down") {
+    return cells::Direction::Down;
+  }
+  return std::nullopt;
+}
+
+const char* split_mode_to_string(cells::SplitMode mode) {
+  switch (mode) {
+  case cells::SplitMode::Zigzag:
+    return "zigzag";
+  case cells::SplitMode::Vertical:
+    return "vertical";
+  case cells::SplitMode::Horizontal:
+    return "horizontal";
+  }
+  return "unknown";
+}
+
+const char* split_dir_to_string(cells::SplitDir dir) {
+  switch (dir) {
+  case cells::SplitDir::Vertical:
+    return "vertical";
+  case cells::SplitDir::Horizontal:
+    return "horizontal";
+  }
+  return "unknown";
+}
+
+std::optional<size_t> get_leaf_field(const nlohmann::json& obj, const char* key,
+                                     std::string& error) {
+  if (!obj.contains(key)) {
+    return std::nullopt;
+  }
+  const auto& value = obj[key];
+  if (!value.is_number_unsigned()) {
+    error = std::string("'") + key + "' must be a non-negative integer";
+    return std::nullopt;
+  }
+  return static_cast<size_t>(value.get<uint64_t>());
+}
+
+tl::expected<Command, std::string> parse_command(const nlohmann::json& obj) {
+  if (!obj.is_object()) {
+    return tl::unexpected("command must be an object");
+  }
+  if (!obj.contains("cmd") || !obj["cmd"].is_string()) {
+    return tl::unexpected("command is missing 'cmd'");
+  }
+  auto name = obj["cmd"].get<std::string>();
+
+  std::string error;
+  Command cmd{};
+  cmd.leaf_id = get_leaf_field(obj, "leaf", error);
+  cmd.target_leaf_id = get_leaf_field(obj, "target", error);
+  if (!error.empty()) {
+    return tl::unexpected(error);
+  }
+
+  if (name == "navigate") {
+    cmd.type = CommandType::Navigate;
+    if (!obj.contains("dir") || !obj["dir"].is_string()) {
+      return tl::unexpected("navigate requires 'dir'");
+    }
+    cmd.direction = parse_direction(obj["dir"].get<std::string>());
+    if (!cmd.direction.has_value()) {
+      return tl::unexpected("invalid direction: " + obj["dir"].get<std::string>());
+    }
+  } else if (name == "swap") {
+    cmd.type = CommandType::Swap;
+  } else if (name == "move") {
+    cmd.type = CommandType::Move;
+    if (!cmd.target_leaf_id.has_value()) {
+      return tl::unexpected("move requires 'target'");
+    }
+  } else if (name == "set-ratio") {
+    cmd.type = CommandType::SetRatio;
+    if (!obj.contains("ratio") || !obj["ratio"].is_number()) {
+      return tl::unexpected("set-ratio requires numeric 'ratio'");
+    }
+    cmd.ratio = obj["ratio"].get<float>();
+  } else if (name == "zen") {
+    cmd.type = CommandType::Zen;
+    std::string state = obj.value("state", "toggle");
+    if (state == "toggle") {
+      cmd.zen_state = ZenState::Toggle;
+    } else if (state == "on") {
+      cmd.zen_state = ZenState::On;
+    } else if (state == "off") {
+      cmd.zen_state = ZenState::Off;
+    } else {
+      return tl::unexpected("invalid zen state: " + state);
+    }
+  } else if (name == "split-mode") {
+    cmd.type = CommandType::SplitMode;
+    std::string mode = obj.value("mode", "cycle");
+    if (mode == "zigzag") {
+      cmd.split_mode = cells::SplitMode::Zigzag;
+    } else if (mode == "vertical") {
+      cmd.split_mode = cells::SplitMode::Vertical;
+    } else if (mode == "horizontal") {
+      cmd.split_mode = cells::SplitMode::Horizontal;
+    } else if (mode != "cycle") {
+      return tl::unexpected("invalid split mode: " + mode);
+    }
+  } else if (name == "query") {
+    cmd.type = CommandType::Query;
+  } else if (name == "recorder") {
+    cmd.type = CommandType::Recorder;
+    std::string format = obj.value("format", "json");
+    if (format == "text") {
+      cmd.as_text = true;
+    } else if (format != "json") {
+      return tl::unexpected("invalid recorder format: " + format);
+    }
+    cmd.last = get_leaf_field(obj, "last", error);
+    if (!error.empty()) {
+      return tl::unexpected(error);
+    }
+  } else if (name == "layout") {
+    cmd.type = CommandType::Layout;
+    if (!obj.contains("name") || !obj["name"].is_string()) {
+      return tl::unexpected("layout requires 'name'");
+    }
+    cmd.layout_name = obj["name"].get<std::string>();
+    cmd.cluster_index = get_leaf_field(obj, "cluster", error);
+    if (!error.empty()) {
+      return tl::unexpected(error);
+    }
+  } else {
+    return tl::unexpected("unknown command: " + name);
+  }
+  return cmd;
+}
+
+// ============================================================================
+// Execution helpers
+// ============================================================================
+
+struct LeafLocation {
+  size_t cluster_index;
+  int cell_index;
+};
+
+std::optional<LeafLocation> find_leaf(const cells::System& system, size_t leaf_id) {
+  for (size_t ci = 0; ci < system.clusters.size(); ++ci) {
+    if (auto idx = cells::find_cell_by_leaf_id(system.clusters[ci].cluster, leaf_id)) {
+      return LeafLocation{ci, *idx};
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<size_t> selected_leaf_id(const cells::System& system) {
+  if (!system.selection.has_value()) {
+    return std::nullopt;
+  }
+  const auto& cluster = system.clusters[system.selection->cluster_index].cluster;
+  return cluster.cells[static_cast<size_t>(system.selection->cell_index)].leaf_id;
+}
+
+// Resolve the command's source leaf: explicit leaf id, else the current selection
+std::optional<LeafLocation> resolve_source(const cells::System& system, const Command& cmd,
+                                           std::string& error) {
+  auto leaf_id = cmd.leaf_id.has_value() ? cmd.leaf_id : selected_leaf_id(system);
+  if (!leaf_id.has_value()) {
+    error = "no leaf given and nothing selected";
+    return std::nullopt;
+  }
+  auto location = find_leaf(system, *leaf_id);
+  if (!location.has_value()) {
+    error = "leaf not found: " + std::to_string(*leaf_id);
+  }
+  return location;
+}
+
+CommandResult fail(std::string message) {
+  return CommandResult{false, std::move(message), nullptr};
+}
+
+CommandResult run_command(cells::System& system, const Command& cmd, const ApplyContext& context,
+                          BatchResult& batch_result) {
+  std::string error;
+  switch (cmd.type) {
+  case CommandType::Navigate: {
+    auto moved = cells::move_selection(system, *cmd.direction);
+    if (!moved.has_value()) {
+      return fail("cannot move selection in that direction");
+    }
+    batch_result.window_to_foreground = moved->leaf_id;
+    batch_result.cursor_pos = moved->center;
+    return CommandResult{true, "", {{"leaf", moved->leaf_id}}};
+  }
+  case CommandType::Swap: {
+    auto source = resolve_source(system, cmd, error);
+    if (!source.has_value()) {
+      return fail(error);
+    }
+    size_t source_leaf = *system.clusters[source->cluster_index]
+                              .cluster.cells[static_cast<size_t>(source->cell_index)]
+                              .leaf_id;
+    auto target_leaf = cmd.target_leaf_id;
+    if (!target_leaf.has_value()) {
+      // No target: exchange with the source cell's sibling
+      target_leaf = cells::get_sibling_leaf_id(system.clusters[source->cluster_index].cluster,
+                                               source->cell_index);
+      if (!target_leaf.has_value()) {
+        return fail("swap requires 'target' when the leaf has no leaf sibling");
+      }
+    }
+    auto target = find_leaf(system, *target_leaf);
+    if (!target.has_value()) {
+      return fail("target not found: " + std::to_string(*target_leaf));
+    }
+    auto center =
+        cells::swap_cells(system, source->cluster_index, source_leaf, target->cluster_index,
+                          *target_leaf, context.gap_horizontal, context.gap_vertical);
+    if (!center.has_value()) {
+      return fail("swap failed");
+    }
+    if (source->cluster_index != target->cluster_index) {
+      batch_result.reassigned_windows.push_back({source_leaf, target->cluster_index});
+      batch_result.reassigned_windows.push_back({*target_leaf, source->cluster_index});
+    }
+    batch_result.cursor_pos = *center;
+    return CommandResult{true, "", nullptr};
+  }
+  case CommandType::Move: {
+    auto source = resolve_source(system, cmd, error);
+    if (!source.has_value()) {
+      return fail(error);
+    }
+    size_t source_leaf = *system.clusters[source->cluster_index]
+                              .cluster.cells[static_cast<size_t>(source->cell_index)]
+                              .leaf_id;
+    auto target = find_leaf(system, *cmd.target_leaf_id);
+    if (!target.has_value()) {
+      return fail("target not found: " + std::to_string(*cmd.target_leaf_id));
+    }
+    auto moved =
+        cells::move_cell(system, source->cluster_index, source_leaf, target->cluster_index,
+                         *cmd.target_leaf_id, context.gap_horizontal, context.gap_vertical);
+    if (!moved.has_value()) {
+      return fail("move failed");
+    }
+    if (moved->new_cluster_index != source->cluster_index) {
+      batch_result.reassigned_windows.push_back({source_leaf, moved->new_cluster_index});
+    }
+    batch_result.cursor_pos = moved->center;
+    return CommandResult{true, "", {{"cluster", moved->new_cluster_index}}};
+  }
+  case CommandType::SetRatio: {
+    auto source = resolve_source(system, cmd, error);
+    if (!source.has_value()) {
+      return fail(error);
+    }
+    auto& cluster = system.clusters[source->cluster_index].cluster;
+    auto parent = cluster.cells[static_cast<size_t>(source->cell_index)].parent;
+    if (!parent.has_value()) {
+      return fail("leaf has no parent split");
+    }
+    if (!cells::set_split_ratio(cluster, *parent, cmd.ratio, context.gap_horizontal,
+                                context.gap_vertical)) {
+      return fail("set-ratio failed");
+    }
+    return CommandResult{
+        true, "", {{"ratio", cluster.cells[static_cast<size_t>(*parent)].split_ratio}}};
+  }
+  case CommandType::Zen: {
+    auto source = resolve_source(system, cmd, error);
+    if (!source.has_value()) {
+      return fail(error);
+    }
+    bool is_zen = cells::is_cell_zen(system, source->cluster_index, source->cell_index);
+    bool want_zen = cmd.zen_state == ZenState::On ||
+                    (cmd.zen_state == ZenState::Toggle && !is_zen);
+    if (want_zen) {
+      size_t leaf = *system.clusters[source->cluster_index]
+                         .cluster.cells[static_cast<size_t>(source->cell_index)]
+                         .leaf_id;
+      if (!cells::set_zen(system, source->cluster_index, leaf)) {
+        return fail("zen failed");
+      }
+    } else if (is_zen) {
+      cells::clear_zen(system, source->cluster_index);
+    }
+    return CommandResult{true, "", {{"zen", want_zen}}};
+  }
+  case CommandType::SplitMode: {
+    if (cmd.split_mode.has_value()) {
+      system.split_mode = *cmd.split_mode;
+    } else if (!cells::cycle_split_mode(system)) {
+      return fail("cycle split mode failed");
+    }
+    return CommandResult{true, "", {{"mode", split_mode_to_string(system.split_mode)}}};
+  }
+  case CommandType::Query:
+    return CommandResult{true, "", query_system(system)};
+  case CommandType::Recorder: {
+    if (context.recorder == nullptr) {
+      return fail("flight recorder not available");
+    }
+    auto events = context.recorder->snapshot();
+    if (cmd.last.has_value() && *cmd.last < events.size()) {
+      events.erase(events.begin(), events.end() - static_cast<std::ptrdiff_t>(*cmd.last));
+    }
+    nlohmann::json data{{"total", context.recorder->total_recorded()}};
+    if (cmd.as_text) {
+      data["text"] = format_flight_events(events);
+    } else {
+      data["events"] = flight_events_to_json(events);
+    }
+    return CommandResult{true, "", std::move(data)};
+  }
+  case CommandType::Layout: {
+    if (context.layouts == nullptr || !context.describe_window) {
+      return fail("layouts not available");
+    }
+    const auto* layout = find_layout_template(*context.layouts, cmd.layout_name);
+    if (layout == nullptr) {
+      return fail("unknown layout: " + cmd.layout_name);
+    }
+    size_t cluster_index = cmd.cluster_index.value_or(
+        system.selection.has_value() ? system.selection->cluster_index : 0);
+    if (cluster_index >= system.clusters.size()) {
+      return fail("cluster not found: " + std::to_string(cluster_index));
+    }
+    // The cluster's own windows get the first pick, then every other managed window
+    std::vector<WindowDescription> windows;
+    for (size_t leaf_id : cells::get_cluster_leaf_ids(system.clusters[cluster_index].cluster)) {
+      windows.push_back(context.describe_window(leaf_id));
+    }
+    for (size_t ci = 0; ci < system.clusters.size(); ++ci) {
+      if (ci == cluster_index) {
+        continue;
+      }
+      for (size_t leaf_id : cells::get_cluster_leaf_ids(system.clusters[ci].cluster)) {
+        windows.push_back(context.describe_window(leaf_id));
+      }
+    }
+    auto match = apply_layout_template(system, cluster_index, *layout, windows,
+                                       context.gap_horizontal, context.gap_vertical);
+    if (!match.has_value()) {
+      return fail("layout '" + cmd.layout_name + "' matched no window");
+    }
+    for (size_t leaf_id : match->claimed_leaf_ids) {
+      batch_result.reassigned_windows.push_back({leaf_id, cluster_index});
+    }
+    return CommandResult{true,
+                         "",
+                         {{"cluster", cluster_index},
+                          {"slots", match->slot_count},
+                          {"filled", match->slotted_leaf_ids.size()}}};
+  }
+  }
+  return fail("unhandled command");
+}
+
+} // namespace
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+tl::expected<CommandBatch, std::string> parse_batch(const std::string& line) {
+  auto json = nlohmann::json::parse(line, nullptr, false);
+  if (json.is_discarded()) {
+    return tl::unexpected("invalid JSON");
+  }
+
+  CommandBatch batch;
+  const nlohmann::json* commands = &json;
+  if (json.is_object() && json.contains("batch")) {
+    if (json.contains("id")) {
+      batch.id = json["id"];
+    }
+    commands = &json["batch"];
+    if (!commands->is_array()) {
+      return tl::unexpected("'batch' must be an array");
+    }
+  } else if (json.is_object() && json.contains("id")) {
+    batch.id = json["id"];
+  }
+
+  if (commands->is_array()) {
+    batch.commands.reserve(commands->size());
+    for (size_t i = 0; i < commands->size(); ++i) {
+      auto cmd = parse_command((*commands)[i]);
+      if (!cmd.has_value()) {
+        return tl::unexpected("command " + std::to_string(i) + ": " + cmd.error());
+      }
+      batch.commands.push_back(*cmd);
+    }
+  } else {
+    auto cmd = parse_command(*commands);
+    if (!cmd.has_value()) {
+      return tl::unexpected(cmd.error());
+    }
+    batch.commands.push_back(*cmd);
+  }
+
+  if (batch.commands.empty()) {
+    return tl::unexpected("empty batch");
+  }
+  return batch;
+}
+
+BatchResult apply_batch(cells::System& system, const CommandBatch& batch,
+                        const ApplyContext& context) {
+  BatchResult result;
+  result.id = batch.id;
+  result.results.reserve(batch.commands.size());
+
+  // Only keep a rollback copy when the batch can actually mutate something
+  bool read_only = std::all_of(batch.commands.begin(), batch.commands.end(),
+                               [](const Command& c) {
+                                 return c.type == CommandType::Query ||
+                                        c.type == CommandType::Recorder;
+                               });
+  std::optional<cells::System> snapshot;
+  if (!read_only) {
+    snapshot = system;
+  }
+
+  for (const auto& cmd : batch.commands) {
+    auto cmd_result = run_command(system, cmd, context, result);
+    bool ok = cmd_result.ok;
+    result.results.push_back(std::move(cmd_result));
+    if (!ok) {
+      result.ok = false;
+      break;
+    }
+  }
+
+  if (!result.ok && snapshot.has_value()) {
+    system = std::move(*snapshot);
+    result.window_to_foreground.reset();
+    result.cursor_pos.reset();
+    result.reassigned_windows.clear();
+    spdlog::debug("IPC batch rolled back after command {} failed", result.results.size() - 1);
+  }
+  return result;
+}
+
+std::string format_batch_result(const BatchResult& result) {
+  nlohmann::json out;
+  if (result.id.has_value()) {
+    out["id"] = *result.id;
+  }
+  out["ok"] = result.ok;
+  auto results = nlohmann::json::array();
+  for (const auto& r : result.results) {
+    nlohmann::json entry{{"ok", r.ok}};
+    if (!r.ok) {
+      entry["error"] = r.error;
+    }
+    if (!r.data.is_null()) {
+      entry["data"] = r.data;
+    }
+    results.push_back(std::move(entry));
+  }
+  out["results"] = std::move(results);
+  return out.dump();
+}
+
+std::string format_error(const std::string& message) {
+  return nlohmann::json{{"ok", false}, {"error", message}}.dump();
+}
+
+nlohmann::json query_system(const cells::System& system) {
+  nlohmann::json out;
+  out["split_mode"] = split_mode_to_string(system.split_mode);
+  if (auto leaf = selected_leaf_id(system)) {
+    out["selection"] = {{"cluster", system.selection->cluster_index}, {"leaf", *leaf}};
+  } else {
+    out["selection"] = nullptr;
+  }
+
+  auto clusters = nlohmann::json::array();
+  for (size_t ci = 0; ci < system.clusters.size(); ++ci) {
+    const auto& pc = system.clusters[ci];
+    nlohmann::json cluster{{"index", ci},
+                           {"x", pc.global_x},
+                           {"y", pc.global_y},
+                           {"width", pc.cluster.window_width},
+                           {"height", pc.cluster.window_height}};
+    cluster["zen"] = nullptr;
+    auto leaves = nlohmann::json::array();
+    for (int i = 0; i < static_cast<int>(pc.cluster.cells.size()); ++i) {
+      const auto& cell = pc.cluster.cells[static_cast<size_t>(i)];
+      if (cell.is_dead || !cells::is_leaf(pc.cluster, i) || !cell.leaf_id.has_value()) {
+        continue;
+      }
+      auto rect = cells::get_cell_global_rect(pc, i);
+      nlohmann::json leaf{{"leaf", *cell.leaf_id},
+                          {"x", rect.x},
+                          {"y", rect.y},
+                          {"width", rect.width},
+                          {"height", rect.height}};
+      if (cell.parent.has_value()) {
+        const auto& parent = pc.cluster.cells[static_cast<size_t>(*cell.parent)];
+        leaf["parent_split"] = split_dir_to_string(parent.split_dir);
+        leaf["parent_ratio"] = parent.split_ratio;
+      }
+      leaves.push_back(std::move(leaf));
+      if (pc.cluster.zen_cell_index.has_value() && *pc.cluster.zen_cell_index == i) {
+        cluster["zen"] = *cell.leaf_id;
+      }
+    }
+    cluster["leaves"] = std::move(leaves);
+    clusters.push_back(std::move(cluster));
+  }
+  out["clusters"] = std::move(clusters);
+  return out;
+}
+
+} // namespace ipc
+} // namespace wintiler
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+#include <tl/expected.hpp>
+#include <vector>
+
+#include "layout_template.h"
+#include "multi_cells.h"
+
+namespace wintiler {
+
+class FlightRecorder;
+
+namespace ipc {
+
+// ============================================================================
+// Command Model
+// ============================================================================
+
+enum class CommandType {
+  Navigate,  // {"cmd": "navigate", "dir": "left"}
+  Swap,      // {"cmd": "swap", "leaf": 1, "target": 2} (leaf defaults to selection)
+  Move,      // {"cmd": "move", "leaf": 1, "target": 2} (leaf defaults to selection)
+  SetRatio,  // {"cmd": "set-ratio", "ratio": 0.6, "leaf": 1} (leaf defaults to selection)
+  Zen,       // {"cmd": "zen", "state": "toggle" | "on" | "off", "leaf": 1}
+  SplitMode, // {"cmd": "split-mode", "mode": "cycle" | "zigzag" | "vertical" | "horizontal"}
+  Query,     // {"cmd": "query"}
+  Recorder,  // {"cmd": "recorder", "format": "json" | "text", "last": 100}
+  Layout,    // {"cmd": "layout", "name": "desk", "cluster": 0} (cluster defaults to selection)
+};
+
+enum class ZenState { Toggle, On, Off };
+
+struct Command {
+  CommandType type;
+  std::optional<cells::Direction> direction;   // Navigate
+  std::optional<size_t> leaf_id;               // Swap/Move/SetRatio/Zen source, else selection
+  std::optional<size_t> target_leaf_id;        // Swap/Move target
+  float ratio = 0.5f;                          // SetRatio
+  ZenState zen_state = ZenState::Toggle;       // Zen
+  std::optional<cells::SplitMode> split_mode;  // SplitMode, empty = cycle
+  bool as_text = false;                        // Recorder
+  std::optional<size_t> last;                  // Recorder, empty = every held event
+  std::string layout_name;                     // Layout
+  std::optional<size_t> cluster_index;         // Layout, empty = selected cluster
+};
+
+// One message from a client. All commands are applied as a single transaction.
+struct CommandBatch {
+  std::optional<nlohmann::json> id; // Echoed back in the response
+  std::vector<Command> commands;
+};
+
+struct CommandResult {
+  bool ok = true;
+  std::string error;
+  nlohmann::json data; // Command-specific payload (null if none)
+};
+
+// A window whose cell moved to another cluster
+struct WindowReassignment {
+  size_t leaf_id;
+  size_t cluster_index;
+
+  bool operator==(const WindowReassignment&) const = default;
+};
+
+struct BatchResult {
+  std::optional<nlohmann::json> id;
+  bool ok = true;
+  std::vector<CommandResult> results;
+
+  // Side effects for the caller to apply once the batch is committed
+  std::optional<size_t> window_to_foreground;
+  std::optional<cells::Point> cursor_pos;
+  // In order, later entries win. The caller lists these windows under their new monitor until
+  // the next enumeration, or the update that places them would move them back.
+  std::vector<WindowReassignment> reassigned_windows;
+};
+
+// Layout parameters needed by mutating commands
+struct ApplyContext {
+  float gap_horizontal;
+  float gap_vertical;
+  const FlightRecorder* recorder = nullptr; // Read by the recorder command
+  const std::vector<LayoutTemplate>* layouts = nullptr; // Read by the layout command
+  // Process, class and title of a managed window, for the layout command's match rules
+  std::function<WindowDescription(size_t leaf_id)> describe_window{};
+};
+
+// ============================================================================
+// Parsing & Execution
+// ============================================================================
+
+// Parse a single JSON line. Accepts a command object, an array of command objects,
+// or {"id": ..., "batch": [...]}.
+tl::expected<CommandBatch, std::string> parse_batch(const std::string& line);
+
+// Apply all commands in order. If any command fails, the system is restored to its
+// state before the batch and the result reports the failing command.
+// Commands only mutate the cell tree; tile placement is left to the caller's next
+// update pass so the whole batch costs one layout pass.
+BatchResult apply_batch(cells::System& system, const CommandBatch& batch,
+                        const ApplyContext& context);
+
+// Serialize a batch result as a single JSON line (without trailing newline).
+std::string format_batch_result(const BatchResult& result);
+
+// Serialize an error response for a line that could not be parsed.
+std::string format_error(const std::string& message);
+
+// Snapshot of clusters, leaves and selection as returned by the query command.
+nlohmann::json query_system(const cells::System& system);
+
+} // namespace ipc
+} // namespace wintiler
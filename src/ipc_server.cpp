@@ -0,0 +1,468 @@
+#include "ipc_server.h"
+
+#include <spdlog/spdlog.h>
+
+#ifdef _WIN32
+#include <windows.h>
+
+#include <sddl.h>
+#else
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#pragma comment(lib, "Advapi32.lib")
+#endif
+
+namespace wintiler {
+namespace ipc {
+
+namespace {
+
+constexpr size_t kReadChunkSize = 4096;
+
+// A client whose unfinished line grows past this gets an error reply and is disconnected
+constexpr size_t kMaxLineSize = 64 * 1024;
+
+std::string line_too_long_reply() {
+  return format_error("request line exceeds " + std::to_string(kMaxLineSize) + " bytes") + "\n";
+}
+
+// Split complete lines off the front of buffer and pass each to on_line
+template <typename OnLine>
+bool consume_lines(std::string& buffer, OnLine&& on_line) {
+  size_t start = 0;
+  size_t newline;
+  while ((newline = buffer.find('\n', start)) != std::string::npos) {
+    std::string line = buffer.substr(start, newline - start);
+    start = newline + 1;
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    if (line.empty()) {
+      continue;
+    }
+    if (!on_line(line)) {
+      return false;
+    }
+  }
+  buffer.erase(0, start);
+  return true;
+}
+
+#ifdef _WIN32
+
+std::wstring to_wide(const std::string& str) {
+  return std::wstring(str.begin(), str.end());
+}
+
+// Security descriptor with a protected DACL that grants access to the user this process runs
+// as and nobody else. Free with LocalFree; nullptr on failure.
+PSECURITY_DESCRIPTOR create_user_only_descriptor() {
+  HANDLE token = nullptr;
+  if (!OpenProcessToken(GetCurrentProcess(), TOKEN_QUERY, &token)) {
+    return nullptr;
+  }
+  DWORD size = 0;
+  GetTokenInformation(token, TokenUser, nullptr, 0, &size);
+  std::vector<BYTE> token_user(size);
+  PSECURITY_DESCRIPTOR descriptor = nullptr;
+  LPWSTR sid = nullptr;
+  if (size > 0 && GetTokenInformation(token, TokenUser, token_user.data(), size, &size) &&
+      ConvertSidToStringSidW(reinterpret_cast<TOKEN_USER*>(token_user.data())->User.Sid,
+                             &sid)) {
+    std::wstring sddl = L"D:P(A;;GA;;;" + std::wstring(sid) + L")";
+    if (!ConvertStringSecurityDescriptorToSecurityDescriptorW(sddl.c_str(), SDDL_REVISION_1,
+                                                              &descriptor, nullptr)) {
+      descriptor = nullptr;
+    }
+    LocalFree(sid);
+  }
+  CloseHandle(token);
+  return descriptor;
+}
+
+// Wait for an overlapped operation, or abort it when stop_event is signaled
+bool wait_overlapped(HANDLE pipe, OVERLAPPED& ov, HANDLE stop_event, DWORD& bytes) {
+  HANDLE handles[2] = {ov.hEvent, stop_event};
+  DWORD wait = WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+  if (wait != WAIT_OBJECT_0) {
+    CancelIo(pipe);
+    GetOverlappedResult(pipe, &ov, &bytes, TRUE);
+    return false;
+  }
+  return GetOverlappedResult(pipe, &ov, &bytes, FALSE) != FALSE;
+}
+
+bool write_all(HANDLE pipe, OVERLAPPED& ov, HANDLE stop_event, const std::string& data) {
+  size_t written = 0;
+  while (written < data.size()) {
+    DWORD bytes = 0;
+    ResetEvent(ov.hEvent);
+    BOOL ok = WriteFile(pipe, data.data() + written, static_cast<DWORD>(data.size() - written),
+                        nullptr, &ov);
+    if (!ok && GetLastError() != ERROR_IO_PENDING) {
+      return false;
+    }
+    if (!wait_overlapped(pipe, ov, stop_event, bytes) || bytes == 0) {
+      return false;
+    }
+    written += bytes;
+  }
+  return true;
+}
+
+#else
+
+bool write_all(int fd, const std::string& data) {
+  size_t written = 0;
+  while (written < data.size()) {
+    ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+    if (n <= 0) {
+      return false;
+    }
+    written += static_cast<size_t>(n);
+  }
+  return true;
+}
+
+#endif
+
+} // namespace
+
+std::string default_endpoint() {
+#ifdef _WIN32
+  return R"(\\.\pipe\win-tiler)";
+#else
+  return "/tmp/win-tiler.sock";
+#endif
+}
+
+CommandServer::CommandServer(std::string endpoint, std::chrono::milliseconds reply_timeout)
+    : endpoint_(std::move(endpoint)), reply_timeout_(reply_timeout) {
+}
+
+CommandServer::~CommandServer() {
+  stop();
+}
+
+bool CommandServer::is_running() const {
+  return running_.load();
+}
+
+bool CommandServer::has_pending() const {
+  return !queue_.empty();
+}
+
+const std::string& CommandServer::endpoint() const {
+  return endpoint_;
+}
+
+std::string CommandServer::handle_line(const std::string& line) {
+  auto batch = parse_batch(line);
+  if (!batch.has_value()) {
+    return format_error(batch.error());
+  }
+
+  auto pending = std::make_shared<PendingBatch>();
+  pending->batch = std::move(*batch);
+  auto reply = pending->reply.get_future();
+  if (!queue_.try_push(pending)) {
+    return format_error("server busy");
+  }
+  if (wake_) {
+    wake_();
+  }
+
+  if (reply.wait_for(reply_timeout_) != std::future_status::ready) {
+    auto expected = PendingBatch::State::Queued;
+    if (pending->state.compare_exchange_strong(expected, PendingBatch::State::Cancelled)) {
+      return format_error("timed out waiting for main loop, batch not applied");
+    }
+    // The loop claimed it just now; its answer is on the way
+  }
+  return reply.get();
+}
+
+size_t CommandServer::drain(const std::function<std::string(const CommandBatch&)>& handler) {
+  size_t handled = 0;
+  while (auto pending = queue_.try_pop()) {
+    auto expected = PendingBatch::State::Queued;
+    if (!(*pending)->state.compare_exchange_strong(expected, PendingBatch::State::Claimed)) {
+      continue; // Its client timed out and was told it was not applied
+    }
+    (*pending)->reply.set_value(handler((*pending)->batch));
+    ++handled;
+  }
+  return handled;
+}
+
+#ifdef _WIN32
+
+bool CommandServer::start(std::function<void()> wake) {
+  if (running_) {
+    return true;
+  }
+  wake_ = std::move(wake);
+  pipe_security_ = create_user_only_descriptor();
+  if (!pipe_security_) {
+    spdlog::error("IPC: failed to build the pipe security descriptor ({})", GetLastError());
+    return false;
+  }
+  stop_event_ = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+  if (!stop_event_) {
+    spdlog::error("IPC: failed to create stop event");
+    LocalFree(pipe_security_);
+    pipe_security_ = nullptr;
+    return false;
+  }
+  running_ = true;
+  thread_ = std::thread([this] { serve(); });
+  spdlog::info("IPC command server listening on {}", endpoint_);
+  return true;
+}
+
+void CommandServer::stop() {
+  if (!running_.exchange(false)) {
+    return;
+  }
+  SetEvent(static_cast<HANDLE>(stop_event_));
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  CloseHandle(static_cast<HANDLE>(stop_event_));
+  stop_event_ = nullptr;
+  LocalFree(pipe_security_);
+  pipe_security_ = nullptr;
+}
+
+void CommandServer::serve() {
+  HANDLE stop_event = static_cast<HANDLE>(stop_event_);
+  auto name = to_wide(endpoint_);
+  SECURITY_ATTRIBUTES security{sizeof(SECURITY_ATTRIBUTES), pipe_security_, FALSE};
+
+  while (running_) {
+    // One instance at a time, each the first: if another process already owns the name,
+    // creation fails instead of sharing the pipe with it
+    HANDLE pipe = CreateNamedPipeW(
+        name.c_str(), PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED | FILE_FLAG_FIRST_PIPE_INSTANCE,
+        PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS, 1,
+        static_cast<DWORD>(kReadChunkSize), static_cast<DWORD>(kReadChunkSize), 0, &security);
+    if (pipe == INVALID_HANDLE_VALUE) {
+      spdlog::error("IPC: CreateNamedPipe failed ({})", GetLastError());
+      running_ = false;
+      return;
+    }
+
+    OVERLAPPED ov{};
+    ov.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+
+    DWORD bytes = 0;
+    bool connected = ConnectNamedPipe(pipe, &ov) != FALSE;
+    if (!connected) {
+      DWORD err = GetLastError();
+      if (err == ERROR_PIPE_CONNECTED) {
+        connected = true;
+      } else if (err == ERROR_IO_PENDING) {
+        connected = wait_overlapped(pipe, ov, stop_event, bytes);
+      }
+    }
+
+    std::string buffer;
+    char chunk[kReadChunkSize];
+    while (connected && running_) {
+      ResetEvent(ov.hEvent);
+      BOOL ok = ReadFile(pipe, chunk, static_cast<DWORD>(sizeof(chunk)), nullptr, &ov);
+      if (!ok && GetLastError() != ERROR_IO_PENDING) {
+        break; // Client disconnected
+      }
+      if (!wait_overlapped(pipe, ov, stop_event, bytes) || bytes == 0) {
+        break;
+      }
+      buffer.append(chunk, bytes);
+      connected = consume_lines(buffer, [&](const std::string& line) {
+        return write_all(pipe, ov, stop_event, handle_line(line) + "\n");
+      });
+      if (connected && buffer.size() > kMaxLineSize) {
+        write_all(pipe, ov, stop_event, line_too_long_reply());
+        break;
+      }
+    }
+
+    DisconnectNamedPipe(pipe);
+    CloseHandle(ov.hEvent);
+    CloseHandle(pipe);
+  }
+}
+
+std::optional<std::string> send_request(const std::string& endpoint, const std::string& line) {
+  auto name = to_wide(endpoint);
+  if (!WaitNamedPipeW(name.c_str(), 2000)) {
+    return std::nullopt;
+  }
+  HANDLE pipe = CreateFileW(name.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr,
+                            OPEN_EXISTING, 0, nullptr);
+  if (pipe == INVALID_HANDLE_VALUE) {
+    return std::nullopt;
+  }
+
+  std::string request = line + "\n";
+  DWORD written = 0;
+  if (!WriteFile(pipe, request.data(), static_cast<DWORD>(request.size()), &written, nullptr)) {
+    CloseHandle(pipe);
+    return std::nullopt;
+  }
+
+  std::string response;
+  char chunk[kReadChunkSize];
+  DWORD read = 0;
+  while (response.find('\n') == std::string::npos &&
+         ReadFile(pipe, chunk, static_cast<DWORD>(sizeof(chunk)), &read, nullptr) && read > 0) {
+    response.append(chunk, read);
+  }
+  CloseHandle(pipe);
+
+  auto newline = response.find('\n');
+  if (newline == std::string::npos) {
+    return std::nullopt;
+  }
+  return response.substr(0, newline);
+}
+
+#else
+
+bool CommandServer::start(std::function<void()> wake) {
+  if (running_) {
+    return true;
+  }
+  wake_ = std::move(wake);
+
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  if (endpoint_.size() >= sizeof(addr.sun_path)) {
+    spdlog::error("IPC: socket path too long: {}", endpoint_);
+    return false;
+  }
+  std::strncpy(addr.sun_path, endpoint_.c_str(), sizeof(addr.sun_path) - 1);
+
+  ::unlink(endpoint_.c_str());
+  listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  // Owner-only, like the named pipe's DACL on Windows
+  if (listen_fd_ < 0 || ::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+      ::chmod(endpoint_.c_str(), S_IRUSR | S_IWUSR) < 0 || ::listen(listen_fd_, 4) < 0 ||
+      ::pipe(stop_pipe_) < 0) {
+    spdlog::error("IPC: failed to listen on {}", endpoint_);
+    if (listen_fd_ >= 0) {
+      ::close(listen_fd_);
+      listen_fd_ = -1;
+    }
+    return false;
+  }
+
+  running_ = true;
+  thread_ = std::thread([this] { serve(); });
+  spdlog::info("IPC command server listening on {}", endpoint_);
+  return true;
+}
+
+void CommandServer::stop() {
+  if (!running_.exchange(false)) {
+    return;
+  }
+  char byte = 1;
+  [[maybe_unused]] auto n = ::write(stop_pipe_[1], &byte, 1);
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  ::close(listen_fd_);
+  ::close(stop_pipe_[0]);
+  ::close(stop_pipe_[1]);
+  listen_fd_ = -1;
+  stop_pipe_[0] = stop_pipe_[1] = -1;
+  ::unlink(endpoint_.c_str());
+}
+
+void CommandServer::serve() {
+  while (running_) {
+    pollfd fds[2] = {{listen_fd_, POLLIN, 0}, {stop_pipe_[0], POLLIN, 0}};
+    if (::poll(fds, 2, -1) < 0 || (fds[1].revents & POLLIN)) {
+      return;
+    }
+    int client = ::accept(listen_fd_, nullptr, nullptr);
+    if (client < 0) {
+      continue;
+    }
+
+    std::string buffer;
+    char chunk[kReadChunkSize];
+    bool connected = true;
+    while (connected && running_) {
+      pollfd client_fds[2] = {{client, POLLIN, 0}, {stop_pipe_[0], POLLIN, 0}};
+      if (::poll(client_fds, 2, -1) < 0 || (client_fds[1].revents & POLLIN)) {
+        break;
+      }
+      ssize_t n = ::read(client, chunk, sizeof(chunk));
+      if (n <= 0) {
+        break; // Client disconnected
+      }
+      buffer.append(chunk, static_cast<size_t>(n));
+      connected = consume_lines(buffer, [&](const std::string& line) {
+        return write_all(client, handle_line(line) + "\n");
+      });
+      if (connected && buffer.size() > kMaxLineSize) {
+        write_all(client, line_too_long_reply());
+        break;
+      }
+    }
+    ::close(client);
+  }
+}
+
+std::optional<std::string> send_request(const std::string& endpoint, const std::string& line) {
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  if (endpoint.size() >= sizeof(addr.sun_path)) {
+    return std::nullopt;
+  }
+  std::strncpy(addr.sun_path, endpoint.c_str(), sizeof(addr.sun_path) - 1);
+
+  int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return std::nullopt;
+  }
+  if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+      !write_all(fd, line + "\n")) {
+    ::close(fd);
+    return std::nullopt;
+  }
+
+  std::string response;
+  char chunk[kReadChunkSize];
+  while (response.find('\n') == std::string::npos) {
+    ssize_t n = ::read(fd, chunk, sizeof(chunk));
+    if (n <= 0) {
+      break;
+    }
+    response.append(chunk, static_cast<size_t>(n));
+  }
+  ::close(fd);
+
+  auto newline = response.find('\n');
+  if (newline == std::string::npos) {
+    return std::nullopt;
+  }
+  return response.substr(0, newline);
+}
+
+#endif
+
+} // namespace ipc
+} // namespace wintiler
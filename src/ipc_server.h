@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "concurrent_queue.h"
+#include "ipc.h"
+
+namespace wintiler {
+namespace ipc {
+
+// How long a client waits for the main loop to answer a batch by default
+constexpr std::chrono::milliseconds kDefaultReplyTimeout{5000};
+
+// Batch waiting for the main loop, answered through reply. The loop claims it in drain() or
+// the waiting client cancels it on timeout, whichever comes first, so a batch reported as
+// timed out is never applied later.
+struct PendingBatch {
+  enum class State : uint8_t { Queued, Claimed, Cancelled };
+
+  CommandBatch batch;
+  std::promise<std::string> reply;
+  std::atomic<State> state{State::Queued};
+};
+
+// Default endpoint: named pipe on Windows, Unix socket path elsewhere
+std::string default_endpoint();
+
+// Local command server. Accepts JSON-lines on a named pipe (Windows) or Unix socket,
+// parses them on its own thread and hands batches to the main loop through a lock-free
+// queue. Each request line gets exactly one response line.
+class CommandServer {
+public:
+  explicit CommandServer(std::string endpoint,
+                         std::chrono::milliseconds reply_timeout = kDefaultReplyTimeout);
+  ~CommandServer();
+
+  CommandServer(const CommandServer&) = delete;
+  CommandServer& operator=(const CommandServer&) = delete;
+
+  // Start listening. wake is called from the server thread after a batch has been queued,
+  // so the main loop can stop waiting. Returns false if the endpoint cannot be opened.
+  bool start(std::function<void()> wake = {});
+
+  // Stop the server thread and close the endpoint. Safe to call more than once.
+  void stop();
+
+  [[nodiscard]] bool is_running() const;
+  [[nodiscard]] const std::string& endpoint() const;
+
+  // Main loop side: run handler on every queued batch and send its return value back
+  // to the client. Returns the number of batches handled.
+  size_t drain(const std::function<std::string(const CommandBatch&)>& handler);
+
+  // Main loop side: true if drain() would handle at least one batch
+  [[nodiscard]] bool has_pending() const;
+
+private:
+  void serve();
+  std::string handle_line(const std::string& line);
+
+  static constexpr size_t kQueueCapacity = 64;
+
+  std::string endpoint_;
+  std::chrono::milliseconds reply_timeout_;
+  std::function<void()> wake_;
+  std::atomic<bool> running_{false};
+  std::thread thread_;
+  SpscQueue<std::shared_ptr<PendingBatch>, kQueueCapacity> queue_;
+
+#ifdef _WIN32
+  void* stop_event_ = nullptr;
+  void* pipe_security_ = nullptr; // Descriptor whose DACL admits only the current user
+#else
+  int listen_fd_ = -1;
+  int stop_pipe_[2] = {-1, -1};
+#endif
+};
+
+// Client helper: send one request line and wait for the response line.
+// Returns nullopt if the server cannot be reached.
+std::optional<std::string> send_request(const std::string& endpoint, const std::string& line);
+
+} // namespace ipc
+} // namespace wintiler
@@ -0,0 +1,238 @@
+#include "layout_template.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace wintiler {
+
+namespace {
+
+char to_lower(char c) {
+  return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+bool iequals(std::string_view a, std::string_view b) {
+  return a.size() == b.size() &&
+         std::equal(a.begin(), a.end(), b.begin(),
+                    [](char x, char y) { return to_lower(x) == to_lower(y); });
+}
+
+bool icontains(std::string_view haystack, std::string_view needle) {
+  return std::search(haystack.begin(), haystack.end(), needle.begin(), needle.end(),
+                     [](char x, char y) { return to_lower(x) == to_lower(y); }) !=
+         haystack.end();
+}
+
+int rule_field_count(const WindowMatchRule& rule) {
+  return static_cast<int>(!rule.process.empty()) + static_cast<int>(!rule.class_name.empty()) +
+         static_cast<int>(!rule.title.empty());
+}
+
+bool is_slot(const LayoutTemplateNode& node) {
+  return !node.first_child.has_value() && !node.second_child.has_value();
+}
+
+// Slot indices in preorder; empty if the nodes are not a single tree rooted at 0 whose
+// splits all have both children
+std::vector<int> preorder_slots(const LayoutTemplate& layout_template) {
+  const auto& nodes = layout_template.nodes;
+  std::vector<int> slots;
+  if (nodes.empty()) {
+    return slots;
+  }
+  std::vector<char> visited(nodes.size(), 0);
+  size_t reached = 0;
+  std::vector<int> stack{0};
+  while (!stack.empty()) {
+    int i = stack.back();
+    stack.pop_back();
+    if (i < 0 || static_cast<size_t>(i) >= nodes.size() || visited[static_cast<size_t>(i)]) {
+      return {};
+    }
+    visited[static_cast<size_t>(i)] = 1;
+    ++reached;
+    const auto& node = nodes[static_cast<size_t>(i)];
+    if (is_slot(node)) {
+      slots.push_back(i);
+    } else if (node.first_child.has_value() && node.second_child.has_value()) {
+      stack.push_back(*node.second_child);
+      stack.push_back(*node.first_child);
+    } else {
+      return {};
+    }
+  }
+  if (reached != nodes.size()) {
+    return {};
+  }
+  return slots;
+}
+
+// Mark every node whose subtree holds a filled slot. Templates come from the config, where
+// their depth is capped, so recursion is fine here.
+bool mark_filled(const LayoutTemplate& layout_template, int index, std::vector<char>& filled) {
+  const auto& node = layout_template.nodes[static_cast<size_t>(index)];
+  if (is_slot(node)) {
+    return filled[static_cast<size_t>(index)] != 0;
+  }
+  bool first = mark_filled(layout_template, *node.first_child, filled);
+  bool second = mark_filled(layout_template, *node.second_child, filled);
+  filled[static_cast<size_t>(index)] = (first || second) ? 1 : 0;
+  return first || second;
+}
+
+// Append the filled part of the subtree at index to out in preorder
+void emit_filled(const LayoutTemplate& layout_template, int index, const std::vector<char>& filled,
+                 const std::vector<std::optional<size_t>>& slotted,
+                 std::vector<cells::LayoutNode>& out) {
+  const auto& node = layout_template.nodes[static_cast<size_t>(index)];
+  if (is_slot(node)) {
+    out.push_back({node.split_dir, node.split_ratio, std::nullopt, std::nullopt,
+                   slotted[static_cast<size_t>(index)]});
+    return;
+  }
+  bool first = filled[static_cast<size_t>(*node.first_child)] != 0;
+  bool second = filled[static_cast<size_t>(*node.second_child)] != 0;
+  if (!first || !second) {
+    // One side is empty: the other takes the whole split
+    emit_filled(layout_template, first ? *node.first_child : *node.second_child, filled, slotted,
+                out);
+    return;
+  }
+  size_t split = out.size();
+  out.push_back({node.split_dir, node.split_ratio, std::nullopt, std::nullopt, std::nullopt});
+  out[split].first_child = static_cast<int>(out.size());
+  emit_filled(layout_template, *node.first_child, filled, slotted, out);
+  out[split].second_child = static_cast<int>(out.size());
+  emit_filled(layout_template, *node.second_child, filled, slotted, out);
+}
+
+// Split leftover windows off the last leaf in turn, alternating direction like zigzag mode
+void append_leftovers(const std::vector<size_t>& leftovers, std::vector<cells::LayoutNode>& out) {
+  if (leftovers.empty()) {
+    return;
+  }
+  size_t next = 0;
+  if (out.empty()) {
+    out.push_back({cells::SplitDir::Vertical, 0.5f, std::nullopt, std::nullopt, leftovers[0]});
+    next = 1;
+  }
+  // Preorder puts the last leaf at the end
+  int last = static_cast<int>(out.size()) - 1;
+  std::optional<int> parent;
+  for (int i = 0; i < last; ++i) {
+    if (out[static_cast<size_t>(i)].first_child == last ||
+        out[static_cast<size_t>(i)].second_child == last) {
+      parent = i;
+      break;
+    }
+  }
+  for (; next < leftovers.size(); ++next) {
+    cells::SplitDir dir = cells::SplitDir::Vertical;
+    if (parent.has_value() &&
+        out[static_cast<size_t>(*parent)].split_dir == cells::SplitDir::Vertical) {
+      dir = cells::SplitDir::Horizontal;
+    }
+    int kept = static_cast<int>(out.size());
+    out.push_back({dir, 0.5f, std::nullopt, std::nullopt, out[static_cast<size_t>(last)].leaf_id});
+    int added = static_cast<int>(out.size());
+    out.push_back({dir, 0.5f, std::nullopt, std::nullopt, leftovers[next]});
+
+    auto& split = out[static_cast<size_t>(last)];
+    split.split_dir = dir;
+    split.split_ratio = 0.5f;
+    split.first_child = kept;
+    split.second_child = added;
+    split.leaf_id.reset();
+    parent = last;
+    last = added;
+  }
+}
+
+} // namespace
+
+bool window_matches(const WindowMatchRule& rule, const WindowDescription& window) {
+  return (rule.process.empty() || iequals(window.process, rule.process)) &&
+         (rule.class_name.empty() || iequals(window.class_name, rule.class_name)) &&
+         (rule.title.empty() || icontains(window.title, rule.title));
+}
+
+const LayoutTemplate* find_layout_template(const std::vector<LayoutTemplate>& layouts,
+                                           std::string_view name) {
+  for (const auto& layout : layouts) {
+    if (layout.name == name) {
+      return &layout;
+    }
+  }
+  return nullptr;
+}
+
+TemplateMatch match_layout_template(const LayoutTemplate& layout_template,
+                                    const std::vector<WindowDescription>& windows,
+                                    const std::vector<size_t>& residents) {
+  TemplateMatch match;
+  auto slots = preorder_slots(layout_template);
+  if (slots.empty()) {
+    return match;
+  }
+  match.slot_count = slots.size();
+
+  // Most specific rules first; stable, so equal ones keep template order
+  std::stable_sort(slots.begin(), slots.end(), [&](int a, int b) {
+    return rule_field_count(layout_template.nodes[static_cast<size_t>(a)].match) >
+           rule_field_count(layout_template.nodes[static_cast<size_t>(b)].match);
+  });
+
+  std::vector<std::optional<size_t>> slotted(layout_template.nodes.size());
+  std::vector<char> filled(layout_template.nodes.size(), 0);
+  std::vector<char> claimed(windows.size(), 0);
+  for (int slot : slots) {
+    const auto& rule = layout_template.nodes[static_cast<size_t>(slot)].match;
+    for (size_t w = 0; w < windows.size(); ++w) {
+      if (claimed[w] || !window_matches(rule, windows[w])) {
+        continue;
+      }
+      claimed[w] = 1;
+      slotted[static_cast<size_t>(slot)] = windows[w].leaf_id;
+      filled[static_cast<size_t>(slot)] = 1;
+      match.slotted_leaf_ids.push_back(windows[w].leaf_id);
+      break;
+    }
+  }
+
+  if (mark_filled(layout_template, 0, filled)) {
+    emit_filled(layout_template, 0, filled, slotted, match.layout);
+  }
+
+  std::vector<size_t> leftovers;
+  for (size_t leaf_id : residents) {
+    if (std::find(match.slotted_leaf_ids.begin(), match.slotted_leaf_ids.end(), leaf_id) ==
+        match.slotted_leaf_ids.end()) {
+      leftovers.push_back(leaf_id);
+    }
+  }
+  append_leftovers(leftovers, match.layout);
+  return match;
+}
+
+std::optional<TemplateMatch> apply_layout_template(cells::System& system, size_t cluster_index,
+                                                   const LayoutTemplate& layout_template,
+                                                   const std::vector<WindowDescription>& windows,
+                                                   float gap_horizontal, float gap_vertical) {
+  if (cluster_index >= system.clusters.size()) {
+    return std::nullopt;
+  }
+  auto residents = cells::get_cluster_leaf_ids(system.clusters[cluster_index].cluster);
+  auto match = match_layout_template(layout_template, windows, residents);
+  if (!cells::build_cluster_layout(system, cluster_index, match.layout, gap_horizontal,
+                                   gap_vertical)) {
+    return std::nullopt;
+  }
+  for (size_t leaf_id : match.slotted_leaf_ids) {
+    if (std::find(residents.begin(), residents.end(), leaf_id) == residents.end()) {
+      match.claimed_leaf_ids.push_back(leaf_id);
+    }
+  }
+  return match;
+}
+
+} // namespace wintiler
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "multi_cells.h"
+
+namespace wintiler {
+
+// Which window a layout template slot takes. Empty fields match anything; process and
+// class_name compare whole names and title looks for a substring, all ignoring case.
+struct WindowMatchRule {
+  std::string process;
+  std::string class_name;
+  std::string title;
+
+  bool operator==(const WindowMatchRule&) const = default;
+};
+
+// One node of a layout template: a split with both children (indices into
+// LayoutTemplate::nodes) or a slot with neither, filled by a window its rule matches
+struct LayoutTemplateNode {
+  cells::SplitDir split_dir = cells::SplitDir::Vertical;
+  float split_ratio = 0.5f;
+  std::optional<int> first_child;
+  std::optional<int> second_child;
+  WindowMatchRule match; // Slots only
+
+  bool operator==(const LayoutTemplateNode&) const = default;
+};
+
+// A named layout from the [[layouts]] config section, root at nodes[0]
+struct LayoutTemplate {
+  std::string name;
+  std::vector<LayoutTemplateNode> nodes;
+
+  bool operator==(const LayoutTemplate&) const = default;
+};
+
+// A live window as the matching engine sees it
+struct WindowDescription {
+  size_t leaf_id;
+  std::string process;
+  std::string class_name;
+  std::string title;
+};
+
+// Outcome of matching a template against windows
+struct TemplateMatch {
+  std::vector<cells::LayoutNode> layout; // Input for cells::build_cluster_layout
+  std::vector<size_t> slotted_leaf_ids;  // Windows that filled a slot, in slot order
+  size_t slot_count = 0;                 // Slots in the template
+  std::vector<size_t> claimed_leaf_ids;  // Slotted windows taken from other clusters
+};
+
+[[nodiscard]] bool window_matches(const WindowMatchRule& rule, const WindowDescription& window);
+
+// Template by name, nullptr if there is none
+[[nodiscard]] const LayoutTemplate* find_layout_template(const std::vector<LayoutTemplate>& layouts,
+                                                         std::string_view name);
+
+// Fill the template's slots from windows. Slots with more rule fields pick first, so a
+// catch-all slot cannot take the window a specific one asks for; each slot takes the first
+// unclaimed matching window in the order given. Subtrees without a filled slot are left out
+// and a split that keeps one side collapses into it. Residents (the target cluster's windows)
+// that filled no slot are split off the last leaf in turn, so applying a template never drops
+// a window from its cluster. An empty layout means nothing matched and there are no residents;
+// a malformed template yields one as well.
+[[nodiscard]] TemplateMatch match_layout_template(const LayoutTemplate& layout_template,
+                                                  const std::vector<WindowDescription>& windows,
+                                                  const std::vector<size_t>& residents);
+
+// Match the template against windows (the cluster's own windows are the residents) and build
+// the result on the cluster in one batch: one layout pass, and the caller's next tile pass
+// places every window at once. Nullopt if the cluster does not exist or nothing is left to lay
+// out. Windows in claimed_leaf_ids now belong to cluster_index; the caller's window report
+// must list them there, or the next update moves them back to their old monitor.
+std::optional<TemplateMatch> apply_layout_template(cells::System& system, size_t cluster_index,
+                                                   const LayoutTemplate& layout_template,
+                                                   const std::vector<WindowDescription>& windows,
+                                                   float gap_horizontal, float gap_vertical);
+
+} // namespace wintiler
@@ -0,0 +1,138 @@
+#include "leaf_interner.h"
+
+namespace wintiler {
+namespace cells {
+
+// ============================================================================
+// DenseBitset
+// ============================================================================
+
+DenseBitset::DenseBitset(size_t bits) : words_((bits + 63) / 64, 0), bits_(bits) {
+}
+
+size_t DenseBitset::size() const {
+  return bits_;
+}
+
+void DenseBitset::set(uint32_t index) {
+  assert(index < bits_);
+  words_[index / 64] |= uint64_t{1} << (index % 64);
+}
+
+void DenseBitset::reset(uint32_t index) {
+  assert(index < bits_);
+  words_[index / 64] &= ~(uint64_t{1} << (index % 64));
+}
+
+bool DenseBitset::test(uint32_t index) const {
+  return index < bits_ && (words_[index / 64] >> (index % 64) & 1) != 0;
+}
+
+size_t DenseBitset::count() const {
+  size_t total = 0;
+  for (uint64_t word : words_) {
+    total += static_cast<size_t>(std::popcount(word));
+  }
+  return total;
+}
+
+// ============================================================================
+// LeafInterner
+// ============================================================================
+
+uint32_t LeafInterner::intern(size_t leaf_id) {
+  auto it = dense_ids_.find(leaf_id);
+  if (it != dense_ids_.end()) {
+    return it->second;
+  }
+  uint32_t dense_id;
+  if (!free_ids_.empty()) {
+    dense_id = free_ids_.back();
+    free_ids_.pop_back();
+    leaf_ids_[dense_id] = leaf_id;
+  } else {
+    dense_id = static_cast<uint32_t>(leaf_ids_.size());
+    leaf_ids_.push_back(leaf_id);
+  }
+  dense_ids_.emplace(leaf_id, dense_id);
+  return dense_id;
+}
+
+std::optional<uint32_t> LeafInterner::find(size_t leaf_id) const {
+  auto it = dense_ids_.find(leaf_id);
+  if (it == dense_ids_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+size_t LeafInterner::leaf_id(uint32_t dense_id) const {
+  assert(dense_id < leaf_ids_.size());
+  return leaf_ids_[dense_id];
+}
+
+bool LeafInterner::release(size_t leaf_id) {
+  auto it = dense_ids_.find(leaf_id);
+  if (it == dense_ids_.end()) {
+    return false;
+  }
+  free_ids_.push_back(it->second);
+  dense_ids_.erase(it);
+  return true;
+}
+
+size_t LeafInterner::size() const {
+  return dense_ids_.size();
+}
+
+size_t LeafInterner::capacity() const {
+  return leaf_ids_.size();
+}
+
+// ============================================================================
+// Set Difference
+// ============================================================================
+
+LeafIdDiff diff_dense_ids(const LeafInterner& interner, const std::vector<uint32_t>& current,
+                          const std::vector<uint32_t>& desired) {
+  DenseBitset current_set(interner.capacity());
+  DenseBitset desired_set(interner.capacity());
+  for (uint32_t dense_id : current) {
+    current_set.set(dense_id);
+  }
+  for (uint32_t dense_id : desired) {
+    desired_set.set(dense_id);
+  }
+
+  LeafIdDiff diff;
+  current_set.for_each_difference(
+      desired_set, [&](uint32_t dense_id) { diff.removed.push_back(interner.leaf_id(dense_id)); });
+
+  // Additions keep the caller's order (it decides where new windows are split in). Each one
+  // is marked in current_set so a duplicate is added only once.
+  for (uint32_t dense_id : desired) {
+    if (!current_set.test(dense_id)) {
+      diff.added.push_back(interner.leaf_id(dense_id));
+      current_set.set(dense_id);
+    }
+  }
+  return diff;
+}
+
+LeafIdDiff diff_leaf_ids(const LeafInterner& interner, const std::vector<size_t>& current,
+                         const std::vector<size_t>& desired) {
+  auto to_dense = [&](const std::vector<size_t>& leaf_ids) {
+    std::vector<uint32_t> dense_ids;
+    dense_ids.reserve(leaf_ids.size());
+    for (size_t leaf_id : leaf_ids) {
+      auto dense_id = interner.find(leaf_id);
+      assert(dense_id.has_value());
+      dense_ids.push_back(*dense_id);
+    }
+    return dense_ids;
+  };
+  return diff_dense_ids(interner, to_dense(current), to_dense(desired));
+}
+
+} // namespace cells
+} // namespace wintiler
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace wintiler {
+namespace cells {
+
+// Fixed-size set of dense ids, one bit each
+class DenseBitset {
+public:
+  DenseBitset() = default;
+  explicit DenseBitset(size_t bits);
+
+  [[nodiscard]] size_t size() const;
+
+  void set(uint32_t index);
+  void reset(uint32_t index);
+  [[nodiscard]] bool test(uint32_t index) const;
+  [[nodiscard]] size_t count() const;
+
+  // Call fn(index) for every bit set here but not in other, in ascending order. Both sets must
+  // have the same size.
+  template <typename Fn>
+  void for_each_difference(const DenseBitset& other, Fn&& fn) const {
+    assert(words_.size() == other.words_.size());
+    for (size_t w = 0; w < words_.size(); ++w) {
+      uint64_t bits = words_[w] & ~other.words_[w];
+      while (bits != 0) {
+        fn(static_cast<uint32_t>(w * 64 + static_cast<size_t>(std::countr_zero(bits))));
+        bits &= bits - 1;
+      }
+    }
+  }
+
+private:
+  std::vector<uint64_t> words_;
+  size_t bits_ = 0;
+};
+
+// Stable bidirectional map between leaf ids (HWND values) and small dense ids. A leaf keeps its
+// dense id until it is released; released ids are handed out again, so dense ids stay below the
+// peak number of live leaves and can index bitsets and side tables directly.
+class LeafInterner {
+public:
+  // Dense id of the leaf, assigning one if it has none yet
+  uint32_t intern(size_t leaf_id);
+
+  [[nodiscard]] std::optional<uint32_t> find(size_t leaf_id) const;
+
+  // Leaf id of a dense id that is currently assigned
+  [[nodiscard]] size_t leaf_id(uint32_t dense_id) const;
+
+  // Give the leaf's dense id back. Returns false if the leaf was not interned.
+  bool release(size_t leaf_id);
+
+  // Number of interned leaves
+  [[nodiscard]] size_t size() const;
+
+  // Exclusive upper bound of the dense ids handed out so far (size for bitsets/side tables)
+  [[nodiscard]] size_t capacity() const;
+
+private:
+  std::unordered_map<size_t, uint32_t> dense_ids_;
+  std::vector<size_t> leaf_ids_; // Indexed by dense id
+  std::vector<uint32_t> free_ids_;
+};
+
+// Set difference of two leaf lists: removed = current - desired (in dense id order), added =
+// desired - current (in desired order, duplicates dropped). Every id must be interned.
+struct LeafIdDiff {
+  std::vector<size_t> removed;
+  std::vector<size_t> added;
+};
+
+[[nodiscard]] LeafIdDiff diff_leaf_ids(const LeafInterner& interner,
+                                       const std::vector<size_t>& current,
+                                       const std::vector<size_t>& desired);
+
+// Same on dense ids already looked up by the caller: no hashing, only bit operations
+[[nodiscard]] LeafIdDiff diff_dense_ids(const LeafInterner& interner,
+                                        const std::vector<uint32_t>& current,
+                                        const std::vector<uint32_t>& desired);
+
+} // namespace cells
+} // namespace wintiler
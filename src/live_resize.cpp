@@ -0,0 +1,89 @@
+#include "live_resize.h"
+
+#include <algorithm>
+
+namespace wintiler {
+
+std::chrono::steady_clock::duration live_resize_frame_interval(std::optional<int> display_rate_hz,
+                                                               int max_rate_hz) {
+  int rate = display_rate_hz.value_or(kFallbackDisplayRateHz);
+  // Displays report 0 or 1 for "hardware default"
+  if (rate <= 1) {
+    rate = kFallbackDisplayRateHz;
+  }
+  if (max_rate_hz > 0) {
+    rate = std::min(rate, max_rate_hz);
+  }
+  return std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::seconds(1)) /
+         rate;
+}
+
+LiveResizeThrottle::LiveResizeThrottle(Clock::duration frame_interval)
+    : frame_interval_(frame_interval) {
+}
+
+void LiveResizeThrottle::set_frame_interval(Clock::duration frame_interval) {
+  frame_interval_ = frame_interval;
+}
+
+void LiveResizeThrottle::on_location(size_t hwnd) {
+  if (hwnd_ != hwnd) {
+    end();
+    hwnd_ = hwnd;
+  }
+  pending_ = true;
+  ++stats_.events;
+}
+
+LiveResizeThrottle::Stats LiveResizeThrottle::end() {
+  Stats finished = stats_;
+  hwnd_.reset();
+  pending_ = false;
+  last_reflow_.reset();
+  last_cost_ = {};
+  stats_ = {};
+  return finished;
+}
+
+std::optional<size_t> LiveResizeThrottle::take(Clock::time_point now) {
+  auto delay = time_until_due(now);
+  if (!delay.has_value() || *delay > Clock::duration::zero()) {
+    return std::nullopt;
+  }
+  pending_ = false;
+  last_reflow_ = now;
+  ++stats_.reflows;
+  return hwnd_;
+}
+
+std::optional<LiveResizeThrottle::Clock::duration>
+LiveResizeThrottle::time_until_due(Clock::time_point now) const {
+  if (!pending_ || !hwnd_.has_value()) {
+    return std::nullopt;
+  }
+  // The first change of a drag is applied right away
+  if (!last_reflow_.has_value()) {
+    return Clock::duration::zero();
+  }
+  auto due = *last_reflow_ + interval();
+  return due > now ? due - now : Clock::duration::zero();
+}
+
+void LiveResizeThrottle::record_cost(Clock::duration cost) {
+  last_cost_ = cost;
+  stats_.max_cost = std::max(stats_.max_cost, cost);
+}
+
+std::optional<size_t> LiveResizeThrottle::active() const {
+  return hwnd_;
+}
+
+LiveResizeThrottle::Clock::duration LiveResizeThrottle::interval() const {
+  return std::max(frame_interval_, last_cost_ * kCostFactor);
+}
+
+const LiveResizeThrottle::Stats& LiveResizeThrottle::stats() const {
+  return stats_;
+}
+
+} // namespace wintiler
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+
+namespace wintiler {
+
+// Refresh rate assumed when the display does not report one
+constexpr int kFallbackDisplayRateHz = 60;
+
+// Reflow interval for live resize: one display frame, or slower when max_rate_hz caps it
+// (0 = no cap)
+[[nodiscard]] std::chrono::steady_clock::duration
+live_resize_frame_interval(std::optional<int> display_rate_hz, int max_rate_hz);
+
+// Paces the neighbor reflow while a tiled window is being resized. Location changes of the
+// dragged window arrive at mouse rate; a reflow runs at most once per interval and reads the
+// window's rect at that moment, so the events in between only mark work as pending. The
+// interval is one frame but never less than kCostFactor times the last reflow's cost, which
+// bounds the share of loop time spent reflowing however long the drag lasts.
+class LiveResizeThrottle {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr int kCostFactor = 2;
+
+  struct Stats {
+    size_t events = 0;  // Location changes seen during the drag
+    size_t reflows = 0; // Reflows handed out by take()
+    Clock::duration max_cost{};
+  };
+
+  explicit LiveResizeThrottle(Clock::duration frame_interval);
+
+  // Change the frame interval (config reload or display change)
+  void set_frame_interval(Clock::duration frame_interval);
+
+  // The dragged window moved or resized. A different window than the tracked one starts a new
+  // drag.
+  void on_location(size_t hwnd);
+
+  // The drag finished: pending work is dropped and the stats of the drag are returned
+  Stats end();
+
+  // Window to reflow now, or nullopt if nothing is pending or the interval has not elapsed
+  [[nodiscard]] std::optional<size_t> take(Clock::time_point now);
+
+  // Delay until pending work is due (zero if due now), nullopt when nothing is pending
+  [[nodiscard]] std::optional<Clock::duration> time_until_due(Clock::time_point now) const;
+
+  // Report how long the reflow handed out by take() took
+  void record_cost(Clock::duration cost);
+
+  // Window of the current drag, nullopt between drags
+  [[nodiscard]] std::optional<size_t> active() const;
+
+  // Effective interval between reflows (frame interval stretched by the last cost)
+  [[nodiscard]] Clock::duration interval() const;
+
+  [[nodiscard]] const Stats& stats() const;
+
+private:
+  Clock::duration frame_interval_;
+  Clock::duration last_cost_{};
+  std::optional<size_t> hwnd_;
+  bool pending_ = false;
+  std::optional<Clock::time_point> last_reflow_;
+  Stats stats_;
+};
+
+} // namespace wintiler
@@ -3,13 +3,31 @@
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
+#include <atomic>
+#include <filesystem>
 #include <magic_enum/magic_enum.hpp>
+#include <memory>
+#include <mutex>
 #include <vector>
 
+#include "executor.h"
+#include "flight_recorder.h"
+#include "gather_thread.h"
+#include "input_events.h"
+#include "invariant_check.h"
+#include "ipc.h"
+#include "ipc_server.h"
+#include "live_resize.h"
+#include "loop_tasks.h"
 #include "model.h"
 #include "multi_cell_renderer.h"
 #include "multi_cells.h"
 #include "overlay.h"
+#include "power_profile.h"
+#include "startup.h"
+#include "thread_pool.h"
+#include "tick_memo.h"
+#include "watchdog.h"
 #include "winapi.h"
 
 namespace wintiler {
@@ -44,6 +62,15 @@ struct ToastState {
     }
     return std::nullopt;
   }
+
+  // Time until the visible message expires and the overlay needs a redraw
+  std::optional<std::chrono::steady_clock::duration> time_remaining() const {
+    auto now = std::chrono::steady_clock::now();
+    if (now < expiry) {
+      return expiry - now;
+    }
+    return std::nullopt;
+  }
 };
 
 // Convert HotkeyAction to integer ID for Windows hotkey registration
@@ -106,6 +133,11 @@ std::optional<cells::Direction> hotkey_action_to_direction(HotkeyAction action)
   case HotkeyAction::ExchangeSiblings:
   case HotkeyAction::ToggleZen:
   case HotkeyAction::ResetSplitRatio:
+  case HotkeyAction::DumpFlightRecorder:
+  case HotkeyAction::NextWorkspace:
+  case HotkeyAction::PrevWorkspace:
+  case HotkeyAction::SendToNextWorkspace:
+  case HotkeyAction::SendToPrevWorkspace:
     return std::nullopt;
   }
   return std::nullopt;
@@ -271,14 +303,15 @@ ActionResult handle_reset_split_ratio(cells::System& system, float gap_horizonta
 // Handle mouse drag-drop move operation
 // Returns true if an operation was performed
 bool handle_mouse_drop_move(cells::System& system, float zen_percentage,
-                            const winapi::LoopInputState& input_state, float gap_horizontal,
+                            const winapi::LoopInputState& input_state,
+                            InputEventState& input_events, float gap_horizontal,
                             float gap_vertical) {
   if (!input_state.drag_info.has_value() || !input_state.drag_info->move_ended) {
     return false;
   }
 
   // Clear the flag immediately to avoid re-processing
-  winapi::clear_drag_ended();
+  clear_drag_ended(input_events);
 
   // Get cursor position from consolidated state
   if (!input_state.cursor_pos.has_value()) {
@@ -373,6 +406,40 @@ bool handle_window_resize(cells::System& system, const winapi::LoopInputState& i
   return result;
 }
 
+// Reflow the neighbors of a window that is still being resized, in one batched move
+// Returns the placed tile updates (empty for a plain move or an unmanaged window)
+std::vector<cells::TileUpdate> reflow_live_resize(cells::System& system, size_t leaf_id,
+                                                  float gap_horizontal, float gap_vertical) {
+  std::vector<cells::TileUpdate> updates;
+  for (size_t ci = 0; ci < system.clusters.size(); ++ci) {
+    if (!cells::find_cell_by_leaf_id(system.clusters[ci].cluster, leaf_id).has_value()) {
+      continue;
+    }
+    auto actual_rect_opt = winapi::get_window_rect(reinterpret_cast<winapi::HWND_T>(leaf_id));
+    if (!actual_rect_opt.has_value()) {
+      return updates;
+    }
+    cells::Rect actual_rect{
+        static_cast<float>(actual_rect_opt->x), static_cast<float>(actual_rect_opt->y),
+        static_cast<float>(actual_rect_opt->width), static_cast<float>(actual_rect_opt->height)};
+    updates = cells::live_resize_tiles(system, ci, leaf_id, actual_rect, gap_horizontal,
+                                       gap_vertical);
+    break;
+  }
+  if (updates.empty()) {
+    return updates;
+  }
+
+  std::vector<winapi::TileInfo> batch;
+  batch.reserve(updates.size());
+  for (const auto& upd : updates) {
+    batch.push_back({reinterpret_cast<winapi::HWND_T>(upd.leaf_id),
+                     winapi::WindowPosition{upd.x, upd.y, upd.width, upd.height}});
+  }
+  winapi::update_window_positions(batch);
+  return updates;
+}
+
 ActionResult dispatch_hotkey_action(HotkeyAction action, cells::System& system,
                                     std::optional<StoredCell>& stored_cell,
                                     std::string& out_message, float gap_horizontal,
@@ -403,6 +470,13 @@ ActionResult dispatch_hotkey_action(HotkeyAction action, cells::System& system,
     return handle_toggle_zen(system);
   case HotkeyAction::ResetSplitRatio:
     return handle_reset_split_ratio(system, gap_horizontal, gap_vertical);
+  case HotkeyAction::DumpFlightRecorder:
+    return ActionResult::Continue; // Needs the recorder, handled by the hotkey task
+  case HotkeyAction::NextWorkspace:
+  case HotkeyAction::PrevWorkspace:
+  case HotkeyAction::SendToNextWorkspace:
+  case HotkeyAction::SendToPrevWorkspace:
+    return ActionResult::Continue; // Needs the input state, handled by the hotkey task
   case HotkeyAction::NavigateLeft:
   case HotkeyAction::NavigateDown:
   case HotkeyAction::NavigateUp:
@@ -416,6 +490,217 @@ ActionResult dispatch_hotkey_action(HotkeyAction action, cells::System& system,
   }
 }
 
+bool is_workspace_action(HotkeyAction action) {
+  return action == HotkeyAction::NextWorkspace || action == HotkeyAction::PrevWorkspace ||
+         action == HotkeyAction::SendToNextWorkspace || action == HotkeyAction::SendToPrevWorkspace;
+}
+
+// Cluster a workspace hotkey acts on: the selection's, else the monitor under the cursor
+std::optional<size_t> workspace_cluster(const cells::System& system,
+                                        const winapi::LoopInputState& input_state) {
+  if (system.selection.has_value()) {
+    return system.selection->cluster_index;
+  }
+  if (!input_state.cursor_pos.has_value()) {
+    return std::nullopt;
+  }
+  float x = static_cast<float>(input_state.cursor_pos->x);
+  float y = static_cast<float>(input_state.cursor_pos->y);
+  for (size_t ci = 0; ci < system.clusters.size(); ++ci) {
+    const auto& pc = system.clusters[ci];
+    if (x >= pc.monitor_x && x < pc.monitor_x + pc.monitor_width && y >= pc.monitor_y &&
+        y < pc.monitor_y + pc.monitor_height) {
+      return ci;
+    }
+  }
+  return std::nullopt;
+}
+
+// Bring the loop's window list in line with a hide/show, so the apply tick that follows sees
+// the new workspace rather than the last enumeration
+void patch_window_lists(winapi::LoopInputState& input_state, size_t cluster_index,
+                        const std::vector<size_t>& hidden, const std::vector<size_t>& shown) {
+  for (auto& windows : input_state.windows_per_monitor) {
+    std::erase_if(windows, [&](const winapi::ManagedWindowInfo& win) {
+      auto id = reinterpret_cast<size_t>(win.handle);
+      return std::find(hidden.begin(), hidden.end(), id) != hidden.end();
+    });
+  }
+  if (cluster_index < input_state.windows_per_monitor.size()) {
+    for (size_t id : shown) {
+      input_state.windows_per_monitor[cluster_index].push_back(
+          {reinterpret_cast<winapi::HWND_T>(id), false});
+    }
+  }
+}
+
+// List a window under another monitor until the next enumeration, keeping its flags
+void reassign_window_list(winapi::LoopInputState& input_state, size_t leaf_id,
+                          size_t cluster_index) {
+  if (cluster_index >= input_state.windows_per_monitor.size()) {
+    return;
+  }
+  auto handle = reinterpret_cast<winapi::HWND_T>(leaf_id);
+  for (auto& windows : input_state.windows_per_monitor) {
+    auto it = std::find_if(windows.begin(), windows.end(),
+                           [&](const winapi::ManagedWindowInfo& win) {
+                             return win.handle == handle;
+                           });
+    if (it != windows.end()) {
+      auto info = *it;
+      windows.erase(it);
+      input_state.windows_per_monitor[cluster_index].push_back(info);
+      return;
+    }
+  }
+}
+
+std::vector<winapi::HWND_T> to_hwnds(const std::vector<size_t>& leaf_ids) {
+  std::vector<winapi::HWND_T> hwnds;
+  hwnds.reserve(leaf_ids.size());
+  for (size_t id : leaf_ids) {
+    hwnds.push_back(reinterpret_cast<winapi::HWND_T>(id));
+  }
+  return hwnds;
+}
+
+// Switch to or send the selected window to the next/previous workspace of a monitor. A switch
+// is one hide/show batch; the shown windows are placed by the next apply tick. Returns the
+// toast message, empty if nothing changed.
+std::string handle_workspace_action(HotkeyAction action, cells::System& system,
+                                    winapi::LoopInputState& input_state, float gap_horizontal,
+                                    float gap_vertical) {
+  auto cluster_index = workspace_cluster(system, input_state);
+  if (!cluster_index.has_value()) {
+    return {};
+  }
+  const auto& pc = system.clusters[*cluster_index];
+  size_t count = cells::workspace_count(pc);
+  bool forward =
+      action == HotkeyAction::NextWorkspace || action == HotkeyAction::SendToNextWorkspace;
+  size_t target = (pc.active_workspace + (forward ? 1 : count - 1)) % count;
+
+  if (action == HotkeyAction::NextWorkspace || action == HotkeyAction::PrevWorkspace) {
+    auto result = cells::switch_workspace(system, *cluster_index, target);
+    if (!result.has_value()) {
+      return {};
+    }
+    winapi::set_windows_visibility(to_hwnds(result->hidden_leaf_ids),
+                                   to_hwnds(result->shown_leaf_ids));
+    patch_window_lists(input_state, *cluster_index, result->hidden_leaf_ids,
+                       result->shown_leaf_ids);
+    if (result->focus.has_value()) {
+      winapi::set_foreground_window(reinterpret_cast<winapi::HWND_T>(result->focus->leaf_id));
+      winapi::set_cursor_pos(result->focus->center.x, result->focus->center.y);
+    }
+    spdlog::info("Monitor {}: workspace {} ({} windows hidden, {} shown)", *cluster_index,
+                 target + 1, result->hidden_leaf_ids.size(), result->shown_leaf_ids.size());
+    return "Workspace " + std::to_string(target + 1);
+  }
+
+  if (!system.selection.has_value()) {
+    return {};
+  }
+  const auto& cell = pc.cluster.cells[static_cast<size_t>(system.selection->cell_index)];
+  if (!cell.leaf_id.has_value()) {
+    return {};
+  }
+  size_t leaf_id = *cell.leaf_id;
+  if (!cells::send_to_workspace(system, *cluster_index, leaf_id, target, gap_horizontal,
+                                gap_vertical)) {
+    return {};
+  }
+  winapi::set_windows_visibility({reinterpret_cast<winapi::HWND_T>(leaf_id)}, {});
+  patch_window_lists(input_state, *cluster_index, {leaf_id}, {});
+  spdlog::info("Sent window {:#x} to workspace {} of monitor {}", leaf_id, target + 1,
+               *cluster_index);
+  return "Sent to workspace " + std::to_string(target + 1);
+}
+
+// Show every window parked in an inactive workspace, before the system is rebuilt or at exit
+void show_parked_windows(const cells::System& system) {
+  if (!system.parked_leaf_ids.empty()) {
+    winapi::set_windows_visibility({}, to_hwnds(system.parked_leaf_ids));
+  }
+}
+
+// Copy the drag tracking folded from hook thread events into the loop input state
+void apply_drag_state(winapi::LoopInputState& input_state, const InputEventState& input_events) {
+  input_state.is_any_window_being_moved = input_events.is_moving;
+  if (input_events.moving_hwnd.has_value()) {
+    input_state.drag_info = winapi::DragInfo{
+        reinterpret_cast<winapi::HWND_T>(*input_events.moving_hwnd), input_events.move_ended};
+  } else {
+    input_state.drag_info.reset();
+  }
+}
+
+// Use the cursor position from mouse-move events once the hook thread has reported one
+void apply_cursor_state(winapi::LoopInputState& input_state, InputEventState& input_events) {
+  if (input_events.cursor_pos.has_value()) {
+    input_state.cursor_pos = winapi::Point{input_events.cursor_pos->first,
+                                           input_events.cursor_pos->second};
+  }
+  input_events.cursor_moved = false;
+}
+
+cells::HoverFocusOptions hover_focus_options(const FocusOptions& focus_options) {
+  return {std::chrono::milliseconds(focus_options.hoverDwellMs),
+          std::chrono::milliseconds(focus_options.minForegroundIntervalMs)};
+}
+
+// Process, class and title of a managed window, for layout template match rules
+WindowDescription describe_window(size_t leaf_id) {
+  auto info = winapi::get_window_info(reinterpret_cast<winapi::HWND_T>(leaf_id));
+  return {leaf_id, info.processName, info.className, info.title};
+}
+
+// Apply queued IPC command batches. Each batch only mutates the cell tree; tiles are
+// placed by the update pass that follows, so a whole batch (a layout template included)
+// costs one layout pass and one placement batch. Windows a batch moved to another monitor
+// are relisted there, so that update pass does not move them back.
+void handle_ipc_commands(ipc::CommandServer& server, cells::System& system,
+                         winapi::LoopInputState& input_state, const GlobalOptions& options,
+                         FlightRecorder& recorder) {
+  server.drain([&](const ipc::CommandBatch& batch) {
+    auto result =
+        ipc::apply_batch(system, batch,
+                         {options.gapOptions.horizontal, options.gapOptions.vertical, &recorder,
+                          &options.layouts, describe_window});
+    recorder.record(FlightEventType::IpcBatch, 0, static_cast<int32_t>(batch.commands.size()),
+                    result.ok ? 1 : 0);
+    for (const auto& reassigned : result.reassigned_windows) {
+      reassign_window_list(input_state, reassigned.leaf_id, reassigned.cluster_index);
+    }
+    if (result.window_to_foreground.has_value()) {
+      winapi::HWND_T hwnd = reinterpret_cast<winapi::HWND_T>(*result.window_to_foreground);
+      if (!winapi::set_foreground_window(hwnd)) {
+        spdlog::error("Failed to set foreground window for HWND {}", hwnd);
+      }
+    }
+    if (result.cursor_pos.has_value()) {
+      winapi::set_cursor_pos(result.cursor_pos->x, result.cursor_pos->y);
+    }
+    spdlog::debug("IPC batch: {} commands, ok={}", batch.commands.size(), result.ok);
+    return ipc::format_batch_result(result);
+  });
+}
+
+// Start the IPC command server if enabled; it wakes this thread when a batch arrives
+std::unique_ptr<ipc::CommandServer> start_ipc_server(const IpcOptions& ipc_options) {
+  if (!ipc_options.enabled) {
+    return nullptr;
+  }
+  auto endpoint = ipc_options.endpoint.empty() ? ipc::default_endpoint() : ipc_options.endpoint;
+  auto server = std::make_unique<ipc::CommandServer>(endpoint);
+  auto loop_thread_id = winapi::get_current_thread_id();
+  if (!server->start([loop_thread_id] { winapi::wake_message_loop(loop_thread_id); })) {
+    spdlog::error("Failed to start IPC command server on {}", endpoint);
+    return nullptr;
+  }
+  return server;
+}
+
 // Helper: Print tile layout from a multi-cluster system
 void print_tile_layout(const cells::System& system) {
   for (size_t cluster_idx = 0; cluster_idx < system.clusters.size(); ++cluster_idx) {
@@ -501,11 +786,13 @@ void run_update_and_apply_tiles(cells::System& system, const GlobalOptions& opti
   }
 }
 
-cells::System create_initial_system_from_monitors(const std::vector<winapi::MonitorInfo>& monitors,
-                                                  const GlobalOptions& options) {
+// Build the cell system from one enumeration of monitors and windows (get_hwnds_for_monitor
+// per monitor would enumerate the desktop once per monitor)
+cells::System create_system_from_input(const winapi::LoopInputState& input_state,
+                                       const GlobalOptions& options) {
   std::vector<cells::ClusterInitInfo> cluster_infos;
-  for (size_t i = 0; i < monitors.size(); ++i) {
-    const auto& monitor = monitors[i];
+  for (size_t i = 0; i < input_state.monitors.size(); ++i) {
+    const auto& monitor = input_state.monitors[i];
     // Workspace bounds (for tiling)
     float x = static_cast<float>(monitor.workArea.left);
     float y = static_cast<float>(monitor.workArea.top);
@@ -517,12 +804,14 @@ cells::System create_initial_system_from_monitors(const std::vector<winapi::Moni
     float mw = static_cast<float>(monitor.rect.right - monitor.rect.left);
     float mh = static_cast<float>(monitor.rect.bottom - monitor.rect.top);
 
-    auto hwnds = winapi::get_hwnds_for_monitor(i, options.ignoreOptions);
     std::vector<size_t> cell_ids;
-    for (auto hwnd : hwnds) {
-      cell_ids.push_back(reinterpret_cast<size_t>(hwnd));
+    if (i < input_state.windows_per_monitor.size()) {
+      for (const auto& win : input_state.windows_per_monitor[i]) {
+        cell_ids.push_back(reinterpret_cast<size_t>(win.handle));
+      }
     }
-    cluster_infos.push_back({x, y, w, h, mx, my, mw, mh, cell_ids});
+    cluster_infos.push_back({x, y, w, h, mx, my, mw, mh, cell_ids,
+                             static_cast<size_t>(options.workspaceOptions.count)});
   }
 
   return cells::create_system(cluster_infos, options.gapOptions.horizontal,
@@ -530,16 +819,16 @@ cells::System create_initial_system_from_monitors(const std::vector<winapi::Moni
 }
 
 cells::System create_initial_system(const GlobalOptions& options) {
-  auto monitors = winapi::get_monitors();
-  winapi::log_monitors(monitors);
-  return create_initial_system_from_monitors(monitors, options);
+  auto input_state = winapi::gather_loop_input_state(options.ignoreOptions);
+  winapi::log_monitors(input_state.monitors);
+  return create_system_from_input(input_state, options);
 }
 
-// Handle config file hot-reload
-void handle_config_refresh(GlobalOptionsProvider& provider, cells::System& system,
+// Handle config file hot-reload, returns true if options changed
+bool handle_config_refresh(GlobalOptionsProvider& provider, cells::System& system,
                            ToastState& toast) {
   if (!provider.refresh()) {
-    return;
+    return false;
   }
   const auto& options = provider.options;
   unregister_navigation_hotkeys(options.keyboardOptions);
@@ -547,6 +836,7 @@ void handle_config_refresh(GlobalOptionsProvider& provider, cells::System& syste
   cells::recompute_rects(system, options.gapOptions.horizontal, options.gapOptions.vertical);
   toast.set_duration(std::chrono::milliseconds(options.visualizationOptions.toastDurationMs));
   spdlog::info("Config hot-reloaded");
+  return true;
 }
 
 // Handle monitor configuration changes, returns true if change occurred
@@ -557,46 +847,131 @@ bool handle_monitor_change(std::vector<winapi::MonitorInfo>& monitors, const Glo
     return false;
   }
   spdlog::info("Monitor configuration changed, reinitializing system...");
-  winapi::log_monitors(current_monitors);
-  monitors = current_monitors;
-  system = create_initial_system_from_monitors(monitors, options);
+  // The new system starts with one tree per monitor, so parked windows come back first
+  show_parked_windows(system);
+  auto input_state = winapi::gather_loop_input_state(options.ignoreOptions);
+  winapi::log_monitors(input_state.monitors);
+  monitors = input_state.monitors;
+  system = create_system_from_input(input_state, options);
   stored_cell.reset();
   spdlog::info("=== Reinitialized Tile Layout ===");
   print_tile_layout(system);
-  // Tile layout will be applied by the main loop's system.update() call
+  // Tile layout will be applied by the loop's apply task after the resync
   return true;
 }
 
+// Flight recorder dump file in the temp directory, e.g. win-tiler-flight-1700000000.txt
+std::filesystem::path flight_dump_path(const char* prefix) {
+  auto stamp = std::chrono::duration_cast<std::chrono::seconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+                   .count();
+  return std::filesystem::temp_directory_path() /
+         (std::string(prefix) + "-" + std::to_string(stamp) + ".txt");
+}
+
+// Message wait timeout for the executor backend (rounded up so timers are due on wake)
+unsigned long timeout_until(std::optional<exec::TimePoint> deadline) {
+  if (!deadline.has_value()) {
+    return winapi::kInfiniteTimeout;
+  }
+  auto now = exec::Clock::now();
+  if (*deadline <= now) {
+    return 0;
+  }
+  auto ms = std::chrono::ceil<std::chrono::milliseconds>(*deadline - now).count();
+  return static_cast<unsigned long>(std::min<long long>(ms, winapi::kInfiniteTimeout - 1));
+}
+
 } // namespace
 
 void run_loop_mode(GlobalOptionsProvider& provider) {
   const auto& options = provider.options;
 
-  // Get initial monitor configuration and create system
-  auto monitors = winapi::get_monitors();
+  // Startup: a single enumeration builds the system and places the first tiles while the
+  // overlay devices are created on a worker thread (see startup.h)
+  std::vector<winapi::MonitorInfo> monitors;
+  cells::System system;
+  StartupHooks startup;
+  startup.gather = [&] { return winapi::gather_loop_input_state(options.ignoreOptions); };
+  startup.first_layout = [&](const winapi::LoopInputState& state) {
+    monitors = state.monitors;
+    system = create_system_from_input(state, options);
+    run_update_and_apply_tiles(system, options, state);
+  };
+  startup.init_overlay_devices = [] { return overlay::init_devices(); };
+  startup.init_overlay_window = [](bool devices_ok) { return devices_ok && overlay::init(); };
+  auto startup_report = run_startup(startup);
+  auto to_ms = [](std::chrono::microseconds us) { return us.count() / 1000.0; };
+  spdlog::info("Startup: first tiles after {:.1f}ms (enumeration {:.1f}ms), overlay {} after "
+               "{:.1f}ms (devices {:.1f}ms on a worker thread)",
+               to_ms(startup_report.time_to_first_tile), to_ms(startup_report.gather),
+               startup_report.overlay_ok ? "ready" : "failed", to_ms(startup_report.total),
+               to_ms(startup_report.overlay_devices));
   winapi::log_monitors(monitors);
-  auto system = create_initial_system_from_monitors(monitors, options);
-
-  // Print initial layout and apply via system.update()
   spdlog::info("=== Initial Tile Layout ===");
   print_tile_layout(system);
 
-  {
-    auto input_state = winapi::gather_loop_input_state(options.ignoreOptions);
-    run_update_and_apply_tiles(system, options, input_state);
+  // Last gathered window list; cheap fields are refreshed on every poll
+  auto input_state = std::move(startup_report.input_state);
+
+  // Window move/resize hooks and hotkeys live on the hook thread, which queues their events
+  // and wakes this thread
+  auto input_event_queue = std::make_unique<InputEventQueue>();
+  InputEventState input_events;
+  auto loop_thread_id = winapi::get_current_thread_id();
+  auto wake_loop = [loop_thread_id] { winapi::wake_message_loop(loop_thread_id); };
+  if (!winapi::start_hook_thread(*input_event_queue, wake_loop)) {
+    // Without them drags are never seen and tiles would fight the user; give up cleanly
+    spdlog::error("Cannot run the loop without window move/size hooks, exiting");
+    overlay::shutdown();
+    return;
   }
 
   // Register keyboard hotkeys
   register_navigation_hotkeys(options.keyboardOptions);
 
-  // Register window move/resize detection hooks
-  winapi::register_move_size_hook();
-
   // Register session/power notifications for pause on lock/sleep/display-off
   winapi::register_session_power_notifications();
 
-  // Initialize overlay for rendering
-  overlay::init();
+  // Accept automation commands over the local IPC channel
+  auto ipc_server = start_ipc_server(options.ipcOptions);
+
+  // Recent loop events, dumped by the DumpFlightRecorder hotkey, the IPC recorder command
+  // or a crash
+  FlightRecorder recorder;
+  uint64_t apply_ticks = 0;
+  winapi::set_crash_handler([&recorder, &system] {
+    write_flight_dump(recorder, flight_dump_path("win-tiler-crash-flight").string(), false);
+    show_parked_windows(system);
+  });
+
+  // Cell tree invariants, checked after every mutating task on just the cells it touched. A
+  // violation repeated from the previous pass is not logged again; the first one of the run
+  // also dumps the flight recorder.
+  cells::InvariantChecker invariant_checker;
+  std::vector<cells::InvariantViolation> last_violations;
+  bool invariant_dump_written = false;
+  auto check_invariants = [&](const char* after) {
+    auto violations = invariant_checker.check(system);
+    if (violations == last_violations) {
+      return;
+    }
+    for (const auto& v : violations) {
+      spdlog::error("Invariant: {} after {} (cluster {}, cell {}, leaf {:#x})",
+                    cells::invariant_violation_type_to_string(v.type), after, v.cluster_index,
+                    v.cell_index, v.leaf_id);
+      recorder.record(FlightEventType::Invariant, v.cluster_index, v.cell_index,
+                      static_cast<int32_t>(v.type));
+    }
+    if (!violations.empty() && !invariant_dump_written) {
+      invariant_dump_written = true;
+      auto path = flight_dump_path("win-tiler-invariant-flight");
+      if (write_flight_dump(recorder, path.string(), false)) {
+        spdlog::error("Invariant: flight recorder dumped to {}", path.string());
+      }
+    }
+    last_violations = std::move(violations);
+  };
 
   // Print keyboard shortcuts
   spdlog::info("=== Keyboard Shortcuts ===");
@@ -604,7 +979,8 @@ void run_loop_mode(GlobalOptionsProvider& provider) {
     spdlog::info("  {}: {}", hotkey_action_to_string(binding.action), binding.hotkey);
   }
 
-  // 3. Enter monitoring loop
+  // 3. Enter monitoring loop: hotkeys, IPC, drag events, enumeration, config/monitor checks
+  // and rendering run as separate tasks on a single-threaded executor (see loop_tasks.h)
   spdlog::info("Monitoring for window changes... (Ctrl+C to exit)");
 
   // Store cell for swap/move operations
@@ -613,90 +989,445 @@ void run_loop_mode(GlobalOptionsProvider& provider) {
   // Toast message state
   ToastState toast(std::chrono::milliseconds(options.visualizationOptions.toastDurationMs));
 
-  while (true) {
-    // Wait for messages (hotkeys) or timeout - responds immediately to hotkeys
-    winapi::wait_for_messages_or_timeout(options.loopOptions.intervalMs);
+  // Power profile: auto mode follows the AC/DC state, re-checked on every poll. Wakeups and
+  // CPU time are accounted per profile and reported on each switch and at exit.
+  const auto& loop_options = options.loopOptions;
+  const auto& power_options = options.powerOptions;
+  PowerProfile power_profile = select_power_profile(power_options.mode, winapi::is_on_ac_power());
+  ProfileSettings profile = profile_settings(power_profile, loop_options, power_options);
+  PowerProfileMeter power_meter(power_profile, exec::Clock::now(), winapi::get_process_cpu_time());
+  spdlog::info("Power profile: {}", power_profile_to_string(power_profile));
+
+  // Overlay needs a redraw (render-on-change profiles skip clean frames)
+  bool overlay_dirty = true;
+  std::optional<std::string> rendered_toast;
+
+  // Apply ticks whose inputs match the last quiet one are skipped along with their redraw.
+  // layout_generation counts changes to the cell tree or its settings made outside the
+  // layout pass; any of them makes the next tick run.
+  TickMemo tick_memo;
+  uint64_t layout_generation = 0;
+  bool tick_skipped = false;
+
+  // Resync interval follows the observed change rate; wakeups are reported per window
+  AdaptiveInterval resync_interval(std::chrono::milliseconds(profile.min_interval_ms),
+                                   std::chrono::milliseconds(profile.max_interval_ms));
+  WakeupMeter wakeups;
+
+  auto log_power_usage = [&] {
+    auto now = exec::Clock::now();
+    auto cpu_time = winapi::get_process_cpu_time();
+    for (auto p : {PowerProfile::Performance, PowerProfile::LowPower}) {
+      auto usage = power_meter.usage(p, now, cpu_time);
+      if (usage.wall == exec::Duration::zero()) {
+        continue;
+      }
+      spdlog::info("Power: {} for {}s, {:.1f} wakeups/min, {:.2f}% CPU", power_profile_to_string(p),
+                   std::chrono::duration_cast<std::chrono::seconds>(usage.wall).count(),
+                   usage.wakeups_per_minute(), usage.cpu_percent());
+    }
+  };
+
+  // Re-select the profile (power source or config changed) and apply its settings
+  auto refresh_power_profile = [&] {
+    auto next = select_power_profile(power_options.mode, winapi::is_on_ac_power());
+    if (next != power_profile) {
+      power_meter.switch_to(next, exec::Clock::now(), winapi::get_process_cpu_time());
+      spdlog::info("Power profile: {} -> {}", power_profile_to_string(power_profile),
+                   power_profile_to_string(next));
+      log_power_usage();
+      power_profile = next;
+    }
+    profile = profile_settings(power_profile, loop_options, power_options);
+    resync_interval.set_bounds(std::chrono::milliseconds(profile.min_interval_ms),
+                               std::chrono::milliseconds(profile.max_interval_ms));
+    overlay_dirty = true;
+    ++layout_generation;
+  };
+
+  // Live resize: neighbors follow a window being resized, at most once per display frame
+  auto live_resize_interval = [&] {
+    return live_resize_frame_interval(winapi::get_display_refresh_rate(),
+                                      options.resizeOptions.maxRateHz);
+  };
+  LiveResizeThrottle live_resize(live_resize_interval());
+  bool live_resized = false; // The current drag has moved neighbors
+
+  exec::Executor executor(
+      {[] { return exec::Clock::now(); },
+       [&](std::optional<exec::TimePoint> deadline) {
+         winapi::wait_for_messages_or_timeout(timeout_until(deadline));
+         power_meter.record_wakeup();
+         if (auto rate = wakeups.record(exec::Clock::now())) {
+           spdlog::debug("Loop: {:.1f} wakeups/s, resync interval {}ms, {} of {} ticks skipped",
+                         *rate,
+                         std::chrono::duration_cast<std::chrono::milliseconds>(
+                             resync_interval.current())
+                             .count(),
+                         tick_memo.skipped(), tick_memo.ticks());
+         }
+       },
+       nullptr});
+
+  // Window enumeration producer. Ignore rules are copied under a lock because config
+  // hot-reload replaces them on this thread.
+  std::mutex gather_ignore_mutex;
+  IgnoreOptions gather_ignore_options = options.ignoreOptions;
+
+  // Phase markers read by the stall watchdog
+  PhaseMarker loop_marker;
+  PhaseMarker gather_marker;
+
+  GatherThread gather_thread(
+      [&] {
+        PhaseScope phase(gather_marker, LoopPhase::Gather);
+        IgnoreOptions ignore_options;
+        {
+          std::lock_guard lock(gather_ignore_mutex);
+          ignore_options = gather_ignore_options;
+        }
+        auto gather_start = std::chrono::high_resolution_clock::now();
+        auto state = winapi::gather_loop_input_state(ignore_options);
+        auto gather_end = std::chrono::high_resolution_clock::now();
+        auto elapsed =
+            std::chrono::duration_cast<std::chrono::microseconds>(gather_end - gather_start);
+        spdlog::trace("gather: {}us", elapsed.count());
+        return state;
+      },
+      [loop_thread_id] { winapi::wake_message_loop(loop_thread_id); });
+  gather_thread.start();
+
+  // Per-cluster update stage runs in parallel across monitors; resized when monitors change
+  auto update_pool = std::make_unique<ThreadPool>(ThreadPool::workers_for(monitors.size()));
+
+  // Stall watchdog: reports a loop phase that blocks for longer than the budget. The handler
+  // runs on the watchdog thread, so it gets its own copy of the options (a config reload
+  // replaces them on this thread) and never touches the stalled window: querying a hung
+  // window would block the watchdog on it too.
+  WatchdogOptions watchdog_options = options.watchdogOptions;
+  std::atomic<bool> minidump_written{false};
+  Watchdog watchdog(
+      std::chrono::milliseconds(watchdog_options.budgetMs),
+      std::chrono::milliseconds(watchdog_options.checkIntervalMs),
+      [watchdog_options, &minidump_written](const StallReport& report) {
+        if (report.recovered) {
+          spdlog::warn("Watchdog: {} thread recovered from {} after {}ms", report.thread_name,
+                       loop_phase_to_string(report.phase), report.elapsed.count());
+          return;
+        }
+        std::string dump_path;
+        if (watchdog_options.minidump && !minidump_written.exchange(true)) {
+          auto path = std::filesystem::path(watchdog_options.dumpDirectory) /
+                      ("win-tiler-stall-" + std::to_string(report.elapsed.count()) + "ms.dmp");
+          if (winapi::write_minidump(path.string())) {
+            dump_path = path.string();
+          }
+        }
+        spdlog::error("Watchdog: {} thread stalled in {} for {}ms (HWND {:#x})",
+                      report.thread_name, loop_phase_to_string(report.phase),
+                      report.elapsed.count(), report.hwnd);
+        if (!dump_path.empty()) {
+          spdlog::error("Watchdog: minidump written to {}", dump_path);
+        }
+      });
+  watchdog.watch("loop", loop_marker);
+  watchdog.watch("gather", gather_marker);
+  if (watchdog_options.enabled) {
+    watchdog.start();
+  }
+
+  LoopHooks hooks;
+
+  hooks.poll = [&] {
+    LoopSignals signals;
+
+    // Session/power notifications and wakeups are still delivered to this thread
+    winapi::pump_messages();
+    if (select_power_profile(power_options.mode, winapi::is_on_ac_power()) != power_profile) {
+      refresh_power_profile();
+    }
+
+    if (drain_input_events(*input_event_queue, input_events, exec::Clock::now()) > 0) {
+      spdlog::trace(
+          "Drained {} hook events, max latency {}us", input_events.last_drained,
+          std::chrono::duration_cast<std::chrono::microseconds>(input_events.max_latency).count());
+    }
+    signals.hotkey = !input_events.hotkey_ids.empty();
 
     // Block if session is paused (locked, sleeping, or display off)
     if (winapi::is_session_paused()) {
       spdlog::debug("Session paused, waiting for resume...");
       winapi::wait_for_session_active();
       spdlog::debug("Session resumed, continuing loop");
-      continue; // Re-gather state after resume
+      signals.resync = true; // Re-gather state after resume
     }
 
-    auto loop_start = std::chrono::high_resolution_clock::now();
+    signals.ipc = ipc_server && ipc_server->has_pending();
 
-    // Gather all Windows API input state in a single call
-    auto input_state = winapi::gather_loop_input_state(options.ignoreOptions);
-
-    // Skip all processing while user is dragging a window - only render
-    if (input_state.is_any_window_being_moved) {
-      renderer::render(system, options.visualizationOptions.renderOptions, stored_cell,
-                       toast.get_visible_message());
-      auto loop_end = std::chrono::high_resolution_clock::now();
-      spdlog::trace(
-          "loop iteration total: {}us",
-          std::chrono::duration_cast<std::chrono::microseconds>(loop_end - loop_start).count());
-      continue;
+    // Take the newest enumeration; snapshots published in between are dropped
+    if (const auto* snapshot = gather_thread.take_latest()) {
+      input_state = *snapshot;
+      signals.snapshot = true;
     }
 
-    // Check if a drag operation just completed
-    if (input_state.drag_info.has_value() && input_state.drag_info->move_ended) {
-      // Try resize first (size changed = ratio update)
-      bool resized = handle_window_resize(system, input_state, options.gapOptions.horizontal,
-                                          options.gapOptions.vertical);
-
-      if (resized) {
-        // Resize performed - clear drag flag; layout applied by system.update() below
-        winapi::clear_drag_ended();
-      } else {
-        // Try move/swap (clear_drag_ended called inside if successful)
-        handle_mouse_drop_move(system, options.visualizationOptions.renderOptions.zen_percentage,
-                               input_state, options.gapOptions.horizontal,
-                               options.gapOptions.vertical);
+    // Hover focus re-runs the layout pass on cursor movement instead of waiting for a resync
+    signals.pointer = input_events.cursor_moved && profile.hover_focus;
+    winapi::refresh_input_state(input_state, !input_events.cursor_pos.has_value());
+    apply_cursor_state(input_state, input_events);
+    apply_drag_state(input_state, input_events);
+    signals.window_event = input_events.move_ended;
+    if (input_events.drag_location_changed) {
+      input_events.drag_location_changed = false;
+      if (options.resizeOptions.live && input_events.moving_hwnd.has_value()) {
+        live_resize.on_location(*input_events.moving_hwnd);
+        signals.drag_location = true;
       }
     }
-
-    // Check for config file changes and hot-reload
-    handle_config_refresh(provider, system, toast);
-
-    // Check for monitor configuration changes (tile layout applied by system.update() below)
-    handle_monitor_change(monitors, options, system, stored_cell);
-
-    // Check for keyboard hotkeys (kept separate - has side effects on message queue)
-    if (auto hotkey_id = winapi::check_keyboard_action()) {
-      auto action_opt = id_to_hotkey_action(*hotkey_id);
+    return signals;
+  };
+
+  hooks.handle_hotkeys = [&] {
+    PhaseScope phase(loop_marker, LoopPhase::Hotkeys);
+    resync_interval.on_activity();
+    overlay_dirty = true;
+    ++layout_generation;
+    auto hotkey_ids = std::move(input_events.hotkey_ids);
+    input_events.hotkey_ids.clear();
+    for (int hotkey_id : hotkey_ids) {
+      auto action_opt = id_to_hotkey_action(hotkey_id);
       if (!action_opt.has_value()) {
         continue; // Unknown hotkey ID
       }
+      recorder.record(FlightEventType::Hotkey, 0, static_cast<int32_t>(*action_opt));
+      if (*action_opt == HotkeyAction::DumpFlightRecorder) {
+        auto path = flight_dump_path("win-tiler-flight");
+        if (write_flight_dump(recorder, path.string(), false)) {
+          spdlog::info("Flight recorder dumped to {}", path.string());
+          toast.show("Flight recorder dumped");
+        }
+        continue;
+      }
+      if (is_workspace_action(*action_opt)) {
+        auto message =
+            handle_workspace_action(*action_opt, system, input_state,
+                                    options.gapOptions.horizontal, options.gapOptions.vertical);
+        if (!message.empty()) {
+          // Snapshots gathered before the hide/show are dropped, even late ones
+          gather_thread.invalidate();
+          toast.show(message);
+        }
+        continue;
+      }
       std::string action_message;
       if (dispatch_hotkey_action(*action_opt, system, stored_cell, action_message,
                                  options.gapOptions.horizontal,
                                  options.gapOptions.vertical) == ActionResult::Exit) {
-        break;
+        return false;
       }
       if (!action_message.empty()) {
         toast.show(action_message);
       }
     }
+    check_invariants("hotkeys");
+    return true;
+  };
+
+  // Apply IPC command batches (layout applied by the apply task)
+  hooks.handle_ipc = [&] {
+    PhaseScope phase(loop_marker, LoopPhase::Ipc);
+    resync_interval.on_activity();
+    overlay_dirty = true;
+    ++layout_generation;
+    if (ipc_server) {
+      handle_ipc_commands(*ipc_server, system, input_state, options, recorder);
+    }
+    check_invariants("ipc");
+  };
+
+  // A drag operation just completed
+  hooks.handle_window_event = [&] {
+    if (!input_state.drag_info.has_value() || !input_state.drag_info->move_ended) {
+      return;
+    }
+    PhaseScope phase(loop_marker, LoopPhase::WindowEvent,
+                     reinterpret_cast<size_t>(input_state.drag_info->hwnd));
+    resync_interval.on_activity();
+    overlay_dirty = true;
+    ++layout_generation;
+    auto live_stats = live_resize.end();
+    if (live_stats.events > 0) {
+      spdlog::debug("Live resize: {} location changes, {} reflows, max {}us", live_stats.events,
+                    live_stats.reflows,
+                    std::chrono::duration_cast<std::chrono::microseconds>(live_stats.max_cost)
+                        .count());
+    }
+    // Try resize first (size changed = ratio update). After live reflows the cell already
+    // has the window's size, so a resize that ended there must not be taken for a drop.
+    bool resized = handle_window_resize(system, input_state, options.gapOptions.horizontal,
+                                        options.gapOptions.vertical) ||
+                   live_resized;
+    live_resized = false;
+    if (resized) {
+      // Resize performed - clear drag flag; layout applied by the apply task
+      clear_drag_ended(input_events);
+    } else {
+      // Try move/swap (clear_drag_ended called inside if successful)
+      bool moved = handle_mouse_drop_move(
+          system, options.visualizationOptions.renderOptions.zen_percentage, input_state,
+          input_events, options.gapOptions.horizontal, options.gapOptions.vertical);
+      auto cursor = input_state.cursor_pos.value_or(winapi::Point{0, 0});
+      recorder.record(FlightEventType::DropMove,
+                      reinterpret_cast<size_t>(input_state.drag_info->hwnd),
+                      static_cast<int32_t>(cursor.x), static_cast<int32_t>(cursor.y),
+                      input_state.is_ctrl_pressed ? 1 : 0, moved ? 1 : 0);
+    }
+    apply_drag_state(input_state, input_events);
+    check_invariants("drag");
+  };
+
+  // The window being dragged moved or resized; placement bypasses the apply task, which
+  // would put the dragged window back into its cell
+  hooks.live_resize = [&] {
+    LiveResizeTick tick;
+    auto now = exec::Clock::now();
+    auto hwnd = live_resize.take(now);
+    if (!hwnd.has_value()) {
+      tick.due = live_resize.time_until_due(now);
+      return tick;
+    }
+    PhaseScope phase(loop_marker, LoopPhase::WindowEvent, *hwnd);
+    auto updates = reflow_live_resize(system, *hwnd, options.gapOptions.horizontal,
+                                      options.gapOptions.vertical);
+    for (const auto& upd : updates) {
+      recorder.record(FlightEventType::TileUpdate, upd.leaf_id, upd.x, upd.y, upd.width,
+                      upd.height);
+    }
+    auto done = exec::Clock::now();
+    live_resize.record_cost(done - now);
+    if (!updates.empty()) {
+      live_resized = true;
+      overlay_dirty = true;
+      ++layout_generation;
+      tick.reflowed = true;
+      check_invariants("live resize");
+    }
+    tick.due = live_resize.time_until_due(done);
+    return tick;
+  };
+
+  hooks.check_config = [&] {
+    PhaseScope phase(loop_marker, LoopPhase::Config);
+    if (!handle_config_refresh(provider, system, toast)) {
+      return false;
+    }
+    recorder.record(FlightEventType::ConfigReload);
+    check_invariants("config reload");
+    refresh_power_profile();
+    live_resize.set_frame_interval(live_resize_interval());
+    std::lock_guard lock(gather_ignore_mutex);
+    gather_ignore_options = options.ignoreOptions;
+    return true;
+  };
+
+  hooks.check_monitors = [&] {
+    PhaseScope phase(loop_marker, LoopPhase::Monitors);
+    if (!handle_monitor_change(monitors, options, system, stored_cell)) {
+      return false;
+    }
+    recorder.record(FlightEventType::MonitorChange, 0, static_cast<int32_t>(monitors.size()));
+    // The pool is idle between update passes, so it can be swapped here
+    if (size_t workers = ThreadPool::workers_for(monitors.size());
+        workers != update_pool->worker_count()) {
+      update_pool = std::make_unique<ThreadPool>(workers);
+      spdlog::debug("Update pool resized to {} workers for {} monitors", workers,
+                    monitors.size());
+    }
+    invariant_checker.reset();
+    check_invariants("monitor change");
+    live_resize.set_frame_interval(live_resize_interval());
+    overlay_dirty = true;
+    ++layout_generation;
+    return true;
+  };
+
+  // Enumeration runs on the gather thread; its snapshots are picked up by poll
+  hooks.gather = [&] {
+    gather_thread.request();
+    return false;
+  };
+
+  hooks.apply = [&] {
+    winapi::refresh_input_state(input_state, !input_events.cursor_pos.has_value());
+    apply_cursor_state(input_state, input_events);
+    apply_drag_state(input_state, input_events);
+
+    // Skip all processing while user is dragging a window - only render
+    if (input_state.is_any_window_being_moved) {
+      resync_interval.on_activity();
+      return;
+    }
+
+    // Same windows, cursor, focus and layout as the last quiet tick: update() and placement
+    // would repeat it exactly, and there is nothing new to draw
+    uint64_t input_digest = digest_input_state(input_state, profile.hover_focus);
+    tick_skipped = tick_memo.should_skip(input_digest, layout_generation);
+    if (tick_skipped) {
+      resync_interval.on_tick(false);
+      return;
+    }
+
+    auto apply_start = std::chrono::high_resolution_clock::now();
+    PhaseScope phase(loop_marker, LoopPhase::Update);
+    uint64_t tick = ++apply_ticks;
+    recorder.record(FlightEventType::TickStart, tick);
 
-    // Extract window state from consolidated input
+    // Extract window state from the last gather
     auto current_state = extract_window_state_from_input(input_state);
 
-    // Use update to sync - cursor position from consolidated state
+    // Use update to sync - cursor position from refreshed state
     float cursor_x =
         input_state.cursor_pos.has_value() ? static_cast<float>(input_state.cursor_pos->x) : 0.0f;
     float cursor_y =
         input_state.cursor_pos.has_value() ? static_cast<float>(input_state.cursor_pos->y) : 0.0f;
     float zen_percentage = options.visualizationOptions.renderOptions.zen_percentage;
-    size_t fg_leaf_id = reinterpret_cast<size_t>(input_state.foreground_window);
-    auto result =
-        cells::update(system, current_state, std::nullopt, {cursor_x, cursor_y}, zen_percentage,
-                      fg_leaf_id, options.gapOptions.horizontal, options.gapOptions.vertical);
+    // Without hover focus the foreground window is not reported, so selection and focus
+    // stay where hotkeys put them
+    size_t fg_leaf_id =
+        profile.hover_focus ? reinterpret_cast<size_t>(input_state.foreground_window) : 0;
+    system.hover_focus_options = hover_focus_options(options.focusOptions);
+    auto result = cells::update(system, current_state, std::nullopt, {cursor_x, cursor_y},
+                                zen_percentage, fg_leaf_id, options.gapOptions.horizontal,
+                                options.gapOptions.vertical, update_pool.get(), exec::Clock::now());
+    for (size_t id : result.deleted_leaf_ids) {
+      recorder.record(FlightEventType::LeafRemoved, id);
+    }
+    for (size_t id : result.added_leaf_ids) {
+      recorder.record(FlightEventType::LeafAdded, id);
+    }
+    bool changed = !result.added_leaf_ids.empty() || !result.deleted_leaf_ids.empty() ||
+                   !result.tile_updates.empty();
+    resync_interval.on_tick(changed);
+    // Keep ticking at the fast interval until a held hover change has fired
+    if (result.selection_update.pending) {
+      resync_interval.on_activity();
+    }
+    if (changed || result.selection_updated) {
+      overlay_dirty = true;
+    }
+    bool quiet = result.added_leaf_ids.empty() && result.deleted_leaf_ids.empty() &&
+                 !result.selection_updated && !result.selection_update.needs_update &&
+                 !result.selection_update.pending &&
+                 !result.selection_update.window_to_foreground.has_value();
+    if (quiet) {
+      tick_memo.record(input_digest, layout_generation);
+    } else {
+      tick_memo.invalidate();
+    }
+    check_invariants("update");
 
     // Apply foreground window change (selection already updated inside update())
     if (result.selection_update.window_to_foreground.has_value()) {
+      loop_marker.enter(LoopPhase::Foreground, *result.selection_update.window_to_foreground);
       // Skip if a context menu is active to avoid stealing focus
       if (!winapi::is_context_menu_active()) {
         winapi::HWND_T hwnd =
@@ -706,6 +1437,7 @@ void run_loop_mode(GlobalOptionsProvider& provider) {
         }
       }
     }
+    loop_marker.enter(LoopPhase::Update);
 
     // Log window changes
     if (!result.deleted_leaf_ids.empty() || !result.added_leaf_ids.empty()) {
@@ -714,6 +1446,7 @@ void run_loop_mode(GlobalOptionsProvider& provider) {
       if (!result.added_leaf_ids.empty()) {
         spdlog::debug("Added windows:");
         for (size_t id : result.added_leaf_ids) {
+          loop_marker.set_hwnd(id); // GetWindowText can block on a hung window
           winapi::HWND_T hwnd = reinterpret_cast<winapi::HWND_T>(id);
           std::string title = winapi::get_window_info(hwnd).title;
           spdlog::debug("  + \"{}\"", title);
@@ -731,27 +1464,78 @@ void run_loop_mode(GlobalOptionsProvider& provider) {
     }
 
     // Apply tile updates
+    loop_marker.enter(LoopPhase::PlaceWindows);
+    std::vector<winapi::TileInfo> batch;
     for (const auto& upd : result.tile_updates) {
+      recorder.record(FlightEventType::TileUpdate, upd.leaf_id, upd.x, upd.y, upd.width,
+                      upd.height);
       winapi::HWND_T hwnd = reinterpret_cast<winapi::HWND_T>(upd.leaf_id);
       winapi::WindowPosition pos{upd.x, upd.y, upd.width, upd.height};
       winapi::TileInfo tile_info{hwnd, pos};
+      if (profile.batch_placement) {
+        batch.push_back(tile_info);
+        continue;
+      }
+      loop_marker.set_hwnd(upd.leaf_id);
       winapi::update_window_position(tile_info);
     }
+    if (!batch.empty()) {
+      winapi::update_window_positions(batch);
+    }
 
-    // Render cell system overlay
+    auto apply_end = std::chrono::high_resolution_clock::now();
+    auto apply_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(apply_end - apply_start).count();
+    recorder.record(FlightEventType::TickEnd, tick, static_cast<int32_t>(apply_us),
+                    static_cast<int32_t>(result.tile_updates.size()),
+                    static_cast<int32_t>(result.added_leaf_ids.size()),
+                    static_cast<int32_t>(result.deleted_leaf_ids.size()));
+    spdlog::trace("apply: {}us", apply_us);
+  };
+
+  // Render cell system overlay; redraw again once the toast expires
+  hooks.render = [&]() -> std::optional<exec::Duration> {
+    PhaseScope phase(loop_marker, LoopPhase::Render);
+    auto toast_message = toast.get_visible_message();
+    if ((profile.render_on_change || tick_skipped) && !overlay_dirty &&
+        toast_message == rendered_toast) {
+      return toast.time_remaining();
+    }
+    overlay_dirty = false;
+    rendered_toast = toast_message;
     renderer::render(system, options.visualizationOptions.renderOptions, stored_cell,
-                     toast.get_visible_message());
-
-    auto loop_end = std::chrono::high_resolution_clock::now();
-    spdlog::trace(
-        "=======================loop iteration total: {}us",
-        std::chrono::duration_cast<std::chrono::microseconds>(loop_end - loop_start).count());
+                     toast_message);
+    return toast.time_remaining();
+  };
+
+  LoopSchedule schedule;
+  schedule.resync_interval = [&] {
+    if (profile.adaptive) {
+      return resync_interval.current();
+    }
+    return exec::Duration(std::chrono::milliseconds(profile.interval_ms));
+  };
+
+  LoopTasks tasks(executor, std::move(hooks), std::move(schedule));
+  tasks.start();
+  executor.run();
+
+  watchdog.stop();
+  gather_thread.stop();
+  log_power_usage();
+  winapi::set_crash_handler(nullptr);
+  show_parked_windows(system);
+  spdlog::debug("Gather thread: {} snapshots published, {} consumed", gather_thread.published(),
+                gather_thread.consumed());
+  spdlog::debug("Tick memo: {} of {} apply ticks skipped", tick_memo.skipped(), tick_memo.ticks());
+
+  // Cleanup IPC server, hotkeys, hooks, and overlay before exit
+  if (ipc_server) {
+    ipc_server->stop();
   }
-
-  // Cleanup hotkeys, hooks, and overlay before exit
   unregister_navigation_hotkeys(options.keyboardOptions);
+  winapi::stop_hook_thread();
   winapi::unregister_session_power_notifications();
-  winapi::unregister_move_size_hook();
   overlay::shutdown();
   spdlog::info("Hotkeys unregistered, hooks unregistered, overlay shutdown, exiting...");
 }
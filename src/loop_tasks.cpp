@@ -0,0 +1,237 @@
+#include "loop_tasks.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace wintiler {
+
+LoopTasks::LoopTasks(exec::Executor& executor, LoopHooks hooks, LoopSchedule schedule)
+    : executor_(executor), hooks_(std::move(hooks)), schedule_(std::move(schedule)),
+      hotkey_event_(executor), ipc_event_(executor), window_event_(executor),
+      live_resize_event_(executor), resync_event_(executor), apply_event_(executor),
+      render_event_(executor) {
+}
+
+void LoopTasks::start() {
+  executor_.set_poll([this] { poll(); });
+
+  executor_.spawn(hotkey_task(), exec::Priority::High);
+  executor_.spawn(ipc_task(), exec::Priority::High);
+  executor_.spawn(window_event_task(), exec::Priority::Normal);
+  executor_.spawn(live_resize_task(), exec::Priority::Normal);
+  executor_.spawn(apply_task(), exec::Priority::Normal);
+  executor_.spawn(render_task(), exec::Priority::Low);
+  executor_.spawn(resync_task(), exec::Priority::Low);
+  executor_.spawn(config_task(), exec::Priority::Low);
+  executor_.spawn(monitor_task(), exec::Priority::Low);
+}
+
+void LoopTasks::poll() {
+  auto signals = hooks_.poll();
+  if (signals.hotkey) {
+    hotkey_event_.set();
+  }
+  if (signals.ipc) {
+    ipc_event_.set();
+  }
+  if (signals.window_event) {
+    window_event_.set();
+  }
+  if (signals.drag_location) {
+    live_resize_event_.set();
+  }
+  if (signals.resync) {
+    request_resync();
+  }
+  if (signals.snapshot || signals.pointer) {
+    request_apply();
+  }
+}
+
+void LoopTasks::request_apply() {
+  apply_event_.set();
+}
+
+void LoopTasks::request_render() {
+  render_event_.set();
+}
+
+void LoopTasks::request_resync() {
+  resync_requested_ = true;
+  resync_event_.set();
+}
+
+// ============================================================================
+// AdaptiveInterval / WakeupMeter
+// ============================================================================
+
+AdaptiveInterval::AdaptiveInterval(exec::Duration min, exec::Duration max)
+    : min_(min), max_(std::max(min, max)), current_(min) {
+}
+
+exec::Duration AdaptiveInterval::current() const {
+  return current_;
+}
+
+void AdaptiveInterval::set_bounds(exec::Duration min, exec::Duration max) {
+  min_ = min;
+  max_ = std::max(min, max);
+  current_ = std::clamp(current_, min_, max_);
+}
+
+void AdaptiveInterval::on_activity() {
+  current_ = min_;
+  idle_ticks_ = 0;
+}
+
+void AdaptiveInterval::on_tick(bool changed) {
+  if (changed) {
+    on_activity();
+    return;
+  }
+  if (++idle_ticks_ >= kIdleTicksBeforeBackoff) {
+    current_ = std::min(current_ * 2, max_);
+  }
+}
+
+WakeupMeter::WakeupMeter(exec::Duration window) : window_(window) {
+}
+
+std::optional<double> WakeupMeter::record(exec::TimePoint now) {
+  ++total_;
+  if (!window_start_.has_value()) {
+    window_start_ = now;
+  }
+  ++window_count_;
+  auto elapsed = now - *window_start_;
+  if (elapsed < window_) {
+    return std::nullopt;
+  }
+  double rate = static_cast<double>(window_count_) /
+                std::chrono::duration<double>(elapsed).count();
+  window_start_ = now;
+  window_count_ = 0;
+  return rate;
+}
+
+uint64_t WakeupMeter::total() const {
+  return total_;
+}
+
+// ============================================================================
+// Tasks
+// ============================================================================
+
+exec::Task LoopTasks::hotkey_task() {
+  for (;;) {
+    co_await hotkey_event_.wait();
+    if (!hooks_.handle_hotkeys()) {
+      executor_.stop();
+      co_return;
+    }
+    request_apply();
+  }
+}
+
+exec::Task LoopTasks::ipc_task() {
+  for (;;) {
+    co_await ipc_event_.wait();
+    hooks_.handle_ipc();
+    request_apply();
+  }
+}
+
+exec::Task LoopTasks::window_event_task() {
+  for (;;) {
+    co_await window_event_.wait();
+    hooks_.handle_window_event();
+    request_apply();
+  }
+}
+
+// Reflows go straight to the affected windows and skip the apply task: a full layout pass
+// would move the dragged window back to its cell mid-drag. A change arriving inside the
+// throttle interval is picked up by the timed wait, so the last one of a burst still lands.
+exec::Task LoopTasks::live_resize_task() {
+  std::optional<exec::Duration> due;
+  for (;;) {
+    if (due.has_value()) {
+      co_await live_resize_event_.wait_for(*due);
+    } else {
+      co_await live_resize_event_.wait();
+    }
+    auto tick = hooks_.live_resize();
+    if (tick.reflowed) {
+      request_render();
+    }
+    due = tick.due;
+  }
+}
+
+exec::Task LoopTasks::config_task() {
+  for (;;) {
+    co_await executor_.sleep_for(schedule_.config_interval);
+    if (hooks_.check_config()) {
+      request_apply();
+    }
+  }
+}
+
+exec::Task LoopTasks::monitor_task() {
+  for (;;) {
+    co_await executor_.sleep_for(schedule_.monitor_interval);
+    if (hooks_.check_monitors()) {
+      request_resync();
+    }
+  }
+}
+
+exec::Task LoopTasks::resync_task() {
+  for (;;) {
+    if (hooks_.gather()) {
+      // Let hotkeys that arrived during enumeration run before the layout pass
+      co_await executor_.yield();
+      request_apply();
+    }
+
+    // Wait one interval from the end of this enumeration. The interval is re-read whenever
+    // the task is woken without a resync request (after a layout pass), so a change that
+    // shortens it takes effect for the current wait.
+    auto started = executor_.now();
+    for (;;) {
+      auto deadline = started + schedule_.resync_interval();
+      auto now = executor_.now();
+      if (now >= deadline) {
+        break;
+      }
+      bool signaled = co_await resync_event_.wait_for(deadline - now);
+      if (!signaled || resync_requested_) {
+        break;
+      }
+    }
+    resync_requested_ = false;
+  }
+}
+
+exec::Task LoopTasks::apply_task() {
+  for (;;) {
+    co_await apply_event_.wait();
+    hooks_.apply();
+    request_render();
+    resync_event_.set(); // Re-read the resync interval
+  }
+}
+
+exec::Task LoopTasks::render_task() {
+  std::optional<exec::Duration> next_redraw;
+  for (;;) {
+    if (next_redraw.has_value()) {
+      co_await render_event_.wait_for(*next_redraw);
+    } else {
+      co_await render_event_.wait();
+    }
+    next_redraw = hooks_.render();
+  }
+}
+
+} // namespace wintiler
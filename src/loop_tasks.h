@@ -0,0 +1,142 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+
+#include "executor.h"
+
+namespace wintiler {
+
+// External sources with pending work, as reported by LoopHooks::poll
+struct LoopSignals {
+  bool hotkey = false;
+  bool ipc = false;
+  bool window_event = false;
+  bool resync = false;
+  bool snapshot = false; // A background gather published new input state
+  bool pointer = false;  // Cursor moved; re-run the layout pass (hover focus) without a gather
+  bool drag_location = false; // The dragged window moved or resized; reflow its neighbors
+};
+
+// Outcome of LoopHooks::live_resize
+struct LiveResizeTick {
+  bool reflowed = false;             // Neighbors were moved; the overlay needs a redraw
+  std::optional<exec::Duration> due; // Delay until a change held back by the throttle is due
+};
+
+// Everything the loop task graph needs from the platform. run_loop_mode wires these to
+// winapi/renderer; tests wire them to a simulated backend.
+struct LoopHooks {
+  std::function<LoopSignals()> poll;          // Non-blocking check of event sources
+  std::function<bool()> handle_hotkeys;       // Returns false to exit the loop
+  std::function<void()> handle_ipc;           // Apply queued IPC batches
+  std::function<void()> handle_window_event;  // Drag/resize finished
+  std::function<bool()> check_config;         // True if options changed
+  std::function<bool()> check_monitors;       // True if the monitor layout changed
+  std::function<bool()> gather;               // Enumerate windows; false if it completes later
+                                              // and is reported through LoopSignals::snapshot
+  std::function<void()> apply;                // Update cells and place tiles from last gather
+  std::function<std::optional<exec::Duration>()> render; // Returns delay until a forced redraw
+  std::function<LiveResizeTick()> live_resize; // Reflow neighbors of a window being resized
+};
+
+// Resync interval that follows the observed change rate. A layout pass that changed
+// something, or user activity (hotkey, drag, IPC), drops it to min. After a few consecutive
+// idle passes it doubles on every further idle pass, up to max.
+class AdaptiveInterval {
+public:
+  static constexpr int kIdleTicksBeforeBackoff = 2;
+
+  AdaptiveInterval(exec::Duration min, exec::Duration max);
+
+  [[nodiscard]] exec::Duration current() const;
+
+  // Change the bounds (config reload); the current interval is clamped into them
+  void set_bounds(exec::Duration min, exec::Duration max);
+
+  void on_activity();
+  void on_tick(bool changed);
+
+private:
+  exec::Duration min_;
+  exec::Duration max_;
+  exec::Duration current_;
+  int idle_ticks_ = 0;
+};
+
+// Counts loop wakeups and reports the rate once per measurement window
+class WakeupMeter {
+public:
+  explicit WakeupMeter(exec::Duration window = std::chrono::seconds(10));
+
+  // Count one wakeup. Returns wakeups per second when a window has just completed.
+  std::optional<double> record(exec::TimePoint now);
+
+  [[nodiscard]] uint64_t total() const;
+
+private:
+  exec::Duration window_;
+  std::optional<exec::TimePoint> window_start_;
+  uint64_t window_count_ = 0;
+  uint64_t total_ = 0;
+};
+
+struct LoopSchedule {
+  std::function<exec::Duration()> resync_interval; // Re-read before and after every apply
+  exec::Duration config_interval = std::chrono::milliseconds(500);
+  exec::Duration monitor_interval = std::chrono::milliseconds(1000);
+};
+
+// The main loop as a set of coroutine tasks, each awaiting its own event source:
+//   hotkeys, ipc         (High)   - run as soon as the message arrives
+//   window events, apply,
+//   live resize          (Normal) - layout from the last gathered window list
+//   render, resync,
+//   config, monitors     (Low)    - periodic or coalesced work
+// A hotkey therefore waits at most for the task step that is currently running,
+// never for a whole enumerate/update/render cycle.
+class LoopTasks {
+public:
+  LoopTasks(exec::Executor& executor, LoopHooks hooks, LoopSchedule schedule);
+
+  LoopTasks(const LoopTasks&) = delete;
+  LoopTasks& operator=(const LoopTasks&) = delete;
+
+  // Spawn all tasks on the executor and hook poll() into it
+  void start();
+
+  // Query LoopHooks::poll and wake the tasks whose sources have work
+  void poll();
+
+  void request_apply();
+  void request_render();
+  void request_resync();
+
+private:
+  exec::Task hotkey_task();
+  exec::Task ipc_task();
+  exec::Task window_event_task();
+  exec::Task live_resize_task();
+  exec::Task config_task();
+  exec::Task monitor_task();
+  exec::Task resync_task();
+  exec::Task apply_task();
+  exec::Task render_task();
+
+  exec::Executor& executor_;
+  LoopHooks hooks_;
+  LoopSchedule schedule_;
+
+  exec::Event hotkey_event_;
+  exec::Event ipc_event_;
+  exec::Event window_event_;
+  exec::Event live_resize_event_;
+  exec::Event resync_event_;
+  bool resync_requested_ = false; // resync_event_ also fires to re-read the interval
+  exec::Event apply_event_;
+  exec::Event render_event_;
+};
+
+} // namespace wintiler
@@ -6,17 +6,23 @@
 #include <algorithm>
 #include <chrono>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <thread>
 #include <unordered_map>
 #include <vector>
 
 #include "argument_parser.h"
+#include "ipc.h"
+#include "ipc_server.h"
 #include "loop.h"
 #include "multi_cells.h"
 #include "multi_ui.h"
 #include "options.h"
+#include "scenario.h"
+#include "stress_workload.h"
 #include "track_windows.h"
 #include "version.h"
 #include "winapi.h"
@@ -102,10 +108,59 @@ void runUiTestMonitor(GlobalOptionsProvider& optionsProvider) {
   run_raylib_ui_multi_cluster(infos, optionsProvider);
 }
 
-void runUiTestMulti(const UiTestMultiCommand& cmd, GlobalOptionsProvider& optionsProvider) {
+// Run a scenario script against the cells API without a raylib window
+int runUiTestMultiScript(const UiTestMultiCommand& cmd,
+                         const std::vector<cells::ClusterInitInfo>& infos,
+                         const GlobalOptions& globalOptions) {
+  std::ifstream scriptFile(*cmd.script);
+  if (!scriptFile) {
+    spdlog::error("Failed to open scenario script: {}", *cmd.script);
+    return 1;
+  }
+  std::stringstream script;
+  script << scriptFile.rdbuf();
+  auto steps = parse_scenario(script.str());
+  if (!steps.has_value()) {
+    spdlog::error("{}: {}", *cmd.script, steps.error());
+    return 1;
+  }
+
+  ScenarioContext context{globalOptions.gapOptions.horizontal, globalOptions.gapOptions.vertical,
+                          globalOptions.visualizationOptions.renderOptions.zen_percentage};
+  ScenarioRunner runner(infos, context);
+  auto report = runner.run(*steps);
+  std::cout << format_scenario_report(report);
+
+  if (cmd.dump) {
+    auto dump = ipc::query_system(runner.system()).dump(2) + "\n";
+    if (*cmd.dump == "-") {
+      std::cout << dump;
+    } else {
+      std::ofstream file(*cmd.dump, std::ios::trunc);
+      file << dump;
+      if (!file) {
+        spdlog::error("Failed to write final state to {}", *cmd.dump);
+        return 1;
+      }
+    }
+  }
+  return report.valid ? 0 : 1;
+}
+
+int runUiTestMulti(const UiTestMultiCommand& cmd, GlobalOptionsProvider& optionsProvider) {
   std::vector<cells::ClusterInitInfo> infos;
 
-  if (cmd.clusters.empty()) {
+  std::optional<StressOptions> stress;
+  if (cmd.stress) {
+    stress.emplace();
+    stress->target_windows = *cmd.stress;
+    stress->monitors = cmd.monitors.value_or(stress->monitors);
+    stress->churn_per_second = cmd.rate.value_or(stress->churn_per_second);
+  }
+
+  if (stress && cmd.clusters.empty()) {
+    infos = make_stress_monitors(stress->monitors, 1920.0f, 1080.0f);
+  } else if (cmd.clusters.empty()) {
     // Default: two monitors side by side (monitor bounds = workspace bounds for UI test)
     infos.push_back({0.0f, 0.0f, 1920.0f, 1080.0f, 0.0f, 0.0f, 1920.0f, 1080.0f, {}});
     infos.push_back({1920.0f, 0.0f, 1920.0f, 1080.0f, 1920.0f, 0.0f, 1920.0f, 1080.0f, {}});
@@ -124,7 +179,46 @@ void runUiTestMulti(const UiTestMultiCommand& cmd, GlobalOptionsProvider& option
     }
   }
 
-  run_raylib_ui_multi_cluster(infos, optionsProvider);
+  if (cmd.script) {
+    return runUiTestMultiScript(cmd, infos, optionsProvider.options);
+  }
+  run_raylib_ui_multi_cluster(infos, optionsProvider, stress);
+  return 0;
+}
+
+// Ask a running loop for its flight recorder over the IPC channel
+int runDumpRecorder(const DumpRecorderCommand& cmd, const GlobalOptions& globalOptions) {
+  const auto& ipcOptions = globalOptions.ipcOptions;
+  auto endpoint = ipcOptions.endpoint.empty() ? ipc::default_endpoint() : ipcOptions.endpoint;
+  nlohmann::json request{{"cmd", "recorder"}, {"format", cmd.json ? "json" : "text"}};
+  auto response = ipc::send_request(endpoint, request.dump());
+  if (!response.has_value()) {
+    spdlog::error("Could not reach a running win-tiler loop on {} (is [ipc] enabled = true?)",
+                  endpoint);
+    return 1;
+  }
+
+  auto parsed = nlohmann::json::parse(*response, nullptr, false);
+  if (parsed.is_discarded() || !parsed.value("ok", false)) {
+    spdlog::error("Flight recorder request failed: {}", *response);
+    return 1;
+  }
+  const auto& data = parsed["results"][0]["data"];
+  std::string dump = cmd.json ? data["events"].dump(1) + "\n" : data["text"].get<std::string>();
+
+  if (!cmd.filepath) {
+    std::cout << dump;
+    return 0;
+  }
+  std::ofstream file(*cmd.filepath, std::ios::trunc);
+  file << dump;
+  if (!file) {
+    spdlog::error("Failed to write flight recorder dump to {}", *cmd.filepath);
+    return 1;
+  }
+  spdlog::info("Flight recorder dump ({} events recorded) written to: {}",
+               data["total"].get<uint64_t>(), *cmd.filepath);
+  return 0;
 }
 
 int main(int argc, char* argv[]) {
@@ -189,6 +283,7 @@ int main(int argc, char* argv[]) {
 
   // Dispatch command
   if (result.args.command) {
+    int exitCode = 0;
     std::visit(overloaded{
                    [](const HelpCommand&) { print_usage(); },
                    [](const VersionCommand&) {
@@ -196,8 +291,15 @@ int main(int argc, char* argv[]) {
                    },
                    [&](const LoopCommand&) { run_loop_mode(optionsProvider); },
                    [&](const UiTestMonitorCommand&) { runUiTestMonitor(optionsProvider); },
-                   [&](const UiTestMultiCommand& cmd) { runUiTestMulti(cmd, optionsProvider); },
-                   [&](const TrackWindowsCommand&) { run_track_windows_mode(optionsProvider); },
+                   [&](const UiTestMultiCommand& cmd) {
+                     exitCode = runUiTestMulti(cmd, optionsProvider);
+                   },
+                   [&](const TrackWindowsCommand& cmd) {
+                     run_track_windows_mode(optionsProvider, cmd);
+                   },
+                   [&](const DumpRecorderCommand& cmd) {
+                     exitCode = runDumpRecorder(cmd, globalOptions);
+                   },
                    [](const InitConfigCommand& cmd) {
                      auto targetPath = cmd.filepath ? std::filesystem::path(*cmd.filepath)
                                                     : getDefaultConfigPath();
@@ -211,7 +313,7 @@ int main(int argc, char* argv[]) {
                    },
                },
                *result.args.command);
-    return 0;
+    return exitCode;
   }
 
   // No command specified - show windows per monitor
@@ -8,9 +8,10 @@
 #include <iterator>
 #include <limits>
 #include <magic_enum/magic_enum.hpp>
-#include <map>
 #include <set>
 
+#include "thread_pool.h"
+
 namespace wintiler {
 
 // ============================================================================
@@ -23,6 +24,8 @@ static std::optional<Point> get_selected_cell_center(const System& system);
 static std::optional<size_t> find_cluster_by_leaf_id(const System& system, size_t leaf_id);
 static std::optional<Point> find_cell_center_by_leaf_id(const System& system, size_t leaf_id);
 static std::vector<TileUpdate> calculate_tile_layout(const System& system, float zen_percentage);
+static SplitDir determine_split_dir(const CellCluster& cluster, int selected_index,
+                                    SplitMode mode);
 static SelectionUpdateResult compute_selection_update(const System& system, float cursor_x,
                                                       float cursor_y, float zen_percentage,
                                                       size_t foreground_window_leaf_id);
@@ -30,7 +33,9 @@ static SelectionUpdateResult compute_selection_update(const System& system, floa
 // Result of deleting a leaf cell
 struct DeleteResult {
   std::optional<int> new_selection_index; // New selection after deletion
-  std::vector<int> deleted_indices;       // Indices to remove during compaction
+  // The deleted leaf's sibling moved from its slot (now dead) into its parent's
+  int promoted_from = -1;
+  int promoted_to = -1;
 };
 
 // Result of splitting a leaf cell.
@@ -50,6 +55,54 @@ static bool is_dead(const CellCluster& cluster, int cell_index) {
   return cluster.cells[static_cast<size_t>(cell_index)].is_dead;
 }
 
+// Mark a cell for the next incremental invariant check
+static void touch_cell(CellCluster& cluster, int cell_index) {
+  if (cluster.all_cells_touched) {
+    return;
+  }
+  if (cluster.touched_cells.size() >= cluster.cells.size()) {
+    cluster.all_cells_touched = true;
+    cluster.touched_cells.clear();
+    return;
+  }
+  cluster.touched_cells.push_back(cell_index);
+}
+
+// ============================================================================
+// Leaf Set Fingerprint
+// ============================================================================
+
+// splitmix64 finalizer: HWND values share most of their bits, so xor/sum of the raw ids would
+// collide on small permutations of low bits
+static uint64_t mix_leaf_id(size_t leaf_id) {
+  uint64_t x = static_cast<uint64_t>(leaf_id) + 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+void LeafSetFingerprint::add(size_t leaf_id) {
+  uint64_t mixed = mix_leaf_id(leaf_id);
+  ++count;
+  xor_hash ^= mixed;
+  sum_hash += mixed;
+}
+
+void LeafSetFingerprint::remove(size_t leaf_id) {
+  uint64_t mixed = mix_leaf_id(leaf_id);
+  --count;
+  xor_hash ^= mixed;
+  sum_hash -= mixed;
+}
+
+LeafSetFingerprint fingerprint_leaf_ids(const std::vector<size_t>& leaf_ids) {
+  LeafSetFingerprint fingerprint;
+  for (size_t leaf_id : leaf_ids) {
+    fingerprint.add(leaf_id);
+  }
+  return fingerprint;
+}
+
 static CellCluster create_initial_state(float width, float height) {
   CellCluster state{};
 
@@ -76,7 +129,9 @@ bool is_leaf(const CellCluster& state, int cell_index) {
 
 int add_cell(CellCluster& state, const Cell& cell) {
   state.cells.push_back(cell);
-  return static_cast<int>(state.cells.size() - 1);
+  int index = static_cast<int>(state.cells.size() - 1);
+  touch_cell(state, index);
+  return index;
 }
 
 static void recompute_children_rects(CellCluster& state, int node_index, float gap_horizontal,
@@ -119,24 +174,33 @@ static void recompute_children_rects(CellCluster& state, int node_index, float g
 
   first_child.rect = first;
   second_child.rect = second;
+  touch_cell(state, *node.first_child);
+  touch_cell(state, *node.second_child);
 }
 
+// Explicit stack rather than recursion: windows added in one update chain-split the newest
+// leaf, so a tree can be as deep as it has windows
 static void recompute_subtree_rects(CellCluster& state, int node_index, float gap_horizontal,
                                     float gap_vertical) {
   if (node_index < 0 || static_cast<std::size_t>(node_index) >= state.cells.size()) {
     return;
   }
 
-  Cell& node = state.cells[static_cast<std::size_t>(node_index)];
-
-  if (is_dead(state, node_index)) {
-    return;
-  }
+  std::vector<int> stack{node_index};
+  while (!stack.empty()) {
+    int index = stack.back();
+    stack.pop_back();
+    if (is_dead(state, index)) {
+      continue;
+    }
 
-  if (node.first_child.has_value() && node.second_child.has_value()) {
-    recompute_children_rects(state, node_index, gap_horizontal, gap_vertical);
-    recompute_subtree_rects(state, *node.first_child, gap_horizontal, gap_vertical);
-    recompute_subtree_rects(state, *node.second_child, gap_horizontal, gap_vertical);
+    const Cell& node = state.cells[static_cast<std::size_t>(index)];
+    if (node.first_child.has_value() && node.second_child.has_value()) {
+      recompute_children_rects(state, index, gap_horizontal, gap_vertical);
+      // Second child below the first, so cells are visited in preorder
+      stack.push_back(*node.second_child);
+      stack.push_back(*node.first_child);
+    }
   }
 }
 
@@ -156,7 +220,9 @@ static std::optional<DeleteResult> delete_leaf(CellCluster& state, int selected_
 
   if (selected_index == 0) {
     state.cells.clear();
-    return DeleteResult{std::nullopt, {}}; // Cluster is now empty
+    state.leaf_fingerprint = {};
+    state.touched_cells.clear();
+    return DeleteResult{std::nullopt}; // Cluster is now empty
   }
 
   if (!selected_cell.parent.has_value()) {
@@ -199,9 +265,12 @@ static std::optional<DeleteResult> delete_leaf(CellCluster& state, int selected_
   }
 
   state.cells[static_cast<std::size_t>(parent_index)] = promoted;
+  touch_cell(state, parent_index);
 
   recompute_subtree_rects(state, parent_index, gap_horizontal, gap_vertical);
 
+  state.leaf_fingerprint.remove(*selected_cell.leaf_id);
+
   // Mark cells as dead
   selected_cell.is_dead = true;
   sibling.is_dead = true;
@@ -218,58 +287,83 @@ static std::optional<DeleteResult> delete_leaf(CellCluster& state, int selected_
     }
   }
 
-  return DeleteResult{current, {selected_index, sibling_index}};
+  // The dead cells stay in place until the next compaction drops them
+  return DeleteResult{current, sibling_index, parent_index};
 }
 
-// Compact cluster by removing cells at given indices
-// Returns remap vector (old_index -> new_index, -1 for deleted)
-static std::vector<int> compact_cluster(CellCluster& cluster,
-                                        const std::set<int>& deleted_indices) {
-  if (deleted_indices.empty()) {
+// Compact cluster into depth-first preorder from the root, dropping dead cells and anything
+// the root does not reach. The root stays at 0 and every subtree becomes one contiguous index
+// range, so a traversal walks forward through memory instead of hopping between the slots
+// splits appended over time.
+// Returns remap vector (old_index -> new_index, -1 for dropped), empty if nothing moved
+static std::vector<int> compact_cluster(CellCluster& cluster) {
+  if (cluster.cells.empty()) {
     return {};
   }
 
-  // Build index remap: old_index -> new_index
+  // Preorder of the live tree; remap doubles as the visited set, so a corrupt tree with a
+  // cycle cannot loop forever
   std::vector<int> remap(cluster.cells.size(), -1);
-  int new_index = 0;
-  for (int i = 0; i < static_cast<int>(cluster.cells.size()); ++i) {
-    if (deleted_indices.count(i) == 0) {
-      remap[static_cast<size_t>(i)] = new_index++;
-    }
-  }
-
-  // Create new cells vector with remapped indices
-  std::vector<Cell> new_cells;
-  new_cells.reserve(static_cast<size_t>(new_index));
-  for (int i = 0; i < static_cast<int>(cluster.cells.size()); ++i) {
-    if (deleted_indices.count(i) > 0) {
+  std::vector<int> order;
+  order.reserve(cluster.cells.size());
+  std::vector<int> stack{0};
+  while (!stack.empty()) {
+    int i = stack.back();
+    stack.pop_back();
+    if (i < 0 || static_cast<size_t>(i) >= cluster.cells.size() || is_dead(cluster, i) ||
+        remap[static_cast<size_t>(i)] != -1) {
       continue;
     }
+    remap[static_cast<size_t>(i)] = static_cast<int>(order.size());
+    order.push_back(i);
 
-    Cell cell = cluster.cells[static_cast<size_t>(i)];
-    if (cell.parent.has_value()) {
-      cell.parent = remap[static_cast<size_t>(*cell.parent)];
+    const Cell& cell = cluster.cells[static_cast<size_t>(i)];
+    if (cell.second_child.has_value()) {
+      stack.push_back(*cell.second_child);
     }
     if (cell.first_child.has_value()) {
-      cell.first_child = remap[static_cast<size_t>(*cell.first_child)];
+      stack.push_back(*cell.first_child);
     }
-    if (cell.second_child.has_value()) {
-      cell.second_child = remap[static_cast<size_t>(*cell.second_child)];
+  }
+
+  bool unchanged = order.size() == cluster.cells.size();
+  for (size_t k = 0; unchanged && k < order.size(); ++k) {
+    unchanged = order[k] == static_cast<int>(k);
+  }
+  if (unchanged) {
+    return {};
+  }
+
+  // Create new cells vector with remapped indices
+  auto remap_index = [&](std::optional<int>& index) {
+    if (index.has_value()) {
+      index = remap[static_cast<size_t>(*index)];
     }
+  };
+  std::vector<Cell> new_cells;
+  new_cells.reserve(order.size());
+  for (int i : order) {
+    Cell cell = cluster.cells[static_cast<size_t>(i)];
+    remap_index(cell.parent);
+    remap_index(cell.first_child);
+    remap_index(cell.second_child);
     new_cells.push_back(std::move(cell));
   }
 
   // Update zen_cell_index if set
   if (cluster.zen_cell_index.has_value()) {
-    int old_zen = *cluster.zen_cell_index;
-    if (deleted_indices.count(old_zen) > 0) {
+    int new_zen = remap[static_cast<size_t>(*cluster.zen_cell_index)];
+    if (new_zen == -1) {
       cluster.zen_cell_index.reset();
     } else {
-      cluster.zen_cell_index = remap[static_cast<size_t>(old_zen)];
+      cluster.zen_cell_index = new_zen;
     }
   }
 
   cluster.cells = std::move(new_cells);
+  // Every index may have moved, so the next check covers the whole cluster
+  cluster.all_cells_touched = true;
+  cluster.touched_cells.clear();
   return remap;
 }
 
@@ -294,6 +388,7 @@ static std::optional<SplitResult> split_leaf(CellCluster& state, int selected_in
                      inset_h > 0.0f ? inset_h : 0.0f};
 
     int index = add_cell(state, root);
+    state.leaf_fingerprint.add(new_leaf_id);
 
     return SplitResult{new_leaf_id, index};
   }
@@ -349,16 +444,130 @@ static std::optional<SplitResult> split_leaf(CellCluster& state, int selected_in
 
   int first_index = add_cell(state, first_child);
   int second_index = add_cell(state, second_child);
+  state.leaf_fingerprint.add(new_leaf_id);
 
   {
     Cell& parent = state.cells[static_cast<std::size_t>(selected_index)];
     parent.first_child = first_index;
     parent.second_child = second_index;
   }
+  touch_cell(state, selected_index);
 
   return SplitResult{new_leaf_id, first_index};
 }
 
+// Exchange the contents of two slots and repoint every link to them
+static void swap_cell_slots(CellCluster& state, int a, int b) {
+  if (a == b) {
+    return;
+  }
+  auto follow = [a, b](std::optional<int>& link) {
+    if (link.has_value()) {
+      link = (*link == a) ? b : ((*link == b) ? a : *link);
+    }
+  };
+  std::swap(state.cells[static_cast<size_t>(a)], state.cells[static_cast<size_t>(b)]);
+  for (int index : {a, b}) {
+    Cell& cell = state.cells[static_cast<size_t>(index)];
+    int old_index = (index == a) ? b : a;
+    follow(cell.parent);
+    follow(cell.first_child);
+    follow(cell.second_child);
+    for (const auto& child : {cell.first_child, cell.second_child}) {
+      if (child.has_value()) {
+        state.cells[static_cast<size_t>(*child)].parent = index;
+      }
+    }
+    if (cell.parent.has_value() && *cell.parent != a && *cell.parent != b) {
+      Cell& parent = state.cells[static_cast<size_t>(*cell.parent)];
+      if (parent.first_child == old_index) {
+        parent.first_child = index;
+      } else if (parent.second_child == old_index) {
+        parent.second_child = index;
+      }
+      touch_cell(state, *cell.parent);
+    }
+    touch_cell(state, index);
+  }
+}
+
+// Move leaf src next to leaf tgt (same cluster, not siblings) by relinking nodes in place.
+// The source's parent is unlinked, its other child taking its place, and spliced back in
+// above the target as the split holding target (first) and source (second). Produces the
+// same tree as delete_leaf + split_leaf without allocating or leaving dead cells; only the
+// promoted sibling subtree and the new split are recomputed.
+// The root must stay at index 0: when the unlinked parent was the root, the promoted
+// sibling is swapped into slot 0 and the returned index is where it came from.
+static std::optional<int> relink_leaf(CellCluster& state, int src, int tgt, SplitMode mode,
+                                      float gap_horizontal, float gap_vertical) {
+  int parent_index = *state.cells[static_cast<size_t>(src)].parent;
+  Cell& parent = state.cells[static_cast<size_t>(parent_index)];
+  int sibling_index = (parent.first_child == src) ? *parent.second_child : *parent.first_child;
+  std::optional<int> grandparent = parent.parent;
+  Rect parent_rect = parent.rect;
+
+  // Detach: the sibling takes the parent's place
+  Cell& sibling = state.cells[static_cast<size_t>(sibling_index)];
+  sibling.parent = grandparent;
+  sibling.rect = parent_rect;
+  if (grandparent.has_value()) {
+    Cell& gp = state.cells[static_cast<size_t>(*grandparent)];
+    if (gp.first_child == parent_index) {
+      gp.first_child = sibling_index;
+    } else {
+      gp.second_child = sibling_index;
+    }
+    touch_cell(state, *grandparent);
+  }
+  parent.parent.reset();
+  parent.first_child.reset();
+  parent.second_child.reset();
+  state.cells[static_cast<size_t>(src)].parent.reset();
+
+  std::optional<int> moved_to_root;
+  int promoted_index = sibling_index;
+  if (!grandparent.has_value()) {
+    swap_cell_slots(state, 0, sibling_index);
+    moved_to_root = sibling_index;
+    promoted_index = 0;
+    parent_index = sibling_index;
+  }
+  touch_cell(state, promoted_index);
+  recompute_subtree_rects(state, promoted_index, gap_horizontal, gap_vertical);
+
+  // Splice: the freed parent becomes the split above the target
+  SplitDir split_dir = determine_split_dir(state, tgt, mode);
+  Cell& target = state.cells[static_cast<size_t>(tgt)];
+  int target_parent = *target.parent;
+  Cell& tp = state.cells[static_cast<size_t>(target_parent)];
+  if (tp.first_child == tgt) {
+    tp.first_child = parent_index;
+  } else {
+    tp.second_child = parent_index;
+  }
+  touch_cell(state, target_parent);
+
+  Cell& split = state.cells[static_cast<size_t>(parent_index)];
+  split.split_dir = split_dir;
+  split.split_ratio = 0.5f;
+  split.parent = target_parent;
+  split.first_child = tgt;
+  split.second_child = src;
+  split.rect = target.rect;
+  split.leaf_id.reset();
+
+  for (int leaf : {tgt, src}) {
+    Cell& cell = state.cells[static_cast<size_t>(leaf)];
+    cell.parent = parent_index;
+    cell.split_dir = split_dir;
+    cell.split_ratio = 0.5f;
+  }
+  touch_cell(state, parent_index);
+  recompute_children_rects(state, parent_index, gap_horizontal, gap_vertical);
+
+  return moved_to_root;
+}
+
 static bool toggle_split_dir(CellCluster& state, int selected_index, float gap_horizontal,
                              float gap_vertical) {
   if (!is_leaf(state, selected_index)) {
@@ -634,6 +843,10 @@ System create_system(const std::vector<ClusterInitInfo>& infos, float gap_horizo
     pc.monitor_width = info.monitor_width;
     pc.monitor_height = info.monitor_height;
     pc.cluster = create_initial_state(info.width, info.height);
+    if (info.workspace_count > 1) {
+      size_t count = std::min(info.workspace_count, kMaxWorkspaces);
+      pc.workspaces.resize(count, Workspace{create_initial_state(info.width, info.height), {}});
+    }
 
     int selection_index = -1;
     // Pre-create leaves if initial_cell_ids provided
@@ -920,8 +1133,6 @@ bool set_split_ratio(CellCluster& state, int cell_index, float new_ratio, float
   }
 
   // Clamp ratio to valid range (0.1 to 0.9 to ensure both children have reasonable space)
-  constexpr float kMinSplitRatio = 0.1f;
-  constexpr float kMaxSplitRatio = 0.9f;
   float clamped_ratio = std::max(kMinSplitRatio, std::min(kMaxSplitRatio, new_ratio));
 
   cell.split_ratio = clamped_ratio;
@@ -998,44 +1209,46 @@ std::optional<Point> adjust_selected_split_ratio(System& system, float delta, fl
   return get_selected_cell_center(system);
 }
 
-std::optional<size_t> get_selected_sibling_leaf_id(const System& system) {
-  if (!system.selection.has_value()) {
+std::optional<size_t> get_sibling_leaf_id(const CellCluster& cluster, int cell_index) {
+  if (!is_leaf(cluster, cell_index)) {
     return std::nullopt;
   }
 
-  assert(system.selection->cluster_index < system.clusters.size());
-  const PositionedCluster& pc = system.clusters[system.selection->cluster_index];
-
-  int selected_index = system.selection->cell_index;
-  if (!is_leaf(pc.cluster, selected_index)) {
-    return std::nullopt;
-  }
-
-  const Cell& leaf = pc.cluster.cells[static_cast<size_t>(selected_index)];
+  const Cell& leaf = cluster.cells[static_cast<size_t>(cell_index)];
   if (!leaf.parent.has_value()) {
     return std::nullopt; // Root has no sibling
   }
 
   int parent_index = *leaf.parent;
-  const Cell& parent = pc.cluster.cells[static_cast<size_t>(parent_index)];
+  const Cell& parent = cluster.cells[static_cast<size_t>(parent_index)];
 
-  if (is_dead(pc.cluster, parent_index) || !parent.first_child.has_value() ||
+  if (is_dead(cluster, parent_index) || !parent.first_child.has_value() ||
       !parent.second_child.has_value()) {
     return std::nullopt;
   }
 
   // Find sibling (the other child of the parent)
   int sibling_index =
-      (*parent.first_child == selected_index) ? *parent.second_child : *parent.first_child;
+      (*parent.first_child == cell_index) ? *parent.second_child : *parent.first_child;
 
-  if (!is_leaf(pc.cluster, sibling_index)) {
+  if (!is_leaf(cluster, sibling_index)) {
     return std::nullopt; // Sibling is not a leaf
   }
 
-  const Cell& sibling = pc.cluster.cells[static_cast<size_t>(sibling_index)];
+  const Cell& sibling = cluster.cells[static_cast<size_t>(sibling_index)];
   return sibling.leaf_id;
 }
 
+std::optional<size_t> get_selected_sibling_leaf_id(const System& system) {
+  if (!system.selection.has_value()) {
+    return std::nullopt;
+  }
+
+  assert(system.selection->cluster_index < system.clusters.size());
+  return get_sibling_leaf_id(system.clusters[system.selection->cluster_index].cluster,
+                             system.selection->cell_index);
+}
+
 bool set_zen(System& system, size_t cluster_index, size_t leaf_id) {
   assert(cluster_index < system.clusters.size());
   PositionedCluster& pc = system.clusters[cluster_index];
@@ -1091,6 +1304,9 @@ bool toggle_selected_zen(System& system) {
 namespace {
 enum class EdgeType { Left, Right, Top, Bottom };
 
+// Window edges closer than this to the cell edge count as unchanged (rounding)
+constexpr float kEdgeTolerance = 2.0f;
+
 // Calculate new ratio based on edge position change
 float calculate_new_ratio_from_edge(const Rect& parent_global_rect, EdgeType edge,
                                     const Rect& actual_rect, float gap_h, float gap_v) {
@@ -1102,8 +1318,8 @@ float calculate_new_ratio_from_edge(const Rect& parent_global_rect, EdgeType edg
     }
 
     if (edge == EdgeType::Left) {
-      // Left edge moved: ratio = distance from parent's left edge to actual left edge / available
-      float first_width = actual_rect.x - parent_global_rect.x;
+      // Left edge moved: the first child ends one gap before the actual left edge
+      float first_width = actual_rect.x - parent_global_rect.x - gap_h;
       return first_width / available;
     } else {
       // Right edge moved: ratio = 1 - (distance from actual right to parent right / available)
@@ -1120,7 +1336,7 @@ float calculate_new_ratio_from_edge(const Rect& parent_global_rect, EdgeType edg
     }
 
     if (edge == EdgeType::Top) {
-      float first_height = actual_rect.y - parent_global_rect.y;
+      float first_height = actual_rect.y - parent_global_rect.y - gap_v;
       return first_height / available;
     } else {
       float actual_bottom = actual_rect.y + actual_rect.height;
@@ -1132,9 +1348,10 @@ float calculate_new_ratio_from_edge(const Rect& parent_global_rect, EdgeType edg
 }
 
 // Find ancestor that controls the given edge and update its ratio
-// Returns true if ratio was updated, false if no controlling ancestor found
-bool update_ratio_for_edge(CellCluster& cluster, const PositionedCluster& pc, int start_cell_index,
-                           EdgeType edge, const Rect& actual_rect, float gap_h, float gap_v) {
+// Returns the updated ancestor, nullopt if no controlling ancestor was found
+std::optional<int> update_ratio_for_edge(CellCluster& cluster, const PositionedCluster& pc,
+                                         int start_cell_index, EdgeType edge,
+                                         const Rect& actual_rect, float gap_h, float gap_v) {
   // Determine required split direction and child position for this edge
   // Left/Right edges are controlled by Vertical splits
   // Top/Bottom edges are controlled by Horizontal splits
@@ -1151,7 +1368,7 @@ bool update_ratio_for_edge(CellCluster& cluster, const PositionedCluster& pc, in
   while (true) {
     const Cell& current = cluster.cells[static_cast<size_t>(current_index)];
     if (!current.parent.has_value()) {
-      return false; // Reached root without finding controller
+      return std::nullopt; // Reached root without finding controller
     }
 
     int parent_index = *current.parent;
@@ -1159,7 +1376,7 @@ bool update_ratio_for_edge(CellCluster& cluster, const PositionedCluster& pc, in
 
     if (is_dead(cluster, parent_index) || !parent.first_child.has_value() ||
         !parent.second_child.has_value()) {
-      return false; // Invalid parent
+      return std::nullopt; // Invalid parent
     }
 
     // Check if parent controls this edge
@@ -1179,13 +1396,59 @@ bool update_ratio_for_edge(CellCluster& cluster, const PositionedCluster& pc, in
         spdlog::debug("update_ratio_for_edge: edge={}, parent_idx={}, new_ratio={}",
                       static_cast<int>(edge), parent_index, new_ratio);
 
-        return set_split_ratio(cluster, parent_index, new_ratio, gap_h, gap_v);
+        if (!set_split_ratio(cluster, parent_index, new_ratio, gap_h, gap_v)) {
+          return std::nullopt;
+        }
+        return parent_index;
       }
     }
 
     current_index = parent_index; // Continue up the tree
   }
 }
+
+// Update the ancestors controlling every edge of the leaf that differs from the actual rect.
+// Returns the updated ancestors (their subtrees have been recomputed).
+std::vector<int> update_ratios_for_changed_edges(PositionedCluster& pc, int cell_index,
+                                                 const Rect& actual_rect, float gap_h,
+                                                 float gap_v) {
+  // Get expected cell rect in global coordinates for edge comparison
+  Rect expected_rect = get_cell_global_rect(pc, cell_index);
+
+  // Detect which edges changed (with tolerance for rounding)
+  bool left_changed = std::abs(actual_rect.x - expected_rect.x) > kEdgeTolerance;
+  bool right_changed = std::abs((actual_rect.x + actual_rect.width) -
+                                (expected_rect.x + expected_rect.width)) > kEdgeTolerance;
+  bool top_changed = std::abs(actual_rect.y - expected_rect.y) > kEdgeTolerance;
+  bool bottom_changed = std::abs((actual_rect.y + actual_rect.height) -
+                                 (expected_rect.y + expected_rect.height)) > kEdgeTolerance;
+
+  std::vector<int> updated;
+  if (!left_changed && !right_changed && !top_changed && !bottom_changed) {
+    spdlog::trace("update_ratios_for_changed_edges: no edge changes detected");
+    return updated;
+  }
+
+  spdlog::debug("update_ratios_for_changed_edges: cell={}, edges changed: L={}, R={}, T={}, B={}",
+                cell_index, left_changed, right_changed, top_changed, bottom_changed);
+
+  // Process each changed edge - find the ancestor that controls it and update ratio
+  auto update_edge = [&](bool changed, EdgeType edge) {
+    if (!changed) {
+      return;
+    }
+    if (auto ancestor =
+            update_ratio_for_edge(pc.cluster, pc, cell_index, edge, actual_rect, gap_h, gap_v)) {
+      updated.push_back(*ancestor);
+    }
+  };
+  update_edge(left_changed, EdgeType::Left);
+  update_edge(right_changed, EdgeType::Right);
+  update_edge(top_changed, EdgeType::Top);
+  update_edge(bottom_changed, EdgeType::Bottom);
+
+  return updated;
+}
 } // anonymous namespace
 
 bool update_split_ratio_from_resize(System& system, size_t cluster_index, size_t leaf_id,
@@ -1223,47 +1486,76 @@ bool update_split_ratio_from_resize(System& system, size_t cluster_index, size_t
     return false;
   }
 
-  // Get expected cell rect in global coordinates for edge comparison
-  Rect expected_rect = get_cell_global_rect(pc, cell_index);
-
-  // Detect which edges changed (with tolerance for rounding)
-  constexpr float kEdgeTolerance = 2.0f;
-  bool left_changed = std::abs(actual_window_rect.x - expected_rect.x) > kEdgeTolerance;
-  bool right_changed = std::abs((actual_window_rect.x + actual_window_rect.width) -
-                                (expected_rect.x + expected_rect.width)) > kEdgeTolerance;
-  bool top_changed = std::abs(actual_window_rect.y - expected_rect.y) > kEdgeTolerance;
-  bool bottom_changed = std::abs((actual_window_rect.y + actual_window_rect.height) -
-                                 (expected_rect.y + expected_rect.height)) > kEdgeTolerance;
+  return !update_ratios_for_changed_edges(pc, cell_index, actual_window_rect, gap_horizontal,
+                                          gap_vertical)
+              .empty();
+}
 
-  if (!left_changed && !right_changed && !top_changed && !bottom_changed) {
-    spdlog::trace("update_split_ratio_from_resize: no edge changes detected");
-    return false;
+std::vector<TileUpdate> live_resize_tiles(System& system, size_t cluster_index, size_t leaf_id,
+                                          const Rect& actual_window_rect, float gap_horizontal,
+                                          float gap_vertical) {
+  std::vector<TileUpdate> updates;
+  if (cluster_index >= system.clusters.size()) {
+    return updates;
   }
 
-  spdlog::debug("update_split_ratio_from_resize: cell={}, edges changed: L={}, R={}, T={}, B={}",
-                cell_index, left_changed, right_changed, top_changed, bottom_changed);
-
-  bool any_updated = false;
-
-  // Process each changed edge - find the ancestor that controls it and update ratio
-  if (left_changed) {
-    any_updated |= update_ratio_for_edge(pc.cluster, pc, cell_index, EdgeType::Left,
-                                         actual_window_rect, gap_horizontal, gap_vertical);
-  }
-  if (right_changed) {
-    any_updated |= update_ratio_for_edge(pc.cluster, pc, cell_index, EdgeType::Right,
-                                         actual_window_rect, gap_horizontal, gap_vertical);
+  PositionedCluster& pc = system.clusters[cluster_index];
+  // Zen and fullscreen clusters are not tiled from split ratios
+  if (pc.cluster.has_fullscreen_cell || pc.cluster.zen_cell_index.has_value()) {
+    return updates;
   }
-  if (top_changed) {
-    any_updated |= update_ratio_for_edge(pc.cluster, pc, cell_index, EdgeType::Top,
-                                         actual_window_rect, gap_horizontal, gap_vertical);
+
+  auto cell_index_opt = find_cell_by_leaf_id(pc.cluster, leaf_id);
+  if (!cell_index_opt.has_value() || !is_leaf(pc.cluster, *cell_index_opt)) {
+    return updates;
   }
-  if (bottom_changed) {
-    any_updated |= update_ratio_for_edge(pc.cluster, pc, cell_index, EdgeType::Bottom,
-                                         actual_window_rect, gap_horizontal, gap_vertical);
+  int cell_index = *cell_index_opt;
+
+  // A window that keeps its size is being moved, not resized; it is handled as a drop
+  Rect expected_rect = get_cell_global_rect(pc, cell_index);
+  if (std::abs(actual_window_rect.width - expected_rect.width) <= kEdgeTolerance &&
+      std::abs(actual_window_rect.height - expected_rect.height) <= kEdgeTolerance) {
+    return updates;
+  }
+
+  // Only the leaves under the updated ancestors moved. Nested ancestors are visited once
+  // per ancestor, so duplicates are removed before building the updates.
+  std::vector<int> stack = update_ratios_for_changed_edges(pc, cell_index, actual_window_rect,
+                                                           gap_horizontal, gap_vertical);
+  std::vector<int> leaves;
+  while (!stack.empty()) {
+    int index = stack.back();
+    stack.pop_back();
+    const Cell& cell = pc.cluster.cells[static_cast<size_t>(index)];
+    if (cell.leaf_id.has_value()) {
+      // The dragged window already has the size the user is giving it
+      if (index != cell_index) {
+        leaves.push_back(index);
+      }
+      continue;
+    }
+    if (cell.first_child.has_value()) {
+      stack.push_back(*cell.first_child);
+    }
+    if (cell.second_child.has_value()) {
+      stack.push_back(*cell.second_child);
+    }
   }
+  std::sort(leaves.begin(), leaves.end());
+  leaves.erase(std::unique(leaves.begin(), leaves.end()), leaves.end());
 
-  return any_updated;
+  updates.reserve(leaves.size());
+  for (int index : leaves) {
+    Rect global_rect = get_cell_global_rect(pc, index);
+    TileUpdate update;
+    update.leaf_id = *pc.cluster.cells[static_cast<size_t>(index)].leaf_id;
+    update.x = static_cast<int>(global_rect.x);
+    update.y = static_cast<int>(global_rect.y);
+    update.width = static_cast<int>(global_rect.width);
+    update.height = static_cast<int>(global_rect.height);
+    updates.push_back(update);
+  }
+  return updates;
 }
 
 std::optional<Point> swap_cells(System& system, size_t cluster_index1, size_t leaf_id1,
@@ -1345,6 +1637,13 @@ std::optional<Point> swap_cells(System& system, size_t cluster_index1, size_t le
 
       std::swap(cell1.rect, cell2.rect);
     }
+    touch_cell(cluster, idx1);
+    touch_cell(cluster, idx2);
+    for (const auto& parent : {parent1, parent2}) {
+      if (parent.has_value()) {
+        touch_cell(cluster, *parent);
+      }
+    }
 
     // Note: Selection stays at the same cell index because the cells
     // still have the same leaf_ids - only their tree positions changed.
@@ -1366,7 +1665,13 @@ std::optional<Point> swap_cells(System& system, size_t cluster_index1, size_t le
       pc2.cluster.zen_cell_index.reset();
     }
 
+    pc1.cluster.leaf_fingerprint.remove(*cell1.leaf_id);
+    pc1.cluster.leaf_fingerprint.add(*cell2.leaf_id);
+    pc2.cluster.leaf_fingerprint.remove(*cell2.leaf_id);
+    pc2.cluster.leaf_fingerprint.add(*cell1.leaf_id);
     std::swap(cell1.leaf_id, cell2.leaf_id);
+    touch_cell(pc1.cluster, idx1);
+    touch_cell(pc2.cluster, idx2);
 
     // Note: Selection doesn't need updating for cross-cluster swap
     // because the selection tracks cell index, not leaf_id
@@ -1379,6 +1684,98 @@ std::optional<MoveSuccess> move_cell(System& system, size_t source_cluster_index
                                      size_t source_leaf_id, size_t target_cluster_index,
                                      size_t target_leaf_id, float gap_horizontal,
                                      float gap_vertical) {
+  if (source_cluster_index != target_cluster_index ||
+      source_cluster_index >= system.clusters.size()) {
+    return move_cell_by_split(system, source_cluster_index, source_leaf_id, target_cluster_index,
+                              target_leaf_id, gap_horizontal, gap_vertical);
+  }
+  CellCluster& cluster = system.clusters[source_cluster_index].cluster;
+
+  auto src_idx_opt = find_cell_by_leaf_id(cluster, source_leaf_id);
+  auto tgt_idx_opt = find_cell_by_leaf_id(cluster, target_leaf_id);
+  if (!src_idx_opt.has_value() || !tgt_idx_opt.has_value()) {
+    return std::nullopt;
+  }
+  int src = *src_idx_opt;
+  int tgt = *tgt_idx_opt;
+
+  // Same cell (no-op)
+  if (source_leaf_id == target_leaf_id) {
+    Point center = get_selected_cell_center(system).value_or(Point{0, 0});
+    return MoveSuccess{src, source_cluster_index, center};
+  }
+
+  if (!is_leaf(cluster, src) || !is_leaf(cluster, tgt)) {
+    return std::nullopt;
+  }
+
+  const Cell& src_cell = cluster.cells[static_cast<size_t>(src)];
+  const Cell& tgt_cell = cluster.cells[static_cast<size_t>(tgt)];
+  if (!src_cell.parent.has_value() || !tgt_cell.parent.has_value()) {
+    return std::nullopt;
+  }
+
+  // Siblings: swap the parent's child pointers
+  if (*src_cell.parent == *tgt_cell.parent) {
+    int parent_index = *src_cell.parent;
+    Cell& parent = cluster.cells[static_cast<size_t>(parent_index)];
+    std::swap(parent.first_child, parent.second_child);
+    recompute_subtree_rects(cluster, parent_index, gap_horizontal, gap_vertical);
+
+    // Selection stays valid (cell indices don't change, only their positions)
+    Point center = get_selected_cell_center(system).value_or(Point{0, 0});
+    return MoveSuccess{src, source_cluster_index, center};
+  }
+
+  bool source_was_selected = system.selection.has_value() &&
+                             system.selection->cluster_index == source_cluster_index &&
+                             system.selection->cell_index == src;
+  bool target_was_selected = system.selection.has_value() &&
+                             system.selection->cluster_index == source_cluster_index &&
+                             system.selection->cell_index == tgt;
+
+  // Clear zen if moving the zen cell
+  if (cluster.zen_cell_index.has_value() && *cluster.zen_cell_index == src) {
+    cluster.zen_cell_index.reset();
+  }
+
+  auto moved_to_root =
+      relink_leaf(cluster, src, tgt, system.split_mode, gap_horizontal, gap_vertical);
+
+  // The root fixup exchanged two slots; follow any index that pointed at them
+  if (moved_to_root.has_value()) {
+    auto follow = [from = *moved_to_root](int index) {
+      return index == from ? 0 : (index == 0 ? from : index);
+    };
+    if (system.selection.has_value() && system.selection->cluster_index == source_cluster_index) {
+      system.selection->cell_index = follow(system.selection->cell_index);
+    }
+    if (cluster.zen_cell_index.has_value()) {
+      cluster.zen_cell_index = follow(*cluster.zen_cell_index);
+    }
+  }
+  if (system.hover_focus.candidate.has_value() &&
+      system.hover_focus.candidate->cluster_index == source_cluster_index) {
+    system.hover_focus.candidate.reset();
+  }
+
+  // Source and target keep their indices, so a selection on either stays put
+  if (source_was_selected || target_was_selected) {
+    int selected = source_was_selected ? src : tgt;
+    system.selection = CellIndicatorByIndex{source_cluster_index, selected};
+    if (cluster.zen_cell_index.has_value() && *cluster.zen_cell_index != selected) {
+      cluster.zen_cell_index.reset();
+    }
+  }
+
+  Point center = get_selected_cell_center(system).value_or(Point{0, 0});
+  return MoveSuccess{src, source_cluster_index, center};
+}
+
+std::optional<MoveSuccess> move_cell_by_split(System& system, size_t source_cluster_index,
+                                              size_t source_leaf_id, size_t target_cluster_index,
+                                              size_t target_leaf_id, float gap_horizontal,
+                                              float gap_vertical) {
   // Validate cluster indices
   if (source_cluster_index >= system.clusters.size()) {
     return std::nullopt;
@@ -1451,8 +1848,13 @@ std::optional<MoveSuccess> move_cell(System& system, size_t source_cluster_index
     src_pc.cluster.zen_cell_index.reset();
   }
 
-  // Delete source
+  // Delete source; a selection on its sibling follows the sibling's promotion
   auto delete_result = delete_leaf(src_pc.cluster, *src_idx_opt, gap_horizontal, gap_vertical);
+  if (delete_result.has_value() && system.selection.has_value() &&
+      system.selection->cluster_index == source_cluster_index &&
+      system.selection->cell_index == delete_result->promoted_from) {
+    system.selection->cell_index = delete_result->promoted_to;
+  }
 
   // Re-find target by leaf_id (index may have changed if same cluster)
   // Note: tgt_pc is a reference, so if source == target cluster, it's already updated
@@ -1588,10 +1990,9 @@ std::optional<DropMoveResult> perform_drop_move(System& system, size_t source_le
 // ============================================================================
 
 void recompute_rects(System& system, float gap_horizontal, float gap_vertical) {
-  for (auto& pc : system.clusters) {
-    auto& cluster = pc.cluster;
+  auto recompute = [&](CellCluster& cluster) {
     if (cluster.cells.empty()) {
-      continue;
+      return;
     }
 
     // Recompute root rect using cluster dimensions and current gaps
@@ -1601,9 +2002,17 @@ void recompute_rects(System& system, float gap_horizontal, float gap_vertical) {
     float inset_h = root_h - 2.0f * gap_vertical;
     cluster.cells[0].rect = Rect{gap_horizontal, gap_vertical, inset_w > 0.0f ? inset_w : 0.0f,
                                  inset_h > 0.0f ? inset_h : 0.0f};
+    touch_cell(cluster, 0);
 
     // Recompute all children rects
     recompute_subtree_rects(cluster, 0, gap_horizontal, gap_vertical);
+  };
+  for (auto& pc : system.clusters) {
+    recompute(pc.cluster);
+    // Parked trees too, so a workspace comes back with the current gaps
+    for (auto& workspace : pc.workspaces) {
+      recompute(workspace.cluster);
+    }
   }
 }
 
@@ -1642,18 +2051,39 @@ bool validate_system(const System& system) {
     if (!validate_state(pc.cluster)) {
       ok = false;
     }
+    for (size_t w = 0; w < pc.workspaces.size(); ++w) {
+      if (w != pc.active_workspace && !validate_state(pc.workspaces[w].cluster)) {
+        spdlog::error("[validate] ERROR: parked workspace {} of cluster {} is invalid", w, ci);
+        ok = false;
+      }
+    }
   }
 
-  // Check for duplicate leaf_ids across all clusters
+  // Check for duplicate leaf_ids across all clusters and parked workspaces
   std::vector<size_t> all_leaf_ids;
+  std::vector<size_t> parked_leaf_ids;
+  auto collect = [](const CellCluster& cluster, std::vector<size_t>& out) {
+    for (int i = 0; i < static_cast<int>(cluster.cells.size()); ++i) {
+      const auto& cell = cluster.cells[static_cast<size_t>(i)];
+      if (!is_dead(cluster, i) && cell.leaf_id.has_value()) {
+        out.push_back(*cell.leaf_id);
+      }
+    }
+  };
   for (const auto& pc : system.clusters) {
-    for (int i = 0; i < static_cast<int>(pc.cluster.cells.size()); ++i) {
-      const auto& cell = pc.cluster.cells[static_cast<size_t>(i)];
-      if (!is_dead(pc.cluster, i) && cell.leaf_id.has_value()) {
-        all_leaf_ids.push_back(*cell.leaf_id);
+    collect(pc.cluster, all_leaf_ids);
+    for (size_t w = 0; w < pc.workspaces.size(); ++w) {
+      if (w != pc.active_workspace) {
+        collect(pc.workspaces[w].cluster, parked_leaf_ids);
       }
     }
   }
+  std::sort(parked_leaf_ids.begin(), parked_leaf_ids.end());
+  if (parked_leaf_ids != system.parked_leaf_ids) {
+    spdlog::error("[validate] ERROR: parked leaf list does not match the parked workspaces");
+    ok = false;
+  }
+  all_leaf_ids.insert(all_leaf_ids.end(), parked_leaf_ids.begin(), parked_leaf_ids.end());
   std::sort(all_leaf_ids.begin(), all_leaf_ids.end());
   for (size_t i = 1; i < all_leaf_ids.size(); ++i) {
     if (all_leaf_ids[i] == all_leaf_ids[i - 1]) {
@@ -1781,72 +2211,265 @@ static bool is_point_in_cluster(const PositionedCluster& pc, float x, float y) {
          y < pc.monitor_y + pc.monitor_height;
 }
 
-// Helper: Find windows in cell_ids that don't exist in any cluster
-static std::vector<size_t>
-find_unmanaged_windows(const std::vector<ClusterCellUpdateInfo>& cell_ids,
-                       const std::vector<PositionedCluster>& clusters) {
-  std::vector<size_t> new_windows;
-  for (const auto& upd : cell_ids) {
-    for (size_t leaf_id : upd.leaf_ids) {
-      bool exists = false;
-      for (const auto& pc : clusters) {
-        if (find_cell_by_leaf_id(pc.cluster, leaf_id).has_value()) {
-          exists = true;
-          break;
-        }
-      }
-      if (!exists) {
-        new_windows.push_back(leaf_id);
+// Helper: Find windows in cell_ids that don't exist in any cluster. dense_ids parallels the
+// leaf lists of cell_ids; managed holds the dense ids of every leaf in the system.
+static std::vector<uint32_t>
+find_unmanaged_windows(const std::vector<std::vector<uint32_t>>& dense_ids,
+                       const DenseBitset& managed) {
+  std::vector<uint32_t> new_windows;
+  for (const auto& ids : dense_ids) {
+    for (uint32_t dense_id : ids) {
+      if (!managed.test(dense_id)) {
+        new_windows.push_back(dense_id);
       }
     }
   }
   return new_windows;
 }
 
-// Helper: Move windows from their detected clusters to target cluster
+// Helper: Move windows from their detected clusters to target cluster (keeping the dense id
+// lists in step with the leaf lists)
 static void redirect_windows_to_cluster(std::vector<ClusterCellUpdateInfo>& cell_ids,
-                                        const std::vector<size_t>& windows_to_redirect,
-                                        size_t target_cluster_index) {
+                                        std::vector<std::vector<uint32_t>>& dense_ids,
+                                        const std::vector<uint32_t>& windows_to_redirect,
+                                        size_t target_cluster_index,
+                                        const LeafInterner& interner) {
   if (windows_to_redirect.empty()) {
     return;
   }
 
+  DenseBitset redirected(interner.capacity());
+  for (uint32_t dense_id : windows_to_redirect) {
+    redirected.set(dense_id);
+  }
+
   // Remove from all clusters
-  for (auto& upd : cell_ids) {
-    auto& ids = upd.leaf_ids;
-    ids.erase(std::remove_if(ids.begin(), ids.end(),
-                             [&windows_to_redirect](size_t id) {
-                               return std::find(windows_to_redirect.begin(),
-                                                windows_to_redirect.end(),
-                                                id) != windows_to_redirect.end();
-                             }),
-              ids.end());
+  for (size_t i = 0; i < cell_ids.size(); ++i) {
+    auto& leaf_ids = cell_ids[i].leaf_ids;
+    auto& ids = dense_ids[i];
+    size_t kept = 0;
+    for (size_t j = 0; j < ids.size(); ++j) {
+      if (!redirected.test(ids[j])) {
+        leaf_ids[kept] = leaf_ids[j];
+        ids[kept] = ids[j];
+        ++kept;
+      }
+    }
+    leaf_ids.resize(kept);
+    ids.resize(kept);
   }
 
   // Add to target cluster
-  for (auto& upd : cell_ids) {
-    if (upd.cluster_index == target_cluster_index) {
-      for (size_t id : windows_to_redirect) {
-        upd.leaf_ids.push_back(id);
+  for (size_t i = 0; i < cell_ids.size(); ++i) {
+    if (cell_ids[i].cluster_index == target_cluster_index) {
+      for (uint32_t dense_id : windows_to_redirect) {
+        cell_ids[i].leaf_ids.push_back(interner.leaf_id(dense_id));
+        dense_ids[i].push_back(dense_id);
       }
       break;
     }
   }
 }
 
-UpdateResult update(System& system, const std::vector<ClusterCellUpdateInfo>& cluster_cell_ids,
-                    std::optional<std::pair<size_t, size_t>> new_selection,
-                    std::pair<float, float> pointer_coords, float zen_percentage,
-                    size_t foreground_leaf_id, float gap_horizontal, float gap_vertical) {
-  UpdateResult result;
-  result.selection_updated = false;
+// Output of the per-cluster stage of update() for one ClusterCellUpdateInfo
+struct ClusterUpdateOutput {
+  std::vector<size_t> deleted_leaf_ids;
+  std::vector<size_t> added_leaf_ids;
+  std::vector<UpdateError> errors;
+  bool cells_changed = false; // Leaves added or deleted; compacted at the end of update()
+
+  // Selection tracking: owns_selection if system.selection points into this cluster,
+  // selected_cell is its cell index (reset if the selected cell was deleted)
+  bool owns_selection = false;
+  std::optional<int> selected_cell;
+};
+
+// Helper: True if no cluster index appears twice (required for the parallel stage)
+static bool has_unique_clusters(const std::vector<ClusterCellUpdateInfo>& cell_ids) {
+  std::vector<size_t> indices;
+  indices.reserve(cell_ids.size());
+  for (const auto& upd : cell_ids) {
+    indices.push_back(upd.cluster_index);
+  }
+  std::sort(indices.begin(), indices.end());
+  return std::adjacent_find(indices.begin(), indices.end()) == indices.end();
+}
+
+// Helper: Apply deletions and additions for one cluster. Only touches pc and out.
+// current_ids/desired_ids are the dense ids of the cluster's leaves and of the update's leaf
+// list. The interner is only read here (clusters may run in parallel).
+static void update_cluster(PositionedCluster& pc, const ClusterCellUpdateInfo& cluster_update,
+                           const std::vector<uint32_t>& current_ids,
+                           const std::vector<uint32_t>& desired_ids, const LeafInterner& interner,
+                           SplitMode split_mode, float gap_horizontal, float gap_vertical,
+                           ClusterUpdateOutput& out) {
+  // Update fullscreen state for this cluster
+  pc.cluster.has_fullscreen_cell = cluster_update.has_fullscreen_cell;
+
+  // to_delete = current - desired, to_add = desired - current (bitsets over dense ids)
+  auto diff = diff_dense_ids(interner, current_ids, desired_ids);
+  const auto& to_delete = diff.removed;
+  const auto& to_add = diff.added;
+
+  // Handle deletions
+  for (size_t leaf_id : to_delete) {
+    auto cell_index_opt = find_cell_by_leaf_id(pc.cluster, leaf_id);
+    if (!cell_index_opt.has_value()) {
+      out.errors.push_back(
+          {UpdateError::Type::LeafNotFound, cluster_update.cluster_index, leaf_id});
+      continue;
+    }
+
+    auto delete_result = delete_leaf(pc.cluster, *cell_index_opt, gap_horizontal, gap_vertical);
+    out.deleted_leaf_ids.push_back(leaf_id);
+
+    if (delete_result.has_value()) {
+      out.cells_changed = true;
+
+      // If deletion succeeded and returned a new selection, update it if this was selected;
+      // a selected sibling follows its promotion
+      if (out.selected_cell.has_value() && *out.selected_cell == *cell_index_opt) {
+        out.selected_cell = delete_result->new_selection_index;
+      } else if (out.selected_cell.has_value() &&
+                 *out.selected_cell == delete_result->promoted_from) {
+        out.selected_cell = delete_result->promoted_to;
+      }
+    }
+  }
+
+  // Determine starting split index for this cluster (prefer selection)
+  int split_from_index = -1;
+  if (out.selected_cell.has_value() && is_leaf(pc.cluster, *out.selected_cell)) {
+    split_from_index = *out.selected_cell;
+  }
+
+  // Handle additions
+  for (size_t leaf_id : to_add) {
+    // Find an existing leaf to split, or create root if empty
+    int current_selection = -1;
+
+    if (pc.cluster.cells.empty()) {
+      // Cluster is empty - will create root with split_leaf(-1)
+      current_selection = -1;
+    } else if (split_from_index >= 0 && is_leaf(pc.cluster, split_from_index)) {
+      // Use tracked split point (follows selection)
+      current_selection = split_from_index;
+    } else {
+      // Fallback: find the first available leaf
+      for (int i = 0; i < static_cast<int>(pc.cluster.cells.size()); ++i) {
+        if (is_leaf(pc.cluster, i)) {
+          current_selection = i;
+          break;
+        }
+      }
+    }
+
+    // Determine split direction based on mode
+    SplitDir split_dir = determine_split_dir(pc.cluster, current_selection, split_mode);
+    auto result_opt = split_leaf(pc.cluster, current_selection, gap_horizontal, gap_vertical,
+                                 leaf_id, split_dir);
+
+    if (result_opt.has_value()) {
+      // The split cell became a parent; a selection on it follows its window to the first child
+      if (out.selected_cell.has_value() && *out.selected_cell == current_selection) {
+        out.selected_cell = result_opt->new_selection_index;
+      }
+      // Update split_from_index to follow the first child for subsequent additions
+      split_from_index = result_opt->new_selection_index;
+      out.added_leaf_ids.push_back(leaf_id);
+      out.cells_changed = true;
+    }
+  }
+
+  // Reset zen if cells were added or removed from this cluster
+  if (!to_delete.empty() || !to_add.empty()) {
+    pc.cluster.zen_cell_index.reset();
+  }
+}
+
+// Helper: True if every update names a distinct, valid cluster whose fingerprint matches the
+// reported window list, i.e. reconciling would neither add, delete nor redirect anything
+static bool leaf_sets_match(const System& system,
+                            const std::vector<ClusterCellUpdateInfo>& cell_ids) {
+  if (!has_unique_clusters(cell_ids)) {
+    return false;
+  }
+  for (const auto& upd : cell_ids) {
+    if (upd.cluster_index >= system.clusters.size() ||
+        fingerprint_leaf_ids(upd.leaf_ids) !=
+            system.clusters[upd.cluster_index].cluster.leaf_fingerprint) {
+      return false;
+    }
+  }
+  return true;
+}
 
-  // Track deleted cell indices per cluster for compaction at end
-  std::map<size_t, std::set<int>> cluster_deletions;
+// Helper: Re-derive every cluster's fingerprint from its tree. Returns the number that were
+// stale (a mutation path that bypassed split_leaf/delete_leaf).
+static size_t refresh_leaf_fingerprints(System& system) {
+  size_t stale = 0;
+  for (auto& pc : system.clusters) {
+    auto fingerprint = fingerprint_leaf_ids(get_cluster_leaf_ids(pc.cluster));
+    if (fingerprint != pc.cluster.leaf_fingerprint) {
+      pc.cluster.leaf_fingerprint = fingerprint;
+      ++stale;
+    }
+  }
+  return stale;
+}
 
+// Helper: Bring the clusters' window sets in line with the update: redirect new windows,
+// then delete and add leaves per cluster. trust_fingerprints lets a cluster whose
+// fingerprint matches its update skip the diff.
+static void reconcile_clusters(System& system,
+                               const std::vector<ClusterCellUpdateInfo>& cluster_cell_ids,
+                               std::pair<float, float> pointer_coords, bool trust_fingerprints,
+                               float gap_horizontal, float gap_vertical, ThreadPool* pool,
+                               UpdateResult& result,
+                               std::set<size_t>& changed_clusters) {
   // Make a mutable copy for redirection
   std::vector<ClusterCellUpdateInfo> redirected_cell_ids = cluster_cell_ids;
 
+  // A parked window that shows up anyway (reshown by its application, or a snapshot taken
+  // before the switch) stays with its workspace
+  if (!system.parked_leaf_ids.empty()) {
+    for (auto& upd : redirected_cell_ids) {
+      std::erase_if(upd.leaf_ids, [&](size_t leaf_id) { return is_parked_leaf(system, leaf_id); });
+    }
+  }
+
+  // Intern every managed and reported leaf up front. After this pass the interner is only
+  // read (the per-cluster stage may run in parallel), and membership tests and set
+  // differences are bit operations on dense ids.
+  LeafInterner& interner = system.leaf_interner;
+  auto intern_cluster = [&](const CellCluster& cluster) {
+    std::vector<uint32_t> ids;
+    for (int i = 0; i < static_cast<int>(cluster.cells.size()); ++i) {
+      if (is_leaf(cluster, i)) {
+        ids.push_back(interner.intern(*cluster.cells[static_cast<size_t>(i)].leaf_id));
+      }
+    }
+    return ids;
+  };
+  std::vector<std::vector<uint32_t>> current_ids;
+  current_ids.reserve(system.clusters.size());
+  for (const auto& pc : system.clusters) {
+    current_ids.push_back(intern_cluster(pc.cluster));
+  }
+  std::vector<std::vector<uint32_t>> desired_ids(redirected_cell_ids.size());
+  for (size_t i = 0; i < redirected_cell_ids.size(); ++i) {
+    desired_ids[i].reserve(redirected_cell_ids[i].leaf_ids.size());
+    for (size_t leaf_id : redirected_cell_ids[i].leaf_ids) {
+      desired_ids[i].push_back(interner.intern(leaf_id));
+    }
+  }
+  DenseBitset managed(interner.capacity());
+  for (const auto& ids : current_ids) {
+    for (uint32_t dense_id : ids) {
+      managed.set(dense_id);
+    }
+  }
+
   // Find empty cluster under pointer for redirection
   std::optional<size_t> pointer_cluster_index;
   for (size_t ci = 0; ci < system.clusters.size(); ++ci) {
@@ -1882,120 +2505,146 @@ UpdateResult update(System& system, const std::vector<ClusterCellUpdateInfo>& cl
 
   // Redirect new windows to target cluster
   if (redirect_target.has_value()) {
-    auto new_windows = find_unmanaged_windows(redirected_cell_ids, system.clusters);
-    redirect_windows_to_cluster(redirected_cell_ids, new_windows, *redirect_target);
-  }
-
-  // Process each cluster update
-  for (const auto& cluster_update : redirected_cell_ids) {
+    auto new_windows = find_unmanaged_windows(desired_ids, managed);
+    redirect_windows_to_cluster(redirected_cell_ids, desired_ids, new_windows, *redirect_target,
+                                interner);
+  }
+
+  // Per-cluster stage: deletions and additions only touch their own cluster (and the selection
+  // if it points into it), so clusters run in parallel when a pool is given and each cluster
+  // appears at most once. Outputs are merged in input order either way.
+  std::vector<ClusterUpdateOutput> outputs(redirected_cell_ids.size());
+  auto prepare = [&](size_t i) {
+    auto& out = outputs[i];
+    size_t ci = redirected_cell_ids[i].cluster_index;
+    out.owns_selection = system.selection.has_value() && system.selection->cluster_index == ci;
+    out.selected_cell = out.owns_selection ? std::optional<int>(system.selection->cell_index)
+                                           : std::nullopt;
+  };
+  // A cluster listed twice (serial path only) has changed since current_ids was taken
+  std::vector<char> processed(system.clusters.size(), 0);
+  auto process = [&](size_t i) {
+    const auto& cluster_update = redirected_cell_ids[i];
     // Bounds check for external input
     if (cluster_update.cluster_index >= system.clusters.size()) {
-      result.errors.push_back({
+      outputs[i].errors.push_back({
           UpdateError::Type::ClusterNotFound, cluster_update.cluster_index,
           0 // no specific leaf ID
       });
-      continue;
+      return;
     }
-
-    PositionedCluster& pc = system.clusters[cluster_update.cluster_index];
-
-    // Update fullscreen state for this cluster
-    pc.cluster.has_fullscreen_cell = cluster_update.has_fullscreen_cell;
-
-    // Get current leaf IDs
-    std::vector<size_t> current_leaf_ids = get_cluster_leaf_ids(pc.cluster);
-
-    // Compute set differences
-    std::vector<size_t> sorted_current = current_leaf_ids;
-    std::vector<size_t> sorted_desired = cluster_update.leaf_ids;
-    std::sort(sorted_current.begin(), sorted_current.end());
-    std::sort(sorted_desired.begin(), sorted_desired.end());
-
-    // to_delete = current - desired
-    std::vector<size_t> to_delete;
-    std::set_difference(sorted_current.begin(), sorted_current.end(), sorted_desired.begin(),
-                        sorted_desired.end(), std::back_inserter(to_delete));
-
-    // to_add = desired - current
-    std::vector<size_t> to_add;
-    std::set_difference(sorted_desired.begin(), sorted_desired.end(), sorted_current.begin(),
-                        sorted_current.end(), std::back_inserter(to_add));
-
-    // Handle deletions
-    for (size_t leaf_id : to_delete) {
-      auto cell_index_opt = find_cell_by_leaf_id(pc.cluster, leaf_id);
-      if (!cell_index_opt.has_value()) {
-        result.errors.push_back(
-            {UpdateError::Type::LeafNotFound, cluster_update.cluster_index, leaf_id});
-        continue;
+    size_t ci = cluster_update.cluster_index;
+    auto& pc = system.clusters[ci];
+    if (processed[ci]) {
+      current_ids[ci].clear();
+      for (size_t leaf_id : get_cluster_leaf_ids(pc.cluster)) {
+        current_ids[ci].push_back(*interner.find(leaf_id));
       }
+    }
+    processed[ci] = 1;
+    if (trust_fingerprints &&
+        fingerprint_leaf_ids(cluster_update.leaf_ids) == pc.cluster.leaf_fingerprint) {
+      pc.cluster.has_fullscreen_cell = cluster_update.has_fullscreen_cell;
+      return;
+    }
+    update_cluster(pc, cluster_update, current_ids[ci], desired_ids[i], interner,
+                   system.split_mode, gap_horizontal, gap_vertical, outputs[i]);
+  };
+  auto write_back_selection = [&](const ClusterUpdateOutput& out) {
+    if (!out.owns_selection) {
+      return;
+    }
+    if (out.selected_cell.has_value()) {
+      system.selection->cell_index = *out.selected_cell;
+    } else {
+      system.selection.reset();
+    }
+  };
 
-      auto delete_result = delete_leaf(pc.cluster, *cell_index_opt, gap_horizontal, gap_vertical);
-      result.deleted_leaf_ids.push_back(leaf_id);
-
-      if (delete_result.has_value()) {
-        // Accumulate deleted indices for compaction at end
-        for (int idx : delete_result->deleted_indices) {
-          cluster_deletions[cluster_update.cluster_index].insert(idx);
-        }
-
-        // If deletion succeeded and returned a new selection, update it if this was selected
-        if (system.selection.has_value() &&
-            system.selection->cluster_index == cluster_update.cluster_index &&
-            system.selection->cell_index == *cell_index_opt) {
-          if (delete_result->new_selection_index.has_value()) {
-            system.selection->cell_index = *delete_result->new_selection_index;
-          } else {
-            system.selection.reset();
-          }
-        }
-      }
+  if (pool != nullptr && pool->worker_count() > 0 && redirected_cell_ids.size() > 1 &&
+      has_unique_clusters(redirected_cell_ids)) {
+    for (size_t i = 0; i < outputs.size(); ++i) {
+      prepare(i);
     }
+    pool->parallel_for(outputs.size(), process);
+    for (const auto& out : outputs) {
+      write_back_selection(out);
+    }
+  } else {
+    for (size_t i = 0; i < outputs.size(); ++i) {
+      prepare(i);
+      process(i);
+      write_back_selection(outputs[i]);
+    }
+  }
 
-    // Determine starting split index for this cluster (prefer selection)
-    int split_from_index = -1;
-    if (system.selection.has_value() &&
-        system.selection->cluster_index == cluster_update.cluster_index &&
-        is_leaf(pc.cluster, system.selection->cell_index)) {
-      split_from_index = system.selection->cell_index;
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    auto& out = outputs[i];
+    result.errors.insert(result.errors.end(), out.errors.begin(), out.errors.end());
+    result.deleted_leaf_ids.insert(result.deleted_leaf_ids.end(), out.deleted_leaf_ids.begin(),
+                                   out.deleted_leaf_ids.end());
+    result.added_leaf_ids.insert(result.added_leaf_ids.end(), out.added_leaf_ids.begin(),
+                                 out.added_leaf_ids.end());
+    if (out.cells_changed) {
+      changed_clusters.insert(redirected_cell_ids[i].cluster_index);
     }
+  }
 
-    // Handle additions
-    for (size_t leaf_id : to_add) {
-      // Find an existing leaf to split, or create root if empty
-      int current_selection = -1;
+  // Every leaf this pass interned or looked up gives its dense id back unless it is managed
+  // at the end: windows that closed, and reported windows that were never added (unknown
+  // cluster, failed split). One that moved between clusters was deleted and added in the same
+  // pass and keeps its id.
+  DenseBitset managed_after = managed;
+  for (size_t leaf_id : result.deleted_leaf_ids) {
+    managed_after.reset(*interner.find(leaf_id));
+  }
+  for (size_t leaf_id : result.added_leaf_ids) {
+    managed_after.set(*interner.find(leaf_id));
+  }
+  DenseBitset touched = managed;
+  for (const auto& ids : desired_ids) {
+    for (uint32_t dense_id : ids) {
+      touched.set(dense_id);
+    }
+  }
+  touched.for_each_difference(managed_after, [&](uint32_t dense_id) {
+    interner.release(interner.leaf_id(dense_id));
+  });
+}
 
-      if (pc.cluster.cells.empty()) {
-        // Cluster is empty - will create root with split_leaf(-1)
-        current_selection = -1;
-      } else if (split_from_index >= 0 && is_leaf(pc.cluster, split_from_index)) {
-        // Use tracked split point (follows selection)
-        current_selection = split_from_index;
-      } else {
-        // Fallback: find the first available leaf
-        for (int i = 0; i < static_cast<int>(pc.cluster.cells.size()); ++i) {
-          if (is_leaf(pc.cluster, i)) {
-            current_selection = i;
-            break;
-          }
-        }
-      }
+UpdateResult update(System& system, const std::vector<ClusterCellUpdateInfo>& cluster_cell_ids,
+                    std::optional<std::pair<size_t, size_t>> new_selection,
+                    std::pair<float, float> pointer_coords, float zen_percentage,
+                    size_t foreground_leaf_id, float gap_horizontal, float gap_vertical,
+                    ThreadPool* pool, std::chrono::steady_clock::time_point now) {
+  UpdateResult result;
+  result.selection_updated = false;
 
-      // Determine split direction based on mode
-      SplitDir split_dir = determine_split_dir(pc.cluster, current_selection, system.split_mode);
-      auto result_opt = split_leaf(pc.cluster, current_selection, gap_horizontal, gap_vertical,
-                                   leaf_id, split_dir);
+  // Clusters whose cells were added or deleted, compacted at the end
+  std::set<size_t> changed_clusters;
 
-      if (result_opt.has_value()) {
-        // Update split_from_index to follow the first child for subsequent additions
-        split_from_index = result_opt->new_selection_index;
-        result.added_leaf_ids.push_back(leaf_id);
-      }
+  // Almost every pass reports the same windows as the last one. When all fingerprints match,
+  // skip reconciliation entirely. Every kFullDiffInterval passes the fingerprints are rebuilt
+  // from the trees and the full diff runs regardless, which catches a stale fingerprint or a
+  // hash collision.
+  bool verify = ++system.updates_since_full_diff >= kFullDiffInterval;
+  if (verify) {
+    system.updates_since_full_diff = 0;
+    if (size_t stale = refresh_leaf_fingerprints(system); stale > 0) {
+      spdlog::warn("update: {} cluster fingerprint(s) were stale", stale);
     }
-
-    // Reset zen if cells were added or removed from this cluster
-    if (!to_delete.empty() || !to_add.empty()) {
-      pc.cluster.zen_cell_index.reset();
+  }
+  bool matched = leaf_sets_match(system, cluster_cell_ids);
+  if (matched && !verify) {
+    result.leaf_sets_unchanged = true;
+    for (const auto& upd : cluster_cell_ids) {
+      system.clusters[upd.cluster_index].cluster.has_fullscreen_cell = upd.has_fullscreen_cell;
+    }
+  } else {
+    reconcile_clusters(system, cluster_cell_ids, pointer_coords, !verify, gap_horizontal,
+                       gap_vertical, pool, result, changed_clusters);
+    if (matched && (!result.added_leaf_ids.empty() || !result.deleted_leaf_ids.empty())) {
+      spdlog::warn("update: leaf set fingerprint collision, full diff found changes");
     }
   }
 
@@ -2029,8 +2678,10 @@ UpdateResult update(System& system, const std::vector<ClusterCellUpdateInfo>& cl
   // Compute selection update based on cursor position and apply to system.selection
   float cursor_x = pointer_coords.first;
   float cursor_y = pointer_coords.second;
-  result.selection_update =
-      compute_selection_update(system, cursor_x, cursor_y, zen_percentage, foreground_leaf_id);
+  result.selection_update = filter_hover_selection(
+      system.hover_focus_options, system.hover_focus,
+      compute_selection_update(system, cursor_x, cursor_y, zen_percentage, foreground_leaf_id),
+      now);
 
   if (result.selection_update.needs_update && result.selection_update.new_selection.has_value()) {
     system.selection = *result.selection_update.new_selection;
@@ -2050,27 +2701,357 @@ UpdateResult update(System& system, const std::vector<ClusterCellUpdateInfo>& cl
     result.new_window_cursor_pos = find_cell_center_by_leaf_id(system, last_added_id);
   }
 
-  // Compact all clusters with deletions and remap indices
-  for (auto& [ci, deleted_indices] : cluster_deletions) {
+  // Compact changed clusters back into preorder and remap indices
+  for (size_t ci : changed_clusters) {
     auto& pc = system.clusters[ci];
-    auto remap = compact_cluster(pc.cluster, deleted_indices);
-
-    // Update selection if in this cluster
-    if (!remap.empty() && system.selection.has_value() && system.selection->cluster_index == ci) {
-      int old_idx = system.selection->cell_index;
-      if (static_cast<size_t>(old_idx) < remap.size()) {
-        if (remap[static_cast<size_t>(old_idx)] == -1) {
-          system.selection.reset(); // Was deleted
-        } else {
-          system.selection->cell_index = remap[static_cast<size_t>(old_idx)];
-        }
+    auto remap = compact_cluster(pc.cluster);
+    if (remap.empty()) {
+      continue;
+    }
+
+    auto follow = [&](std::optional<CellIndicatorByIndex>& indicator) {
+      if (!indicator.has_value() || indicator->cluster_index != ci ||
+          static_cast<size_t>(indicator->cell_index) >= remap.size()) {
+        return;
+      }
+      int new_idx = remap[static_cast<size_t>(indicator->cell_index)];
+      if (new_idx == -1) {
+        indicator.reset(); // Was deleted
+      } else {
+        indicator->cell_index = new_idx;
+      }
+    };
+    follow(system.selection);
+    follow(system.hover_focus.candidate);
+  }
+
+  return result;
+}
+
+// ============================================================================
+// Batch Construction
+// ============================================================================
+
+// Helper: True if layout is a single tree rooted at 0 with well-formed splits and leaves and
+// no leaf id twice
+static bool is_valid_layout(const std::vector<LayoutNode>& layout) {
+  if (layout.empty()) {
+    return false;
+  }
+  std::vector<char> visited(layout.size(), 0);
+  std::vector<size_t> leaf_ids;
+  size_t reached = 0;
+  std::vector<int> stack{0};
+  while (!stack.empty()) {
+    int i = stack.back();
+    stack.pop_back();
+    if (i < 0 || static_cast<size_t>(i) >= layout.size() || visited[static_cast<size_t>(i)]) {
+      return false; // Out of range, shared or cyclic
+    }
+    visited[static_cast<size_t>(i)] = 1;
+    ++reached;
+
+    const LayoutNode& node = layout[static_cast<size_t>(i)];
+    bool is_split = node.first_child.has_value() && node.second_child.has_value();
+    bool is_leaf_node = !node.first_child.has_value() && !node.second_child.has_value();
+    if (is_leaf_node && node.leaf_id.has_value()) {
+      leaf_ids.push_back(*node.leaf_id);
+    } else if (is_split && !node.leaf_id.has_value()) {
+      stack.push_back(*node.second_child);
+      stack.push_back(*node.first_child);
+    } else {
+      return false;
+    }
+  }
+  std::sort(leaf_ids.begin(), leaf_ids.end());
+  return reached == layout.size() &&
+         std::adjacent_find(leaf_ids.begin(), leaf_ids.end()) == leaf_ids.end();
+}
+
+// Helper: Where a leaf id lives now, if anywhere
+static std::optional<CellIndicatorByIndex> locate_leaf(const System& system, size_t leaf_id) {
+  auto cluster_index = find_cluster_by_leaf_id(system, leaf_id);
+  if (!cluster_index.has_value()) {
+    return std::nullopt;
+  }
+  return CellIndicatorByIndex{
+      *cluster_index, *find_cell_by_leaf_id(system.clusters[*cluster_index].cluster, leaf_id)};
+}
+
+bool build_cluster_layout(System& system, size_t cluster_index,
+                          const std::vector<LayoutNode>& layout, float gap_horizontal,
+                          float gap_vertical) {
+  if (cluster_index >= system.clusters.size() || !is_valid_layout(layout)) {
+    return false;
+  }
+
+  // Indices change in every cluster touched below; selection and hover candidate are looked up
+  // again by leaf id afterwards
+  auto leaf_of = [&](const std::optional<CellIndicatorByIndex>& indicator) {
+    std::optional<size_t> leaf_id;
+    if (indicator.has_value() && indicator->cluster_index < system.clusters.size() &&
+        is_leaf(system.clusters[indicator->cluster_index].cluster, indicator->cell_index)) {
+      leaf_id = system.clusters[indicator->cluster_index]
+                    .cluster.cells[static_cast<size_t>(indicator->cell_index)]
+                    .leaf_id;
+    }
+    return leaf_id;
+  };
+  auto selected_leaf = leaf_of(system.selection);
+  auto candidate_leaf = leaf_of(system.hover_focus.candidate);
+
+  // Take the layout's windows out of the other clusters
+  std::set<size_t> sources;
+  for (const auto& node : layout) {
+    if (!node.leaf_id.has_value()) {
+      continue;
+    }
+    for (size_t ci = 0; ci < system.clusters.size(); ++ci) {
+      if (ci == cluster_index) {
+        continue;
+      }
+      auto& other = system.clusters[ci].cluster;
+      if (auto index = find_cell_by_leaf_id(other, *node.leaf_id)) {
+        delete_leaf(other, *index, gap_horizontal, gap_vertical);
+        other.zen_cell_index.reset();
+        sources.insert(ci);
+        break;
       }
     }
   }
+  for (size_t ci : sources) {
+    compact_cluster(system.clusters[ci].cluster);
+  }
+
+  // Write the layout in preorder, so the cluster is already compact
+  struct Pending {
+    int node;
+    std::optional<int> parent;
+    bool is_first;
+  };
+  std::vector<Cell> cells;
+  cells.reserve(layout.size());
+  LeafSetFingerprint fingerprint;
+  std::vector<Pending> stack{{0, std::nullopt, true}};
+  while (!stack.empty()) {
+    Pending pending = stack.back();
+    stack.pop_back();
+    const LayoutNode& node = layout[static_cast<size_t>(pending.node)];
+    int index = static_cast<int>(cells.size());
+
+    Cell cell{};
+    cell.split_dir = node.split_dir;
+    cell.split_ratio = std::max(kMinSplitRatio, std::min(kMaxSplitRatio, node.split_ratio));
+    cell.parent = pending.parent;
+    cell.leaf_id = node.leaf_id;
+    cells.push_back(cell);
+    if (pending.parent.has_value()) {
+      Cell& parent = cells[static_cast<size_t>(*pending.parent)];
+      (pending.is_first ? parent.first_child : parent.second_child) = index;
+    }
+
+    if (node.leaf_id.has_value()) {
+      fingerprint.add(*node.leaf_id);
+    } else {
+      stack.push_back({*node.second_child, index, false});
+      stack.push_back({*node.first_child, index, true});
+    }
+  }
+
+  CellCluster& cluster = system.clusters[cluster_index].cluster;
+  cluster.cells = std::move(cells);
+  cluster.leaf_fingerprint = fingerprint;
+  cluster.zen_cell_index.reset();
+  cluster.all_cells_touched = true;
+  cluster.touched_cells.clear();
+
+  // One layout pass from the root
+  float inset_w = cluster.window_width - 2.0f * gap_horizontal;
+  float inset_h = cluster.window_height - 2.0f * gap_vertical;
+  cluster.cells[0].rect = Rect{gap_horizontal, gap_vertical, inset_w > 0.0f ? inset_w : 0.0f,
+                               inset_h > 0.0f ? inset_h : 0.0f};
+  recompute_subtree_rects(cluster, 0, gap_horizontal, gap_vertical);
+
+  // A selected window the layout dropped hands the selection to the layout's first window
+  system.selection = selected_leaf.has_value() ? locate_leaf(system, *selected_leaf)
+                                               : std::nullopt;
+  if (selected_leaf.has_value() && !system.selection.has_value()) {
+    for (int i = 0; i < static_cast<int>(cluster.cells.size()); ++i) {
+      if (is_leaf(cluster, i)) {
+        system.selection = CellIndicatorByIndex{cluster_index, i};
+        break;
+      }
+    }
+  }
+  system.hover_focus.candidate =
+      candidate_leaf.has_value() ? locate_leaf(system, *candidate_leaf) : std::nullopt;
+  return true;
+}
+
+// ============================================================================
+// Workspaces
+// ============================================================================
+
+// Helper: Add parked leaf ids to the system's sorted list and remove unparked ones
+static void update_parked_leaf_ids(System& system, const std::vector<size_t>& parked,
+                                   std::vector<size_t> unparked) {
+  auto& ids = system.parked_leaf_ids;
+  if (!unparked.empty()) {
+    std::sort(unparked.begin(), unparked.end());
+    std::erase_if(ids, [&](size_t leaf_id) {
+      return std::binary_search(unparked.begin(), unparked.end(), leaf_id);
+    });
+  }
+  ids.insert(ids.end(), parked.begin(), parked.end());
+  std::sort(ids.begin(), ids.end());
+}
 
+size_t workspace_count(const PositionedCluster& pc) {
+  return std::max<size_t>(1, pc.workspaces.size());
+}
+
+std::optional<WorkspaceSwitchResult> switch_workspace(System& system, size_t cluster_index,
+                                                      size_t workspace) {
+  if (cluster_index >= system.clusters.size()) {
+    return std::nullopt;
+  }
+  PositionedCluster& pc = system.clusters[cluster_index];
+  if (workspace >= pc.workspaces.size() || workspace == pc.active_workspace) {
+    return std::nullopt;
+  }
+  Workspace& outgoing = pc.workspaces[pc.active_workspace];
+  Workspace& incoming = pc.workspaces[workspace];
+
+  WorkspaceSwitchResult result;
+  result.hidden_leaf_ids = get_cluster_leaf_ids(pc.cluster);
+  result.shown_leaf_ids = get_cluster_leaf_ids(incoming.cluster);
+
+  // Remember the selection for when this workspace comes back; indices into the outgoing tree
+  // are dropped
+  bool owns_selection =
+      !system.selection.has_value() || system.selection->cluster_index == cluster_index;
+  outgoing.selected_leaf_id.reset();
+  if (system.selection.has_value() && system.selection->cluster_index == cluster_index &&
+      is_leaf(pc.cluster, system.selection->cell_index)) {
+    outgoing.selected_leaf_id =
+        pc.cluster.cells[static_cast<size_t>(system.selection->cell_index)].leaf_id;
+  }
+  if (system.hover_focus.candidate.has_value() &&
+      system.hover_focus.candidate->cluster_index == cluster_index) {
+    system.hover_focus.candidate.reset();
+  }
+
+  // Two swaps: the active tree into its parking slot, the incoming tree out of its own (which
+  // keeps the empty stand-in)
+  std::swap(outgoing.cluster, pc.cluster);
+  std::swap(pc.cluster, incoming.cluster);
+  pc.active_workspace = workspace;
+  pc.cluster.all_cells_touched = true;
+  pc.cluster.touched_cells.clear();
+  update_parked_leaf_ids(system, result.hidden_leaf_ids, result.shown_leaf_ids);
+
+  if (!owns_selection) {
+    return result;
+  }
+  std::optional<int> selected;
+  if (incoming.selected_leaf_id.has_value()) {
+    selected = find_cell_by_leaf_id(pc.cluster, *incoming.selected_leaf_id);
+  }
+  for (int i = 0; !selected.has_value() && i < static_cast<int>(pc.cluster.cells.size()); ++i) {
+    if (is_leaf(pc.cluster, i)) {
+      selected = i;
+    }
+  }
+  if (!selected.has_value()) {
+    system.selection.reset();
+    return result;
+  }
+  system.selection = CellIndicatorByIndex{cluster_index, *selected};
+  size_t leaf_id = *pc.cluster.cells[static_cast<size_t>(*selected)].leaf_id;
+  result.focus = MoveSelectionResult{leaf_id, *get_selected_cell_center(system)};
   return result;
 }
 
+bool send_to_workspace(System& system, size_t cluster_index, size_t leaf_id, size_t workspace,
+                       float gap_horizontal, float gap_vertical) {
+  if (cluster_index >= system.clusters.size()) {
+    return false;
+  }
+  PositionedCluster& pc = system.clusters[cluster_index];
+  if (workspace >= pc.workspaces.size() || workspace == pc.active_workspace) {
+    return false;
+  }
+  auto cell_index = find_cell_by_leaf_id(pc.cluster, leaf_id);
+  if (!cell_index.has_value()) {
+    return false;
+  }
+
+  // Take the window out of the active tree; selection and hover candidate follow the cells
+  // like they do in update()
+  auto deleted = delete_leaf(pc.cluster, *cell_index, gap_horizontal, gap_vertical);
+  if (!deleted.has_value()) {
+    return false;
+  }
+  pc.cluster.zen_cell_index.reset();
+  auto after_delete = [&](std::optional<CellIndicatorByIndex>& indicator) {
+    if (!indicator.has_value() || indicator->cluster_index != cluster_index) {
+      return;
+    }
+    if (indicator->cell_index == *cell_index) {
+      if (deleted->new_selection_index.has_value()) {
+        indicator->cell_index = *deleted->new_selection_index;
+      } else {
+        indicator.reset();
+      }
+    } else if (indicator->cell_index == deleted->promoted_from) {
+      indicator->cell_index = deleted->promoted_to;
+    }
+  };
+  after_delete(system.selection);
+  after_delete(system.hover_focus.candidate);
+  auto remap = compact_cluster(pc.cluster);
+  auto follow = [&](std::optional<CellIndicatorByIndex>& indicator) {
+    if (remap.empty() || !indicator.has_value() || indicator->cluster_index != cluster_index) {
+      return;
+    }
+    int new_idx = remap[static_cast<size_t>(indicator->cell_index)];
+    if (new_idx == -1) {
+      indicator.reset();
+    } else {
+      indicator->cell_index = new_idx;
+    }
+  };
+  follow(system.selection);
+  follow(system.hover_focus.candidate);
+
+  // Split it off the window remembered in the target workspace (its last window otherwise)
+  Workspace& target = pc.workspaces[workspace];
+  CellCluster& tree = target.cluster;
+  int split_from = -1;
+  if (target.selected_leaf_id.has_value()) {
+    split_from = find_cell_by_leaf_id(tree, *target.selected_leaf_id).value_or(-1);
+  }
+  for (int i = static_cast<int>(tree.cells.size()) - 1; split_from < 0 && i >= 0; --i) {
+    if (is_leaf(tree, i)) {
+      split_from = i;
+    }
+  }
+  SplitDir split_dir = determine_split_dir(tree, split_from, system.split_mode);
+  split_leaf(tree, split_from, gap_horizontal, gap_vertical, leaf_id, split_dir);
+  tree.zen_cell_index.reset();
+  compact_cluster(tree);
+  if (!target.selected_leaf_id.has_value()) {
+    target.selected_leaf_id = leaf_id;
+  }
+  update_parked_leaf_ids(system, {leaf_id}, {});
+  return true;
+}
+
+bool is_parked_leaf(const System& system, size_t leaf_id) {
+  return std::binary_search(system.parked_leaf_ids.begin(), system.parked_leaf_ids.end(),
+                            leaf_id);
+}
+
 // ============================================================================
 // Pure Logic Utilities
 // ============================================================================
@@ -2146,6 +3127,41 @@ static std::vector<TileUpdate> calculate_tile_layout(const System& system, float
   return updates;
 }
 
+SelectionUpdateResult filter_hover_selection(const HoverFocusOptions& options,
+                                             HoverFocusState& state,
+                                             const SelectionUpdateResult& candidate,
+                                             std::chrono::steady_clock::time_point now) {
+  // Cursor is on the selection (or nothing selectable): nothing to wait for
+  if (!candidate.needs_update || !candidate.new_selection.has_value()) {
+    state.candidate.reset();
+    return candidate;
+  }
+
+  const auto& cell = *candidate.new_selection;
+  if (!state.candidate.has_value() || state.candidate->cluster_index != cell.cluster_index ||
+      state.candidate->cell_index != cell.cell_index) {
+    state.candidate = cell;
+    state.candidate_since = now;
+  }
+
+  bool dwelled = now - state.candidate_since >= options.dwell;
+  bool rate_ok = !candidate.window_to_foreground.has_value() ||
+                 !state.last_foreground_change.has_value() ||
+                 now - *state.last_foreground_change >= options.min_foreground_interval;
+  if (!dwelled || !rate_ok) {
+    SelectionUpdateResult held{};
+    held.needs_update = false;
+    held.pending = true;
+    return held;
+  }
+
+  state.candidate.reset();
+  if (candidate.window_to_foreground.has_value()) {
+    state.last_foreground_change = now;
+  }
+  return candidate;
+}
+
 static SelectionUpdateResult compute_selection_update(const System& system, float cursor_x,
                                                       float cursor_y, float zen_percentage,
                                                       size_t foreground_window_leaf_id) {
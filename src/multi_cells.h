@@ -1,13 +1,19 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <tl/expected.hpp>
 #include <utility>
 #include <vector>
 
+#include "leaf_interner.h"
+
 namespace wintiler {
 
+class ThreadPool;
+
 // ============================================================================
 // Basic Cell Types
 // ============================================================================
@@ -51,9 +57,32 @@ struct Cell {
   bool is_dead = false;          // true if cell is logically deleted but not yet compacted
 };
 
+// Order-independent summary of a set of leaf ids: count plus xor and sum of mixed ids. Equal
+// fingerprints mean equal sets unless the 128 hash bits collide; update() compares them to skip
+// the per-cluster diff when a cluster's windows have not changed.
+struct LeafSetFingerprint {
+  size_t count = 0;
+  uint64_t xor_hash = 0;
+  uint64_t sum_hash = 0;
+
+  void add(size_t leaf_id);
+  void remove(size_t leaf_id);
+
+  bool operator==(const LeafSetFingerprint&) const = default;
+};
+
+// Fingerprint of a leaf id list (a duplicate counts twice, so it never matches a cluster)
+[[nodiscard]] LeafSetFingerprint fingerprint_leaf_ids(const std::vector<size_t>& leaf_ids);
+
 struct CellCluster {
+  // Root at 0. After update() compacts a cluster the cells are in depth-first preorder, so every
+  // subtree is a contiguous range; splits and moves append out of order until the next one.
   std::vector<Cell> cells;
 
+  // Fingerprint of the leaf ids in cells, kept up to date by split_leaf/delete_leaf and the
+  // cross-cluster swap (the only places that change a cluster's leaf set)
+  LeafSetFingerprint leaf_fingerprint;
+
   // Logical window size used to derive the initial root cell rect
   // when the first cell is created lazily on a split.
   float window_width = 0.0f;
@@ -64,6 +93,11 @@ struct CellCluster {
 
   // True if any window in this cluster is fullscreen
   bool has_fullscreen_cell = false;
+
+  // Cells whose links, leaf id or rect changed since the last InvariantChecker pass. Once the
+  // list would outgrow the cluster (or after a compaction) all_cells_touched stands in for it.
+  std::vector<int> touched_cells;
+  bool all_cells_touched = false;
 };
 
 enum class Direction {
@@ -80,8 +114,19 @@ enum class Direction {
 // Multi-Cluster System
 // ============================================================================
 
-struct PositionedCluster {
+// A workspace's tree while another workspace is active on its monitor. Its windows are
+// hidden, so they are neither enumerated nor placed: a parked workspace costs nothing per tick.
+struct Workspace {
   CellCluster cluster;
+  std::optional<size_t> selected_leaf_id; // Selection to restore when it becomes active
+};
+
+struct PositionedCluster {
+  CellCluster cluster; // Tree of the active workspace
+  // One entry per workspace (none = a single workspace). The active workspace's entry is an
+  // empty stand-in while its tree is in cluster, so a switch swaps two trees and rebuilds none.
+  std::vector<Workspace> workspaces;
+  size_t active_workspace = 0;
   float global_x; // Workspace position (for tiling)
   float global_y;
   // Full monitor bounds (for pointer detection)
@@ -101,6 +146,10 @@ struct CellIndicatorByIndex {
 constexpr float kDefaultCellGapHorizontal = 10.0f;
 constexpr float kDefaultCellGapVertical = 10.0f;
 
+// Split ratio bounds, so both children of a split keep a reasonable share
+constexpr float kMinSplitRatio = 0.1f;
+constexpr float kMaxSplitRatio = 0.9f;
+
 // ============================================================================
 // Forward declarations for System function return types
 // ============================================================================
@@ -133,6 +182,7 @@ struct SelectionUpdateResult {
   bool needs_update;
   std::optional<CellIndicatorByIndex> new_selection;
   std::optional<size_t> window_to_foreground; // leaf_id
+  bool pending = false; // Hovered cell held back by dwell or the foreground rate limit
 };
 
 struct UpdateResult {
@@ -149,6 +199,9 @@ struct UpdateResult {
 
   // Cursor position for newly added windows (if any)
   std::optional<Point> new_window_cursor_pos;
+
+  // Every reported window set matched its cluster's fingerprint; no cluster was diffed
+  bool leaf_sets_unchanged = false;
 };
 
 struct MoveSuccess {
@@ -173,10 +226,29 @@ struct DropMoveResult {
 // System
 // ============================================================================
 
+// Hover focus hysteresis. A hovered cell only becomes the selection (and its window the
+// foreground) after the cursor rested on it for dwell, and foreground changes are at least
+// min_foreground_interval apart. Zero disables a check.
+struct HoverFocusOptions {
+  std::chrono::milliseconds dwell{0};
+  std::chrono::milliseconds min_foreground_interval{0};
+};
+
+struct HoverFocusState {
+  std::optional<CellIndicatorByIndex> candidate; // Hovered cell waiting to be selected
+  std::chrono::steady_clock::time_point candidate_since{};
+  std::optional<std::chrono::steady_clock::time_point> last_foreground_change;
+};
+
 struct System {
   std::vector<PositionedCluster> clusters;
   std::optional<CellIndicatorByIndex> selection; // System-wide selection
   SplitMode split_mode = SplitMode::Zigzag;      // How splits determine direction
+  HoverFocusOptions hover_focus_options;
+  HoverFocusState hover_focus;
+  LeafInterner leaf_interner; // Dense ids for leaf ids; interned when update() reconciles
+  size_t updates_since_full_diff = 0; // update() passes since the last verifying full diff
+  std::vector<size_t> parked_leaf_ids; // Windows of parked workspaces, sorted; update() skips them
 };
 
 struct ClusterInitInfo {
@@ -190,6 +262,7 @@ struct ClusterInitInfo {
   float monitor_width;
   float monitor_height;
   std::vector<size_t> initial_cell_ids; // Optional pre-assigned leaf IDs
+  size_t workspace_count = 1;           // Workspaces on this monitor (1 = no switching)
 };
 
 // ============================================================================
@@ -253,10 +326,22 @@ adjust_selected_split_ratio(System& system, float delta, float gap_horizontal, f
                                                   size_t leaf_id, const Rect& actual_window_rect,
                                                   float gap_horizontal, float gap_vertical);
 
+// Live variant of update_split_ratio_from_resize for a window that is still being resized:
+// updates the same ancestor ratios and returns new positions for the other leaves under the
+// updated ancestors only. Empty if the window only moved, nothing changed, or the cluster is in
+// zen/fullscreen mode.
+[[nodiscard]] std::vector<TileUpdate>
+live_resize_tiles(System& system, size_t cluster_index, size_t leaf_id,
+                  const Rect& actual_window_rect, float gap_horizontal, float gap_vertical);
+
 // ============================================================================
 // Cell Movement & Exchange
 // ============================================================================
 
+// Get the leaf_id of a leaf cell's sibling, nullopt if the sibling is not a leaf
+[[nodiscard]] std::optional<size_t> get_sibling_leaf_id(const CellCluster& cluster,
+                                                        int cell_index);
+
 // Get the leaf_id of the selected cell's sibling (for use with swap_cells)
 [[nodiscard]] std::optional<size_t> get_selected_sibling_leaf_id(const System& system);
 
@@ -265,12 +350,21 @@ std::optional<Point> swap_cells(System& system, size_t cluster_index1, size_t le
                                 size_t cluster_index2, size_t leaf_id2, float gap_horizontal,
                                 float gap_vertical);
 
-// Move a cell from source to target (delete + split)
+// Move a cell from source to target: the source becomes the target's sibling. Within one
+// cluster the nodes are relinked in place (no allocation, no dead cells); across clusters
+// this is move_cell_by_split.
 std::optional<MoveSuccess> move_cell(System& system, size_t source_cluster_index,
                                      size_t source_leaf_id, size_t target_cluster_index,
                                      size_t target_leaf_id, float gap_horizontal,
                                      float gap_vertical);
 
+// Move by deleting the source and splitting the target. Leaves dead cells in the source
+// cluster until it is compacted.
+std::optional<MoveSuccess> move_cell_by_split(System& system, size_t source_cluster_index,
+                                              size_t source_leaf_id, size_t target_cluster_index,
+                                              size_t target_leaf_id, float gap_horizontal,
+                                              float gap_vertical);
+
 // Perform drop move (drag-and-drop operation)
 std::optional<DropMoveResult> perform_drop_move(System& system, size_t source_leaf_id,
                                                 float cursor_x, float cursor_y,
@@ -297,14 +391,89 @@ void clear_zen(System& system, size_t cluster_index);
 // System State Updates
 // ============================================================================
 
-// Recompute all cell rectangles
+// update() passes between verifying full diffs (see update())
+constexpr size_t kFullDiffInterval = 64;
+
+// Recompute all cell rectangles, parked workspaces included
 void recompute_rects(System& system, float gap_horizontal, float gap_vertical);
 
-// Update system state with new window configuration
+// Update system state with new window configuration. With a pool, the per-cluster
+// deletions/additions run in parallel; the result is identical to the serial path.
+// now drives the hover focus dwell and foreground rate limit (see HoverFocusOptions).
+// When every reported window set matches its cluster's fingerprint the diff is skipped;
+// every kFullDiffInterval passes it runs anyway and re-derives the fingerprints from the trees.
 UpdateResult update(System& system, const std::vector<ClusterCellUpdateInfo>& cluster_cell_ids,
                     std::optional<std::pair<size_t, size_t>> new_selection,
                     std::pair<float, float> pointer_coords, float zen_percentage,
-                    size_t foreground_leaf_id, float gap_horizontal, float gap_vertical);
+                    size_t foreground_leaf_id, float gap_horizontal, float gap_vertical,
+                    ThreadPool* pool = nullptr, std::chrono::steady_clock::time_point now = {});
+
+// Pass a cursor-driven selection change through the hover focus dwell and foreground rate
+// limit. Returns the change once it is allowed; until then an empty result with pending set.
+SelectionUpdateResult filter_hover_selection(const HoverFocusOptions& options,
+                                             HoverFocusState& state,
+                                             const SelectionUpdateResult& candidate,
+                                             std::chrono::steady_clock::time_point now);
+
+// ============================================================================
+// Batch Construction
+// ============================================================================
+
+// One node of a layout built in a single pass (see build_cluster_layout). A split has both
+// children, given as indices into the node list; a leaf has neither and holds a leaf_id.
+struct LayoutNode {
+  SplitDir split_dir = SplitDir::Vertical;
+  float split_ratio = 0.5f; // Clamped to kMinSplitRatio-kMaxSplitRatio
+  std::optional<int> first_child;
+  std::optional<int> second_child;
+  std::optional<size_t> leaf_id;
+};
+
+// Replace a cluster's tree with layout (root at index 0) in one batch: the cells are written
+// in preorder and their rects computed in one pass, instead of a split and relayout per window.
+// Windows held by other clusters are taken out of them first. Windows of the cluster that the
+// layout leaves out are dropped from it; the next update() adds them back if they still exist.
+// Selection follows its window (to the layout's first leaf if the window was dropped) and zen
+// is cleared in every cluster that changed. Returns false and changes nothing if the cluster
+// does not exist or the layout is malformed (bad shape, unreachable or shared node, repeated
+// leaf id).
+bool build_cluster_layout(System& system, size_t cluster_index,
+                          const std::vector<LayoutNode>& layout, float gap_horizontal,
+                          float gap_vertical);
+
+// ============================================================================
+// Workspaces
+// ============================================================================
+
+// Most workspaces a monitor can have
+constexpr size_t kMaxWorkspaces = 9;
+
+// Windows to hide and show after a workspace switch, plus the window that takes the focus
+struct WorkspaceSwitchResult {
+  std::vector<size_t> hidden_leaf_ids;
+  std::vector<size_t> shown_leaf_ids;
+  std::optional<MoveSelectionResult> focus; // Empty if the new workspace has no windows
+};
+
+// Number of workspaces on a cluster (at least 1)
+[[nodiscard]] size_t workspace_count(const PositionedCluster& pc);
+
+// Make workspace the active one on the cluster. The active tree is parked and the workspace's
+// tree swapped in as it was left: nothing is rebuilt and no rect recomputed. The caller hides
+// and shows the listed windows; the next update() places the shown ones in one batch. A
+// selection in the cluster moves to the workspace's remembered window (its first window
+// otherwise). Nullopt if the cluster or workspace does not exist or is already active.
+std::optional<WorkspaceSwitchResult> switch_workspace(System& system, size_t cluster_index,
+                                                      size_t workspace);
+
+// Move a window from the cluster's active tree into one of its parked workspaces, next to the
+// window remembered there. The caller hides it. Returns false if the window is not in the
+// active tree or the workspace does not exist or is the active one.
+bool send_to_workspace(System& system, size_t cluster_index, size_t leaf_id, size_t workspace,
+                       float gap_horizontal, float gap_vertical);
+
+// True if the window belongs to a parked workspace
+[[nodiscard]] bool is_parked_leaf(const System& system, size_t leaf_id);
 
 // ============================================================================
 // Utilities
@@ -9,16 +9,20 @@
 #include "multi_ui.h"
 
 #include <algorithm>
+#include <array>
+#include <chrono>
 #include <cmath>
 #include <limits>
 #include <magic_enum/magic_enum.hpp>
 #include <optional>
 #include <string>
+#include <utility>
 
 #include "model.h"
 #include "options.h"
 #include "raylib.h"
 #include "spdlog/spdlog.h"
+#include "stress_workload.h"
 
 namespace wintiler {
 
@@ -267,18 +271,93 @@ std::optional<HotkeyAction> get_key_action() {
     return HotkeyAction::CycleSplitMode;
   if (IsKeyPressed(KEY_HOME))
     return HotkeyAction::ResetSplitRatio;
+  if (IsKeyPressed(KEY_N))
+    return HotkeyAction::NextWorkspace;
+  if (IsKeyPressed(KEY_P))
+    return HotkeyAction::PrevWorkspace;
+  if (IsKeyPressed(KEY_M))
+    return HotkeyAction::SendToNextWorkspace;
+  if (IsKeyPressed(KEY_B))
+    return HotkeyAction::SendToPrevWorkspace;
   return std::nullopt;
 }
 
+// Next or previous workspace of the selected cell's monitor, wrapping around
+std::optional<std::pair<size_t, size_t>> selected_workspace_target(const cells::System& system,
+                                                                   bool forward) {
+  if (!system.selection.has_value()) {
+    return std::nullopt;
+  }
+  size_t cluster_index = system.selection->cluster_index;
+  const auto& pc = system.clusters[cluster_index];
+  size_t count = cells::workspace_count(pc);
+  return std::pair{cluster_index, (pc.active_workspace + (forward ? 1 : count - 1)) % count};
+}
+
+// Cell border styles, in draw order so the selection ends up on top
+enum class BorderKind { Normal, Stored, Selected, SelectedStored, Count };
+constexpr size_t kBorderKindCount = static_cast<size_t>(BorderKind::Count);
+
+struct CellLabel {
+  Rectangle rect;
+  std::string text;
+};
+
+// Stress mode leaves out labels of cells smaller than this on screen; at 500+ windows the
+// text dominates draw time and is unreadable anyway
+constexpr float kStressMinLabelSize = 48.0f;
+constexpr size_t kStressLeafIdOffset = 1'000'000;
+
+// Frame graph: one bar per held frame, engine time stacked under draw time
+constexpr float kGraphBarWidth = 1.0f;
+constexpr float kGraphHeight = 80.0f;
+constexpr float kGraphMaxMs = 33.3f;
+
+void draw_stress_overlay(const FrameTimeHistory& history, const StressWorkload& workload,
+                         size_t windows, int screen_height) {
+  float width = static_cast<float>(FrameTimeHistory::kCapacity) * kGraphBarWidth;
+  float x0 = 10.0f;
+  float y0 = static_cast<float>(screen_height) - kGraphHeight - 10.0f;
+  DrawRectangleRec({x0, y0, width, kGraphHeight}, Fade(BLACK, 0.6f));
+
+  auto bar_height = [](float ms) { return std::min(ms, kGraphMaxMs) / kGraphMaxMs * kGraphHeight; };
+  for (size_t i = 0; i < history.size(); ++i) {
+    const auto& sample = history.at(i);
+    float x = x0 + static_cast<float>(i) * kGraphBarWidth;
+    float update_h = bar_height(sample.update_ms);
+    float draw_h = std::min(bar_height(sample.draw_ms), kGraphHeight - update_h);
+    float bottom = y0 + kGraphHeight;
+    DrawRectangleRec({x, bottom - update_h, kGraphBarWidth, update_h}, RED);
+    DrawRectangleRec({x, bottom - update_h - draw_h, kGraphBarWidth, draw_h}, SKYBLUE);
+  }
+  // 60 FPS budget
+  float budget_y = y0 + kGraphHeight - bar_height(1000.0f / 60.0f);
+  DrawLineEx({x0, budget_y}, {x0 + width, budget_y}, 1.0f, YELLOW);
+
+  auto summary = history.summary();
+  auto text = fmt::format("{} windows  +{} -{}  frame {:.1f}ms  update avg {:.2f} max {:.2f}ms  "
+                          "draw avg {:.2f} max {:.2f}ms",
+                          windows, workload.total_spawned(), workload.total_killed(),
+                          GetFrameTime() * 1000.0f, summary.update_avg_ms, summary.update_max_ms,
+                          summary.draw_avg_ms, summary.draw_max_ms);
+  DrawText(text.c_str(), static_cast<int>(x0), static_cast<int>(y0) - 22, 18, DARKGRAY);
+}
+
 } // namespace
 
 void run_raylib_ui_multi_cluster(const std::vector<cells::ClusterInitInfo>& infos,
-                                 GlobalOptionsProvider& options_provider) {
+                                 GlobalOptionsProvider& options_provider,
+                                 const std::optional<StressOptions>& stress) {
   const auto& options = options_provider.options;
 
+  auto workspace_infos = infos;
+  for (auto& info : workspace_infos) {
+    info.workspace_count = static_cast<size_t>(options.workspaceOptions.count);
+  }
+
   MultiClusterAppState app_state;
-  app_state.system =
-      cells::create_system(infos, options.gapOptions.horizontal, options.gapOptions.vertical);
+  app_state.system = cells::create_system(workspace_infos, options.gapOptions.horizontal,
+                                          options.gapOptions.vertical);
 
   // Set next_process_id to avoid collisions with any pre-existing leaf IDs
   size_t next_process_id = CELL_ID_START;
@@ -308,6 +387,20 @@ void run_raylib_ui_multi_cluster(const std::vector<cells::ClusterInitInfo>& info
   float gap_h = options.gapOptions.horizontal;
   float gap_v = options.gapOptions.vertical;
 
+  // Stress mode: synthetic processes spawn and die every frame; engine and draw time are
+  // measured separately for the graph
+  using Clock = std::chrono::steady_clock;
+  std::optional<StressWorkload> workload;
+  if (stress.has_value()) {
+    // Synthetic ids live far above the ones SPACE hands out, so the two never collide
+    workload.emplace(*stress, next_process_id + kStressLeafIdOffset);
+    spdlog::info("Stress mode: {} windows on {} monitors, {}/s churn", stress->target_windows,
+                 app_state.system.clusters.size(), stress->churn_per_second);
+  }
+  FrameTimeHistory frame_history;
+  std::array<std::vector<Rectangle>, kBorderKindCount> border_runs;
+  std::vector<CellLabel> labels;
+
   while (!WindowShouldClose()) {
     // Check for config changes and hot-reload
     if (options_provider.refresh()) {
@@ -335,6 +428,20 @@ void run_raylib_ui_multi_cluster(const std::vector<cells::ClusterInitInfo>& info
     }
     // Note: Empty clusters no longer maintain "selected" state - selection requires a cell
 
+    float update_ms = 0.0f;
+    size_t stress_windows = 0;
+    if (workload.has_value()) {
+      auto start = Clock::now();
+      auto tick = workload->tick(app_state.system, GetFrameTime());
+      stress_windows = 0;
+      for (const auto& cluster : tick.state) {
+        stress_windows += cluster.leaf_ids.size();
+      }
+      apply_stress_tick(app_state.system, tick, {global_x, global_y},
+                        options.visualizationOptions.renderOptions.zen_percentage, gap_h, gap_v);
+      update_ms = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+    }
+
     // Keyboard input (actions not in HotkeyAction enum)
     if (IsKeyPressed(KEY_SPACE)) {
       add_new_process_multi(app_state, next_process_id, vt, gap_h, gap_v);
@@ -484,6 +591,36 @@ void run_raylib_ui_multi_cluster(const std::vector<cells::ClusterInitInfo>& info
           center_mouse_on_point(vt, *center);
         }
         break;
+      case HotkeyAction::DumpFlightRecorder:
+        spdlog::info("DumpFlightRecorder: no flight recorder in multi_ui");
+        break;
+      case HotkeyAction::NextWorkspace:
+      case HotkeyAction::PrevWorkspace:
+        if (auto target = selected_workspace_target(
+                app_state.system, *action == HotkeyAction::NextWorkspace)) {
+          spdlog::info("Workspace: monitor {} to workspace {}", target->first,
+                       target->second + 1);
+          auto result = cells::switch_workspace(app_state.system, target->first, target->second);
+          if (result.has_value() && result->focus.has_value()) {
+            center_mouse_on_point(vt, result->focus->center);
+          }
+        }
+        break;
+      case HotkeyAction::SendToNextWorkspace:
+      case HotkeyAction::SendToPrevWorkspace:
+        if (auto target = selected_workspace_target(
+                app_state.system, *action == HotkeyAction::SendToNextWorkspace)) {
+          const auto& pc = app_state.system.clusters[target->first];
+          const auto& cell =
+              pc.cluster.cells[static_cast<size_t>(app_state.system.selection->cell_index)];
+          if (cell.leaf_id.has_value() &&
+              !cells::send_to_workspace(app_state.system, target->first, *cell.leaf_id,
+                                        target->second, gap_h, gap_v)) {
+            spdlog::error("SendToWorkspace: failed to send cell to workspace {}",
+                          target->second + 1);
+          }
+        }
+        break;
       case HotkeyAction::Exit:
         spdlog::info("Exit: exit action (not implemented in multi_ui)");
         // Not implemented in multi_ui
@@ -492,6 +629,7 @@ void run_raylib_ui_multi_cluster(const std::vector<cells::ClusterInitInfo>& info
     }
 
     // Drawing
+    auto draw_start = Clock::now();
     BeginDrawing();
     ClearBackground(RAYWHITE);
 
@@ -505,11 +643,22 @@ void run_raylib_ui_multi_cluster(const std::vector<cells::ClusterInitInfo>& info
       DrawRectangleLinesEx(screen_rect, 2.0f, DARKGRAY);
     }
 
-    // Draw cells
+    // Draw cells. Borders are collected per color and drawn in runs, then all labels, so the
+    // shape batch is not broken up by text for every cell.
     const auto& selected_cell = app_state.system.selection;
+    const auto& ro = options.visualizationOptions.renderOptions;
+    for (auto& run : border_runs) {
+      run.clear();
+    }
+    labels.clear();
 
     for (size_t cluster_idx = 0; cluster_idx < app_state.system.clusters.size(); ++cluster_idx) {
       const auto& pc = app_state.system.clusters[cluster_idx];
+      std::optional<int> stored_idx;
+      if (stored_cell.has_value() && stored_cell->cluster_index == cluster_idx) {
+        stored_idx = cells::find_cell_by_leaf_id(pc.cluster, stored_cell->leaf_id);
+      }
+
       for (int i = 0; i < static_cast<int>(pc.cluster.cells.size()); ++i) {
         if (!cells::is_leaf(pc.cluster, i)) {
           continue;
@@ -522,50 +671,57 @@ void run_raylib_ui_multi_cluster(const std::vector<cells::ClusterInitInfo>& info
         bool is_selected = selected_cell.has_value() &&
                            selected_cell->cluster_index == cluster_idx &&
                            selected_cell->cell_index == i;
-
-        // Check if this cell is the stored cell
-        bool is_stored_cell = false;
-        if (stored_cell.has_value() && stored_cell->cluster_index == cluster_idx) {
-          auto stored_idx = cells::find_cell_by_leaf_id(pc.cluster, stored_cell->leaf_id);
-          if (stored_idx.has_value() && *stored_idx == i) {
-            is_stored_cell = true;
-          }
-        }
-
-        // Determine border color and width from VisualizationOptions
-        const auto& ro = options.visualizationOptions.renderOptions;
-        Color border_color;
-        float border_width;
-        if (is_selected && is_stored_cell) {
-          border_color = PURPLE;
-          border_width = ro.border_width + 1.0f;
-        } else if (is_stored_cell) {
-          border_color = to_raylib_color(ro.stored_color);
-          border_width = ro.border_width;
-        } else if (is_selected) {
-          border_color = to_raylib_color(ro.selected_color);
-          border_width = ro.border_width;
-        } else {
-          border_color = to_raylib_color(ro.normal_color);
-          border_width = ro.border_width;
+        bool is_stored_cell = stored_idx.has_value() && *stored_idx == i;
+
+        BorderKind kind = is_selected && is_stored_cell ? BorderKind::SelectedStored
+                          : is_stored_cell              ? BorderKind::Stored
+                          : is_selected                 ? BorderKind::Selected
+                                                        : BorderKind::Normal;
+        border_runs[static_cast<size_t>(kind)].push_back(screen_rect);
+
+        // Label with the process ID (leaf_id is the process ID)
+        bool label_fits = !workload.has_value() ||
+                          std::min(screen_rect.width, screen_rect.height) >= kStressMinLabelSize;
+        if (cell.leaf_id.has_value() && label_fits) {
+          labels.push_back({screen_rect, "P:" + std::to_string(*cell.leaf_id)});
         }
+      }
+    }
 
-        DrawRectangleLinesEx(screen_rect, border_width, border_color);
+    // Border color and width from VisualizationOptions
+    for (size_t k = 0; k < kBorderKindCount; ++k) {
+      Color border_color;
+      float border_width = ro.border_width;
+      switch (static_cast<BorderKind>(k)) {
+      case BorderKind::SelectedStored:
+        border_color = PURPLE;
+        border_width = ro.border_width + 1.0f;
+        break;
+      case BorderKind::Stored:
+        border_color = to_raylib_color(ro.stored_color);
+        break;
+      case BorderKind::Selected:
+        border_color = to_raylib_color(ro.selected_color);
+        break;
+      default:
+        border_color = to_raylib_color(ro.normal_color);
+        break;
+      }
+      for (const auto& rect : border_runs[k]) {
+        DrawRectangleLinesEx(rect, border_width, border_color);
+      }
+    }
 
-        // Draw process ID (leaf_id is the process ID)
-        if (cell.leaf_id.has_value()) {
-          std::string label_text = "P:" + std::to_string(*cell.leaf_id);
-          float font_size = std::min(screen_rect.width, screen_rect.height) * 0.2f;
-          if (font_size < 10.0f)
-            font_size = 10.0f;
+    for (const auto& label : labels) {
+      float font_size = std::min(label.rect.width, label.rect.height) * 0.2f;
+      if (font_size < 10.0f)
+        font_size = 10.0f;
 
-          int text_width = MeasureText(label_text.c_str(), (int)font_size);
-          int text_x = (int)(screen_rect.x + (screen_rect.width - text_width) / 2);
-          int text_y = (int)(screen_rect.y + (screen_rect.height - font_size) / 2);
+      int text_width = MeasureText(label.text.c_str(), (int)font_size);
+      int text_x = (int)(label.rect.x + (label.rect.width - text_width) / 2);
+      int text_y = (int)(label.rect.y + (label.rect.height - font_size) / 2);
 
-          DrawText(label_text.c_str(), text_x, text_y, (int)font_size, DARKGRAY);
-        }
-      }
+      DrawText(label.text.c_str(), text_x, text_y, (int)font_size, DARKGRAY);
     }
 
     // Draw zen cell overlays for each cluster
@@ -610,9 +766,26 @@ void run_raylib_ui_multi_cluster(const std::vector<cells::ClusterInitInfo>& info
       }
     }
 
+    if (workload.has_value()) {
+      draw_stress_overlay(frame_history, *workload, stress_windows, screen_height);
+      // EndDrawing waits for the frame limiter, so draw time stops before it
+      frame_history.push(update_ms,
+                         std::chrono::duration<float, std::milli>(Clock::now() - draw_start)
+                             .count());
+    }
+
     EndDrawing();
   }
 
+  if (workload.has_value()) {
+    auto summary = frame_history.summary();
+    spdlog::info("Stress mode: {} spawned, {} killed; last {} frames update avg {:.2f}ms max "
+                 "{:.2f}ms, draw avg {:.2f}ms max {:.2f}ms",
+                 workload->total_spawned(), workload->total_killed(), frame_history.size(),
+                 summary.update_avg_ms, summary.update_max_ms, summary.draw_avg_ms,
+                 summary.draw_max_ms);
+  }
+
   CloseWindow();
 }
 
@@ -1,13 +1,18 @@
 #pragma once
 
+#include <optional>
 #include <vector>
 
 #include "multi_cells.h"
 #include "options.h"
+#include "stress_workload.h"
 
 namespace wintiler {
 
+// With stress options, synthetic processes are spawned and killed every frame and an
+// engine/draw frame time graph is shown
 void run_raylib_ui_multi_cluster(const std::vector<cells::ClusterInitInfo>& infos,
-                                 GlobalOptionsProvider& options_provider);
+                                 GlobalOptionsProvider& options_provider,
+                                 const std::optional<StressOptions>& stress = std::nullopt);
 
 } // namespace wintiler
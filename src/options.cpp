@@ -45,6 +45,16 @@ std::string hotkey_action_to_string(HotkeyAction action) {
     return "ToggleZen";
   case HotkeyAction::ResetSplitRatio:
     return "ResetSplitRatio";
+  case HotkeyAction::DumpFlightRecorder:
+    return "DumpFlightRecorder";
+  case HotkeyAction::NextWorkspace:
+    return "NextWorkspace";
+  case HotkeyAction::PrevWorkspace:
+    return "PrevWorkspace";
+  case HotkeyAction::SendToNextWorkspace:
+    return "SendToNextWorkspace";
+  case HotkeyAction::SendToPrevWorkspace:
+    return "SendToPrevWorkspace";
   }
   return "Unknown";
 }
@@ -82,6 +92,16 @@ std::optional<HotkeyAction> string_to_hotkey_action(const std::string& str) {
     return HotkeyAction::ToggleZen;
   if (str == "ResetSplitRatio")
     return HotkeyAction::ResetSplitRatio;
+  if (str == "DumpFlightRecorder")
+    return HotkeyAction::DumpFlightRecorder;
+  if (str == "NextWorkspace")
+    return HotkeyAction::NextWorkspace;
+  if (str == "PrevWorkspace")
+    return HotkeyAction::PrevWorkspace;
+  if (str == "SendToNextWorkspace")
+    return HotkeyAction::SendToNextWorkspace;
+  if (str == "SendToPrevWorkspace")
+    return HotkeyAction::SendToPrevWorkspace;
   return std::nullopt;
 }
 
@@ -119,10 +139,42 @@ std::string get_default_hotkey(HotkeyAction action) {
     return "super+shift+'";
   case HotkeyAction::ResetSplitRatio:
     return "super+shift+home";
+  case HotkeyAction::DumpFlightRecorder:
+    return "super+shift+insert";
+  case HotkeyAction::NextWorkspace:
+    return "super+shift+n";
+  case HotkeyAction::PrevWorkspace:
+    return "super+shift+p";
+  case HotkeyAction::SendToNextWorkspace:
+    return "super+ctrl+shift+n";
+  case HotkeyAction::SendToPrevWorkspace:
+    return "super+ctrl+shift+p";
   }
   return "";
 }
 
+std::string power_mode_to_string(PowerMode mode) {
+  switch (mode) {
+  case PowerMode::Auto:
+    return "auto";
+  case PowerMode::Performance:
+    return "performance";
+  case PowerMode::LowPower:
+    return "low-power";
+  }
+  return "auto";
+}
+
+std::optional<PowerMode> string_to_power_mode(const std::string& str) {
+  if (str == "auto")
+    return PowerMode::Auto;
+  if (str == "performance")
+    return PowerMode::Performance;
+  if (str == "low-power")
+    return PowerMode::LowPower;
+  return std::nullopt;
+}
+
 // Helper to read a numeric value, accepting both float and integer TOML types
 template <typename T>
 std::optional<T> get_number(const toml::node_view<toml::node>& node) {
@@ -135,6 +187,116 @@ std::optional<T> get_number(const toml::node_view<toml::node>& node) {
   return std::nullopt;
 }
 
+const char* split_dir_to_string(cells::SplitDir dir) {
+  switch (dir) {
+  case cells::SplitDir::Vertical:
+    return "vertical";
+  case cells::SplitDir::Horizontal:
+    return "horizontal";
+  }
+  return "vertical";
+}
+
+std::optional<cells::SplitDir> string_to_split_dir(const std::string& str) {
+  if (str == "vertical")
+    return cells::SplitDir::Vertical;
+  if (str == "horizontal")
+    return cells::SplitDir::Horizontal;
+  return std::nullopt;
+}
+
+// Parse a layout template node and its subtree into layout.nodes (preorder). A table with
+// 'split' is a split with 'first' and 'second' tables, any other table a slot whose
+// 'process', 'class' and 'title' keys form its match rule. Returns the node's index.
+tl::expected<int, std::string> parse_layout_node(toml::table& node, LayoutTemplate& layout,
+                                                 int depth) {
+  if (depth > kMaxLayoutTemplateDepth) {
+    return tl::unexpected("splits nested deeper than " + std::to_string(kMaxLayoutTemplateDepth));
+  }
+  int index = static_cast<int>(layout.nodes.size());
+  layout.nodes.emplace_back();
+
+  auto split = node["split"].as_string();
+  if (!split) {
+    if (node["first"] || node["second"]) {
+      return tl::unexpected(std::string("'first'/'second' given without 'split'"));
+    }
+    auto& rule = layout.nodes[static_cast<size_t>(index)].match;
+    if (auto process = node["process"].as_string()) {
+      rule.process = process->get();
+    }
+    if (auto class_name = node["class"].as_string()) {
+      rule.class_name = class_name->get();
+    }
+    if (auto title = node["title"].as_string()) {
+      rule.title = title->get();
+    }
+    return index;
+  }
+
+  auto dir = string_to_split_dir(split->get());
+  if (!dir) {
+    return tl::unexpected("invalid split '" + split->get() + "' (expected vertical or horizontal)");
+  }
+  float ratio = 0.5f;
+  if (node["ratio"]) {
+    auto parsed = get_number<float>(node["ratio"]);
+    if (!parsed) {
+      return tl::unexpected(std::string("'ratio' must be a number"));
+    }
+    ratio = *parsed;
+  }
+  if (ratio < cells::kMinSplitRatio || ratio > cells::kMaxSplitRatio) {
+    spdlog::error("Invalid layout ratio ({}): must be between {} and {}. Clamping.", ratio,
+                  cells::kMinSplitRatio, cells::kMaxSplitRatio);
+    ratio = std::clamp(ratio, cells::kMinSplitRatio, cells::kMaxSplitRatio);
+  }
+
+  auto first = node["first"].as_table();
+  auto second = node["second"].as_table();
+  if (!first || !second) {
+    return tl::unexpected(std::string("split needs 'first' and 'second' tables"));
+  }
+  auto first_index = parse_layout_node(*first, layout, depth + 1);
+  if (!first_index) {
+    return first_index;
+  }
+  auto second_index = parse_layout_node(*second, layout, depth + 1);
+  if (!second_index) {
+    return second_index;
+  }
+
+  auto& parsed = layout.nodes[static_cast<size_t>(index)];
+  parsed.split_dir = *dir;
+  parsed.split_ratio = ratio;
+  parsed.first_child = *first_index;
+  parsed.second_child = *second_index;
+  return index;
+}
+
+// Inverse of parse_layout_node
+toml::table layout_node_to_toml(const LayoutTemplate& layout, int index) {
+  const auto& node = layout.nodes[static_cast<size_t>(index)];
+  toml::table out;
+  if (node.first_child.has_value() && node.second_child.has_value()) {
+    out.insert("split", split_dir_to_string(node.split_dir));
+    out.insert("ratio", node.split_ratio);
+    out.insert("first", layout_node_to_toml(layout, *node.first_child));
+    out.insert("second", layout_node_to_toml(layout, *node.second_child));
+    return out;
+  }
+  if (!node.match.process.empty()) {
+    out.insert("process", node.match.process);
+  }
+  if (!node.match.class_name.empty()) {
+    out.insert("class", node.match.class_name);
+  }
+  if (!node.match.title.empty()) {
+    out.insert("title", node.match.title);
+  }
+  return out;
+}
+
 } // anonymous namespace
 
 IgnoreOptions get_default_ignore_options() {
@@ -243,8 +405,50 @@ tl::expected<void, std::string> write_options_toml(const GlobalOptions& options,
     // Build loop section
     toml::table loop;
     loop.insert("interval_ms", options.loopOptions.intervalMs);
+    loop.insert("adaptive", options.loopOptions.adaptive);
+    loop.insert("min_interval_ms", options.loopOptions.minIntervalMs);
+    loop.insert("max_interval_ms", options.loopOptions.maxIntervalMs);
     root.insert("loop", loop);
 
+    // Build ipc section
+    toml::table ipc;
+    ipc.insert("enabled", options.ipcOptions.enabled);
+    ipc.insert("endpoint", options.ipcOptions.endpoint);
+    root.insert("ipc", ipc);
+
+    // Build watchdog section
+    toml::table watchdog;
+    watchdog.insert("enabled", options.watchdogOptions.enabled);
+    watchdog.insert("budget_ms", options.watchdogOptions.budgetMs);
+    watchdog.insert("check_interval_ms", options.watchdogOptions.checkIntervalMs);
+    watchdog.insert("minidump", options.watchdogOptions.minidump);
+    watchdog.insert("dump_directory", options.watchdogOptions.dumpDirectory);
+    root.insert("watchdog", watchdog);
+
+    // Build power section
+    toml::table power;
+    power.insert("mode", power_mode_to_string(options.powerOptions.mode));
+    power.insert("low_power_min_interval_ms", options.powerOptions.lowPowerMinIntervalMs);
+    power.insert("low_power_max_interval_ms", options.powerOptions.lowPowerMaxIntervalMs);
+    root.insert("power", power);
+
+    // Build focus section
+    toml::table focus;
+    focus.insert("hover_dwell_ms", options.focusOptions.hoverDwellMs);
+    focus.insert("min_foreground_interval_ms", options.focusOptions.minForegroundIntervalMs);
+    root.insert("focus", focus);
+
+    // Build resize section
+    toml::table resize;
+    resize.insert("live", options.resizeOptions.live);
+    resize.insert("max_rate_hz", options.resizeOptions.maxRateHz);
+    root.insert("resize", resize);
+
+    // Build workspaces section
+    toml::table workspaces;
+    workspaces.insert("count", options.workspaceOptions.count);
+    root.insert("workspaces", workspaces);
+
     // Build visualization section with nested render
     toml::table visualization;
     toml::table render;
@@ -267,6 +471,20 @@ tl::expected<void, std::string> write_options_toml(const GlobalOptions& options,
     visualization.insert("toast_duration_ms", options.visualizationOptions.toastDurationMs);
     root.insert("visualization", visualization);
 
+    // Build layouts array (omitted when there are none)
+    if (!options.layouts.empty()) {
+      toml::array layouts;
+      for (const auto& layout : options.layouts) {
+        toml::table entry;
+        entry.insert("name", layout.name);
+        if (!layout.nodes.empty()) {
+          entry.insert("root", layout_node_to_toml(layout, 0));
+        }
+        layouts.push_back(entry);
+      }
+      root.insert("layouts", layouts);
+    }
+
     // Write to file
     std::ofstream file(filepath);
     if (!file) {
@@ -496,6 +714,15 @@ tl::expected<GlobalOptions, std::string> read_options_toml(const std::filesystem
       if (auto intervalMs = (*loop)["interval_ms"].as_integer()) {
         options.loopOptions.intervalMs = static_cast<int>(intervalMs->get());
       }
+      if (auto adaptive = (*loop)["adaptive"].as_boolean()) {
+        options.loopOptions.adaptive = adaptive->get();
+      }
+      if (auto minIntervalMs = (*loop)["min_interval_ms"].as_integer()) {
+        options.loopOptions.minIntervalMs = static_cast<int>(minIntervalMs->get());
+      }
+      if (auto maxIntervalMs = (*loop)["max_interval_ms"].as_integer()) {
+        options.loopOptions.maxIntervalMs = static_cast<int>(maxIntervalMs->get());
+      }
     }
 
     // Validate loop interval - negative values not allowed
@@ -505,6 +732,143 @@ tl::expected<GlobalOptions, std::string> read_options_toml(const std::filesystem
       options.loopOptions.intervalMs = kDefaultLoopIntervalMs;
     }
 
+    // Validate adaptive bounds - positive and min <= max
+    if (options.loopOptions.minIntervalMs <= 0 ||
+        options.loopOptions.maxIntervalMs < options.loopOptions.minIntervalMs) {
+      spdlog::error("Invalid loop.min_interval_ms/max_interval_ms ({}/{}): need 0 < min <= max. "
+                    "Using defaults.",
+                    options.loopOptions.minIntervalMs, options.loopOptions.maxIntervalMs);
+      options.loopOptions.minIntervalMs = kDefaultLoopMinIntervalMs;
+      options.loopOptions.maxIntervalMs = kDefaultLoopMaxIntervalMs;
+    }
+
+    // Parse ipc section
+    if (auto ipc = tbl["ipc"].as_table()) {
+      if (auto enabled = (*ipc)["enabled"].as_boolean()) {
+        options.ipcOptions.enabled = enabled->get();
+      }
+      if (auto endpoint = (*ipc)["endpoint"].as_string()) {
+        options.ipcOptions.endpoint = endpoint->get();
+      }
+    }
+
+    // Parse watchdog section
+    if (auto watchdog = tbl["watchdog"].as_table()) {
+      if (auto enabled = (*watchdog)["enabled"].as_boolean()) {
+        options.watchdogOptions.enabled = enabled->get();
+      }
+      if (auto budgetMs = (*watchdog)["budget_ms"].as_integer()) {
+        options.watchdogOptions.budgetMs = static_cast<int>(budgetMs->get());
+      }
+      if (auto checkIntervalMs = (*watchdog)["check_interval_ms"].as_integer()) {
+        options.watchdogOptions.checkIntervalMs = static_cast<int>(checkIntervalMs->get());
+      }
+      if (auto minidump = (*watchdog)["minidump"].as_boolean()) {
+        options.watchdogOptions.minidump = minidump->get();
+      }
+      if (auto dumpDirectory = (*watchdog)["dump_directory"].as_string()) {
+        options.watchdogOptions.dumpDirectory = dumpDirectory->get();
+      }
+    }
+
+    // Validate watchdog timings - must be positive
+    if (options.watchdogOptions.budgetMs <= 0) {
+      spdlog::error("Invalid watchdog.budget_ms value ({}): must be positive. Using default.",
+                    options.watchdogOptions.budgetMs);
+      options.watchdogOptions.budgetMs = kDefaultWatchdogBudgetMs;
+    }
+    if (options.watchdogOptions.checkIntervalMs <= 0) {
+      spdlog::error(
+          "Invalid watchdog.check_interval_ms value ({}): must be positive. Using default.",
+          options.watchdogOptions.checkIntervalMs);
+      options.watchdogOptions.checkIntervalMs = kDefaultWatchdogCheckIntervalMs;
+    }
+
+    // Parse power section
+    if (auto power = tbl["power"].as_table()) {
+      if (auto mode = (*power)["mode"].as_string()) {
+        if (auto parsed = string_to_power_mode(mode->get())) {
+          options.powerOptions.mode = *parsed;
+        } else {
+          spdlog::error("Invalid power.mode value ({}): expected auto, performance or low-power. "
+                        "Using auto.",
+                        mode->get());
+        }
+      }
+      if (auto minMs = (*power)["low_power_min_interval_ms"].as_integer()) {
+        options.powerOptions.lowPowerMinIntervalMs = static_cast<int>(minMs->get());
+      }
+      if (auto maxMs = (*power)["low_power_max_interval_ms"].as_integer()) {
+        options.powerOptions.lowPowerMaxIntervalMs = static_cast<int>(maxMs->get());
+      }
+    }
+
+    // Validate low-power bounds - positive and min <= max
+    if (options.powerOptions.lowPowerMinIntervalMs <= 0 ||
+        options.powerOptions.lowPowerMaxIntervalMs < options.powerOptions.lowPowerMinIntervalMs) {
+      spdlog::error("Invalid power.low_power_min/max_interval_ms ({}/{}): need 0 < min <= max. "
+                    "Using defaults.",
+                    options.powerOptions.lowPowerMinIntervalMs,
+                    options.powerOptions.lowPowerMaxIntervalMs);
+      options.powerOptions.lowPowerMinIntervalMs = kDefaultLowPowerMinIntervalMs;
+      options.powerOptions.lowPowerMaxIntervalMs = kDefaultLowPowerMaxIntervalMs;
+    }
+
+    // Parse focus section
+    if (auto focus = tbl["focus"].as_table()) {
+      if (auto dwellMs = (*focus)["hover_dwell_ms"].as_integer()) {
+        options.focusOptions.hoverDwellMs = static_cast<int>(dwellMs->get());
+      }
+      if (auto intervalMs = (*focus)["min_foreground_interval_ms"].as_integer()) {
+        options.focusOptions.minForegroundIntervalMs = static_cast<int>(intervalMs->get());
+      }
+    }
+
+    // Validate focus timings - zero disables, negative is invalid
+    if (options.focusOptions.hoverDwellMs < 0) {
+      spdlog::error("Invalid focus.hover_dwell_ms value ({}): must not be negative. Using default.",
+                    options.focusOptions.hoverDwellMs);
+      options.focusOptions.hoverDwellMs = kDefaultHoverDwellMs;
+    }
+    if (options.focusOptions.minForegroundIntervalMs < 0) {
+      spdlog::error("Invalid focus.min_foreground_interval_ms value ({}): must not be negative. "
+                    "Using default.",
+                    options.focusOptions.minForegroundIntervalMs);
+      options.focusOptions.minForegroundIntervalMs = kDefaultMinForegroundIntervalMs;
+    }
+
+    // Parse resize section
+    if (auto resize = tbl["resize"].as_table()) {
+      if (auto live = (*resize)["live"].as_boolean()) {
+        options.resizeOptions.live = live->get();
+      }
+      if (auto maxRateHz = (*resize)["max_rate_hz"].as_integer()) {
+        options.resizeOptions.maxRateHz = static_cast<int>(maxRateHz->get());
+      }
+    }
+
+    // Validate resize rate cap - zero means no cap, negative is invalid
+    if (options.resizeOptions.maxRateHz < 0) {
+      spdlog::error("Invalid resize.max_rate_hz value ({}): must not be negative. Using default.",
+                    options.resizeOptions.maxRateHz);
+      options.resizeOptions.maxRateHz = kDefaultLiveResizeMaxRateHz;
+    }
+
+    // Parse workspaces section
+    if (auto workspaces = tbl["workspaces"].as_table()) {
+      if (auto count = (*workspaces)["count"].as_integer()) {
+        options.workspaceOptions.count = static_cast<int>(count->get());
+      }
+    }
+
+    // Validate workspace count
+    if (options.workspaceOptions.count < 1 ||
+        options.workspaceOptions.count > static_cast<int>(cells::kMaxWorkspaces)) {
+      spdlog::error("Invalid workspaces.count value ({}): must be between 1 and {}. Using default.",
+                    options.workspaceOptions.count, cells::kMaxWorkspaces);
+      options.workspaceOptions.count = kDefaultWorkspaceCount;
+    }
+
     // Parse visualization section with nested render
     if (auto visualization = tbl["visualization"].as_table()) {
       auto parseColor = [](const toml::array* arr) -> std::optional<overlay::Color> {
@@ -595,6 +959,35 @@ tl::expected<GlobalOptions, std::string> read_options_toml(const std::filesystem
       ro.zen_percentage = 1.0f;
     }
 
+    // Parse layouts - an invalid template is skipped as a whole
+    if (auto layouts = tbl["layouts"].as_array()) {
+      for (size_t i = 0; i < layouts->size(); ++i) {
+        auto entry = (*layouts)[i].as_table();
+        auto name = entry ? (*entry)["name"].as_string() : nullptr;
+        if (!name || name->get().empty()) {
+          spdlog::error("Invalid layouts[{}]: missing 'name'. Skipping.", i);
+          continue;
+        }
+        if (find_layout_template(options.layouts, name->get()) != nullptr) {
+          spdlog::error("Invalid layout '{}': name already used. Skipping.", name->get());
+          continue;
+        }
+        auto root_node = (*entry)["root"].as_table();
+        if (!root_node) {
+          spdlog::error("Invalid layout '{}': missing 'root' table. Skipping.", name->get());
+          continue;
+        }
+        LayoutTemplate layout;
+        layout.name = name->get();
+        auto parsed = parse_layout_node(*root_node, layout, 0);
+        if (!parsed) {
+          spdlog::error("Invalid layout '{}': {}. Skipping.", layout.name, parsed.error());
+          continue;
+        }
+        options.layouts.push_back(std::move(layout));
+      }
+    }
+
     return options;
   } catch (const toml::parse_error& e) {
     return tl::unexpected(std::string("TOML parse error: ") + e.what());
@@ -8,6 +8,7 @@
 #include <variant>
 #include <vector>
 
+#include "layout_template.h"
 #include "overlay.h"
 
 namespace wintiler {
@@ -49,7 +50,12 @@ enum class HotkeyAction {
   SplitDecrease,
   ExchangeSiblings,
   ToggleZen,
-  ResetSplitRatio
+  ResetSplitRatio,
+  DumpFlightRecorder,
+  NextWorkspace,
+  PrevWorkspace,
+  SendToNextWorkspace,
+  SendToPrevWorkspace
 };
 
 // Maps a hotkey action to its keyboard shortcut string
@@ -69,6 +75,36 @@ constexpr float kDefaultGapVertical = 10.0f;
 // Default loop interval
 constexpr int kDefaultLoopIntervalMs = 100;
 
+// Default adaptive loop interval bounds
+constexpr bool kDefaultLoopAdaptive = true;
+constexpr int kDefaultLoopMinIntervalMs = 50;
+constexpr int kDefaultLoopMaxIntervalMs = 1000;
+
+// Default IPC command server state. Off: the channel can move and focus any window, so it is
+// opt-in.
+constexpr bool kDefaultIpcEnabled = false;
+
+// Default loop stall watchdog settings
+constexpr bool kDefaultWatchdogEnabled = true;
+constexpr int kDefaultWatchdogBudgetMs = 2000;
+constexpr int kDefaultWatchdogCheckIntervalMs = 250;
+constexpr bool kDefaultWatchdogMinidump = false;
+
+// Default power profile settings
+constexpr int kDefaultLowPowerMinIntervalMs = 250;
+constexpr int kDefaultLowPowerMaxIntervalMs = 3000;
+
+// Default hover focus hysteresis
+constexpr int kDefaultHoverDwellMs = 120;
+constexpr int kDefaultMinForegroundIntervalMs = 250;
+
+// Default live resize settings
+constexpr bool kDefaultLiveResize = true;
+constexpr int kDefaultLiveResizeMaxRateHz = 0;
+
+// Default workspaces per monitor
+constexpr int kDefaultWorkspaceCount = 4;
+
 // Default zen percentage (0.0-1.0 range, 1.0 = full cluster)
 constexpr float kDefaultZenPercentage = 0.85f;
 
@@ -81,6 +117,9 @@ constexpr int kDefaultToastDurationMs = 2000;
 constexpr int kDefaultSmallWindowBarrierWidth = 200;
 constexpr int kDefaultSmallWindowBarrierHeight = 150;
 
+// Deepest split nesting accepted in a [[layouts]] template
+constexpr int kMaxLayoutTemplateDepth = 16;
+
 // Gap configuration for window spacing
 struct GapOptions {
   float horizontal = kDefaultGapHorizontal;
@@ -89,7 +128,53 @@ struct GapOptions {
 
 // Loop configuration
 struct LoopOptions {
-  int intervalMs = kDefaultLoopIntervalMs;
+  int intervalMs = kDefaultLoopIntervalMs; // Fixed interval when adaptive is off
+  bool adaptive = kDefaultLoopAdaptive;    // Follow the change rate between min and max
+  int minIntervalMs = kDefaultLoopMinIntervalMs;
+  int maxIntervalMs = kDefaultLoopMaxIntervalMs;
+};
+
+// Local IPC command server configuration
+struct IpcOptions {
+  bool enabled = kDefaultIpcEnabled;
+  std::string endpoint; // Pipe name / socket path, empty = platform default
+};
+
+// Power profile selection: auto follows AC/DC, the others pin a profile
+enum class PowerMode { Auto, Performance, LowPower };
+
+// Power profile configuration
+struct PowerOptions {
+  PowerMode mode = PowerMode::Auto;
+  int lowPowerMinIntervalMs = kDefaultLowPowerMinIntervalMs; // Adaptive bounds on battery
+  int lowPowerMaxIntervalMs = kDefaultLowPowerMaxIntervalMs;
+};
+
+// Hover focus configuration (selection and foreground follow the cursor)
+struct FocusOptions {
+  int hoverDwellMs = kDefaultHoverDwellMs;                       // Cursor rest before focusing
+  int minForegroundIntervalMs = kDefaultMinForegroundIntervalMs; // Min gap between focus changes
+};
+
+// Live resize: neighbors follow a tiled window while it is being resized
+struct ResizeOptions {
+  bool live = kDefaultLiveResize;
+  int maxRateHz = kDefaultLiveResizeMaxRateHz; // Reflow rate cap, 0 = display refresh rate
+};
+
+// Per-monitor workspaces, switched and filled by hotkey. Applied when the cell system is built
+// (startup or a monitor change).
+struct WorkspaceOptions {
+  int count = kDefaultWorkspaceCount; // Workspaces per monitor, 1 to cells::kMaxWorkspaces
+};
+
+// Loop stall watchdog configuration
+struct WatchdogOptions {
+  bool enabled = kDefaultWatchdogEnabled;
+  int budgetMs = kDefaultWatchdogBudgetMs;               // Max time a single loop phase may take
+  int checkIntervalMs = kDefaultWatchdogCheckIntervalMs; // How often the watchdog looks
+  bool minidump = kDefaultWatchdogMinidump;              // Write a minidump on the first stall
+  std::string dumpDirectory; // Where minidumps go, empty = current directory
 };
 
 // Render-specific options used by the renderer
@@ -116,7 +201,14 @@ struct GlobalOptions {
   KeyboardOptions keyboardOptions;
   GapOptions gapOptions;
   LoopOptions loopOptions;
+  IpcOptions ipcOptions;
+  WatchdogOptions watchdogOptions;
+  PowerOptions powerOptions;
+  FocusOptions focusOptions;
+  ResizeOptions resizeOptions;
+  WorkspaceOptions workspaceOptions;
   VisualizationOptions visualizationOptions;
+  std::vector<LayoutTemplate> layouts; // [[layouts]], applied by name over IPC
 };
 
 // Get default global options
@@ -56,6 +56,7 @@ ID2D1Bitmap1* g_targetBitmap = nullptr;
 IDWriteFactory* g_dwriteFactory = nullptr;
 
 bool g_initialized = false;
+bool g_devicesReady = false; // init_devices() succeeded (possibly on another thread)
 bool g_comInitialized = false;
 
 // Helper to safely release COM objects
@@ -83,6 +84,30 @@ std::wstring utf8_to_wide(const std::string& str) {
   return result;
 }
 
+// Virtual screen metrics size both the window and the swap chain
+void query_virtual_screen() {
+  g_virtualX = GetSystemMetrics(SM_XVIRTUALSCREEN);
+  g_virtualY = GetSystemMetrics(SM_YVIRTUALSCREEN);
+  g_virtualWidth = GetSystemMetrics(SM_CXVIRTUALSCREEN);
+  g_virtualHeight = GetSystemMetrics(SM_CYVIRTUALSCREEN);
+
+  spdlog::info("Virtual screen: x={}, y={}, w={}, h={}", g_virtualX, g_virtualY, g_virtualWidth,
+               g_virtualHeight);
+}
+
+// Release everything init_devices() created
+void release_devices() {
+  g_devicesReady = false;
+  safe_release(g_dwriteFactory);
+  safe_release(g_targetBitmap);
+  safe_release(g_d2dContext);
+  safe_release(g_d2dDevice);
+  safe_release(g_d2dFactory);
+  safe_release(g_swapChain);
+  safe_release(g_d3dContext);
+  safe_release(g_d3dDevice);
+}
+
 bool create_window() {
   g_hInstance = GetModuleHandleW(nullptr);
 
@@ -103,15 +128,6 @@ bool create_window() {
     }
   }
 
-  // Get virtual screen metrics
-  g_virtualX = GetSystemMetrics(SM_XVIRTUALSCREEN);
-  g_virtualY = GetSystemMetrics(SM_YVIRTUALSCREEN);
-  g_virtualWidth = GetSystemMetrics(SM_CXVIRTUALSCREEN);
-  g_virtualHeight = GetSystemMetrics(SM_CYVIRTUALSCREEN);
-
-  spdlog::info("Virtual screen: x={}, y={}, w={}, h={}", g_virtualX, g_virtualY, g_virtualWidth,
-               g_virtualHeight);
-
   // Create layered, transparent, topmost window
   DWORD exStyle = WS_EX_LAYERED | WS_EX_TRANSPARENT | WS_EX_TOPMOST | WS_EX_TOOLWINDOW;
   DWORD style = WS_POPUP;
@@ -459,55 +475,71 @@ bool bind_swap_chain_to_window() {
 
 } // namespace
 
-bool init() {
-  if (g_initialized) {
+bool init_devices() {
+  if (g_devicesReady) {
     return true;
   }
 
-  // Set DPI awareness (system-level only)
+  // Set DPI awareness (system-level only) before the metrics are read
   SetProcessDpiAwarenessContext(DPI_AWARENESS_CONTEXT_SYSTEM_AWARE);
-
-  // Initialize COM
-  HRESULT hr = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
-  if (SUCCEEDED(hr)) {
-    g_comInitialized = true;
-  } else if (hr != RPC_E_CHANGED_MODE) {
-    spdlog::error("Failed to initialize COM: 0x{:08X}", static_cast<unsigned int>(hr));
-    return false;
-  }
-
-  // Create window
-  if (!create_window()) {
-    shutdown();
-    return false;
-  }
+  query_virtual_screen();
 
   // Create D3D device
   if (!create_d3d_device()) {
-    shutdown();
+    release_devices();
     return false;
   }
 
   // Create swap chain
   if (!create_swap_chain()) {
-    shutdown();
+    release_devices();
     return false;
   }
 
   // Create D2D resources
   if (!create_d2d_resources()) {
-    shutdown();
+    release_devices();
     return false;
   }
 
   // Create render target
   if (!create_render_target()) {
-    shutdown();
+    release_devices();
     return false;
   }
 
   // Create DWrite resources
   if (!create_dwrite_resources()) {
+    release_devices();
+    return false;
+  }
+
+  g_devicesReady = true;
+  return true;
+}
+
+bool init() {
+  if (g_initialized) {
+    return true;
+  }
+
+  // Initialize COM
+  HRESULT hr = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
+  if (SUCCEEDED(hr)) {
+    g_comInitialized = true;
+  } else if (hr != RPC_E_CHANGED_MODE) {
+    spdlog::error("Failed to initialize COM: 0x{:08X}", static_cast<unsigned int>(hr));
+    return false;
+  }
+
+  // Devices may already have been created on a worker thread
+  if (!init_devices()) {
+    shutdown();
+    return false;
+  }
+
+  // Create window
+  if (!create_window()) {
     shutdown();
     return false;
   }
@@ -526,14 +558,7 @@ bool init() {
 void shutdown() {
   g_initialized = false;
 
-  safe_release(g_dwriteFactory);
-  safe_release(g_targetBitmap);
-  safe_release(g_d2dContext);
-  safe_release(g_d2dDevice);
-  safe_release(g_d2dFactory);
-  safe_release(g_swapChain);
-  safe_release(g_d3dContext);
-  safe_release(g_d3dDevice);
+  release_devices();
 
   if (g_hwnd) {
     DestroyWindow(g_hwnd);
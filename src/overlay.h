@@ -27,8 +27,13 @@ struct Toast {
   float font_size;  // Font size in points
 };
 
+// Create the D3D/D2D/DWrite resources without the window. Touches no thread-affine state, so
+// it may run on a worker thread while startup continues; init() then only creates the window
+// and binds it. Returns true on success; on failure everything it created is released.
+bool init_devices();
+
 // Initialize the overlay system. Returns true on success.
-// Creates the transparent window and D2D resources.
+// Creates the transparent window and D2D resources (unless init_devices() already did).
 bool init();
 
 // Shutdown the overlay system. Releases all resources.
@@ -0,0 +1,101 @@
+#include "power_profile.h"
+
+namespace wintiler {
+
+const char* power_profile_to_string(PowerProfile profile) {
+  switch (profile) {
+  case PowerProfile::Performance:
+    return "performance";
+  case PowerProfile::LowPower:
+    return "low-power";
+  }
+  return "unknown";
+}
+
+PowerProfile select_power_profile(PowerMode mode, std::optional<bool> on_ac_power) {
+  switch (mode) {
+  case PowerMode::Performance:
+    return PowerProfile::Performance;
+  case PowerMode::LowPower:
+    return PowerProfile::LowPower;
+  case PowerMode::Auto:
+    return on_ac_power.value_or(true) ? PowerProfile::Performance : PowerProfile::LowPower;
+  }
+  return PowerProfile::Performance;
+}
+
+ProfileSettings profile_settings(PowerProfile profile, const LoopOptions& loop_options,
+                                 const PowerOptions& power_options) {
+  switch (profile) {
+  case PowerProfile::Performance:
+    return {loop_options.adaptive,
+            loop_options.intervalMs,
+            loop_options.minIntervalMs,
+            loop_options.maxIntervalMs,
+            false,
+            true,
+            false};
+  case PowerProfile::LowPower:
+    return {true,
+            power_options.lowPowerMaxIntervalMs,
+            power_options.lowPowerMinIntervalMs,
+            power_options.lowPowerMaxIntervalMs,
+            true,
+            false,
+            true};
+  }
+  return profile_settings(PowerProfile::Performance, loop_options, power_options);
+}
+
+// ============================================================================
+// PowerProfileMeter
+// ============================================================================
+
+double PowerProfileMeter::Usage::wakeups_per_minute() const {
+  double minutes = std::chrono::duration<double, std::ratio<60>>(wall).count();
+  return minutes > 0.0 ? static_cast<double>(wakeups) / minutes : 0.0;
+}
+
+double PowerProfileMeter::Usage::cpu_percent() const {
+  double wall_us = std::chrono::duration<double, std::micro>(wall).count();
+  return wall_us > 0.0 ? 100.0 * static_cast<double>(cpu.count()) / wall_us : 0.0;
+}
+
+PowerProfileMeter::PowerProfileMeter(PowerProfile initial, Clock::time_point now,
+                                     CpuTime cpu_time)
+    : current_(initial), interval_start_(now), interval_cpu_start_(cpu_time) {
+}
+
+PowerProfile PowerProfileMeter::current() const {
+  return current_;
+}
+
+void PowerProfileMeter::record_wakeup() {
+  ++interval_wakeups_;
+}
+
+void PowerProfileMeter::switch_to(PowerProfile profile, Clock::time_point now,
+                                  CpuTime cpu_time) {
+  auto& total = totals_[static_cast<size_t>(current_)];
+  total.wall += now - interval_start_;
+  total.cpu += cpu_time - interval_cpu_start_;
+  total.wakeups += interval_wakeups_;
+
+  current_ = profile;
+  interval_start_ = now;
+  interval_cpu_start_ = cpu_time;
+  interval_wakeups_ = 0;
+}
+
+PowerProfileMeter::Usage PowerProfileMeter::usage(PowerProfile profile, Clock::time_point now,
+                                                  CpuTime cpu_time) const {
+  Usage result = totals_[static_cast<size_t>(profile)];
+  if (profile == current_) {
+    result.wall += now - interval_start_;
+    result.cpu += cpu_time - interval_cpu_start_;
+    result.wakeups += interval_wakeups_;
+  }
+  return result;
+}
+
+} // namespace wintiler
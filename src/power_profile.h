@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "options.h"
+
+namespace wintiler {
+
+enum class PowerProfile { Performance, LowPower };
+constexpr size_t kPowerProfileCount = 2;
+
+const char* power_profile_to_string(PowerProfile profile);
+
+// Profile for the configured mode. on_ac_power is nullopt when the power source is unknown,
+// which auto mode treats like AC (desktops without a battery).
+PowerProfile select_power_profile(PowerMode mode, std::optional<bool> on_ac_power);
+
+// Loop behaviour for a profile
+struct ProfileSettings {
+  bool adaptive;         // Adaptive resync interval between min and max
+  int interval_ms;       // Fixed resync interval when not adaptive
+  int min_interval_ms;
+  int max_interval_ms;
+  bool render_on_change; // Skip overlay redraws when nothing visible changed
+  bool hover_focus;      // Selection and foreground follow the cursor
+  bool batch_placement;  // Place all tiles with one DeferWindowPos batch
+};
+
+ProfileSettings profile_settings(PowerProfile profile, const LoopOptions& loop_options,
+                                 const PowerOptions& power_options);
+
+// Process CPU time and loop wakeups accounted to the profile that was active at the time
+class PowerProfileMeter {
+public:
+  using Clock = std::chrono::steady_clock;
+  using CpuTime = std::chrono::microseconds;
+
+  struct Usage {
+    Clock::duration wall{};
+    CpuTime cpu{};
+    uint64_t wakeups = 0;
+
+    [[nodiscard]] double wakeups_per_minute() const;
+    [[nodiscard]] double cpu_percent() const; // Of one core
+  };
+
+  PowerProfileMeter(PowerProfile initial, Clock::time_point now, CpuTime cpu_time);
+
+  [[nodiscard]] PowerProfile current() const;
+
+  void record_wakeup();
+
+  // Close the running interval and account from now on to profile
+  void switch_to(PowerProfile profile, Clock::time_point now, CpuTime cpu_time);
+
+  // Totals for profile, including the running interval if it is the current one
+  [[nodiscard]] Usage usage(PowerProfile profile, Clock::time_point now, CpuTime cpu_time) const;
+
+private:
+  PowerProfile current_;
+  Clock::time_point interval_start_;
+  CpuTime interval_cpu_start_;
+  uint64_t interval_wakeups_ = 0;
+  std::array<Usage, kPowerProfileCount> totals_{};
+};
+
+} // namespace wintiler
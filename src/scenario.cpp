@@ -0,0 +1,448 @@
+#include "scenario.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+namespace wintiler {
+
+namespace {
+
+// Leaf ids handed out by add steps start here, like the interactive ui-test-multi
+constexpr size_t kFirstLeafId = 10;
+
+// Steps that move the mouse in the interactive UI move the scripted pointer instead
+void set_pointer(float& x, float& y, const cells::Point& point) {
+  x = static_cast<float>(point.x);
+  y = static_cast<float>(point.y);
+}
+
+std::optional<cells::Direction> parse_direction(const std::string& word) {
+  if (word == "left") {
+    return cells::Direction::Left;
+  }
+  if (word == "right") {
+    return cells::Direction::Right;
+  }
+  if (word == "up") {
+    return cells::Direction::Up;
+  }
+  if (word == "down") {
+    return cells::Direction::Down;
+  }
+  return std::nullopt;
+}
+
+template <typename T>
+bool parse_number(const std::string& word, T& out) {
+  std::istringstream in(word);
+  in >> out;
+  return !in.fail() && in.eof();
+}
+
+// Parse the step words after an optional repeat prefix
+tl::expected<ScenarioStep, std::string> parse_step(const std::vector<std::string>& words) {
+  ScenarioStep step;
+  const auto& name = words[0];
+  auto args = words.size() - 1;
+  auto arity = [&](size_t min, size_t max) { return args >= min && args <= max; };
+  auto error = [&](const std::string& usage) {
+    return tl::unexpected("usage: " + usage);
+  };
+
+  if (name == "add" || name == "delete" || name == "select") {
+    step.op = name == "add" ? ScenarioOp::Add
+              : name == "delete" ? ScenarioOp::Delete
+                                 : ScenarioOp::Select;
+    bool required = step.op == ScenarioOp::Select;
+    const char* usage = step.op == ScenarioOp::Add      ? "add [cluster]"
+                        : step.op == ScenarioOp::Delete ? "delete [leaf]"
+                                                        : "select <leaf>";
+    if (!arity(required ? 1 : 0, 1)) {
+      return error(usage);
+    }
+    if (args == 1) {
+      size_t index = 0;
+      if (!parse_number(words[1], index)) {
+        return error(usage);
+      }
+      step.index = index;
+    }
+  } else if (name == "point" || name == "drop") {
+    step.op = name == "point" ? ScenarioOp::Point : ScenarioOp::Drop;
+    bool drop = step.op == ScenarioOp::Drop;
+    const char* usage = drop ? "drop <x> <y> [swap]" : "point <x> <y>";
+    if (!arity(2, drop ? 3 : 2) || !parse_number(words[1], step.x) ||
+        !parse_number(words[2], step.y)) {
+      return error(usage);
+    }
+    if (args == 3) {
+      if (words[3] != "swap") {
+        return error(usage);
+      }
+      step.exchange = true;
+    }
+  } else if (name == "navigate") {
+    auto direction = args == 1 ? parse_direction(words[1]) : std::nullopt;
+    if (!direction) {
+      return error("navigate left|right|up|down");
+    }
+    step.op = ScenarioOp::Navigate;
+    step.direction = *direction;
+  } else if (name == "ratio") {
+    if (!arity(1, 1) || !parse_number(words[1], step.value)) {
+      return error("ratio <ratio> | ratio +<delta> | ratio -<delta>");
+    }
+    step.op = ScenarioOp::Ratio;
+    step.relative = words[1][0] == '+' || words[1][0] == '-';
+  } else {
+    struct Simple {
+      const char* name;
+      ScenarioOp op;
+    };
+    static constexpr Simple kSimple[] = {
+        {"store", ScenarioOp::Store},
+        {"clear-stored", ScenarioOp::ClearStored},
+        {"swap", ScenarioOp::Swap},
+        {"move", ScenarioOp::Move},
+        {"exchange-siblings", ScenarioOp::ExchangeSiblings},
+        {"zen", ScenarioOp::Zen},
+        {"toggle-split", ScenarioOp::ToggleSplit},
+        {"split-mode", ScenarioOp::SplitMode},
+        {"validate", ScenarioOp::Validate},
+    };
+    auto it = std::find_if(std::begin(kSimple), std::end(kSimple),
+                           [&](const Simple& simple) { return name == simple.name; });
+    if (it == std::end(kSimple)) {
+      return tl::unexpected("unknown step '" + name + "'");
+    }
+    if (args != 0) {
+      return error(name);
+    }
+    step.op = it->op;
+  }
+  return step;
+}
+
+} // namespace
+
+tl::expected<std::vector<ScenarioStep>, std::string> parse_scenario(const std::string& script) {
+  std::vector<ScenarioStep> steps;
+  std::istringstream lines(script);
+  std::string line;
+  int line_number = 0;
+  while (std::getline(lines, line)) {
+    ++line_number;
+    line = line.substr(0, line.find('#'));
+    std::istringstream in(line);
+    std::vector<std::string> words;
+    for (std::string word; in >> word;) {
+      words.push_back(word);
+    }
+    if (words.empty()) {
+      continue;
+    }
+
+    int repeat = 1;
+    if (words[0] == "repeat") {
+      if (words.size() < 3 || !parse_number(words[1], repeat) || repeat < 1) {
+        return tl::unexpected(
+            fmt::format("line {}: usage: repeat <count> <step> [args]", line_number));
+      }
+      words.erase(words.begin(), words.begin() + 2);
+    }
+
+    auto step = parse_step(words);
+    if (!step) {
+      return tl::unexpected(fmt::format("line {}: {}", line_number, step.error()));
+    }
+    step->line = line_number;
+    step->repeat = repeat;
+    auto first = line.find_first_not_of(" \t\r");
+    auto last = line.find_last_not_of(" \t\r");
+    step->text = line.substr(first, last - first + 1);
+    steps.push_back(std::move(*step));
+  }
+  return steps;
+}
+
+// ============================================================================
+// ScenarioRunner
+// ============================================================================
+
+ScenarioRunner::ScenarioRunner(const std::vector<cells::ClusterInitInfo>& infos,
+                               const ScenarioContext& context)
+    : system_(cells::create_system(infos, context.gap_horizontal, context.gap_vertical)),
+      context_(context), next_leaf_id_(kFirstLeafId) {
+  for (const auto& info : infos) {
+    for (size_t id : info.initial_cell_ids) {
+      next_leaf_id_ = std::max(next_leaf_id_, id + 1);
+    }
+  }
+  if (!infos.empty()) {
+    pointer_x_ = infos[0].x + infos[0].width / 2.0f;
+    pointer_y_ = infos[0].y + infos[0].height / 2.0f;
+  }
+}
+
+std::vector<cells::ClusterCellUpdateInfo> ScenarioRunner::current_state() const {
+  std::vector<cells::ClusterCellUpdateInfo> state;
+  for (size_t ci = 0; ci < system_.clusters.size(); ++ci) {
+    const auto& pc = system_.clusters[ci];
+    state.push_back({ci, cells::get_cluster_leaf_ids(pc.cluster), pc.cluster.has_fullscreen_cell});
+  }
+  return state;
+}
+
+size_t ScenarioRunner::leaf_count() const {
+  size_t count = 0;
+  for (const auto& pc : system_.clusters) {
+    count += cells::get_cluster_leaf_ids(pc.cluster).size();
+  }
+  return count;
+}
+
+std::optional<size_t> ScenarioRunner::selected_leaf_id() const {
+  if (!system_.selection.has_value()) {
+    return std::nullopt;
+  }
+  const auto& pc = system_.clusters[system_.selection->cluster_index];
+  auto cell_index = static_cast<size_t>(system_.selection->cell_index);
+  if (cell_index >= pc.cluster.cells.size()) {
+    return std::nullopt;
+  }
+  return pc.cluster.cells[cell_index].leaf_id;
+}
+
+// Selecting moves the pointer onto the cell, as hovering does; otherwise the next update
+// would select whatever is under the old pointer position
+bool ScenarioRunner::select(size_t leaf_id) {
+  for (size_t ci = 0; ci < system_.clusters.size(); ++ci) {
+    const auto& pc = system_.clusters[ci];
+    if (auto cell_index = cells::find_cell_by_leaf_id(pc.cluster, leaf_id)) {
+      system_.selection = cells::CellIndicatorByIndex{ci, *cell_index};
+      auto rect = cells::get_cell_global_rect(pc, *cell_index);
+      pointer_x_ = rect.x + rect.width / 2.0f;
+      pointer_y_ = rect.y + rect.height / 2.0f;
+      return true;
+    }
+  }
+  return false;
+}
+
+// New windows go where update() redirects them: an empty cluster under the pointer, else the
+// selected cluster. An explicit cluster is targeted by hovering its center first.
+bool ScenarioRunner::add(std::optional<size_t> cluster_index) {
+  if (cluster_index) {
+    if (*cluster_index >= system_.clusters.size()) {
+      return false;
+    }
+    const auto& pc = system_.clusters[*cluster_index];
+    pointer_x_ = pc.global_x + pc.cluster.window_width / 2.0f;
+    pointer_y_ = pc.global_y + pc.cluster.window_height / 2.0f;
+    if (auto cell =
+            cells::find_cell_at_point(system_, pointer_x_, pointer_y_, context_.zen_percentage)) {
+      system_.selection = cells::CellIndicatorByIndex{cell->first, cell->second};
+    }
+  } else {
+    cluster_index = system_.selection ? system_.selection->cluster_index : 0;
+  }
+  auto state = current_state();
+  size_t leaf_id = next_leaf_id_++;
+  state[*cluster_index].leaf_ids.push_back(leaf_id);
+  auto result =
+      cells::update(system_, state, std::make_pair(*cluster_index, leaf_id),
+                    {pointer_x_, pointer_y_}, context_.zen_percentage, 0,
+                    context_.gap_horizontal, context_.gap_vertical);
+  return !result.added_leaf_ids.empty();
+}
+
+bool ScenarioRunner::remove(std::optional<size_t> leaf_id) {
+  if (!leaf_id) {
+    leaf_id = selected_leaf_id();
+  }
+  if (!leaf_id) {
+    return false;
+  }
+  auto state = current_state();
+  bool found = false;
+  for (auto& cluster : state) {
+    auto& ids = cluster.leaf_ids;
+    auto it = std::find(ids.begin(), ids.end(), *leaf_id);
+    if (it != ids.end()) {
+      ids.erase(it);
+      found = true;
+    }
+  }
+  if (!found) {
+    return false;
+  }
+  cells::update(system_, state, std::nullopt, {pointer_x_, pointer_y_}, context_.zen_percentage,
+                0, context_.gap_horizontal, context_.gap_vertical);
+  if (stored_cell_ && stored_cell_->leaf_id == *leaf_id) {
+    stored_cell_.reset();
+  }
+  return true;
+}
+
+bool ScenarioRunner::run_step(const ScenarioStep& step) {
+  float gap_h = context_.gap_horizontal;
+  float gap_v = context_.gap_vertical;
+
+  switch (step.op) {
+  case ScenarioOp::Add:
+    return add(step.index);
+  case ScenarioOp::Delete:
+    return remove(step.index);
+  case ScenarioOp::Select:
+    return select(*step.index);
+  case ScenarioOp::Point: {
+    pointer_x_ = step.x;
+    pointer_y_ = step.y;
+    auto cell = cells::find_cell_at_point(system_, step.x, step.y, context_.zen_percentage);
+    if (!cell) {
+      return false;
+    }
+    system_.selection = cells::CellIndicatorByIndex{cell->first, cell->second};
+    return true;
+  }
+  case ScenarioOp::Navigate:
+    if (auto result = cells::move_selection(system_, step.direction)) {
+      set_pointer(pointer_x_, pointer_y_, result->center);
+      return true;
+    }
+    return false;
+  case ScenarioOp::Store: {
+    auto leaf_id = selected_leaf_id();
+    if (!leaf_id) {
+      return false;
+    }
+    stored_cell_ = StoredCell{system_.selection->cluster_index, *leaf_id};
+    return true;
+  }
+  case ScenarioOp::ClearStored:
+    stored_cell_.reset();
+    return true;
+  case ScenarioOp::Swap:
+  case ScenarioOp::Move: {
+    auto leaf_id = selected_leaf_id();
+    if (!stored_cell_ || !leaf_id) {
+      return false;
+    }
+    size_t cluster_index = system_.selection->cluster_index;
+    bool ok = step.op == ScenarioOp::Swap
+                  ? cells::swap_cells(system_, cluster_index, *leaf_id,
+                                      stored_cell_->cluster_index, stored_cell_->leaf_id, gap_h,
+                                      gap_v)
+                        .has_value()
+                  : cells::move_cell(system_, stored_cell_->cluster_index,
+                                     stored_cell_->leaf_id, cluster_index, *leaf_id, gap_h, gap_v)
+                        .has_value();
+    if (ok) {
+      stored_cell_.reset();
+    }
+    return ok;
+  }
+  case ScenarioOp::ExchangeSiblings: {
+    auto leaf_id = selected_leaf_id();
+    auto sibling = cells::get_selected_sibling_leaf_id(system_);
+    if (!leaf_id || !sibling) {
+      return false;
+    }
+    size_t cluster_index = system_.selection->cluster_index;
+    if (auto center = cells::swap_cells(system_, cluster_index, *leaf_id, cluster_index,
+                                        *sibling, gap_h, gap_v)) {
+      set_pointer(pointer_x_, pointer_y_, *center);
+      return true;
+    }
+    return false;
+  }
+  case ScenarioOp::Drop: {
+    auto leaf_id = selected_leaf_id();
+    if (!leaf_id) {
+      return false;
+    }
+    auto result = cells::perform_drop_move(system_, *leaf_id, step.x, step.y,
+                                           context_.zen_percentage, step.exchange, gap_h, gap_v);
+    if (!result) {
+      return false;
+    }
+    set_pointer(pointer_x_, pointer_y_, result->cursor_pos);
+    return true;
+  }
+  case ScenarioOp::Zen:
+    return cells::toggle_selected_zen(system_);
+  case ScenarioOp::Ratio: {
+    auto center = step.relative
+                      ? cells::adjust_selected_split_ratio(system_, step.value, gap_h, gap_v)
+                      : cells::set_selected_split_ratio(system_, step.value, gap_h, gap_v);
+    if (!center) {
+      return false;
+    }
+    set_pointer(pointer_x_, pointer_y_, *center);
+    return true;
+  }
+  case ScenarioOp::ToggleSplit:
+    return cells::toggle_selected_split_dir(system_, gap_h, gap_v);
+  case ScenarioOp::SplitMode:
+    return cells::cycle_split_mode(system_);
+  case ScenarioOp::Validate: {
+    bool valid = cells::validate_system(system_);
+    valid_ = valid_ && valid;
+    return valid;
+  }
+  }
+  return false;
+}
+
+ScenarioReport ScenarioRunner::run(const std::vector<ScenarioStep>& steps) {
+  using Clock = std::chrono::steady_clock;
+  ScenarioReport report;
+  for (const auto& step : steps) {
+    ScenarioStepResult result;
+    result.line = step.line;
+    result.text = step.text;
+    for (int i = 0; i < step.repeat; ++i) {
+      auto start = Clock::now();
+      bool ok = run_step(step);
+      auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+      result.min_ns = result.runs == 0 ? ns : std::min(result.min_ns, ns);
+      result.max_ns = std::max(result.max_ns, ns);
+      result.total_ns += ns;
+      ++result.runs;
+      if (!ok) {
+        ++result.failures;
+      }
+    }
+    result.leaves = leaf_count();
+    report.total_ns += result.total_ns;
+    report.failures += result.failures;
+    report.steps.push_back(std::move(result));
+  }
+  report.valid = valid_;
+  return report;
+}
+
+// ============================================================================
+// Report
+// ============================================================================
+
+std::string format_scenario_report(const ScenarioReport& report) {
+  auto us = [](int64_t ns) { return static_cast<double>(ns) / 1e3; };
+  std::string out = fmt::format("{:>5} {:<28} {:>6} {:>6} {:>10} {:>10} {:>10} {:>7}\n", "line",
+                                "step", "runs", "failed", "avg us", "min us", "max us", "leaves");
+  for (const auto& step : report.steps) {
+    out += fmt::format("{:>5} {:<28} {:>6} {:>6} {:>10.1f} {:>10.1f} {:>10.1f} {:>7}\n",
+                       step.line, step.text, step.runs, step.failures,
+                       us(step.total_ns / std::max(step.runs, 1)), us(step.min_ns),
+                       us(step.max_ns), step.leaves);
+  }
+  out += fmt::format("{} steps, {:.1f}us total, {} failed runs{}\n", report.steps.size(),
+                     us(report.total_ns), report.failures,
+                     report.valid ? "" : ", VALIDATION FAILED");
+  return out;
+}
+
+} // namespace wintiler
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <tl/expected.hpp>
+#include <vector>
+
+#include "model.h"
+#include "multi_cells.h"
+
+namespace wintiler {
+
+// ============================================================================
+// Scenario Scripts
+// ============================================================================
+
+// One line of a scenario script. Lines are `[repeat <n>] <step> [args]`, # starts a comment:
+//   add [cluster]          new leaf in the selected (or given) cluster, then select it
+//   delete [leaf]          remove the selected (or given) leaf
+//   select <leaf>          select a leaf by id
+//   point <x> <y>          move the pointer and select the cell under it, like hovering
+//   navigate <dir>         left, right, up or down
+//   store | clear-stored   remember the selected leaf for swap/move
+//   swap | move            exchange with / move the stored leaf to the selection
+//   exchange-siblings      swap the selected leaf with its sibling
+//   drop <x> <y> [swap]    drag-and-drop the selected leaf at a point
+//   zen                    toggle zen for the selected leaf
+//   ratio <r> | ratio +d   set or adjust (signed delta) the selected leaf's parent split ratio
+//   toggle-split           flip the selected leaf's parent split direction
+//   split-mode             cycle the split mode
+//   validate               check the system invariants
+enum class ScenarioOp {
+  Add,
+  Delete,
+  Select,
+  Point,
+  Navigate,
+  Store,
+  ClearStored,
+  Swap,
+  Move,
+  ExchangeSiblings,
+  Drop,
+  Zen,
+  Ratio,
+  ToggleSplit,
+  SplitMode,
+  Validate,
+};
+
+struct ScenarioStep {
+  ScenarioOp op;
+  int line = 0;                // 1-based line in the script
+  std::string text;            // The line without comment and surrounding blanks
+  int repeat = 1;
+  std::optional<size_t> index; // Add cluster, Delete/Select leaf
+  float x = 0.0f;              // Point/Drop
+  float y = 0.0f;
+  cells::Direction direction = cells::Direction::Left;
+  float value = 0.0f;          // Ratio
+  bool relative = false;       // Ratio: value is a delta
+  bool exchange = false;       // Drop: exchange instead of move
+};
+
+tl::expected<std::vector<ScenarioStep>, std::string> parse_scenario(const std::string& script);
+
+// ============================================================================
+// Running
+// ============================================================================
+
+struct ScenarioStepResult {
+  int line = 0;
+  std::string text;
+  int runs = 0;
+  int failures = 0; // Runs where the step had no effect or the operation refused
+  int64_t total_ns = 0;
+  int64_t min_ns = 0;
+  int64_t max_ns = 0;
+  size_t leaves = 0; // Leaves in the system after the step
+};
+
+struct ScenarioReport {
+  std::vector<ScenarioStepResult> steps;
+  int64_t total_ns = 0;
+  int failures = 0;
+  bool valid = true; // Every validate step passed
+};
+
+struct ScenarioContext {
+  float gap_horizontal = 0.0f;
+  float gap_vertical = 0.0f;
+  float zen_percentage = 0.9f;
+};
+
+// Drives a cells::System the way the ui-test-multi window does, without raylib: the pointer
+// is set by point steps instead of the mouse, and every step is timed.
+class ScenarioRunner {
+public:
+  ScenarioRunner(const std::vector<cells::ClusterInitInfo>& infos,
+                 const ScenarioContext& context);
+
+  // Run one repetition of a step. Returns false if it had no effect.
+  bool run_step(const ScenarioStep& step);
+
+  ScenarioReport run(const std::vector<ScenarioStep>& steps);
+
+  [[nodiscard]] const cells::System& system() const { return system_; }
+
+private:
+  bool add(std::optional<size_t> cluster_index);
+  bool remove(std::optional<size_t> leaf_id);
+  bool select(size_t leaf_id);
+  [[nodiscard]] std::optional<size_t> selected_leaf_id() const;
+  [[nodiscard]] std::vector<cells::ClusterCellUpdateInfo> current_state() const;
+  [[nodiscard]] size_t leaf_count() const;
+
+  cells::System system_;
+  ScenarioContext context_;
+  size_t next_leaf_id_;
+  std::optional<StoredCell> stored_cell_;
+  float pointer_x_ = 0.0f;
+  float pointer_y_ = 0.0f;
+  bool valid_ = true;
+};
+
+// Per-step latency table followed by the totals
+std::string format_scenario_report(const ScenarioReport& report);
+
+} // namespace wintiler
@@ -0,0 +1,41 @@
+#include "startup.h"
+
+#include <future>
+#include <utility>
+
+namespace wintiler {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::chrono::microseconds since(Clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+}
+
+} // namespace
+
+StartupReport run_startup(const StartupHooks& hooks) {
+  StartupReport report;
+  auto start = Clock::now();
+
+  // Device creation is the slow part of the overlay and does not need the window
+  auto devices = std::async(std::launch::async, [&hooks] {
+    auto device_start = Clock::now();
+    bool ok = hooks.init_overlay_devices();
+    return std::make_pair(ok, since(device_start));
+  });
+
+  report.input_state = hooks.gather();
+  report.gather = since(start);
+  hooks.first_layout(report.input_state);
+  report.time_to_first_tile = since(start);
+
+  auto [devices_ok, device_time] = devices.get();
+  report.overlay_devices = device_time;
+  report.overlay_ok = hooks.init_overlay_window(devices_ok);
+  report.total = since(start);
+  return report;
+}
+
+} // namespace wintiler
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+
+#include "winapi.h"
+
+namespace wintiler {
+
+// Steps of the loop mode startup, wired to winapi/overlay in run_loop_mode and to a simulated
+// backend in tests
+struct StartupHooks {
+  // Enumerate monitors and windows once (any thread)
+  std::function<winapi::LoopInputState()> gather;
+  // Build the cell system from the gathered state and place the first tiles (calling thread)
+  std::function<void(const winapi::LoopInputState&)> first_layout;
+  // Create the overlay's GPU and text resources (runs on a worker thread)
+  std::function<bool()> init_overlay_devices;
+  // Create the overlay window and bind it to the devices (calling thread, after the devices;
+  // receives whether they were created)
+  std::function<bool(bool devices_ok)> init_overlay_window;
+};
+
+struct StartupReport {
+  std::chrono::microseconds gather{};
+  std::chrono::microseconds time_to_first_tile{}; // From start until the first tiles are placed
+  std::chrono::microseconds overlay_devices{};    // Worker thread, overlapped with the above
+  std::chrono::microseconds total{};              // Until the overlay is ready (or failed)
+  bool overlay_ok = false;
+  winapi::LoopInputState input_state; // The single enumeration, reused as the loop's first state
+};
+
+// Startup pipeline: overlay device creation starts on a worker thread, the calling thread
+// enumerates once and lays out the first tiles, then waits for the devices and finishes the
+// overlay window (window creation must stay on the thread that pumps its messages).
+StartupReport run_startup(const StartupHooks& hooks);
+
+} // namespace wintiler
@@ -0,0 +1,137 @@
+#include "stress_workload.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace wintiler {
+
+namespace {
+
+// A stalled frame (debugger, window drag) must not turn into a burst of thousands of spawns
+constexpr double kMaxCreditSeconds = 1.0;
+
+// Whole processes owed for this tick; the fraction stays in credit
+size_t take_credit(double& credit, double rate, double dt_seconds) {
+  credit = std::min(credit + rate * dt_seconds, std::max(rate * kMaxCreditSeconds, 1.0));
+  // Tolerate rounding: 30/s over two 1/60s ticks must make one whole process
+  auto whole = static_cast<size_t>(std::floor(credit + 1e-9));
+  credit = std::max(credit - static_cast<double>(whole), 0.0);
+  return whole;
+}
+
+} // namespace
+
+std::vector<cells::ClusterInitInfo> make_stress_monitors(size_t count, float width,
+                                                         float height) {
+  std::vector<cells::ClusterInitInfo> infos;
+  auto columns = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+  for (size_t i = 0; i < count; ++i) {
+    float x = static_cast<float>(i % columns) * width;
+    float y = static_cast<float>(i / columns) * height;
+    infos.push_back({x, y, width, height, x, y, width, height, {}});
+  }
+  return infos;
+}
+
+// ============================================================================
+// StressWorkload
+// ============================================================================
+
+StressWorkload::StressWorkload(const StressOptions& options, size_t first_leaf_id)
+    : options_(options), rng_(options.seed), next_leaf_id_(first_leaf_id) {}
+
+StressTick StressWorkload::tick(const cells::System& system, double dt_seconds) {
+  StressTick tick;
+  size_t total = 0;
+  for (size_t ci = 0; ci < system.clusters.size(); ++ci) {
+    const auto& pc = system.clusters[ci];
+    tick.state.push_back(
+        {ci, cells::get_cluster_leaf_ids(pc.cluster), pc.cluster.has_fullscreen_cell});
+    total += tick.state.back().leaf_ids.size();
+  }
+  if (tick.state.empty()) {
+    return tick;
+  }
+
+  size_t spawns = 0;
+  size_t kills = 0;
+  if (total < options_.target_windows) {
+    spawns = std::min(take_credit(spawn_credit_, options_.spawn_per_second, dt_seconds),
+                      options_.target_windows - total);
+    // Ramp credit left over at the target would come out as a burst at the churn rate
+    if (total + spawns == options_.target_windows) {
+      spawn_credit_ = 0.0;
+    }
+  } else {
+    spawns = take_credit(spawn_credit_, options_.churn_per_second, dt_seconds);
+    kills = std::min(take_credit(kill_credit_, options_.churn_per_second, dt_seconds), total);
+  }
+
+  // Kill uniformly over all windows, so busy clusters lose more
+  for (size_t k = 0; k < kills; ++k) {
+    size_t victim = std::uniform_int_distribution<size_t>(0, total - 1)(rng_);
+    for (auto& cluster : tick.state) {
+      if (victim < cluster.leaf_ids.size()) {
+        cluster.leaf_ids.erase(cluster.leaf_ids.begin() + static_cast<std::ptrdiff_t>(victim));
+        break;
+      }
+      victim -= cluster.leaf_ids.size();
+    }
+    --total;
+  }
+
+  std::uniform_int_distribution<size_t> pick_cluster(0, tick.state.size() - 1);
+  for (size_t s = 0; s < spawns; ++s) {
+    tick.state[pick_cluster(rng_)].leaf_ids.push_back(next_leaf_id_++);
+  }
+
+  tick.spawned = spawns;
+  tick.killed = kills;
+  total_spawned_ += spawns;
+  total_killed_ += kills;
+  return tick;
+}
+
+cells::UpdateResult apply_stress_tick(cells::System& system, const StressTick& tick,
+                                      std::pair<float, float> pointer, float zen_percentage,
+                                      float gap_horizontal, float gap_vertical) {
+  if (tick.spawned > 0) {
+    system.selection.reset();
+  }
+  return cells::update(system, tick.state, std::nullopt, pointer, zen_percentage, 0,
+                       gap_horizontal, gap_vertical);
+}
+
+// ============================================================================
+// FrameTimeHistory
+// ============================================================================
+
+void FrameTimeHistory::push(float update_ms, float draw_ms) {
+  samples_[next_] = {update_ms, draw_ms};
+  next_ = (next_ + 1) % kCapacity;
+  count_ = std::min(count_ + 1, kCapacity);
+}
+
+const FrameTimeHistory::Sample& FrameTimeHistory::at(size_t i) const {
+  size_t oldest = (next_ + kCapacity - count_) % kCapacity;
+  return samples_[(oldest + i) % kCapacity];
+}
+
+FrameTimeHistory::Summary FrameTimeHistory::summary() const {
+  Summary summary;
+  if (count_ == 0) {
+    return summary;
+  }
+  for (size_t i = 0; i < count_; ++i) {
+    const auto& sample = at(i);
+    summary.update_avg_ms += sample.update_ms;
+    summary.draw_avg_ms += sample.draw_ms;
+    summary.update_max_ms = std::max(summary.update_max_ms, sample.update_ms);
+    summary.draw_max_ms = std::max(summary.draw_max_ms, sample.draw_ms);
+  }
+  summary.update_avg_ms /= static_cast<float>(count_);
+  summary.draw_avg_ms /= static_cast<float>(count_);
+  return summary;
+}
+
+} // namespace wintiler
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "multi_cells.h"
+
+namespace wintiler {
+
+// ============================================================================
+// Synthetic Workload
+// ============================================================================
+
+struct StressOptions {
+  size_t monitors = 8;
+  size_t target_windows = 500;
+  double spawn_per_second = 200.0; // While ramping up to target_windows
+  double churn_per_second = 20.0;  // Spawns and kills per second each at target
+  uint64_t seed = 1;
+};
+
+// Monitors of width x height in a grid as close to square as possible, left to right then
+// top to bottom
+std::vector<cells::ClusterInitInfo> make_stress_monitors(size_t count, float width, float height);
+
+// What one tick of the workload asks for, in the form cells::update() takes
+struct StressTick {
+  std::vector<cells::ClusterCellUpdateInfo> state;
+  size_t spawned = 0;
+  size_t killed = 0;
+};
+
+// Spawns synthetic processes into random clusters until target_windows exist, then keeps
+// killing random ones and spawning replacements at churn_per_second. Rates are fractional:
+// what does not add up to a whole process in one tick carries over to the next.
+class StressWorkload {
+public:
+  StressWorkload(const StressOptions& options, size_t first_leaf_id);
+
+  // Advance by dt_seconds against the system's current leaves
+  StressTick tick(const cells::System& system, double dt_seconds);
+
+  [[nodiscard]] size_t total_spawned() const { return total_spawned_; }
+  [[nodiscard]] size_t total_killed() const { return total_killed_; }
+
+private:
+  StressOptions options_;
+  std::mt19937_64 rng_;
+  size_t next_leaf_id_;
+  double spawn_credit_ = 0.0;
+  double kill_credit_ = 0.0;
+  size_t total_spawned_ = 0;
+  size_t total_killed_ = 0;
+};
+
+// Apply a tick with cells::update(). The selection is dropped first, otherwise update() would
+// redirect every new window into the selected cluster; the pointer re-selects by hover.
+cells::UpdateResult apply_stress_tick(cells::System& system, const StressTick& tick,
+                                      std::pair<float, float> pointer, float zen_percentage,
+                                      float gap_horizontal, float gap_vertical);
+
+// ============================================================================
+// Frame Timing
+// ============================================================================
+
+// Last kCapacity frames of engine (cells::update) and draw time, for the on-screen graph
+class FrameTimeHistory {
+public:
+  static constexpr size_t kCapacity = 240;
+
+  struct Sample {
+    float update_ms = 0.0f;
+    float draw_ms = 0.0f;
+  };
+
+  struct Summary {
+    float update_avg_ms = 0.0f;
+    float update_max_ms = 0.0f;
+    float draw_avg_ms = 0.0f;
+    float draw_max_ms = 0.0f;
+  };
+
+  void push(float update_ms, float draw_ms);
+
+  [[nodiscard]] size_t size() const { return count_; }
+
+  // i = 0 is the oldest held frame
+  [[nodiscard]] const Sample& at(size_t i) const;
+
+  [[nodiscard]] Summary summary() const;
+
+private:
+  Sample samples_[kCapacity];
+  size_t next_ = 0;
+  size_t count_ = 0;
+};
+
+} // namespace wintiler
@@ -0,0 +1,224 @@
+#ifndef DOCTEST_CONFIG_DISABLE
+
+#include <doctest/doctest.h>
+
+#include <string>
+#include <vector>
+
+#include "enum_profile.h"
+
+using namespace wintiler;
+
+namespace {
+
+constexpr int64_t kUs = 1'000;
+constexpr int64_t kMs = 1'000'000;
+
+// A visit that got as far as the process name lookup
+WindowQuerySample make_sample(size_t hwnd, const std::string& process, const std::string& title,
+                              int64_t text_ns = 2 * kUs, int64_t open_ns = 20 * kUs) {
+  WindowQuerySample sample;
+  sample.hwnd = hwnd;
+  sample.process = process;
+  sample.title = title;
+  sample.accepted = true;
+  sample.add(EnumApi::IsWindowVisible, 1 * kUs);
+  sample.add(EnumApi::GetWindowText, text_ns);
+  sample.add(EnumApi::OpenProcess, open_ns);
+  return sample;
+}
+
+bool contains(const std::string& text, const std::string& part) {
+  return text.find(part) != std::string::npos;
+}
+
+} // namespace
+
+TEST_SUITE("enum profile - aggregation") {
+  TEST_CASE("costs are summed per API and per process") {
+    EnumProfiler profiler;
+    for (int pass = 0; pass < 4; ++pass) {
+      profiler.add_pass({make_sample(0x10, "editor.exe", "a.txt"),
+                         make_sample(0x20, "editor.exe", "b.txt"),
+                         make_sample(0x30, "shell.exe", "Desktop")},
+                        100 * kUs);
+    }
+    CHECK(profiler.passes() == 4);
+
+    auto report = profiler.report(IgnoreOptions{});
+    CHECK(report.passes == 4);
+    CHECK(report.total_ns == 400 * kUs);
+    CHECK(report.max_pass_ns == 100 * kUs);
+    CHECK(report.windows_visited == 12);
+
+    REQUIRE(report.apis.size() == 3);
+    CHECK(report.apis[0].api == EnumApi::OpenProcess); // Most expensive first
+    CHECK(report.apis[0].calls == 12);
+    CHECK(report.apis[0].total_ns == 12 * 20 * kUs);
+    CHECK(report.apis[2].api == EnumApi::IsWindowVisible);
+
+    REQUIRE(report.processes.size() == 2);
+    const auto& editor = report.processes[0];
+    CHECK(editor.process == "editor.exe");
+    CHECK(editor.windows == 2);
+    CHECK(editor.samples == 8);
+    CHECK(editor.accepted == 8);
+    CHECK(editor.ns_per_pass == 2 * 23 * kUs);
+    CHECK(editor.titles == 2);
+    CHECK(report.processes[1].process == "shell.exe");
+    CHECK(report.processes[1].ns_per_pass == 23 * kUs);
+  }
+
+  TEST_CASE("the slowest single query is kept with its title") {
+    EnumProfiler profiler;
+    profiler.add_pass({make_sample(0x10, "app.exe", "Fast")}, kMs);
+    profiler.add_pass({make_sample(0x10, "app.exe", "Not Responding", 40 * kMs)}, 41 * kMs);
+    profiler.add_pass({make_sample(0x10, "app.exe", "Fast")}, kMs);
+
+    auto report = profiler.report(IgnoreOptions{});
+    REQUIRE(report.processes.size() == 1);
+    CHECK(report.processes[0].worst_api == EnumApi::GetWindowText);
+    CHECK(report.processes[0].worst_ns == 40 * kMs);
+    CHECK(report.processes[0].worst_title == "Not Responding");
+    CHECK(report.max_pass_ns == 41 * kMs);
+    REQUIRE(report.apis.size() == 3);
+    CHECK(report.apis[0].api == EnumApi::GetWindowText);
+    CHECK(report.apis[0].max_ns == 40 * kMs);
+  }
+
+  TEST_CASE("an empty profiler reports no passes") {
+    EnumProfiler profiler;
+    auto report = profiler.report(IgnoreOptions{});
+    CHECK(report.passes == 0);
+    CHECK(report.apis.empty());
+    CHECK(report.processes.empty());
+    CHECK(contains(format_enum_profile_report(report), "no passes recorded"));
+  }
+}
+
+TEST_SUITE("enum profile - offenders") {
+  TEST_CASE("cheap processes are not flagged") {
+    EnumProfiler profiler;
+    profiler.add_pass({make_sample(0x10, "editor.exe", "a.txt")}, 50 * kUs);
+    auto report = profiler.report(IgnoreOptions{});
+    CHECK_FALSE(report.processes[0].offender);
+    CHECK(report.suggestions.empty());
+  }
+
+  TEST_CASE("a costly process is flagged and suggested") {
+    EnumProfiler profiler;
+    for (int pass = 0; pass < 10; ++pass) {
+      profiler.add_pass({make_sample(0x10, "slow.exe", "Main", 2 * kUs, 3 * kMs),
+                         make_sample(0x20, "editor.exe", "a.txt")},
+                        4 * kMs);
+    }
+    auto report = profiler.report(IgnoreOptions{});
+    REQUIRE(report.processes.size() == 2);
+    CHECK(report.processes[0].process == "slow.exe");
+    CHECK(report.processes[0].offender);
+    CHECK_FALSE(report.processes[1].offender);
+    REQUIRE(report.suggestions.size() == 1);
+    CHECK(report.suggestions[0].kind == IgnoreSuggestion::Kind::Process);
+    CHECK(report.suggestions[0].process == "slow.exe");
+    CHECK(contains(report.suggestions[0].reason, "OpenProcess"));
+  }
+
+  TEST_CASE("one rare slow query is enough to flag a process") {
+    EnumProfiler profiler;
+    profiler.add_pass({make_sample(0x10, "hung.exe", "Main", 50 * kMs)}, 51 * kMs);
+    for (int pass = 0; pass < 99; ++pass) {
+      profiler.add_pass({make_sample(0x10, "hung.exe", "Main")}, 30 * kUs);
+    }
+    auto report = profiler.report(IgnoreOptions{});
+    CHECK(report.processes[0].ns_per_pass < EnumProfileThresholds{}.offender_pass_ns);
+    CHECK(report.processes[0].offender);
+  }
+
+  TEST_CASE("a process dominated by one title gets a process/title pair") {
+    EnumProfiler profiler;
+    for (int pass = 0; pass < 5; ++pass) {
+      profiler.add_pass({make_sample(0x10, "browser.exe", "Inbox"),
+                         make_sample(0x20, "browser.exe", "Picture-in-picture", 5 * kMs)},
+                        6 * kMs);
+    }
+    auto report = profiler.report(IgnoreOptions{});
+    REQUIRE(report.suggestions.size() == 1);
+    CHECK(report.suggestions[0].kind == IgnoreSuggestion::Kind::ProcessTitlePair);
+    CHECK(report.suggestions[0].process == "browser.exe");
+    CHECK(report.suggestions[0].title == "Picture-in-picture");
+  }
+
+  TEST_CASE("windows of unknown processes get a title rule") {
+    EnumProfiler profiler;
+    profiler.add_pass({make_sample(0x10, "", "Elevated Console", 2 * kUs, 5 * kMs)}, 6 * kMs);
+    auto report = profiler.report(IgnoreOptions{});
+    REQUIRE(report.suggestions.size() == 1);
+    CHECK(report.suggestions[0].kind == IgnoreSuggestion::Kind::WindowTitle);
+    CHECK(report.suggestions[0].title == "Elevated Console");
+  }
+
+  TEST_CASE("rules that are already configured are not suggested again") {
+    EnumProfiler profiler;
+    profiler.add_pass({make_sample(0x10, "slow.exe", "Main", 2 * kUs, 5 * kMs),
+                       make_sample(0x20, "browser.exe", "Inbox"),
+                       make_sample(0x30, "browser.exe", "PiP", 5 * kMs),
+                       make_sample(0x40, "", "Elevated", 5 * kMs)},
+                      20 * kMs);
+    IgnoreOptions ignore;
+    ignore.ignored_processes = {"slow.exe"};
+    ignore.ignored_process_title_pairs = {{"BROWSER.EXE", "pip"}};
+    ignore.ignored_window_titles = {"Elevated"};
+    auto report = profiler.report(ignore);
+    CHECK(report.processes[0].offender);
+    CHECK(report.suggestions.empty());
+  }
+
+  TEST_CASE("offenders are capped") {
+    EnumProfiler profiler;
+    std::vector<WindowQuerySample> samples;
+    for (size_t i = 0; i < 5; ++i) {
+      samples.push_back(
+          make_sample(0x10 * (i + 1), "app" + std::to_string(i) + ".exe", "Main", 2 * kMs));
+    }
+    profiler.add_pass(samples, 12 * kMs);
+    EnumProfileThresholds thresholds;
+    thresholds.max_offenders = 2;
+    auto report = profiler.report(IgnoreOptions{}, thresholds);
+    CHECK(report.processes[0].offender);
+    CHECK(report.processes[1].offender);
+    CHECK_FALSE(report.processes[2].offender);
+    CHECK(report.suggestions.size() == 2);
+  }
+}
+
+TEST_SUITE("enum profile - report") {
+  TEST_CASE("the report lists APIs, processes and a TOML snippet") {
+    EnumProfiler profiler;
+    for (int pass = 0; pass < 3; ++pass) {
+      profiler.add_pass({make_sample(0x10, "slow.exe", "Main", 2 * kUs, 3 * kMs),
+                         make_sample(0x20, "browser.exe", "Inbox"),
+                         make_sample(0x30, "browser.exe", "Say \"hi\"", 4 * kMs),
+                         make_sample(0x40, "", "Admin", 2 * kUs, 2 * kMs)},
+                        10 * kMs);
+    }
+    auto text = format_enum_profile_report(profiler.report(IgnoreOptions{}));
+    CHECK(contains(text, "Enumeration profile: 3 passes, 10.00ms avg"));
+    CHECK(contains(text, "By API:"));
+    CHECK(contains(text, "OpenProcess"));
+    CHECK(contains(text, "! slow.exe"));
+    CHECK(contains(text, "! <unknown>"));
+    CHECK(contains(text, "processes = [\"slow.exe\"]"));
+    CHECK(contains(text, "process_title_pairs = [{ process = \"browser.exe\", "
+                         "title = \"Say \\\"hi\\\"\" }]"));
+    CHECK(contains(text, "window_titles = [\"Admin\"]"));
+  }
+
+  TEST_CASE("a clean profile says so") {
+    EnumProfiler profiler;
+    profiler.add_pass({make_sample(0x10, "editor.exe", "a.txt")}, 50 * kUs);
+    auto text = format_enum_profile_report(profiler.report(IgnoreOptions{}));
+    CHECK(contains(text, "No ignore rules suggested."));
+  }
+}
+
+#endif // !DOCTEST_CONFIG_DISABLE
@@ -0,0 +1,615 @@
+#ifndef DOCTEST_CONFIG_DISABLE
+
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "executor.h"
+#include "live_resize.h"
+#include "loop_tasks.h"
+
+using namespace wintiler;
+using namespace std::chrono_literals;
+
+namespace {
+
+// Virtual clock: waiting jumps straight to the next deadline or scripted event,
+// hooks "spend" time by advancing it.
+struct SimBackend {
+  exec::TimePoint time{};
+  exec::TimePoint end = exec::TimePoint{} + 10s;
+  std::vector<exec::TimePoint> scripted_events; // sorted
+  size_t next_event = 0;
+  exec::Executor* executor = nullptr;
+
+  exec::Executor::Backend backend() {
+    return {[this] { return time; },
+            [this](std::optional<exec::TimePoint> deadline) { wait(deadline); }, nullptr};
+  }
+
+  void wait(std::optional<exec::TimePoint> deadline) {
+    exec::TimePoint target = deadline.value_or(end);
+    if (next_event < scripted_events.size()) {
+      target = std::min(target, scripted_events[next_event]);
+    }
+    if (target >= end) {
+      time = end;
+      executor->stop();
+      return;
+    }
+    time = std::max(time, target);
+  }
+
+  // Move scripted events that are due into out
+  void collect(std::vector<exec::TimePoint>& out) {
+    while (next_event < scripted_events.size() && scripted_events[next_event] <= time) {
+      out.push_back(scripted_events[next_event++]);
+    }
+  }
+
+  void spend(exec::Duration duration) {
+    time += duration;
+  }
+};
+
+exec::Task record_after_sleep(exec::Executor& ex, exec::Duration delay, std::string name,
+                              std::vector<std::string>& log) {
+  co_await ex.sleep_for(delay);
+  log.push_back(name);
+}
+
+exec::Task record_now(std::string name, std::vector<std::string>& log) {
+  log.push_back(name);
+  co_return;
+}
+
+exec::Task yield_twice(exec::Executor& ex, std::string name, std::vector<std::string>& log) {
+  log.push_back(name + "1");
+  co_await ex.yield();
+  log.push_back(name + "2");
+}
+
+exec::Task wait_event(exec::Event& event, std::optional<exec::Duration> timeout,
+                      std::vector<bool>& results) {
+  if (timeout.has_value()) {
+    results.push_back(co_await event.wait_for(*timeout));
+  } else {
+    results.push_back(co_await event.wait());
+  }
+}
+
+// Count signaled wakeups until a wait times out
+exec::Task count_wakeups(exec::Event& event, int& runs) {
+  for (;;) {
+    bool signaled = co_await event.wait_for(100ms);
+    if (!signaled) {
+      co_return;
+    }
+    ++runs;
+  }
+}
+
+exec::Task set_times(exec::Event& event, int times) {
+  for (int i = 0; i < times; ++i) {
+    event.set();
+  }
+  co_return;
+}
+
+} // namespace
+
+TEST_SUITE("executor - primitives") {
+  TEST_CASE("sleeping tasks resume in deadline order") {
+    SimBackend sim;
+    exec::Executor ex(sim.backend());
+    sim.executor = &ex;
+
+    std::vector<std::string> log;
+    ex.spawn(record_after_sleep(ex, 30ms, "c", log));
+    ex.spawn(record_after_sleep(ex, 10ms, "a", log));
+    ex.spawn(record_after_sleep(ex, 20ms, "b", log));
+    ex.run();
+
+    CHECK(log == std::vector<std::string>{"a", "b", "c"});
+    CHECK(sim.time == exec::TimePoint{} + 30ms);
+    CHECK(ex.task_count() == 0);
+  }
+
+  TEST_CASE("higher priority tasks run first and yield interleaves equals") {
+    SimBackend sim;
+    exec::Executor ex(sim.backend());
+    sim.executor = &ex;
+
+    std::vector<std::string> log;
+    ex.spawn(record_now("low", log), exec::Priority::Low);
+    ex.spawn(yield_twice(ex, "x", log), exec::Priority::Normal);
+    ex.spawn(yield_twice(ex, "y", log), exec::Priority::Normal);
+    ex.spawn(record_now("high", log), exec::Priority::High);
+    ex.run();
+
+    CHECK(log == std::vector<std::string>{"high", "x1", "y1", "x2", "y2", "low"});
+  }
+
+  TEST_CASE("event set before wait is remembered and coalesced") {
+    SimBackend sim;
+    exec::Executor ex(sim.backend());
+    sim.executor = &ex;
+
+    exec::Event event(ex);
+    event.set();
+    event.set();
+    CHECK(event.is_set());
+
+    std::vector<bool> results;
+    ex.spawn(wait_event(event, std::nullopt, results));
+    ex.run();
+
+    CHECK(results == std::vector<bool>{true});
+    CHECK_FALSE(event.is_set());
+  }
+
+  TEST_CASE("sets made while the waiter's wakeup is queued coalesce into it") {
+    SimBackend sim;
+    exec::Executor ex(sim.backend());
+    sim.executor = &ex;
+
+    exec::Event event(ex);
+    int runs = 0;
+    ex.spawn(count_wakeups(event, runs)); // Suspends in its first wait
+    ex.spawn(set_times(event, 3));        // First set queues the waiter, the rest coalesce
+    ex.run();
+
+    CHECK(runs == 1);
+    CHECK_FALSE(event.is_set());
+    CHECK(ex.task_count() == 0);
+  }
+
+  TEST_CASE("timed event wait reports timeout or signal") {
+    SimBackend sim;
+    exec::Executor ex(sim.backend());
+    sim.executor = &ex;
+
+    exec::Event timed_out(ex);
+    exec::Event signaled(ex);
+    std::vector<bool> timeout_results;
+    std::vector<bool> signal_results;
+    ex.spawn(wait_event(timed_out, 50ms, timeout_results));
+    ex.spawn(wait_event(signaled, 50ms, signal_results));
+
+    // Signal the second event at 20ms from another task
+    struct Setter {
+      static exec::Task run(exec::Executor& ex, exec::Event& event) {
+        co_await ex.sleep_for(20ms);
+        event.set();
+      }
+    };
+    ex.spawn(Setter::run(ex, signaled));
+    ex.run();
+
+    CHECK(timeout_results == std::vector<bool>{false});
+    CHECK(signal_results == std::vector<bool>{true});
+    CHECK(sim.time == exec::TimePoint{} + 50ms);
+  }
+
+  TEST_CASE("a signaled timed wait no longer drives the backend deadline") {
+    SimBackend sim;
+    std::vector<exec::TimePoint> deadlines;
+    exec::Executor ex({[&] { return sim.time; },
+                       [&](std::optional<exec::TimePoint> deadline) {
+                         if (deadline.has_value()) {
+                           deadlines.push_back(*deadline);
+                         }
+                         sim.wait(deadline);
+                       },
+                       nullptr});
+    sim.executor = &ex;
+
+    // The waiter is signaled at 20ms, well before its 1s timeout, then sleeps until 5020ms
+    exec::Event event(ex);
+    struct Tasks {
+      static exec::Task wait_then_sleep(exec::Executor& ex, exec::Event& event) {
+        bool signaled = co_await event.wait_for(1s);
+        CHECK(signaled);
+        co_await ex.sleep_for(5s);
+      }
+      static exec::Task set_later(exec::Executor& ex, exec::Event& event) {
+        co_await ex.sleep_for(20ms);
+        event.set();
+      }
+    };
+    ex.spawn(Tasks::wait_then_sleep(ex, event));
+    ex.spawn(Tasks::set_later(ex, event));
+    ex.run();
+
+    CHECK(deadlines == std::vector<exec::TimePoint>{exec::TimePoint{} + 20ms,
+                                                    exec::TimePoint{} + 5020ms});
+    CHECK(sim.time == exec::TimePoint{} + 5020ms);
+    CHECK(ex.task_count() == 0);
+  }
+
+  TEST_CASE("destroying executor releases suspended tasks") {
+    SimBackend sim;
+    std::vector<bool> results;
+    {
+      exec::Executor ex(sim.backend());
+      sim.executor = &ex;
+      exec::Event never(ex);
+      ex.spawn(wait_event(never, std::nullopt, results));
+      ex.run(); // Stops when the simulated end time is reached
+      CHECK(ex.task_count() == 1);
+    }
+    CHECK(results.empty());
+  }
+}
+
+TEST_SUITE("executor - loop tasks") {
+  TEST_CASE("hotkeys never wait behind enumeration or render") {
+    constexpr auto kGatherCost = 40ms;
+    constexpr auto kApplyCost = 3ms;
+    constexpr auto kRenderCost = 12ms;
+    constexpr auto kResyncInterval = 100ms;
+
+    SimBackend sim;
+    sim.end = exec::TimePoint{} + 2s;
+    // Hotkeys scattered across the run, several landing inside an enumeration
+    for (int ms : {5, 101, 117, 250, 333, 480, 505, 777, 901, 1203, 1540, 1999}) {
+      sim.scripted_events.push_back(exec::TimePoint{} + std::chrono::milliseconds(ms));
+    }
+
+    exec::Executor ex(sim.backend());
+    sim.executor = &ex;
+
+    std::vector<exec::TimePoint> pending;
+    std::vector<exec::Duration> latencies;
+    int gathers = 0;
+    int applies = 0;
+    int renders = 0;
+
+    LoopHooks hooks;
+    hooks.poll = [&] {
+      sim.collect(pending);
+      LoopSignals signals;
+      signals.hotkey = !pending.empty();
+      return signals;
+    };
+    hooks.handle_hotkeys = [&] {
+      for (auto injected : pending) {
+        latencies.push_back(sim.time - injected);
+      }
+      pending.clear();
+      sim.spend(1ms);
+      return true;
+    };
+    hooks.handle_ipc = [] {};
+    hooks.handle_window_event = [] {};
+    hooks.check_config = [] { return false; };
+    hooks.check_monitors = [] { return false; };
+    hooks.gather = [&] {
+      sim.spend(kGatherCost);
+      ++gathers;
+      return true;
+    };
+    hooks.apply = [&] {
+      sim.spend(kApplyCost);
+      ++applies;
+    };
+    hooks.render = [&]() -> std::optional<exec::Duration> {
+      sim.spend(kRenderCost);
+      ++renders;
+      return std::nullopt;
+    };
+
+    LoopSchedule schedule;
+    schedule.resync_interval = [&] { return exec::Duration(kResyncInterval); };
+
+    LoopTasks tasks(ex, hooks, schedule);
+    tasks.start();
+    ex.run();
+
+    REQUIRE(latencies.size() == sim.scripted_events.size());
+    auto worst = *std::max_element(latencies.begin(), latencies.end());
+    // Worst case is waiting for the single step already running, never a full cycle
+    CHECK(worst <= kGatherCost);
+    CHECK(worst < kResyncInterval);
+    CHECK(gathers >= 10);
+    CHECK(applies >= gathers);
+    CHECK(renders >= 1);
+    CHECK(renders <= applies); // Render requests coalesce
+  }
+
+  TEST_CASE("exit hotkey stops the loop and resync request wakes enumeration early") {
+    SimBackend sim;
+    sim.scripted_events = {exec::TimePoint{} + 10ms, exec::TimePoint{} + 500ms};
+
+    exec::Executor ex(sim.backend());
+    sim.executor = &ex;
+
+    std::vector<exec::TimePoint> pending;
+    std::vector<exec::TimePoint> gather_times;
+    int hotkeys_seen = 0;
+
+    LoopHooks hooks;
+    hooks.poll = [&] {
+      size_t before = pending.size();
+      sim.collect(pending);
+      LoopSignals signals;
+      // First event is a resync request (e.g. session resume), second is the exit hotkey
+      signals.resync = before == 0 && pending.size() == 1;
+      signals.hotkey = pending.size() >= 2;
+      return signals;
+    };
+    hooks.handle_hotkeys = [&] {
+      ++hotkeys_seen;
+      return false;
+    };
+    hooks.handle_ipc = [] {};
+    hooks.handle_window_event = [] {};
+    hooks.check_config = [] { return false; };
+    hooks.check_monitors = [] { return false; };
+    hooks.gather = [&] {
+      gather_times.push_back(sim.time);
+      return true;
+    };
+    hooks.apply = [] {};
+    hooks.render = []() -> std::optional<exec::Duration> { return std::nullopt; };
+
+    LoopSchedule schedule;
+    schedule.resync_interval = [] { return exec::Duration(1s); };
+
+    LoopTasks tasks(ex, hooks, schedule);
+    tasks.start();
+    ex.run();
+
+    CHECK(hotkeys_seen == 1);
+    CHECK(ex.is_stopped());
+    CHECK(sim.time == exec::TimePoint{} + 500ms);
+    REQUIRE(gather_times.size() == 2);
+    CHECK(gather_times[1] == exec::TimePoint{} + 10ms);
+  }
+
+  TEST_CASE("pointer signal runs the layout pass without a gather") {
+    SimBackend sim;
+    sim.end = exec::TimePoint{} + 300ms;
+    sim.scripted_events = {exec::TimePoint{} + 50ms, exec::TimePoint{} + 120ms,
+                           exec::TimePoint{} + 200ms};
+
+    exec::Executor ex(sim.backend());
+    sim.executor = &ex;
+
+    std::vector<exec::TimePoint> pending;
+    std::vector<exec::TimePoint> apply_times;
+    int gathers = 0;
+
+    LoopHooks hooks;
+    hooks.poll = [&] {
+      size_t before = pending.size();
+      sim.collect(pending);
+      LoopSignals signals;
+      signals.pointer = pending.size() > before;
+      return signals;
+    };
+    hooks.handle_hotkeys = [] { return true; };
+    hooks.handle_ipc = [] {};
+    hooks.handle_window_event = [] {};
+    hooks.check_config = [] { return false; };
+    hooks.check_monitors = [] { return false; };
+    hooks.gather = [&] {
+      ++gathers;
+      return true;
+    };
+    hooks.apply = [&] { apply_times.push_back(sim.time); };
+    hooks.render = []() -> std::optional<exec::Duration> { return std::nullopt; };
+
+    LoopSchedule schedule;
+    schedule.resync_interval = [] { return exec::Duration(10s); };
+
+    LoopTasks tasks(ex, hooks, schedule);
+    tasks.start();
+    ex.run();
+
+    CHECK(gathers == 1); // Only the startup enumeration
+    REQUIRE(apply_times.size() == 4);
+    CHECK(apply_times[1] == exec::TimePoint{} + 50ms);
+    CHECK(apply_times[2] == exec::TimePoint{} + 120ms);
+    CHECK(apply_times[3] == exec::TimePoint{} + 200ms);
+  }
+
+  TEST_CASE("live resize reflows once per frame and still lands the last change") {
+    SimBackend sim;
+    sim.end = exec::TimePoint{} + 200ms;
+    // A burst of location changes at mouse rate, then the mouse rests
+    for (int ms = 10; ms <= 18; ms += 2) {
+      sim.scripted_events.push_back(exec::TimePoint{} + std::chrono::milliseconds(ms));
+    }
+
+    exec::Executor ex(sim.backend());
+    sim.executor = &ex;
+
+    std::vector<exec::TimePoint> pending;
+    std::vector<exec::TimePoint> reflow_times;
+    LiveResizeThrottle throttle(16ms);
+    int applies = 0;
+    int renders = 0;
+
+    LoopHooks hooks;
+    hooks.poll = [&] {
+      size_t before = pending.size();
+      sim.collect(pending);
+      for (size_t i = before; i < pending.size(); ++i) {
+        throttle.on_location(42);
+      }
+      LoopSignals signals;
+      signals.drag_location = pending.size() > before;
+      return signals;
+    };
+    hooks.handle_hotkeys = [] { return true; };
+    hooks.handle_ipc = [] {};
+    hooks.handle_window_event = [] {};
+    hooks.check_config = [] { return false; };
+    hooks.check_monitors = [] { return false; };
+    hooks.gather = [] { return true; };
+    hooks.apply = [&] { ++applies; };
+    hooks.render = [&]() -> std::optional<exec::Duration> {
+      ++renders;
+      return std::nullopt;
+    };
+    hooks.live_resize = [&] {
+      LiveResizeTick tick;
+      if (throttle.take(sim.time).has_value()) {
+        reflow_times.push_back(sim.time);
+        sim.spend(1ms);
+        throttle.record_cost(1ms);
+        tick.reflowed = true;
+      }
+      tick.due = throttle.time_until_due(sim.time);
+      return tick;
+    };
+
+    LoopSchedule schedule;
+    schedule.resync_interval = [] { return exec::Duration(10s); };
+
+    LoopTasks tasks(ex, hooks, schedule);
+    tasks.start();
+    ex.run();
+
+    CHECK(applies == 1); // Only the startup layout pass; reflows bypass it
+    REQUIRE(reflow_times.size() == 2);
+    CHECK(reflow_times[0] == exec::TimePoint{} + 10ms);
+    CHECK(reflow_times[1] == exec::TimePoint{} + 26ms);
+    CHECK(throttle.stats().events == 5);
+    CHECK(renders == 3); // Startup plus one per reflow, none for held-back changes
+  }
+}
+
+TEST_SUITE("executor - adaptive interval") {
+  TEST_CASE("idle ticks back off exponentially and changes reset to min") {
+    AdaptiveInterval interval(50ms, 1000ms);
+    CHECK(interval.current() == 50ms);
+
+    std::vector<exec::Duration> seen;
+    for (int i = 0; i < 8; ++i) {
+      interval.on_tick(false);
+      seen.push_back(interval.current());
+    }
+    std::vector<exec::Duration> expected{50ms, 100ms, 200ms, 400ms, 800ms, 1000ms, 1000ms, 1000ms};
+    CHECK(seen == expected);
+
+    interval.on_tick(true);
+    CHECK(interval.current() == 50ms);
+
+    // One idle tick after a change is not enough to back off again
+    interval.on_tick(false);
+    CHECK(interval.current() == 50ms);
+
+    interval.on_tick(false);
+    interval.on_tick(false);
+    CHECK(interval.current() == 200ms);
+    interval.on_activity();
+    CHECK(interval.current() == 50ms);
+  }
+
+  TEST_CASE("new bounds clamp the current interval") {
+    AdaptiveInterval interval(50ms, 1000ms);
+    for (int i = 0; i < 10; ++i) {
+      interval.on_tick(false);
+    }
+    CHECK(interval.current() == 1000ms);
+    interval.set_bounds(20ms, 300ms);
+    CHECK(interval.current() == 300ms);
+    interval.on_activity();
+    CHECK(interval.current() == 20ms);
+  }
+
+  TEST_CASE("wakeup meter reports once per window") {
+    WakeupMeter meter(1s);
+    exec::TimePoint t{};
+    std::optional<double> rate;
+    for (int i = 0; i <= 20; ++i) {
+      rate = meter.record(t + i * 50ms);
+      if (i < 20) {
+        CHECK_FALSE(rate.has_value());
+      }
+    }
+    REQUIRE(rate.has_value());
+    CHECK(*rate == doctest::Approx(21.0));
+    CHECK(meter.total() == 21);
+  }
+
+  TEST_CASE("simulated idle desktop wakes rarely and reacts fast after a change") {
+    constexpr auto kNewWindowAt = exec::TimePoint{} + 30s;
+
+    auto run = [&](bool adaptive, std::vector<exec::TimePoint>& gather_times,
+                   std::optional<double>& last_rate) {
+      SimBackend sim;
+      sim.end = exec::TimePoint{} + 60s;
+      WakeupMeter meter(10s);
+      exec::Executor ex({[&] { return sim.time; },
+                         [&](std::optional<exec::TimePoint> deadline) {
+                           sim.wait(deadline);
+                           if (auto rate = meter.record(sim.time)) {
+                             last_rate = rate;
+                           }
+                         },
+                         nullptr});
+      sim.executor = &ex;
+
+      AdaptiveInterval interval(50ms, 1000ms);
+      bool window_seen = false;
+
+      LoopHooks hooks;
+      hooks.poll = [] { return LoopSignals{}; };
+      hooks.handle_hotkeys = [] { return true; };
+      hooks.handle_ipc = [] {};
+      hooks.handle_window_event = [] {};
+      hooks.check_config = [] { return false; };
+      hooks.check_monitors = [] { return false; };
+      hooks.gather = [&] {
+        gather_times.push_back(sim.time);
+        sim.spend(2ms);
+        return true;
+      };
+      hooks.apply = [&] {
+        // The only change in the whole run: a window opens at 30s
+        bool changed = !window_seen && sim.time >= kNewWindowAt;
+        window_seen = window_seen || changed;
+        interval.on_tick(changed);
+      };
+      hooks.render = []() -> std::optional<exec::Duration> { return std::nullopt; };
+
+      LoopSchedule schedule;
+      schedule.resync_interval = [&] {
+        return adaptive ? interval.current() : exec::Duration(50ms);
+      };
+
+      LoopTasks tasks(ex, hooks, schedule);
+      tasks.start();
+      ex.run();
+    };
+
+    std::vector<exec::TimePoint> adaptive_gathers;
+    std::vector<exec::TimePoint> fixed_gathers;
+    std::optional<double> adaptive_rate;
+    std::optional<double> fixed_rate;
+    run(true, adaptive_gathers, adaptive_rate);
+    run(false, fixed_gathers, fixed_rate);
+
+    // Mostly idle: far fewer enumerations and wakeups than a fixed min interval
+    CHECK(adaptive_gathers.size() * 10 < fixed_gathers.size());
+    REQUIRE(adaptive_rate.has_value());
+    REQUIRE(fixed_rate.has_value());
+    CHECK(*adaptive_rate < 5.0);
+    CHECK(*fixed_rate > 15.0);
+
+    // The change is noticed within one max interval, then polling is fast again
+    auto detected = std::find_if(adaptive_gathers.begin(), adaptive_gathers.end(),
+                                 [&](exec::TimePoint t) { return t >= kNewWindowAt; });
+    REQUIRE(detected != adaptive_gathers.end());
+    CHECK(*detected - kNewWindowAt <= 1000ms + 2ms);
+    REQUIRE(detected + 1 != adaptive_gathers.end());
+    CHECK(*(detected + 1) - *detected <= 50ms + 2ms);
+  }
+}
+
+#endif // !DOCTEST_CONFIG_DISABLE
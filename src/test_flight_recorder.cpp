@@ -0,0 +1,157 @@
+#ifndef DOCTEST_CONFIG_DISABLE
+
+#include <doctest/doctest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "flight_recorder.h"
+
+using namespace wintiler;
+
+namespace {
+
+std::string read_file(const std::filesystem::path& path) {
+  std::ifstream file(path);
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  return buffer.str();
+}
+
+} // namespace
+
+TEST_SUITE("flight recorder - ring buffer") {
+  TEST_CASE("capacity rounds up to a power of two") {
+    CHECK(FlightRecorder(1).capacity() == 1);
+    CHECK(FlightRecorder(5).capacity() == 8);
+    CHECK(FlightRecorder(64).capacity() == 64);
+    CHECK(FlightRecorder(0).capacity() == 1);
+  }
+
+  TEST_CASE("events are returned oldest first before wraparound") {
+    FlightRecorder recorder(8);
+    for (uint64_t i = 0; i < 5; ++i) {
+      recorder.record(FlightEventType::TickStart, i);
+    }
+    CHECK(recorder.size() == 5);
+    CHECK(recorder.total_recorded() == 5);
+    auto events = recorder.snapshot();
+    REQUIRE(events.size() == 5);
+    for (uint64_t i = 0; i < 5; ++i) {
+      CHECK(events[i].id == i);
+    }
+  }
+
+  TEST_CASE("wraparound keeps only the newest capacity events") {
+    FlightRecorder recorder(8);
+    for (uint64_t i = 0; i < 21; ++i) {
+      recorder.record(FlightEventType::LeafAdded, i);
+    }
+    CHECK(recorder.size() == 8);
+    CHECK(recorder.total_recorded() == 21);
+    auto events = recorder.snapshot();
+    REQUIRE(events.size() == 8);
+    for (size_t i = 0; i < events.size(); ++i) {
+      CHECK(events[i].id == 13 + i);
+    }
+    // Timestamps never go backwards across the wrap point
+    for (size_t i = 1; i < events.size(); ++i) {
+      CHECK(events[i].time_us >= events[i - 1].time_us);
+    }
+  }
+
+  TEST_CASE("clear empties the buffer") {
+    FlightRecorder recorder(4);
+    recorder.record(FlightEventType::ConfigReload);
+    recorder.clear();
+    CHECK(recorder.size() == 0);
+    CHECK(recorder.snapshot().empty());
+  }
+}
+
+TEST_SUITE("flight recorder - decoding") {
+  TEST_CASE("text decoding names the payload fields per type") {
+    FlightEvent tile{1500000, 0x1a2b, 0, 10, 960, 1040, FlightEventType::TileUpdate};
+    CHECK(format_flight_event(tile) ==
+          "    1.500000 TileUpdate leaf=0x1a2b x=0 y=10 width=960 height=1040");
+
+    FlightEvent tick_end{42, 7, 350, 3, 1, 2, FlightEventType::TickEnd};
+    CHECK(format_flight_event(tick_end) ==
+          "    0.000042 TickEnd tick=7 duration_us=350 tiles=3 added=1 removed=2");
+
+    FlightEvent reload{0, 0, 0, 0, 0, 0, FlightEventType::ConfigReload};
+    CHECK(format_flight_event(reload) == "    0.000000 ConfigReload");
+  }
+
+  TEST_CASE("json decoding round-trips every event type") {
+    FlightRecorder recorder(16);
+    recorder.record(FlightEventType::TickStart, 1);
+    recorder.record(FlightEventType::LeafAdded, 0x100);
+    recorder.record(FlightEventType::LeafRemoved, 0x200);
+    recorder.record(FlightEventType::TileUpdate, 0x100, -8, 0, 1936, 1048);
+    recorder.record(FlightEventType::Hotkey, 0, 3);
+    recorder.record(FlightEventType::DropMove, 0x100, 500, 400, 1, 1);
+    recorder.record(FlightEventType::MonitorChange, 0, 2);
+    recorder.record(FlightEventType::ConfigReload);
+    recorder.record(FlightEventType::IpcBatch, 0, 4, 1);
+    recorder.record(FlightEventType::TickEnd, 1, 120, 1, 1, 1);
+
+    auto events = recorder.snapshot();
+    auto json = flight_events_to_json(events);
+    REQUIRE(json.size() == events.size());
+    CHECK(json[3]["type"] == "TileUpdate");
+    CHECK(json[3]["leaf"] == 0x100);
+    CHECK(json[3]["x"] == -8);
+    CHECK(json[5]["exchange"] == 1);
+    CHECK_FALSE(json[7].contains("leaf"));
+
+    auto decoded = flight_events_from_json(nlohmann::json::parse(json.dump()));
+    REQUIRE(decoded.has_value());
+    REQUIRE(decoded->size() == events.size());
+    for (size_t i = 0; i < events.size(); ++i) {
+      CHECK((*decoded)[i].type == events[i].type);
+      CHECK((*decoded)[i].time_us == events[i].time_us);
+      CHECK((*decoded)[i].id == events[i].id);
+      CHECK((*decoded)[i].a == events[i].a);
+      CHECK((*decoded)[i].b == events[i].b);
+      CHECK((*decoded)[i].c == events[i].c);
+      CHECK((*decoded)[i].d == events[i].d);
+    }
+  }
+
+  TEST_CASE("json decoding rejects malformed input") {
+    CHECK_FALSE(flight_events_from_json(nlohmann::json::object()).has_value());
+    CHECK_FALSE(flight_events_from_json(nlohmann::json::parse(R"([{"type": "Bogus", "t_us": 0}])"))
+                    .has_value());
+    CHECK_FALSE(flight_events_from_json(nlohmann::json::parse(R"([{"type": "TickStart"}])"))
+                    .has_value());
+  }
+
+  TEST_CASE("dump writes text and json files") {
+    FlightRecorder recorder(4);
+    for (uint64_t i = 0; i < 6; ++i) {
+      recorder.record(FlightEventType::LeafAdded, i);
+    }
+    auto dir = std::filesystem::temp_directory_path();
+    auto text_path = dir / "win-tiler-test-flight.txt";
+    auto json_path = dir / "win-tiler-test-flight.json";
+
+    REQUIRE(write_flight_dump(recorder, text_path.string(), false));
+    auto text = read_file(text_path);
+    CHECK(text.find("# 4 of 6 recorded events") == 0);
+    CHECK(text.find("leaf=0x2") != std::string::npos);
+    CHECK(text.find("leaf=0x1\n") == std::string::npos);
+
+    REQUIRE(write_flight_dump(recorder, json_path.string(), true));
+    auto decoded = flight_events_from_json(nlohmann::json::parse(read_file(json_path)));
+    REQUIRE(decoded.has_value());
+    CHECK(decoded->size() == 4);
+
+    std::filesystem::remove(text_path);
+    std::filesystem::remove(json_path);
+  }
+}
+
+#endif // !DOCTEST_CONFIG_DISABLE
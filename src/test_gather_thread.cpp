@@ -0,0 +1,228 @@
+#ifndef DOCTEST_CONFIG_DISABLE
+
+#include <doctest/doctest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include "concurrent_queue.h"
+#include "gather_thread.h"
+
+using namespace wintiler;
+
+namespace {
+
+using SteadyClock = std::chrono::steady_clock;
+
+// Synthetic snapshot: the sequence number is encoded in the foreground window and repeated in
+// every window handle so a torn read would be visible
+winapi::LoopInputState make_snapshot(uint64_t sequence, size_t monitors, size_t windows) {
+  winapi::LoopInputState state;
+  auto handle = reinterpret_cast<winapi::HWND_T>(static_cast<uintptr_t>(sequence));
+  state.foreground_window = handle;
+  state.windows_per_monitor.resize(monitors);
+  for (auto& monitor_windows : state.windows_per_monitor) {
+    monitor_windows.assign(windows, winapi::ManagedWindowInfo{handle, false});
+  }
+  return state;
+}
+
+uint64_t snapshot_sequence(const winapi::LoopInputState& state) {
+  return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(state.foreground_window));
+}
+
+bool snapshot_consistent(const winapi::LoopInputState& state) {
+  for (const auto& monitor_windows : state.windows_per_monitor) {
+    for (const auto& window : monitor_windows) {
+      if (window.handle != state.foreground_window) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+TEST_SUITE("gather thread - triple buffer") {
+  TEST_CASE("consumer sees only the newest published value") {
+    TripleBuffer<int> buffer;
+    CHECK_FALSE(buffer.update());
+
+    buffer.write_buffer() = 1;
+    buffer.publish();
+    buffer.write_buffer() = 2;
+    buffer.publish();
+
+    CHECK(buffer.update());
+    CHECK(buffer.read() == 2);
+    CHECK_FALSE(buffer.update()); // Nothing new
+    CHECK(buffer.read() == 2);
+
+    buffer.write_buffer() = 3;
+    buffer.publish();
+    CHECK(buffer.update());
+    CHECK(buffer.read() == 3);
+  }
+
+  TEST_CASE("throughput: synthetic producer against a busy consumer") {
+    constexpr uint64_t kSnapshots = 20000;
+    constexpr size_t kMonitors = 3;
+    constexpr size_t kWindowsPerMonitor = 16;
+
+    TripleBuffer<winapi::LoopInputState> buffer;
+    std::atomic<bool> done{false};
+
+    auto start = SteadyClock::now();
+    std::thread producer([&] {
+      for (uint64_t sequence = 1; sequence <= kSnapshots; ++sequence) {
+        buffer.write_buffer() = make_snapshot(sequence, kMonitors, kWindowsPerMonitor);
+        buffer.publish();
+      }
+      done = true;
+    });
+
+    uint64_t consumed = 0;
+    uint64_t last_sequence = 0;
+    bool monotonic = true;
+    bool consistent = true;
+    for (;;) {
+      bool finished = done.load();
+      while (buffer.update()) {
+        const auto& snapshot = buffer.read();
+        auto sequence = snapshot_sequence(snapshot);
+        monotonic = monotonic && sequence > last_sequence;
+        consistent = consistent && snapshot_consistent(snapshot) &&
+                     snapshot.windows_per_monitor.size() == kMonitors;
+        last_sequence = sequence;
+        ++consumed;
+      }
+      if (finished) {
+        break;
+      }
+      std::this_thread::yield();
+    }
+    producer.join();
+    auto elapsed = std::chrono::duration<double>(SteadyClock::now() - start).count();
+
+    CHECK(monotonic);
+    CHECK(consistent);
+    CHECK(last_sequence == kSnapshots); // The final snapshot is never lost
+    CHECK(consumed >= 1);
+    CHECK(consumed <= kSnapshots);
+    MESSAGE("published " << kSnapshots << " snapshots in " << elapsed * 1000.0 << " ms ("
+                         << static_cast<double>(kSnapshots) / elapsed << "/s), consumed "
+                         << consumed << ", dropped as stale " << kSnapshots - consumed);
+  }
+}
+
+TEST_SUITE("gather thread - worker") {
+  TEST_CASE("request publishes a snapshot and wakes the consumer") {
+    std::atomic<uint64_t> gathers{0};
+    std::atomic<int> wakes{0};
+    GatherThread gather_thread([&] { return make_snapshot(++gathers, 2, 4); }, [&] { ++wakes; });
+    gather_thread.start();
+    CHECK(gather_thread.is_running());
+    CHECK(gather_thread.take_latest() == nullptr);
+
+    gather_thread.request();
+    const winapi::LoopInputState* snapshot = nullptr;
+    auto deadline = SteadyClock::now() + std::chrono::seconds(5);
+    while (snapshot == nullptr && SteadyClock::now() < deadline) {
+      snapshot = gather_thread.take_latest();
+      std::this_thread::yield();
+    }
+    REQUIRE(snapshot != nullptr);
+    CHECK(snapshot_sequence(*snapshot) == 1);
+    CHECK(snapshot->windows_per_monitor.size() == 2);
+    CHECK(wakes.load() == 1);
+    CHECK(gather_thread.take_latest() == nullptr);
+
+    gather_thread.stop();
+    CHECK_FALSE(gather_thread.is_running());
+    CHECK(gather_thread.published() == 1);
+    CHECK(gather_thread.consumed() == 1);
+  }
+
+  TEST_CASE("requests during a slow gather coalesce and the consumer gets the newest") {
+    std::atomic<uint64_t> gathers{0};
+    std::atomic<bool> release{false};
+    std::atomic<bool> entered{false};
+    GatherThread gather_thread([&] {
+      entered = true;
+      while (!release.load()) {
+        std::this_thread::yield();
+      }
+      return make_snapshot(++gathers, 1, 1);
+    });
+    gather_thread.start();
+
+    gather_thread.request();
+    // Wait until the worker is inside the first gather, then pile up more requests
+    while (!entered.load()) {
+      std::this_thread::yield();
+    }
+    for (int i = 0; i < 10; ++i) {
+      gather_thread.request();
+    }
+    release = true;
+
+    auto deadline = SteadyClock::now() + std::chrono::seconds(5);
+    while (gather_thread.published() < 2 && SteadyClock::now() < deadline) {
+      std::this_thread::yield();
+    }
+    gather_thread.stop();
+
+    // One gather for the first request, one for all the coalesced ones
+    CHECK(gather_thread.published() == 2);
+    const auto* snapshot = gather_thread.take_latest();
+    REQUIRE(snapshot != nullptr);
+    CHECK(snapshot_sequence(*snapshot) == 2);
+    CHECK(gather_thread.consumed() == 1);
+  }
+
+  TEST_CASE("a gather that started before invalidate is dropped even if published after it") {
+    std::atomic<uint64_t> gathers{0};
+    std::atomic<uint64_t> allowed{0};
+    std::atomic<bool> entered{false};
+    GatherThread gather_thread([&] {
+      entered = true;
+      while (gathers.load() >= allowed.load()) {
+        std::this_thread::yield();
+      }
+      return make_snapshot(++gathers, 1, 1);
+    });
+    gather_thread.start();
+
+    gather_thread.request();
+    while (!entered.load()) {
+      std::this_thread::yield();
+    }
+    // The first gather is in progress: invalidate, then let it publish
+    gather_thread.invalidate();
+    allowed = 1;
+    auto deadline = SteadyClock::now() + std::chrono::seconds(5);
+    while (gather_thread.published() < 1 && SteadyClock::now() < deadline) {
+      std::this_thread::yield();
+    }
+    REQUIRE(gather_thread.published() == 1);
+    CHECK(gather_thread.take_latest() == nullptr);
+
+    // The gather invalidate requested is current
+    allowed = 2;
+    const winapi::LoopInputState* snapshot = nullptr;
+    while (snapshot == nullptr && SteadyClock::now() < deadline) {
+      snapshot = gather_thread.take_latest();
+      std::this_thread::yield();
+    }
+    gather_thread.stop();
+    REQUIRE(snapshot != nullptr);
+    CHECK(snapshot_sequence(*snapshot) == 2);
+    CHECK(gather_thread.published() == 2);
+    CHECK(gather_thread.consumed() == 1);
+  }
+}
+
+#endif // !DOCTEST_CONFIG_DISABLE
@@ -0,0 +1,186 @@
+#ifndef DOCTEST_CONFIG_DISABLE
+
+#include <doctest/doctest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "concurrent_queue.h"
+#include "input_events.h"
+
+using namespace wintiler;
+
+namespace {
+
+using SteadyClock = std::chrono::steady_clock;
+
+InputEvent make_event(InputEventType type, size_t hwnd, int hotkey_id = 0) {
+  InputEvent event;
+  event.type = type;
+  event.hwnd = hwnd;
+  event.hotkey_id = hotkey_id;
+  event.timestamp = SteadyClock::now();
+  return event;
+}
+
+} // namespace
+
+TEST_SUITE("input events - mpsc queue") {
+  TEST_CASE("single thread push and pop keep FIFO order") {
+    MpscQueue<int, 4> queue;
+    CHECK(queue.empty());
+    CHECK(queue.try_push(1));
+    CHECK(queue.try_push(2));
+    CHECK(queue.try_push(3));
+    CHECK(queue.try_push(4));
+    CHECK_FALSE(queue.try_push(5)); // Full
+    CHECK(queue.try_pop() == 1);
+    CHECK(queue.try_push(5)); // Slot released by pop
+    CHECK(queue.try_pop() == 2);
+    CHECK(queue.try_pop() == 3);
+    CHECK(queue.try_pop() == 4);
+    CHECK(queue.try_pop() == 5);
+    CHECK_FALSE(queue.try_pop().has_value());
+    CHECK(queue.empty());
+  }
+
+  TEST_CASE("stress: concurrent producers lose nothing and keep per-producer order") {
+    constexpr int kProducers = 4;
+    constexpr int kEventsPerProducer = 50000;
+
+    // Small capacity so producers regularly hit a full queue and retry
+    MpscQueue<InputEvent, 256> queue;
+    std::atomic<bool> go{false};
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+      producers.emplace_back([&queue, &go, p] {
+        while (!go.load()) {
+          std::this_thread::yield();
+        }
+        for (int i = 0; i < kEventsPerProducer; ++i) {
+          auto event = make_event(InputEventType::Hotkey, static_cast<size_t>(p), i);
+          while (!queue.try_push(event)) {
+            std::this_thread::yield();
+          }
+        }
+      });
+    }
+
+    std::vector<int> next_expected(kProducers, 0);
+    int received = 0;
+    bool in_order = true;
+    go = true;
+    while (received < kProducers * kEventsPerProducer) {
+      auto event = queue.try_pop();
+      if (!event.has_value()) {
+        std::this_thread::yield();
+        continue;
+      }
+      auto producer = event->hwnd;
+      if (event->hotkey_id != next_expected[producer]) {
+        in_order = false;
+      }
+      next_expected[producer] = event->hotkey_id + 1;
+      ++received;
+    }
+    for (auto& producer : producers) {
+      producer.join();
+    }
+
+    CHECK(in_order);
+    CHECK(received == kProducers * kEventsPerProducer);
+    for (int p = 0; p < kProducers; ++p) {
+      CHECK(next_expected[p] == kEventsPerProducer);
+    }
+    CHECK(queue.empty());
+  }
+}
+
+TEST_SUITE("input events - state") {
+  TEST_CASE("drag start and end fold into a one-shot move_ended") {
+    InputEventState state;
+    apply_input_event(state, make_event(InputEventType::MoveSizeStart, 42));
+    CHECK(state.is_moving);
+    CHECK(state.moving_hwnd == 42u);
+    CHECK_FALSE(state.move_ended);
+
+    apply_input_event(state, make_event(InputEventType::MoveSizeEnd, 42));
+    CHECK_FALSE(state.is_moving);
+    CHECK(state.move_ended);
+    CHECK(state.moving_hwnd == 42u);
+
+    clear_drag_ended(state);
+    CHECK_FALSE(state.move_ended);
+    CHECK_FALSE(state.moving_hwnd.has_value());
+  }
+
+  TEST_CASE("end without a start still reports the window") {
+    InputEventState state;
+    apply_input_event(state, make_event(InputEventType::MoveSizeEnd, 7));
+    CHECK(state.move_ended);
+    CHECK(state.moving_hwnd == 7u);
+  }
+
+  TEST_CASE("drain collects hotkeys in order and reports latency") {
+    InputEventQueue queue;
+    auto start = SteadyClock::now();
+    auto first = make_event(InputEventType::Hotkey, 0, 3);
+    first.timestamp = start;
+    auto second = make_event(InputEventType::Hotkey, 0, 5);
+    second.timestamp = start + std::chrono::milliseconds(4);
+    REQUIRE(queue.try_push(first));
+    REQUIRE(queue.try_push(make_event(InputEventType::MoveSizeStart, 9)));
+    REQUIRE(queue.try_push(second));
+
+    InputEventState state;
+    auto drained = drain_input_events(queue, state, start + std::chrono::milliseconds(10));
+    CHECK(drained == 3);
+    CHECK(state.last_drained == 3);
+    CHECK(state.hotkey_ids == std::vector<int>{3, 5});
+    CHECK(state.is_moving);
+    CHECK(state.max_latency >= std::chrono::milliseconds(10));
+
+    CHECK(drain_input_events(queue, state, SteadyClock::now()) == 0);
+    CHECK(state.max_latency == SteadyClock::duration::zero());
+  }
+
+  TEST_CASE("cursor moves coalesce to the latest position") {
+    InputEventQueue queue;
+    for (int i = 1; i <= 5; ++i) {
+      auto move = make_event(InputEventType::CursorMove, 0);
+      move.x = i * 10;
+      move.y = i * 20;
+      REQUIRE(queue.try_push(move));
+    }
+
+    InputEventState state;
+    CHECK_FALSE(state.cursor_pos.has_value());
+    CHECK(drain_input_events(queue, state, SteadyClock::now()) == 5);
+    CHECK(state.cursor_moved);
+    CHECK(state.cursor_pos == std::make_pair(50, 100));
+    CHECK(state.hotkey_ids.empty());
+    CHECK_FALSE(state.is_moving);
+  }
+
+  TEST_CASE("location changes count only for the window being dragged") {
+    InputEventState state;
+    apply_input_event(state, make_event(InputEventType::WindowLocation, 42));
+    CHECK_FALSE(state.drag_location_changed); // No drag in progress
+
+    apply_input_event(state, make_event(InputEventType::MoveSizeStart, 42));
+    apply_input_event(state, make_event(InputEventType::WindowLocation, 7));
+    CHECK_FALSE(state.drag_location_changed);
+    apply_input_event(state, make_event(InputEventType::WindowLocation, 42));
+    CHECK(state.drag_location_changed);
+
+    // The end of the drag supersedes pending location changes
+    apply_input_event(state, make_event(InputEventType::MoveSizeEnd, 42));
+    CHECK_FALSE(state.drag_location_changed);
+    apply_input_event(state, make_event(InputEventType::WindowLocation, 42));
+    CHECK_FALSE(state.drag_location_changed);
+  }
+}
+
+#endif // !DOCTEST_CONFIG_DISABLE
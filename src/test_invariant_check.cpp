@@ -0,0 +1,283 @@
+#ifndef DOCTEST_CONFIG_DISABLE
+
+#include <doctest/doctest.h>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "invariant_check.h"
+#include "multi_cells.h"
+
+using namespace wintiler;
+
+namespace {
+
+constexpr float kGap = 10.0f;
+
+cells::System make_system(size_t clusters, size_t leaves_per_cluster) {
+  std::vector<cells::ClusterInitInfo> infos;
+  size_t next_id = 1;
+  for (size_t c = 0; c < clusters; ++c) {
+    float x = 1920.0f * static_cast<float>(c);
+    cells::ClusterInitInfo info{x, 0.0f, 1920.0f, 1040.0f, x, 0.0f, 1920.0f, 1080.0f, {}};
+    for (size_t i = 0; i < leaves_per_cluster; ++i) {
+      info.initial_cell_ids.push_back(next_id++);
+    }
+    infos.push_back(info);
+  }
+  return cells::create_system(infos, kGap, kGap);
+}
+
+std::vector<cells::InvariantViolation::Type> types(
+    const std::vector<cells::InvariantViolation>& violations) {
+  std::vector<cells::InvariantViolation::Type> result;
+  for (const auto& v : violations) {
+    result.push_back(v.type);
+  }
+  return result;
+}
+
+bool has_type(const std::vector<cells::InvariantViolation>& violations,
+              cells::InvariantViolation::Type type) {
+  for (const auto& v : violations) {
+    if (v.type == type) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// First split cell that has a split child, so there are descendants below the child
+int find_grandparent(const cells::CellCluster& cluster) {
+  for (int i = 0; i < static_cast<int>(cluster.cells.size()); ++i) {
+    const auto& cell = cluster.cells[static_cast<size_t>(i)];
+    if (cell.first_child.has_value() && !cells::is_leaf(cluster, *cell.first_child)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+} // namespace
+
+TEST_SUITE("invariant check - cost") {
+  TEST_CASE("first pass checks every cell, an idle pass none") {
+    auto system = make_system(2, 8);
+    cells::InvariantChecker checker;
+    CHECK(checker.check(system).empty());
+    CHECK(checker.cells_checked() == 2 * 15); // 8 leaves and 7 splits per cluster
+
+    CHECK(checker.check(system).empty());
+    CHECK(checker.cells_checked() == 2 * 15);
+    CHECK(checker.passes() == 2);
+  }
+
+  TEST_CASE("a ratio change checks only the cells it moved") {
+    auto system = make_system(1, 16);
+    cells::InvariantChecker checker;
+    CHECK(checker.check(system).empty());
+    uint64_t before = checker.cells_checked();
+
+    auto& cluster = system.clusters[0].cluster;
+    int leaf = -1;
+    for (int i = static_cast<int>(cluster.cells.size()) - 1; i >= 0; --i) {
+      if (cells::is_leaf(cluster, i)) {
+        leaf = i;
+        break;
+      }
+    }
+    REQUIRE(leaf > 0);
+    int parent = *cluster.cells[static_cast<size_t>(leaf)].parent;
+    REQUIRE(cells::set_split_ratio(cluster, parent, 0.3f, kGap, kGap));
+    CHECK(checker.check(system).empty());
+    CHECK(checker.cells_checked() - before <= 2);
+  }
+
+  TEST_CASE("a full reset rechecks everything") {
+    auto system = make_system(1, 4);
+    cells::InvariantChecker checker;
+    CHECK(checker.check(system).empty());
+    checker.reset();
+    CHECK(checker.check(system).empty());
+    CHECK(checker.cells_checked() == 2 * 7);
+  }
+}
+
+TEST_SUITE("invariant check - detection") {
+  TEST_CASE("a child that does not point back is a broken link") {
+    auto system = make_system(1, 4);
+    cells::InvariantChecker checker;
+    CHECK(checker.check(system).empty());
+
+    auto& cluster = system.clusters[0].cluster;
+    cluster.cells[1].parent = 2;
+    cluster.touched_cells.push_back(1);
+    CHECK(has_type(checker.check(system), cells::InvariantViolation::Type::BrokenLink));
+  }
+
+  TEST_CASE("a split with one child has a bad shape") {
+    auto system = make_system(1, 4);
+    cells::InvariantChecker checker;
+    CHECK(checker.check(system).empty());
+
+    auto& cluster = system.clusters[0].cluster;
+    cluster.cells[0].second_child.reset();
+    cluster.touched_cells.push_back(0);
+    CHECK(has_type(checker.check(system), cells::InvariantViolation::Type::BadShape));
+  }
+
+  TEST_CASE("a leaf id held twice is found through the index") {
+    auto system = make_system(2, 4);
+    cells::InvariantChecker checker;
+    CHECK(checker.check(system).empty());
+
+    // Copy a leaf id from cluster 0 into cluster 1; only the copy is touched
+    auto& first = system.clusters[0].cluster;
+    auto& second = system.clusters[1].cluster;
+    auto source = cells::find_cell_by_leaf_id(first, 1);
+    auto target = cells::find_cell_by_leaf_id(second, 5);
+    REQUIRE(source.has_value());
+    REQUIRE(target.has_value());
+    second.cells[static_cast<size_t>(*target)].leaf_id = 1;
+    second.touched_cells.push_back(*target);
+
+    auto violations = checker.check(system);
+    REQUIRE(violations.size() == 1);
+    CHECK(violations[0].type == cells::InvariantViolation::Type::DuplicateLeafId);
+    CHECK(violations[0].cluster_index == 1);
+    CHECK(violations[0].leaf_id == 1);
+  }
+
+  TEST_CASE("a leaf id that moved is not a duplicate") {
+    auto system = make_system(2, 4);
+    cells::InvariantChecker checker;
+    CHECK(checker.check(system).empty());
+
+    auto point = cells::swap_cells(system, 0, 1, 1, 5, kGap, kGap);
+    REQUIRE(point.has_value());
+    CHECK(checker.check(system).empty());
+  }
+
+  TEST_CASE("a rect outside its parent is reported") {
+    auto system = make_system(1, 4);
+    cells::InvariantChecker checker;
+    CHECK(checker.check(system).empty());
+
+    auto& cluster = system.clusters[0].cluster;
+    cluster.cells[1].rect.x += 5000.0f;
+    cluster.touched_cells.push_back(1);
+    CHECK(types(checker.check(system)) ==
+          std::vector{cells::InvariantViolation::Type::RectOutsideParent});
+  }
+
+  TEST_CASE("a selection on a split cell is reported every pass") {
+    auto system = make_system(1, 4);
+    cells::InvariantChecker checker;
+    system.selection = cells::CellIndicatorByIndex{0, 0};
+    CHECK(types(checker.check(system)) ==
+          std::vector{cells::InvariantViolation::Type::InvalidSelection});
+    CHECK(has_type(checker.check(system), cells::InvariantViolation::Type::InvalidSelection));
+  }
+}
+
+TEST_SUITE("invariant check - mutations") {
+  TEST_CASE("random update churn, moves and swaps keep every pass clean") {
+    std::mt19937 rng(5);
+    auto system = make_system(3, 6);
+    cells::InvariantChecker checker;
+    REQUIRE(checker.check(system).empty());
+
+    std::vector<std::vector<size_t>> ids(3);
+    size_t next_id = 100;
+    for (int step = 0; step < 300; ++step) {
+      for (size_t k = 0; k < 3; ++k) {
+        ids[k] = cells::get_cluster_leaf_ids(system.clusters[k].cluster);
+      }
+      // Select a random window so deletions and splits have a selection to carry along
+      size_t c = rng() % 3;
+      if (!ids[c].empty()) {
+        size_t selected = ids[c][rng() % ids[c].size()];
+        auto index = cells::find_cell_by_leaf_id(system.clusters[c].cluster, selected);
+        system.selection = cells::CellIndicatorByIndex{c, *index};
+      }
+      size_t d = rng() % 3;
+      switch (rng() % 4) {
+      case 0:
+        ids[c].push_back(next_id++);
+        ids[c].push_back(next_id++);
+        break;
+      case 1:
+        if (!ids[c].empty()) {
+          ids[c].erase(ids[c].begin() + static_cast<std::ptrdiff_t>(rng() % ids[c].size()));
+        }
+        break;
+      case 2:
+        if (!ids[c].empty() && !ids[d].empty()) {
+          size_t a = ids[c][rng() % ids[c].size()];
+          size_t b = ids[d][rng() % ids[d].size()];
+          (void)cells::move_cell(system, c, a, d, b, kGap, kGap);
+          ids[c] = cells::get_cluster_leaf_ids(system.clusters[c].cluster);
+          ids[d] = cells::get_cluster_leaf_ids(system.clusters[d].cluster);
+        }
+        break;
+      default:
+        if (!ids[c].empty() && !ids[d].empty()) {
+          size_t a = ids[c][rng() % ids[c].size()];
+          size_t b = ids[d][rng() % ids[d].size()];
+          (void)cells::swap_cells(system, c, a, d, b, kGap, kGap);
+          ids[c] = cells::get_cluster_leaf_ids(system.clusters[c].cluster);
+          ids[d] = cells::get_cluster_leaf_ids(system.clusters[d].cluster);
+        }
+        break;
+      }
+      // The move or swap on its own must leave a clean tree
+      REQUIRE(checker.check(system).empty());
+
+      std::vector<cells::ClusterCellUpdateInfo> infos;
+      for (size_t k = 0; k < 3; ++k) {
+        infos.push_back({k, ids[k]});
+      }
+      cells::update(system, infos, std::nullopt, {-1.0f, -1.0f}, 0.85f, 0, kGap, kGap);
+
+      INFO("step " << step);
+      REQUIRE(checker.check(system).empty());
+      REQUIRE(cells::validate_system(system));
+    }
+  }
+
+  TEST_CASE("benchmark: per-tick check vs validate_system on 500 windows" * doctest::skip()) {
+    using Clock = std::chrono::steady_clock;
+    auto system = make_system(4, 125);
+    cells::InvariantChecker checker;
+    REQUIRE(checker.check(system).empty());
+
+    // Idle ticks dominate; every tenth tick adjusts one split ratio
+    constexpr int kTicks = 20000;
+    auto& cluster = system.clusters[0].cluster;
+    int split = find_grandparent(cluster);
+    REQUIRE(split >= 0);
+    auto start = Clock::now();
+    for (int i = 0; i < kTicks; ++i) {
+      if (i % 10 == 0) {
+        cells::set_split_ratio(cluster, split, (i % 20 == 0) ? 0.4f : 0.6f, kGap, kGap);
+      }
+      CHECK(checker.check(system).empty());
+    }
+    double incremental_us =
+        std::chrono::duration<double, std::micro>(Clock::now() - start).count() / kTicks;
+
+    constexpr int kFullRuns = 200;
+    start = Clock::now();
+    for (int i = 0; i < kFullRuns; ++i) {
+      CHECK(cells::validate_system(system));
+    }
+    double full_us =
+        std::chrono::duration<double, std::micro>(Clock::now() - start).count() / kFullRuns;
+    MESSAGE("500 windows: incremental check " << incremental_us << " us/tick, validate_system "
+                                              << full_us << " us/call");
+    CHECK(incremental_us < full_us);
+  }
+}
+
+#endif // !DOCTEST_CONFIG_DISABLE
@@ -0,0 +1,363 @@
+#ifndef DOCTEST_CONFIG_DISABLE
+
+#include <doctest/doctest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+#include "flight_recorder.h"
+#include "ipc.h"
+#include "ipc_server.h"
+
+using namespace wintiler;
+
+namespace {
+
+constexpr float kGap = 10.0f;
+const ipc::ApplyContext kContext{kGap, kGap};
+
+// Single 800x600 cluster pre-populated with the given leaf ids
+cells::System make_ipc_system(const std::vector<size_t>& ids) {
+  cells::ClusterInitInfo info{0.0f, 0.0f, 800.0f, 600.0f, 0.0f, 0.0f, 800.0f, 600.0f, ids};
+  return cells::create_system({info}, kGap, kGap);
+}
+
+ipc::CommandBatch parse_ok(const std::string& line) {
+  auto batch = ipc::parse_batch(line);
+  REQUIRE(batch.has_value());
+  return *batch;
+}
+
+std::string unique_endpoint() {
+#ifdef _WIN32
+  return R"(\\.\pipe\win-tiler-test-)" +
+         std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+#else
+  return (std::filesystem::temp_directory_path() /
+          ("wt-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count() %
+                                  1000000000) +
+           ".sock"))
+      .string();
+#endif
+}
+
+} // namespace
+
+TEST_SUITE("ipc - parsing") {
+  TEST_CASE("single command object parses into a one-command batch") {
+    auto batch = parse_ok(R"({"cmd": "navigate", "dir": "left"})");
+    REQUIRE(batch.commands.size() == 1);
+    CHECK(batch.commands[0].type == ipc::CommandType::Navigate);
+    CHECK(batch.commands[0].direction == cells::Direction::Left);
+    CHECK_FALSE(batch.id.has_value());
+  }
+
+  TEST_CASE("batch object keeps id and command order") {
+    auto batch = parse_ok(
+        R"({"id": 7, "batch": [{"cmd": "split-mode", "mode": "vertical"}, {"cmd": "query"}]})");
+    REQUIRE(batch.id.has_value());
+    CHECK(*batch.id == 7);
+    REQUIRE(batch.commands.size() == 2);
+    CHECK(batch.commands[0].type == ipc::CommandType::SplitMode);
+    CHECK(batch.commands[0].split_mode == cells::SplitMode::Vertical);
+    CHECK(batch.commands[1].type == ipc::CommandType::Query);
+  }
+
+  TEST_CASE("top-level array is a batch") {
+    auto batch = parse_ok(R"([{"cmd": "zen", "state": "on"}, {"cmd": "set-ratio", "ratio": 0.3}])");
+    REQUIRE(batch.commands.size() == 2);
+    CHECK(batch.commands[0].zen_state == ipc::ZenState::On);
+    CHECK(batch.commands[1].ratio == doctest::Approx(0.3f));
+  }
+
+  TEST_CASE("invalid input is rejected with a message") {
+    CHECK_FALSE(ipc::parse_batch("not json").has_value());
+    CHECK_FALSE(ipc::parse_batch(R"({"dir": "left"})").has_value());
+    CHECK_FALSE(ipc::parse_batch(R"({"cmd": "navigate", "dir": "sideways"})").has_value());
+    CHECK_FALSE(ipc::parse_batch(R"({"cmd": "move"})").has_value());
+    CHECK_FALSE(ipc::parse_batch(R"({"cmd": "swap", "target": -1})").has_value());
+    CHECK_FALSE(ipc::parse_batch(R"({"batch": []})").has_value());
+
+    auto error = ipc::parse_batch(R"([{"cmd": "query"}, {"cmd": "bogus"}])");
+    REQUIRE_FALSE(error.has_value());
+    CHECK(error.error().find("command 1") != std::string::npos);
+  }
+}
+
+TEST_SUITE("ipc - apply") {
+  TEST_CASE("navigate moves selection and reports foreground window") {
+    auto system = make_ipc_system({1, 2});
+    REQUIRE(system.selection.has_value());
+    auto start_leaf = ipc::query_system(system)["selection"]["leaf"].get<size_t>();
+
+    auto result = ipc::apply_batch(system, parse_ok(R"({"cmd": "navigate", "dir": "right"})"),
+                                   kContext);
+    auto end_leaf = ipc::query_system(system)["selection"]["leaf"].get<size_t>();
+    if (start_leaf == 1) {
+      CHECK(result.ok);
+      CHECK(end_leaf == 2);
+      CHECK(result.window_to_foreground == 2);
+      CHECK(result.cursor_pos.has_value());
+    } else {
+      CHECK_FALSE(result.ok);
+      CHECK(end_leaf == start_leaf);
+    }
+  }
+
+  TEST_CASE("swap exchanges two explicit leaves") {
+    auto system = make_ipc_system({1, 2, 3});
+    auto& pc = system.clusters[0];
+    auto rect_of = [&](size_t leaf) {
+      return cells::get_cell_global_rect(pc, *cells::find_cell_by_leaf_id(pc.cluster, leaf));
+    };
+    auto rect1 = rect_of(1);
+    auto rect3 = rect_of(3);
+
+    auto result =
+        ipc::apply_batch(system, parse_ok(R"({"cmd": "swap", "leaf": 1, "target": 3})"), kContext);
+    REQUIRE(result.ok);
+    CHECK(rect_of(3).x == doctest::Approx(rect1.x));
+    CHECK(rect_of(3).y == doctest::Approx(rect1.y));
+    CHECK(rect_of(1).x == doctest::Approx(rect3.x));
+    CHECK(rect_of(1).y == doctest::Approx(rect3.y));
+  }
+
+  TEST_CASE("swap without a target uses the given leaf's sibling, not the selection's") {
+    auto system = make_ipc_system({1, 2, 3});
+    auto& pc = system.clusters[0];
+    auto cell_of = [&](size_t leaf) { return *cells::find_cell_by_leaf_id(pc.cluster, leaf); };
+    // 1 and 3 share a split; 2 (selected) has a split as its sibling
+    REQUIRE(cells::get_sibling_leaf_id(pc.cluster, cell_of(1)) == 3u);
+    system.selection = cells::CellIndicatorByIndex{0, cell_of(2)};
+    auto rect1 = cells::get_cell_global_rect(pc, cell_of(1));
+    auto rect2 = cells::get_cell_global_rect(pc, cell_of(2));
+    auto rect3 = cells::get_cell_global_rect(pc, cell_of(3));
+
+    auto result = ipc::apply_batch(system, parse_ok(R"({"cmd": "swap", "leaf": 1})"), kContext);
+    REQUIRE(result.ok);
+    CHECK(cells::get_cell_global_rect(pc, cell_of(1)).y == doctest::Approx(rect3.y));
+    CHECK(cells::get_cell_global_rect(pc, cell_of(3)).y == doctest::Approx(rect1.y));
+    CHECK(cells::get_cell_global_rect(pc, cell_of(2)).x == doctest::Approx(rect2.x));
+  }
+
+  TEST_CASE("a layout pulling windows from another monitor reports them as reassigned") {
+    cells::ClusterInitInfo left{0.0f, 0.0f, 800.0f, 600.0f, 0.0f, 0.0f, 800.0f, 600.0f, {1}};
+    cells::ClusterInitInfo right{800.0f, 0.0f, 800.0f, 600.0f, 800.0f, 0.0f, 800.0f, 600.0f,
+                                 {2, 3}};
+    auto system = cells::create_system({left, right}, kGap, kGap);
+    LayoutTemplate pair;
+    pair.name = "pair";
+    pair.nodes.resize(3);
+    pair.nodes[0].first_child = 1;
+    pair.nodes[0].second_child = 2;
+    pair.nodes[1].match.process = "one.exe";
+    pair.nodes[2].match.process = "two.exe";
+    std::vector<LayoutTemplate> layouts{pair};
+    ipc::ApplyContext context{kGap, kGap, nullptr, &layouts, [](size_t leaf_id) {
+                                return WindowDescription{
+                                    leaf_id, leaf_id == 1 ? "one.exe" : "two.exe", "", ""};
+                              }};
+
+    auto result = ipc::apply_batch(
+        system, parse_ok(R"({"cmd": "layout", "name": "pair", "cluster": 0})"), context);
+    REQUIRE(result.ok);
+    CHECK(result.reassigned_windows == std::vector<ipc::WindowReassignment>{{2, 0}});
+
+    // A failed batch is rolled back and reports nothing
+    auto failed = ipc::apply_batch(system, parse_ok(R"({"batch": [
+        {"cmd": "move", "leaf": 3, "target": 1},
+        {"cmd": "swap", "leaf": 1, "target": 99}]})"),
+                                   context);
+    CHECK_FALSE(failed.ok);
+    CHECK(failed.reassigned_windows.empty());
+  }
+
+  TEST_CASE("batch applies every command and validates") {
+    auto system = make_ipc_system({1, 2, 3});
+    auto result = ipc::apply_batch(system, parse_ok(R"({"id": "abc", "batch": [
+        {"cmd": "set-ratio", "leaf": 1, "ratio": 0.7},
+        {"cmd": "split-mode", "mode": "horizontal"},
+        {"cmd": "zen", "leaf": 2, "state": "on"},
+        {"cmd": "query"}]})"),
+                                   kContext);
+
+    REQUIRE(result.ok);
+    REQUIRE(result.results.size() == 4);
+    CHECK(system.split_mode == cells::SplitMode::Horizontal);
+    CHECK(result.results[0].data["ratio"].get<float>() == doctest::Approx(0.7f));
+    CHECK(result.results[3].data["clusters"][0]["zen"] == 2);
+    CHECK(cells::validate_system(system));
+
+    auto line = ipc::format_batch_result(result);
+    auto parsed = nlohmann::json::parse(line);
+    CHECK(parsed["id"] == "abc");
+    CHECK(parsed["ok"] == true);
+    CHECK(parsed["results"].size() == 4);
+  }
+
+  TEST_CASE("failed command rolls back the whole batch") {
+    auto system = make_ipc_system({1, 2, 3});
+    auto before = ipc::query_system(system);
+
+    auto result = ipc::apply_batch(system, parse_ok(R"([
+        {"cmd": "split-mode", "mode": "vertical"},
+        {"cmd": "move", "leaf": 1, "target": 3},
+        {"cmd": "swap", "leaf": 2, "target": 99}])"),
+                                   kContext);
+
+    CHECK_FALSE(result.ok);
+    REQUIRE(result.results.size() == 3);
+    CHECK(result.results[0].ok);
+    CHECK(result.results[1].ok);
+    CHECK_FALSE(result.results[2].ok);
+    CHECK(ipc::query_system(system) == before);
+    CHECK_FALSE(result.cursor_pos.has_value());
+  }
+
+  TEST_CASE("move relocates a leaf next to its target") {
+    auto system = make_ipc_system({1, 2, 3});
+    auto result =
+        ipc::apply_batch(system, parse_ok(R"({"cmd": "move", "leaf": 1, "target": 3})"), kContext);
+    REQUIRE(result.ok);
+    CHECK(cells::has_leaf_id(system, 1));
+    CHECK(cells::validate_system(system));
+
+    auto& cluster = system.clusters[0].cluster;
+    auto idx1 = *cells::find_cell_by_leaf_id(cluster, 1);
+    auto idx3 = *cells::find_cell_by_leaf_id(cluster, 3);
+    CHECK(cluster.cells[static_cast<size_t>(idx1)].parent ==
+          cluster.cells[static_cast<size_t>(idx3)].parent);
+  }
+
+  TEST_CASE("recorder command returns the newest events") {
+    FlightRecorder recorder(16);
+    for (uint64_t i = 0; i < 5; ++i) {
+      recorder.record(FlightEventType::LeafAdded, i);
+    }
+    ipc::ApplyContext context{kGap, kGap, &recorder};
+    auto system = make_ipc_system({1, 2});
+
+    auto result = ipc::apply_batch(system, parse_ok(R"({"cmd": "recorder", "last": 2})"), context);
+    REQUIRE(result.ok);
+    const auto& data = result.results[0].data;
+    CHECK(data["total"] == 5);
+    REQUIRE(data["events"].size() == 2);
+    CHECK(data["events"][0]["leaf"] == 3);
+    CHECK(data["events"][1]["leaf"] == 4);
+
+    result = ipc::apply_batch(system, parse_ok(R"({"cmd": "recorder", "format": "text"})"),
+                              context);
+    REQUIRE(result.ok);
+    CHECK(result.results[0].data["text"].get<std::string>().find("LeafAdded leaf=0x4") !=
+          std::string::npos);
+
+    // Without a recorder the command fails instead of returning an empty dump
+    result = ipc::apply_batch(system, parse_ok(R"({"cmd": "recorder"})"), kContext);
+    CHECK_FALSE(result.ok);
+    CHECK_FALSE(ipc::parse_batch(R"({"cmd": "recorder", "format": "xml"})").has_value());
+  }
+}
+
+TEST_SUITE("ipc - transport") {
+  TEST_CASE("spsc queue preserves order across threads") {
+    SpscQueue<int, 8> queue;
+    constexpr int kCount = 10000;
+    std::thread producer([&] {
+      for (int i = 0; i < kCount; ++i) {
+        while (!queue.try_push(i)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+
+    int expected = 0;
+    bool in_order = true;
+    while (expected < kCount) {
+      if (auto value = queue.try_pop()) {
+        in_order = in_order && (*value == expected);
+        ++expected;
+      }
+    }
+    producer.join();
+    CHECK(in_order);
+    CHECK(queue.empty());
+  }
+
+  TEST_CASE("server round-trips a batch through the loop handler") {
+    auto system = make_ipc_system({1, 2});
+    ipc::CommandServer server(unique_endpoint());
+    std::atomic<int> wakes{0};
+    REQUIRE(server.start([&] { wakes++; }));
+
+    // Stand-in for the main loop: drain until the client got its answer
+    std::atomic<bool> done{false};
+    std::thread loop([&] {
+      while (!done) {
+        server.drain([&](const ipc::CommandBatch& batch) {
+          return ipc::format_batch_result(ipc::apply_batch(system, batch, kContext));
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    });
+
+    auto response = ipc::send_request(
+        server.endpoint(), R"({"id": 1, "batch": [{"cmd": "split-mode"}, {"cmd": "query"}]})");
+    auto bad = ipc::send_request(server.endpoint(), "{oops");
+    done = true;
+    loop.join();
+    server.stop();
+
+    REQUIRE(response.has_value());
+    auto parsed = nlohmann::json::parse(*response);
+    CHECK(parsed["id"] == 1);
+    CHECK(parsed["ok"] == true);
+    CHECK(parsed["results"][1]["data"]["split_mode"] == "vertical");
+    CHECK(wakes.load() == 1);
+
+    REQUIRE(bad.has_value());
+    CHECK(nlohmann::json::parse(*bad)["ok"] == false);
+  }
+
+  TEST_CASE("an oversized request line is rejected without reaching the loop") {
+    ipc::CommandServer server(unique_endpoint());
+    REQUIRE(server.start());
+
+    auto response = ipc::send_request(server.endpoint(), std::string(80 * 1024, ' '));
+    REQUIRE(response.has_value());
+    auto parsed = nlohmann::json::parse(*response);
+    CHECK(parsed["ok"] == false);
+    CHECK(parsed["error"].get<std::string>().find("exceeds") != std::string::npos);
+    CHECK(server.drain([](const ipc::CommandBatch&) { return std::string(); }) == 0);
+
+    // The server keeps serving after dropping the client
+    auto next = ipc::send_request(server.endpoint(), "{oops");
+    REQUIRE(next.has_value());
+    CHECK(nlohmann::json::parse(*next)["ok"] == false);
+    server.stop();
+  }
+
+  TEST_CASE("a batch whose client timed out is not applied by a later drain") {
+    auto system = make_ipc_system({1, 2});
+    ipc::CommandServer server(unique_endpoint(), std::chrono::milliseconds(50));
+    REQUIRE(server.start());
+
+    // No loop drains: the client gives up first
+    auto response = ipc::send_request(server.endpoint(), R"({"id": 7, "cmd": "split-mode"})");
+    REQUIRE(response.has_value());
+    auto parsed = nlohmann::json::parse(*response);
+    CHECK(parsed["ok"] == false);
+    CHECK(parsed["error"].get<std::string>().find("not applied") != std::string::npos);
+
+    int applied = 0;
+    CHECK(server.drain([&](const ipc::CommandBatch& batch) {
+      ++applied;
+      return ipc::format_batch_result(ipc::apply_batch(system, batch, kContext));
+    }) == 0);
+    CHECK(applied == 0);
+    CHECK(system.split_mode == cells::SplitMode::Zigzag);
+    server.stop();
+  }
+}
+
+#endif // !DOCTEST_CONFIG_DISABLE
@@ -0,0 +1,298 @@
+#ifndef DOCTEST_CONFIG_DISABLE
+
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "invariant_check.h"
+#include "layout_template.h"
+#include "multi_cells.h"
+
+using namespace wintiler;
+
+namespace {
+
+constexpr float kGap = 10.0f;
+
+LayoutTemplateNode slot(std::string process, std::string class_name = "",
+                        std::string title = "") {
+  LayoutTemplateNode node;
+  node.match = {std::move(process), std::move(class_name), std::move(title)};
+  return node;
+}
+
+LayoutTemplateNode split(cells::SplitDir dir, float ratio, int first, int second) {
+  LayoutTemplateNode node;
+  node.split_dir = dir;
+  node.split_ratio = ratio;
+  node.first_child = first;
+  node.second_child = second;
+  return node;
+}
+
+// Trading desk: chart on the left (60%), the right column split into an order book window
+// (any "Orders" title) above a spreadsheet
+LayoutTemplate make_desk() {
+  LayoutTemplate desk;
+  desk.name = "desk";
+  desk.nodes = {
+      split(cells::SplitDir::Vertical, 0.6f, 1, 2),
+      slot("chart.exe"),
+      split(cells::SplitDir::Horizontal, 0.5f, 3, 4),
+      slot("", "", "orders"),
+      slot("EXCEL.EXE"),
+  };
+  return desk;
+}
+
+WindowDescription window(size_t leaf_id, std::string process, std::string title = "",
+                         std::string class_name = "") {
+  return {leaf_id, std::move(process), std::move(class_name), std::move(title)};
+}
+
+// Leaf ids of the layout in preorder (splits skipped)
+std::vector<size_t> layout_leaves(const std::vector<cells::LayoutNode>& layout) {
+  std::vector<size_t> leaves;
+  std::vector<int> stack{0};
+  while (!layout.empty() && !stack.empty()) {
+    const auto& node = layout[static_cast<size_t>(stack.back())];
+    stack.pop_back();
+    if (node.leaf_id.has_value()) {
+      leaves.push_back(*node.leaf_id);
+    } else {
+      stack.push_back(*node.second_child);
+      stack.push_back(*node.first_child);
+    }
+  }
+  return leaves;
+}
+
+cells::System make_system(std::vector<size_t> left_ids, std::vector<size_t> right_ids) {
+  cells::ClusterInitInfo left{0.0f, 0.0f, 1920.0f, 1040.0f, 0.0f, 0.0f, 1920.0f, 1080.0f,
+                              std::move(left_ids)};
+  cells::ClusterInitInfo right{1920.0f, 0.0f, 1920.0f, 1040.0f, 1920.0f, 0.0f, 1920.0f, 1080.0f,
+                               std::move(right_ids)};
+  return cells::create_system({left, right}, kGap, kGap);
+}
+
+} // namespace
+
+TEST_SUITE("layout template - matching") {
+  TEST_CASE("rules ignore case, titles match substrings and empty fields match anything") {
+    auto win = window(1, "Chart.exe", "BTC Orders - Desk", "TradeFrame");
+    CHECK(window_matches({"chart.EXE", "", ""}, win));
+    CHECK(window_matches({"", "tradeframe", "orders"}, win));
+    CHECK(window_matches({}, win));
+    CHECK_FALSE(window_matches({"chart", "", ""}, win)); // Process names compare whole
+    CHECK_FALSE(window_matches({"chart.exe", "Other", ""}, win));
+    CHECK_FALSE(window_matches({"", "", "positions"}, win));
+  }
+
+  TEST_CASE("every slot takes the first matching window") {
+    auto windows = std::vector{window(10, "excel.exe"), window(11, "chart.exe"),
+                               window(12, "chart.exe"), window(13, "browser.exe", "Orders")};
+    auto match = match_layout_template(make_desk(), windows, {});
+    CHECK(match.slot_count == 3);
+    CHECK(layout_leaves(match.layout) == std::vector<size_t>{11, 13, 10});
+    REQUIRE(match.layout.size() == 5);
+    CHECK(match.layout[0].split_ratio == doctest::Approx(0.6f));
+    CHECK(match.layout[0].split_dir == cells::SplitDir::Vertical);
+  }
+
+  TEST_CASE("specific slots pick before catch-alls") {
+    // The catch-all comes first in the template but must not take the chart window
+    LayoutTemplate tpl;
+    tpl.nodes = {split(cells::SplitDir::Vertical, 0.5f, 1, 2), slot(""), slot("chart.exe")};
+    auto match = match_layout_template(tpl, {window(1, "chart.exe"), window(2, "notes.exe")}, {});
+    CHECK(layout_leaves(match.layout) == std::vector<size_t>{2, 1});
+    CHECK(match.slotted_leaf_ids == std::vector<size_t>{1, 2});
+  }
+
+  TEST_CASE("a split with one empty side collapses into the other") {
+    auto match = match_layout_template(make_desk(),
+                                       {window(1, "chart.exe"), window(2, "excel.exe")}, {});
+    // The orders slot is empty, so the spreadsheet takes the whole right column
+    REQUIRE(match.layout.size() == 3);
+    CHECK(layout_leaves(match.layout) == std::vector<size_t>{1, 2});
+    CHECK(match.layout[0].split_ratio == doctest::Approx(0.6f));
+
+    match = match_layout_template(make_desk(), {window(2, "excel.exe")}, {});
+    REQUIRE(match.layout.size() == 1);
+    CHECK(match.layout[0].leaf_id == 2u);
+
+    match = match_layout_template(make_desk(), {window(3, "notes.exe")}, {});
+    CHECK(match.layout.empty());
+    CHECK(match.slotted_leaf_ids.empty());
+  }
+
+  TEST_CASE("residents without a slot are split off the last leaf") {
+    auto windows = std::vector{window(1, "chart.exe"), window(2, "excel.exe"),
+                               window(3, "notes.exe"), window(4, "mail.exe")};
+    auto match = match_layout_template(make_desk(), windows, {2, 3, 4});
+    CHECK(layout_leaves(match.layout) == std::vector<size_t>{1, 2, 3, 4});
+    // Leftovers alternate direction, starting opposite to the last leaf's parent (vertical)
+    REQUIRE(match.layout.size() == 7);
+    CHECK(match.layout[2].split_dir == cells::SplitDir::Horizontal);
+    CHECK(match.layout[4].split_dir == cells::SplitDir::Vertical);
+
+    match = match_layout_template(make_desk(), {window(3, "notes.exe")}, {3});
+    REQUIRE(match.layout.size() == 1);
+    CHECK(match.layout[0].leaf_id == 3u);
+  }
+
+  TEST_CASE("malformed templates match nothing") {
+    LayoutTemplate one_child;
+    one_child.nodes = {slot("a.exe"), slot("b.exe")}; // Node 1 unreachable
+    auto match = match_layout_template(one_child, {window(1, "a.exe")}, {});
+    CHECK(match.layout.empty());
+    CHECK(match.slot_count == 0);
+
+    LayoutTemplate cycle;
+    cycle.nodes = {split(cells::SplitDir::Vertical, 0.5f, 1, 0), slot("a.exe")};
+    CHECK(match_layout_template(cycle, {window(1, "a.exe")}, {}).layout.empty());
+    CHECK(match_layout_template(LayoutTemplate{}, {window(1, "a.exe")}, {}).layout.empty());
+  }
+
+  TEST_CASE("templates are found by name") {
+    std::vector<LayoutTemplate> layouts{make_desk()};
+    layouts.push_back(make_desk());
+    layouts.back().name = "other";
+    CHECK(find_layout_template(layouts, "other") == &layouts[1]);
+    CHECK(find_layout_template(layouts, "missing") == nullptr);
+  }
+}
+
+TEST_SUITE("layout template - apply") {
+  TEST_CASE("apply builds the desk from windows on both monitors") {
+    auto system = make_system({1, 2}, {3, 4});
+    std::vector<WindowDescription> windows{window(1, "notes.exe"), window(2, "excel.exe"),
+                                           window(3, "chart.exe"),
+                                           window(4, "browser.exe", "Orders")};
+    cells::InvariantChecker checker;
+    REQUIRE(checker.check(system).empty());
+
+    auto match = apply_layout_template(system, 0, make_desk(), windows, kGap, kGap);
+    REQUIRE(match.has_value());
+    CHECK(match->slotted_leaf_ids.size() == 3);
+    CHECK(cells::get_cluster_leaf_ids(system.clusters[0].cluster) ==
+          std::vector<size_t>{3, 4, 2, 1});
+    CHECK(system.clusters[1].cluster.cells.empty());
+    CHECK(checker.check(system).empty());
+    CHECK(cells::validate_system(system));
+
+    // The chart takes 60% of the monitor; the next update only places windows
+    auto chart = cells::find_cell_by_leaf_id(system.clusters[0].cluster, 3);
+    REQUIRE(chart.has_value());
+    const auto& rect = system.clusters[0].cluster.cells[static_cast<size_t>(*chart)].rect;
+    CHECK(rect.width == doctest::Approx((1920.0f - 3.0f * kGap) * 0.6f));
+    auto result = cells::update(system, {{0, {1, 2, 3, 4}}, {1, {}}}, std::nullopt,
+                                {-1.0f, -1.0f}, 0.85f, 0, kGap, kGap);
+    CHECK(result.added_leaf_ids.empty());
+    CHECK(result.deleted_leaf_ids.empty());
+    CHECK(result.tile_updates.size() == 4);
+  }
+
+  TEST_CASE("a cross-monitor template survives the next update") {
+    auto system = make_system({1, 2}, {3, 4});
+    std::vector<WindowDescription> windows{window(1, "notes.exe"), window(2, "excel.exe"),
+                                           window(3, "chart.exe"),
+                                           window(4, "browser.exe", "Orders")};
+    auto match = apply_layout_template(system, 0, make_desk(), windows, kGap, kGap);
+    REQUIRE(match.has_value());
+    CHECK(match->claimed_leaf_ids == std::vector<size_t>{3, 4});
+    auto layout = cells::get_cluster_leaf_ids(system.clusters[0].cluster);
+
+    // The last enumeration still lists the claimed windows on the right monitor; relist them
+    // the way the loop does before its update pass
+    std::vector<cells::ClusterCellUpdateInfo> report{{0, {1, 2}}, {1, {3, 4}}};
+    for (size_t leaf_id : match->claimed_leaf_ids) {
+      auto& right = report[1].leaf_ids;
+      right.erase(std::find(right.begin(), right.end(), leaf_id));
+      report[0].leaf_ids.push_back(leaf_id);
+    }
+    auto result =
+        cells::update(system, report, std::nullopt, {-1.0f, -1.0f}, 0.85f, 0, kGap, kGap);
+    CHECK(result.added_leaf_ids.empty());
+    CHECK(result.deleted_leaf_ids.empty());
+    CHECK(cells::get_cluster_leaf_ids(system.clusters[0].cluster) == layout);
+    CHECK(system.clusters[1].cluster.cells.empty());
+  }
+
+  TEST_CASE("applying the same template twice gives the same tree") {
+    auto system = make_system({1, 2, 3}, {});
+    std::vector<WindowDescription> windows{window(1, "excel.exe"), window(2, "chart.exe"),
+                                           window(3, "x.exe", "Orders")};
+    REQUIRE(apply_layout_template(system, 0, make_desk(), windows, kGap, kGap).has_value());
+    auto first = system.clusters[0].cluster.cells.size();
+    auto ids = cells::get_cluster_leaf_ids(system.clusters[0].cluster);
+    REQUIRE(apply_layout_template(system, 0, make_desk(), windows, kGap, kGap).has_value());
+    CHECK(system.clusters[0].cluster.cells.size() == first);
+    CHECK(cells::get_cluster_leaf_ids(system.clusters[0].cluster) == ids);
+  }
+
+  TEST_CASE("nothing to lay out leaves the system alone") {
+    auto system = make_system({}, {1});
+    CHECK_FALSE(apply_layout_template(system, 0, make_desk(), {window(1, "notes.exe")}, kGap,
+                                      kGap)
+                    .has_value());
+    CHECK_FALSE(apply_layout_template(system, 5, make_desk(), {}, kGap, kGap).has_value());
+    CHECK(cells::get_cluster_leaf_ids(system.clusters[1].cluster) == std::vector<size_t>{1});
+  }
+
+  TEST_CASE("benchmark: one batch vs one update per window" * doctest::skip()) {
+    using Clock = std::chrono::steady_clock;
+    constexpr size_t kWindows = 24;
+    constexpr int kRuns = 2000;
+
+    // A balanced template with a catch-all slot per window
+    LayoutTemplate tpl;
+    tpl.nodes.push_back(slot(""));
+    for (size_t leaves = 1; leaves < kWindows;) {
+      size_t n = tpl.nodes.size();
+      for (size_t i = 0; i < n && leaves < kWindows; ++i) {
+        if (tpl.nodes[i].first_child.has_value()) {
+          continue;
+        }
+        int first = static_cast<int>(tpl.nodes.size());
+        tpl.nodes.push_back(slot(""));
+        tpl.nodes.push_back(slot(""));
+        tpl.nodes[i] = split(cells::SplitDir::Vertical, 0.5f, first, first + 1);
+        ++leaves;
+      }
+    }
+    std::vector<WindowDescription> windows;
+    std::vector<size_t> ids;
+    for (size_t i = 1; i <= kWindows; ++i) {
+      windows.push_back(window(i, "app.exe"));
+      ids.push_back(i);
+    }
+
+    auto start = Clock::now();
+    for (int run = 0; run < kRuns; ++run) {
+      auto system = make_system({}, {});
+      CHECK(apply_layout_template(system, 0, tpl, windows, kGap, kGap).has_value());
+    }
+    double batch_us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+    start = Clock::now();
+    for (int run = 0; run < kRuns; ++run) {
+      auto system = make_system({}, {});
+      std::vector<size_t> opened;
+      for (size_t id : ids) {
+        opened.push_back(id);
+        (void)cells::update(system, {{0, opened}}, std::nullopt, {-1.0f, -1.0f}, 0.85f, 0, kGap,
+                            kGap);
+      }
+    }
+    double incremental_us =
+        std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    MESSAGE(kWindows << " windows: template " << batch_us / kRuns << " us, one update per window "
+                     << incremental_us / kRuns << " us");
+    CHECK(batch_us < incremental_us);
+  }
+}
+
+#endif // !DOCTEST_CONFIG_DISABLE
@@ -0,0 +1,144 @@
+#ifndef DOCTEST_CONFIG_DISABLE
+
+#include <doctest/doctest.h>
+
+#include <chrono>
+
+#include "live_resize.h"
+
+using namespace wintiler;
+using namespace std::chrono_literals;
+
+namespace {
+
+using Clock = LiveResizeThrottle::Clock;
+
+constexpr size_t kWindow = 42;
+
+} // namespace
+
+TEST_SUITE("live resize - frame interval") {
+  TEST_CASE("follows the display rate") {
+    CHECK(live_resize_frame_interval(144, 0) == Clock::duration(1s) / 144);
+    CHECK(live_resize_frame_interval(60, 0) == Clock::duration(1s) / 60);
+  }
+
+  TEST_CASE("unknown or default rates fall back to 60Hz") {
+    CHECK(live_resize_frame_interval(std::nullopt, 0) == Clock::duration(1s) / 60);
+    CHECK(live_resize_frame_interval(1, 0) == Clock::duration(1s) / 60);
+    CHECK(live_resize_frame_interval(0, 0) == Clock::duration(1s) / 60);
+  }
+
+  TEST_CASE("max rate caps fast displays only") {
+    CHECK(live_resize_frame_interval(144, 30) == Clock::duration(1s) / 30);
+    CHECK(live_resize_frame_interval(60, 120) == Clock::duration(1s) / 60);
+  }
+}
+
+TEST_SUITE("live resize - throttle") {
+  TEST_CASE("first change of a drag is due at once, later ones once per frame") {
+    LiveResizeThrottle throttle(16ms);
+    Clock::time_point t{};
+    CHECK_FALSE(throttle.take(t).has_value()); // Nothing pending
+    CHECK_FALSE(throttle.time_until_due(t).has_value());
+
+    throttle.on_location(kWindow);
+    CHECK(throttle.active() == kWindow);
+    CHECK(throttle.time_until_due(t) == Clock::duration::zero());
+    CHECK(throttle.take(t) == kWindow);
+
+    // Changes within the frame coalesce into one pending reflow
+    throttle.on_location(kWindow);
+    throttle.on_location(kWindow);
+    CHECK_FALSE(throttle.take(t + 5ms).has_value());
+    CHECK(throttle.time_until_due(t + 5ms) == Clock::duration(11ms));
+    CHECK(throttle.take(t + 16ms) == kWindow);
+    CHECK_FALSE(throttle.take(t + 40ms).has_value()); // Consumed
+
+    CHECK(throttle.stats().events == 3);
+    CHECK(throttle.stats().reflows == 2);
+  }
+
+  TEST_CASE("the last change of a burst is not lost") {
+    LiveResizeThrottle throttle(16ms);
+    Clock::time_point t{};
+    throttle.on_location(kWindow);
+    REQUIRE(throttle.take(t).has_value());
+    throttle.on_location(kWindow); // Mouse stops right after this one
+
+    auto delay = throttle.time_until_due(t + 2ms);
+    REQUIRE(delay.has_value());
+    CHECK(throttle.take(t + 2ms + *delay) == kWindow);
+    CHECK_FALSE(throttle.time_until_due(t + 100ms).has_value());
+  }
+
+  TEST_CASE("end drops pending work and a new window starts a new drag") {
+    LiveResizeThrottle throttle(16ms);
+    Clock::time_point t{};
+    throttle.on_location(kWindow);
+    REQUIRE(throttle.take(t).has_value());
+    throttle.on_location(kWindow);
+
+    auto stats = throttle.end();
+    CHECK(stats.events == 2);
+    CHECK(stats.reflows == 1);
+    CHECK_FALSE(throttle.active().has_value());
+    CHECK_FALSE(throttle.take(t + 1s).has_value());
+
+    // A different window is applied at once even within the old frame
+    throttle.on_location(kWindow);
+    REQUIRE(throttle.take(t + 1s).has_value());
+    throttle.on_location(7);
+    CHECK(throttle.active() == 7u);
+    CHECK(throttle.stats().events == 1);
+    CHECK(throttle.take(t + 1s + 1ms) == 7u);
+  }
+
+  TEST_CASE("slow reflows stretch the interval") {
+    LiveResizeThrottle throttle(16ms);
+    CHECK(throttle.interval() == Clock::duration(16ms));
+    throttle.record_cost(5ms);
+    CHECK(throttle.interval() == Clock::duration(16ms));
+    throttle.record_cost(30ms);
+    CHECK(throttle.interval() == Clock::duration(60ms));
+    CHECK(throttle.stats().max_cost == Clock::duration(30ms));
+    throttle.record_cost(1ms); // Recovers as soon as reflows are cheap again
+    CHECK(throttle.interval() == Clock::duration(16ms));
+  }
+
+  TEST_CASE("reflow time stays bounded over a long drag") {
+    // Ten seconds of mouse-rate events, driven like the loop task: take when due, else wait
+    for (auto cost : {Clock::duration(2ms), Clock::duration(25ms)}) {
+      LiveResizeThrottle throttle(Clock::duration(1s) / 60);
+      Clock::time_point t{};
+      auto drag_end = t + 10s;
+      auto next_event = t;
+      Clock::duration busy{};
+
+      while (t < drag_end) {
+        while (next_event <= t) {
+          throttle.on_location(kWindow);
+          next_event += 1ms;
+        }
+        if (throttle.take(t).has_value()) {
+          throttle.record_cost(cost);
+          busy += cost;
+          t += cost;
+          continue;
+        }
+        auto delay = throttle.time_until_due(t).value_or(Clock::duration(1ms));
+        t += std::min<Clock::duration>(delay, next_event - t);
+      }
+
+      auto stats = throttle.stats();
+      INFO("cost " << std::chrono::duration_cast<std::chrono::milliseconds>(cost).count());
+      CHECK(stats.events >= 10000);
+      // At most one reflow per frame, and never more than 1/kCostFactor of the time
+      CHECK(stats.reflows <= 10 * 60 + 1);
+      CHECK(busy <= Clock::duration(10s) / LiveResizeThrottle::kCostFactor + cost);
+      CHECK(stats.reflows >= 10 * 1000 / (2 * 25 + 1));
+    }
+  }
+}
+
+#endif // !DOCTEST_CONFIG_DISABLE
@@ -2,6 +2,7 @@
 
 #include <doctest/doctest.h>
 
+#include <algorithm>
 #include <chrono>
 #include <filesystem>
 #include <fstream>
@@ -699,4 +700,462 @@ TEST_SUITE("Type Coercion") {
   }
 }
 
+TEST_SUITE("IpcOptions") {
+  TEST_CASE("ipc section defaults to disabled with platform endpoint") {
+    auto defaults = get_default_global_options();
+    CHECK(defaults.ipcOptions.enabled == kDefaultIpcEnabled);
+    CHECK_FALSE(defaults.ipcOptions.enabled);
+    CHECK(defaults.ipcOptions.endpoint.empty());
+  }
+
+  TEST_CASE("ipc section is read and round-trips through write") {
+    auto temp_path = create_temp_file_path();
+    TempFileGuard guard(temp_path);
+
+    {
+      std::ofstream file(temp_path);
+      file << "[ipc]\n";
+      file << "enabled = true\n";
+      file << "endpoint = \"custom-pipe\"\n";
+    }
+
+    auto result = read_options_toml(temp_path);
+    REQUIRE(result.has_value());
+    CHECK(result.value().ipcOptions.enabled == true);
+    CHECK(result.value().ipcOptions.endpoint == "custom-pipe");
+
+    REQUIRE(write_options_toml(result.value(), temp_path).has_value());
+    auto reread = read_options_toml(temp_path);
+    REQUIRE(reread.has_value());
+    CHECK(reread.value().ipcOptions.enabled == true);
+    CHECK(reread.value().ipcOptions.endpoint == "custom-pipe");
+  }
+}
+
+TEST_SUITE("WatchdogOptions") {
+  TEST_CASE("watchdog section defaults") {
+    auto defaults = get_default_global_options();
+    CHECK(defaults.watchdogOptions.enabled == kDefaultWatchdogEnabled);
+    CHECK(defaults.watchdogOptions.budgetMs == kDefaultWatchdogBudgetMs);
+    CHECK(defaults.watchdogOptions.checkIntervalMs == kDefaultWatchdogCheckIntervalMs);
+    CHECK(defaults.watchdogOptions.minidump == kDefaultWatchdogMinidump);
+    CHECK(defaults.watchdogOptions.dumpDirectory.empty());
+  }
+
+  TEST_CASE("watchdog section is read and round-trips through write") {
+    auto temp_path = create_temp_file_path();
+    TempFileGuard guard(temp_path);
+
+    {
+      std::ofstream file(temp_path);
+      file << "[watchdog]\n";
+      file << "enabled = false\n";
+      file << "budget_ms = 500\n";
+      file << "check_interval_ms = 50\n";
+      file << "minidump = true\n";
+      file << "dump_directory = \"C:/dumps\"\n";
+    }
+
+    auto result = read_options_toml(temp_path);
+    REQUIRE(result.has_value());
+    const auto& watchdog = result.value().watchdogOptions;
+    CHECK(watchdog.enabled == false);
+    CHECK(watchdog.budgetMs == 500);
+    CHECK(watchdog.checkIntervalMs == 50);
+    CHECK(watchdog.minidump == true);
+    CHECK(watchdog.dumpDirectory == "C:/dumps");
+
+    REQUIRE(write_options_toml(result.value(), temp_path).has_value());
+    auto reread = read_options_toml(temp_path);
+    REQUIRE(reread.has_value());
+    CHECK(reread.value().watchdogOptions.budgetMs == 500);
+    CHECK(reread.value().watchdogOptions.minidump == true);
+    CHECK(reread.value().watchdogOptions.dumpDirectory == "C:/dumps");
+  }
+
+  TEST_CASE("non-positive watchdog timings fall back to defaults") {
+    auto temp_path = create_temp_file_path();
+    TempFileGuard guard(temp_path);
+
+    {
+      std::ofstream file(temp_path);
+      file << "[watchdog]\n";
+      file << "budget_ms = 0\n";
+      file << "check_interval_ms = -5\n";
+    }
+
+    auto result = read_options_toml(temp_path);
+    REQUIRE(result.has_value());
+    CHECK(result.value().watchdogOptions.budgetMs == kDefaultWatchdogBudgetMs);
+    CHECK(result.value().watchdogOptions.checkIntervalMs == kDefaultWatchdogCheckIntervalMs);
+  }
+}
+
+TEST_SUITE("LoopOptions - adaptive interval") {
+  TEST_CASE("adaptive bounds default and round-trip through write") {
+    auto defaults = get_default_global_options();
+    CHECK(defaults.loopOptions.adaptive == kDefaultLoopAdaptive);
+    CHECK(defaults.loopOptions.minIntervalMs == kDefaultLoopMinIntervalMs);
+    CHECK(defaults.loopOptions.maxIntervalMs == kDefaultLoopMaxIntervalMs);
+
+    auto temp_path = create_temp_file_path();
+    TempFileGuard guard(temp_path);
+
+    {
+      std::ofstream file(temp_path);
+      file << "[loop]\n";
+      file << "adaptive = false\n";
+      file << "min_interval_ms = 20\n";
+      file << "max_interval_ms = 2000\n";
+    }
+
+    auto result = read_options_toml(temp_path);
+    REQUIRE(result.has_value());
+    CHECK(result.value().loopOptions.adaptive == false);
+    CHECK(result.value().loopOptions.minIntervalMs == 20);
+    CHECK(result.value().loopOptions.maxIntervalMs == 2000);
+
+    REQUIRE(write_options_toml(result.value(), temp_path).has_value());
+    auto reread = read_options_toml(temp_path);
+    REQUIRE(reread.has_value());
+    CHECK(reread.value().loopOptions.adaptive == false);
+    CHECK(reread.value().loopOptions.maxIntervalMs == 2000);
+  }
+
+  TEST_CASE("min above max falls back to default bounds") {
+    auto temp_path = create_temp_file_path();
+    TempFileGuard guard(temp_path);
+
+    {
+      std::ofstream file(temp_path);
+      file << "[loop]\n";
+      file << "min_interval_ms = 500\n";
+      file << "max_interval_ms = 100\n";
+    }
+
+    auto result = read_options_toml(temp_path);
+    REQUIRE(result.has_value());
+    CHECK(result.value().loopOptions.minIntervalMs == kDefaultLoopMinIntervalMs);
+    CHECK(result.value().loopOptions.maxIntervalMs == kDefaultLoopMaxIntervalMs);
+  }
+}
+
+TEST_SUITE("PowerOptions") {
+  TEST_CASE("power section defaults and round-trip through write") {
+    auto defaults = get_default_global_options();
+    CHECK(defaults.powerOptions.mode == PowerMode::Auto);
+    CHECK(defaults.powerOptions.lowPowerMinIntervalMs == kDefaultLowPowerMinIntervalMs);
+    CHECK(defaults.powerOptions.lowPowerMaxIntervalMs == kDefaultLowPowerMaxIntervalMs);
+
+    auto temp_path = create_temp_file_path();
+    TempFileGuard guard(temp_path);
+
+    {
+      std::ofstream file(temp_path);
+      file << "[power]\n";
+      file << "mode = \"low-power\"\n";
+      file << "low_power_min_interval_ms = 500\n";
+      file << "low_power_max_interval_ms = 4000\n";
+    }
+
+    auto result = read_options_toml(temp_path);
+    REQUIRE(result.has_value());
+    CHECK(result.value().powerOptions.mode == PowerMode::LowPower);
+    CHECK(result.value().powerOptions.lowPowerMinIntervalMs == 500);
+    CHECK(result.value().powerOptions.lowPowerMaxIntervalMs == 4000);
+
+    REQUIRE(write_options_toml(result.value(), temp_path).has_value());
+    auto reread = read_options_toml(temp_path);
+    REQUIRE(reread.has_value());
+    CHECK(reread.value().powerOptions.mode == PowerMode::LowPower);
+    CHECK(reread.value().powerOptions.lowPowerMaxIntervalMs == 4000);
+  }
+
+  TEST_CASE("invalid mode and bounds fall back to defaults") {
+    auto temp_path = create_temp_file_path();
+    TempFileGuard guard(temp_path);
+
+    {
+      std::ofstream file(temp_path);
+      file << "[power]\n";
+      file << "mode = \"turbo\"\n";
+      file << "low_power_min_interval_ms = 800\n";
+      file << "low_power_max_interval_ms = 200\n";
+    }
+
+    auto result = read_options_toml(temp_path);
+    REQUIRE(result.has_value());
+    CHECK(result.value().powerOptions.mode == PowerMode::Auto);
+    CHECK(result.value().powerOptions.lowPowerMinIntervalMs == kDefaultLowPowerMinIntervalMs);
+    CHECK(result.value().powerOptions.lowPowerMaxIntervalMs == kDefaultLowPowerMaxIntervalMs);
+  }
+}
+
+TEST_SUITE("FocusOptions") {
+  TEST_CASE("focus section defaults and round-trip through write") {
+    auto defaults = get_default_global_options();
+    CHECK(defaults.focusOptions.hoverDwellMs == kDefaultHoverDwellMs);
+    CHECK(defaults.focusOptions.minForegroundIntervalMs == kDefaultMinForegroundIntervalMs);
+
+    auto temp_path = create_temp_file_path();
+    TempFileGuard guard(temp_path);
+
+    {
+      std::ofstream file(temp_path);
+      file << "[focus]\n";
+      file << "hover_dwell_ms = 0\n";
+      file << "min_foreground_interval_ms = 600\n";
+    }
+
+    auto result = read_options_toml(temp_path);
+    REQUIRE(result.has_value());
+    CHECK(result.value().focusOptions.hoverDwellMs == 0);
+    CHECK(result.value().focusOptions.minForegroundIntervalMs == 600);
+
+    REQUIRE(write_options_toml(result.value(), temp_path).has_value());
+    auto reread = read_options_toml(temp_path);
+    REQUIRE(reread.has_value());
+    CHECK(reread.value().focusOptions.hoverDwellMs == 0);
+    CHECK(reread.value().focusOptions.minForegroundIntervalMs == 600);
+  }
+
+  TEST_CASE("negative focus timings fall back to defaults") {
+    auto temp_path = create_temp_file_path();
+    TempFileGuard guard(temp_path);
+
+    {
+      std::ofstream file(temp_path);
+      file << "[focus]\n";
+      file << "hover_dwell_ms = -1\n";
+      file << "min_foreground_interval_ms = -50\n";
+    }
+
+    auto result = read_options_toml(temp_path);
+    REQUIRE(result.has_value());
+    CHECK(result.value().focusOptions.hoverDwellMs == kDefaultHoverDwellMs);
+    CHECK(result.value().focusOptions.minForegroundIntervalMs == kDefaultMinForegroundIntervalMs);
+  }
+}
+
+TEST_SUITE("ResizeOptions") {
+  TEST_CASE("resize section defaults and round-trip through write") {
+    auto defaults = get_default_global_options();
+    CHECK(defaults.resizeOptions.live == kDefaultLiveResize);
+    CHECK(defaults.resizeOptions.maxRateHz == kDefaultLiveResizeMaxRateHz);
+
+    auto temp_path = create_temp_file_path();
+    TempFileGuard guard(temp_path);
+
+    {
+      std::ofstream file(temp_path);
+      file << "[resize]\n";
+      file << "live = false\n";
+      file << "max_rate_hz = 30\n";
+    }
+
+    auto result = read_options_toml(temp_path);
+    REQUIRE(result.has_value());
+    CHECK_FALSE(result.value().resizeOptions.live);
+    CHECK(result.value().resizeOptions.maxRateHz == 30);
+
+    REQUIRE(write_options_toml(result.value(), temp_path).has_value());
+    auto reread = read_options_toml(temp_path);
+    REQUIRE(reread.has_value());
+    CHECK_FALSE(reread.value().resizeOptions.live);
+    CHECK(reread.value().resizeOptions.maxRateHz == 30);
+  }
+
+  TEST_CASE("negative rate cap falls back to default") {
+    auto temp_path = create_temp_file_path();
+    TempFileGuard guard(temp_path);
+
+    {
+      std::ofstream file(temp_path);
+      file << "[resize]\n";
+      file << "max_rate_hz = -5\n";
+    }
+
+    auto result = read_options_toml(temp_path);
+    REQUIRE(result.has_value());
+    CHECK(result.value().resizeOptions.live == kDefaultLiveResize);
+    CHECK(result.value().resizeOptions.maxRateHz == kDefaultLiveResizeMaxRateHz);
+  }
+}
+
+TEST_SUITE("WorkspaceOptions") {
+  TEST_CASE("workspaces section defaults and round-trip through write") {
+    auto defaults = get_default_global_options();
+    CHECK(defaults.workspaceOptions.count == kDefaultWorkspaceCount);
+    auto binding = std::find_if(
+        defaults.keyboardOptions.bindings.begin(), defaults.keyboardOptions.bindings.end(),
+        [](const HotkeyBinding& b) { return b.action == HotkeyAction::SendToNextWorkspace; });
+    REQUIRE(binding != defaults.keyboardOptions.bindings.end());
+    CHECK(binding->hotkey == "super+ctrl+shift+n");
+
+    auto temp_path = create_temp_file_path();
+    TempFileGuard guard(temp_path);
+
+    {
+      std::ofstream file(temp_path);
+      file << "[workspaces]\n";
+      file << "count = 6\n";
+    }
+
+    auto result = read_options_toml(temp_path);
+    REQUIRE(result.has_value());
+    CHECK(result.value().workspaceOptions.count == 6);
+
+    REQUIRE(write_options_toml(result.value(), temp_path).has_value());
+    auto reread = read_options_toml(temp_path);
+    REQUIRE(reread.has_value());
+    CHECK(reread.value().workspaceOptions.count == 6);
+  }
+
+  TEST_CASE("out-of-range workspace count falls back to default") {
+    for (int count : {0, static_cast<int>(cells::kMaxWorkspaces) + 1}) {
+      auto temp_path = create_temp_file_path();
+      TempFileGuard guard(temp_path);
+
+      {
+        std::ofstream file(temp_path);
+        file << "[workspaces]\n";
+        file << "count = " << count << "\n";
+      }
+
+      auto result = read_options_toml(temp_path);
+      REQUIRE(result.has_value());
+      CHECK(result.value().workspaceOptions.count == kDefaultWorkspaceCount);
+    }
+  }
+}
+
+TEST_SUITE("LayoutTemplates") {
+  TEST_CASE("nested layouts parse in preorder and round-trip through write") {
+    CHECK(get_default_global_options().layouts.empty());
+
+    auto temp_path = create_temp_file_path();
+    TempFileGuard guard(temp_path);
+
+    {
+      std::ofstream file(temp_path);
+      file << "[[layouts]]\n";
+      file << "name = \"desk\"\n";
+      file << "[layouts.root]\n";
+      file << "split = \"vertical\"\n";
+      file << "ratio = 0.6\n";
+      file << "[layouts.root.first]\n";
+      file << "process = \"chart.exe\"\n";
+      file << "[layouts.root.second]\n";
+      file << "split = \"horizontal\"\n";
+      file << "[layouts.root.second.first]\n";
+      file << "title = \"Orders\"\n";
+      file << "[layouts.root.second.second]\n";
+      file << "process = \"EXCEL.EXE\"\n";
+      file << "class = \"XLMAIN\"\n";
+      file << "\n";
+      file << "[[layouts]]\n";
+      file << "name = \"single\"\n";
+      file << "[layouts.root]\n";
+    }
+
+    auto result = read_options_toml(temp_path);
+    REQUIRE(result.has_value());
+    const auto& layouts = result.value().layouts;
+    REQUIRE(layouts.size() == 2);
+
+    const auto& desk = layouts[0];
+    CHECK(desk.name == "desk");
+    REQUIRE(desk.nodes.size() == 5);
+    CHECK(desk.nodes[0].split_dir == cells::SplitDir::Vertical);
+    CHECK(desk.nodes[0].split_ratio == doctest::Approx(0.6f));
+    CHECK(desk.nodes[0].first_child == 1);
+    CHECK(desk.nodes[0].second_child == 2);
+    CHECK(desk.nodes[1].match.process == "chart.exe");
+    CHECK(desk.nodes[2].split_dir == cells::SplitDir::Horizontal);
+    CHECK(desk.nodes[2].split_ratio == doctest::Approx(0.5f));
+    CHECK(desk.nodes[3].match.title == "Orders");
+    CHECK(desk.nodes[4].match.process == "EXCEL.EXE");
+    CHECK(desk.nodes[4].match.class_name == "XLMAIN");
+
+    // An empty root is a single catch-all slot
+    REQUIRE(layouts[1].nodes.size() == 1);
+    CHECK(layouts[1].nodes[0].match == WindowMatchRule{});
+
+    REQUIRE(write_options_toml(result.value(), temp_path).has_value());
+    auto reread = read_options_toml(temp_path);
+    REQUIRE(reread.has_value());
+    CHECK(reread.value().layouts == layouts);
+  }
+
+  TEST_CASE("invalid layouts are skipped and out-of-range ratios clamped") {
+    auto temp_path = create_temp_file_path();
+    TempFileGuard guard(temp_path);
+
+    {
+      std::ofstream file(temp_path);
+      file << "[[layouts]]\n"; // No name
+      file << "[layouts.root]\n";
+      file << "\n";
+      file << "[[layouts]]\n"; // No root
+      file << "name = \"rootless\"\n";
+      file << "\n";
+      file << "[[layouts]]\n"; // Split missing its second child
+      file << "name = \"half\"\n";
+      file << "[layouts.root]\n";
+      file << "split = \"vertical\"\n";
+      file << "[layouts.root.first]\n";
+      file << "\n";
+      file << "[[layouts]]\n"; // Unknown split direction
+      file << "name = \"diagonal\"\n";
+      file << "[layouts.root]\n";
+      file << "split = \"diagonal\"\n";
+      file << "[layouts.root.first]\n";
+      file << "[layouts.root.second]\n";
+      file << "\n";
+      file << "[[layouts]]\n";
+      file << "name = \"wide\"\n";
+      file << "[layouts.root]\n";
+      file << "split = \"vertical\"\n";
+      file << "ratio = 0.99\n";
+      file << "[layouts.root.first]\n";
+      file << "[layouts.root.second]\n";
+      file << "\n";
+      file << "[[layouts]]\n"; // Duplicate name
+      file << "name = \"wide\"\n";
+      file << "[layouts.root]\n";
+    }
+
+    auto result = read_options_toml(temp_path);
+    REQUIRE(result.has_value());
+    const auto& layouts = result.value().layouts;
+    REQUIRE(layouts.size() == 1);
+    CHECK(layouts[0].name == "wide");
+    REQUIRE(layouts[0].nodes.size() == 3);
+    CHECK(layouts[0].nodes[0].split_ratio == doctest::Approx(cells::kMaxSplitRatio));
+  }
+
+  TEST_CASE("layouts nested past the depth limit are skipped") {
+    auto temp_path = create_temp_file_path();
+    TempFileGuard guard(temp_path);
+
+    {
+      std::ofstream file(temp_path);
+      file << "[[layouts]]\n";
+      file << "name = \"deep\"\n";
+      std::string path = "layouts.root";
+      for (int depth = 0; depth <= kMaxLayoutTemplateDepth; ++depth) {
+        file << "[" << path << "]\n";
+        file << "split = \"vertical\"\n";
+        file << "[" << path << ".second]\n";
+        path += ".first";
+      }
+      file << "[" << path << "]\n";
+    }
+
+    auto result = read_options_toml(temp_path);
+    REQUIRE(result.has_value());
+    CHECK(result.value().layouts.empty());
+  }
+}
+
 #endif // !DOCTEST_CONFIG_DISABLE
@@ -0,0 +1,250 @@
+#ifndef DOCTEST_CONFIG_DISABLE
+
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <new>
+#include <vector>
+
+#include "multi_cells.h"
+#include "options.h"
+
+using namespace wintiler;
+
+// Performance budgets for the hot cells operations and config loading. Every suite here is
+// named "perf - ...", so quick runs can leave them out with --test-suite-exclude="perf*".
+//
+// Times are budgeted in calibration units (one pass of a fixed integer loop, measured once per
+// run) rather than in nanoseconds, so the same budget holds on a slow CI machine and a fast
+// desktop. Budgets are about twenty times an optimized build's cost, enough for Test-Debug;
+// they catch an accidental complexity change (an O(n) scan on 512 windows), not a few percent.
+// Allocation budgets likewise leave room for the container proxies of MSVC debug iterators.
+
+// Allocation counter: the replaceable global operator new counts every allocation made in the
+// test binary. Only the perf suites read it.
+namespace {
+std::atomic<uint64_t> g_allocations{0};
+std::atomic<uint64_t> g_calibration_sink{0}; // Keeps the calibration loop from being elided
+} // namespace
+
+void* operator new(std::size_t size) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+  return ::operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kClusters = 8;
+constexpr size_t kWindowsPerCluster = 64;
+constexpr float kGap = 10.0f;
+constexpr float kZenPercentage = 0.85f;
+
+// Nanoseconds for one pass of a fixed integer loop, best of several runs
+double calibration_ns() {
+  static const double ns = [] {
+    double best = 0.0;
+    for (int run = 0; run < 7; ++run) {
+      auto start = Clock::now();
+      uint64_t x = 0x9e3779b97f4a7c15ULL;
+      for (int i = 0; i < 10000; ++i) {
+        x ^= x >> 31;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x += static_cast<uint64_t>(i);
+      }
+      g_calibration_sink.store(x, std::memory_order_relaxed);
+      double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+      best = (run == 0) ? elapsed : std::min(best, elapsed);
+    }
+    MESSAGE("perf calibration: " << best << " ns per unit");
+    return best;
+  }();
+  return ns;
+}
+
+struct Cost {
+  double units;       // Calibration units per call
+  double allocations; // Heap allocations per call
+};
+
+// Cost of one call to fn, best of three timed batches after a warm-up call
+template <typename Fn>
+Cost measure(int calls, Fn&& fn) {
+  fn();
+  double best_ns = 0.0;
+  uint64_t allocations = 0;
+  for (int batch = 0; batch < 3; ++batch) {
+    uint64_t allocations_before = g_allocations.load(std::memory_order_relaxed);
+    auto start = Clock::now();
+    for (int i = 0; i < calls; ++i) {
+      fn();
+    }
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / calls;
+    allocations = g_allocations.load(std::memory_order_relaxed) - allocations_before;
+    best_ns = (batch == 0) ? ns : std::min(best_ns, ns);
+  }
+  return {best_ns / calibration_ns(), static_cast<double>(allocations) / calls};
+}
+
+void check_budget(const char* name, const Cost& cost, double max_units, double max_allocations) {
+  MESSAGE(name << ": " << cost.units << " units (budget " << max_units << "), "
+               << cost.allocations << " allocations (budget " << max_allocations << ")");
+  CHECK(cost.units <= max_units);
+  CHECK(cost.allocations <= max_allocations);
+}
+
+// kClusters monitors side by side, kWindowsPerCluster windows each, reconciled once
+struct LargeSystem {
+  cells::System system;
+  std::vector<cells::ClusterCellUpdateInfo> windows;
+
+  LargeSystem() {
+    std::vector<cells::ClusterInitInfo> infos;
+    for (size_t c = 0; c < kClusters; ++c) {
+      float x = 1920.0f * static_cast<float>(c);
+      infos.push_back({x, 0.0f, 1920.0f, 1040.0f, x, 0.0f, 1920.0f, 1080.0f, {}});
+    }
+    system = cells::create_system(infos, kGap, kGap);
+    size_t next_id = 0x10000;
+    for (size_t c = 0; c < kClusters; ++c) {
+      cells::ClusterCellUpdateInfo info{c, {}};
+      for (size_t i = 0; i < kWindowsPerCluster; ++i) {
+        info.leaf_ids.push_back(next_id);
+        next_id += 8; // HWND-like spacing
+      }
+      windows.push_back(info);
+    }
+    update();
+    REQUIRE(cells::validate_system(system));
+  }
+
+  cells::UpdateResult update() {
+    return cells::update(system, windows, std::nullopt, {-1.0f, -1.0f}, kZenPercentage, 0,
+                         kGap, kGap);
+  }
+
+  size_t leaf(size_t cluster, size_t i) const {
+    return windows[cluster].leaf_ids[i];
+  }
+};
+
+} // namespace
+
+TEST_SUITE("perf - cells") {
+  TEST_CASE("update on unchanged input") {
+    LargeSystem large;
+    auto cost = measure(200, [&] { (void)large.update(); });
+    // Fingerprint match: no diff, but the tile layout is rebuilt for all 512 windows
+    check_budget("update, 8x64 unchanged", cost, 30.0, 32.0);
+  }
+
+  TEST_CASE("keyboard navigation") {
+    LargeSystem large;
+    auto index = cells::find_cell_by_leaf_id(large.system.clusters[3].cluster, large.leaf(3, 20));
+    REQUIRE(index.has_value());
+    large.system.selection = cells::CellIndicatorByIndex{3, *index};
+    int step = 0;
+    constexpr cells::Direction kDirs[] = {cells::Direction::Left, cells::Direction::Up,
+                                          cells::Direction::Right, cells::Direction::Down};
+    auto cost =
+        measure(2000, [&] { (void)cells::move_selection(large.system, kDirs[step++ % 4]); });
+    check_budget("move_selection, 8x64", cost, 4.0, 2.0);
+  }
+
+  TEST_CASE("hit testing") {
+    LargeSystem large;
+    int step = 0;
+    auto cost = measure(5000, [&] {
+      float x = static_cast<float>((step * 397) % (1920 * static_cast<int>(kClusters)));
+      float y = static_cast<float>((step * 131) % 1080);
+      ++step;
+      (void)cells::find_cell_at_point(large.system, x, y, kZenPercentage);
+    });
+    check_budget("find_cell_at_point, 8x64", cost, 4.0, 2.0);
+  }
+
+  TEST_CASE("swap within and across clusters") {
+    LargeSystem large;
+    // Each pair of swaps puts the windows back, so every call sees the same trees
+    size_t a = large.leaf(2, 7);
+    size_t b = large.leaf(2, 50);
+    size_t c = large.leaf(5, 50);
+    int step = 0;
+    auto cost = measure(2000, [&] {
+      switch (step++ % 4) {
+      case 0:
+      case 1:
+        (void)cells::swap_cells(large.system, 2, a, 2, b, kGap, kGap);
+        break;
+      case 2:
+        (void)cells::swap_cells(large.system, 2, a, 5, c, kGap, kGap);
+        break;
+      default:
+        (void)cells::swap_cells(large.system, 2, c, 5, a, kGap, kGap);
+        break;
+      }
+    });
+    check_budget("swap_cells, 8x64", cost, 2.0, 2.0);
+    CHECK(step % 4 == 1);
+    CHECK(cells::validate_system(large.system));
+  }
+
+  TEST_CASE("move within a cluster") {
+    LargeSystem large;
+    // Move one window next to a far one and back next to a near one; the cluster keeps its
+    // size, so every call costs the same
+    bool out = true;
+    auto cost = measure(2000, [&] {
+      size_t target = out ? large.leaf(4, 60) : large.leaf(4, 1);
+      (void)cells::move_cell(large.system, 4, large.leaf(4, 30), 4, target, kGap, kGap);
+      out = !out;
+    });
+    // One allocation: the rect recompute stack of the promoted subtree
+    check_budget("move_cell, 8x64", cost, 2.0, 4.0);
+    CHECK(cells::validate_system(large.system));
+  }
+}
+
+TEST_SUITE("perf - options") {
+  TEST_CASE("read_options_toml on a full config") {
+    auto path = std::filesystem::temp_directory_path() /
+                ("win-tiler-perf-" +
+                 std::to_string(Clock::now().time_since_epoch().count()) + ".toml");
+    REQUIRE(write_options_toml(GlobalOptions{}, path).has_value());
+
+    auto cost = measure(50, [&] { REQUIRE(read_options_toml(path).has_value()); });
+    std::filesystem::remove(path);
+    check_budget("read_options_toml, default config", cost, 500.0, 5000.0);
+  }
+}
+
+#endif // !DOCTEST_CONFIG_DISABLE
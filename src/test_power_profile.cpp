@@ -0,0 +1,101 @@
+#ifndef DOCTEST_CONFIG_DISABLE
+
+#include <doctest/doctest.h>
+
+#include <chrono>
+
+#include "power_profile.h"
+
+using namespace wintiler;
+using namespace std::chrono_literals;
+
+TEST_SUITE("power profile - selection") {
+  TEST_CASE("auto follows the power source") {
+    CHECK(select_power_profile(PowerMode::Auto, true) == PowerProfile::Performance);
+    CHECK(select_power_profile(PowerMode::Auto, false) == PowerProfile::LowPower);
+  }
+
+  TEST_CASE("auto with an unknown power source stays on performance") {
+    CHECK(select_power_profile(PowerMode::Auto, std::nullopt) == PowerProfile::Performance);
+  }
+
+  TEST_CASE("pinned modes ignore the power source") {
+    for (auto on_ac : {std::optional<bool>{true}, std::optional<bool>{false},
+                       std::optional<bool>{}}) {
+      CHECK(select_power_profile(PowerMode::Performance, on_ac) == PowerProfile::Performance);
+      CHECK(select_power_profile(PowerMode::LowPower, on_ac) == PowerProfile::LowPower);
+    }
+  }
+
+  TEST_CASE("performance keeps the loop options and hover focus") {
+    LoopOptions loop;
+    loop.adaptive = false;
+    loop.intervalMs = 80;
+    PowerOptions power;
+    auto settings = profile_settings(PowerProfile::Performance, loop, power);
+    CHECK_FALSE(settings.adaptive);
+    CHECK(settings.interval_ms == 80);
+    CHECK(settings.min_interval_ms == loop.minIntervalMs);
+    CHECK(settings.max_interval_ms == loop.maxIntervalMs);
+    CHECK_FALSE(settings.render_on_change);
+    CHECK(settings.hover_focus);
+    CHECK_FALSE(settings.batch_placement);
+  }
+
+  TEST_CASE("low power polls slower, renders on change and batches placement") {
+    LoopOptions loop;
+    loop.adaptive = false;
+    PowerOptions power;
+    power.lowPowerMinIntervalMs = 400;
+    power.lowPowerMaxIntervalMs = 5000;
+    auto settings = profile_settings(PowerProfile::LowPower, loop, power);
+    CHECK(settings.adaptive);
+    CHECK(settings.min_interval_ms == 400);
+    CHECK(settings.max_interval_ms == 5000);
+    CHECK(settings.min_interval_ms > loop.minIntervalMs);
+    CHECK(settings.render_on_change);
+    CHECK_FALSE(settings.hover_focus);
+    CHECK(settings.batch_placement);
+  }
+}
+
+TEST_SUITE("power profile - meter") {
+  TEST_CASE("usage is accounted to the profile active at the time") {
+    using CpuTime = PowerProfileMeter::CpuTime;
+    PowerProfileMeter::Clock::time_point t{};
+    PowerProfileMeter meter(PowerProfile::Performance, t, CpuTime(0));
+
+    for (int i = 0; i < 600; ++i) {
+      meter.record_wakeup();
+    }
+    // One minute on AC using 1.2s of CPU, then two minutes on battery using 0.6s
+    meter.switch_to(PowerProfile::LowPower, t + 60s, CpuTime(1200000));
+    CHECK(meter.current() == PowerProfile::LowPower);
+    for (int i = 0; i < 40; ++i) {
+      meter.record_wakeup();
+    }
+    auto now = t + 180s;
+    CpuTime cpu(1800000);
+
+    auto perf = meter.usage(PowerProfile::Performance, now, cpu);
+    CHECK(perf.wakeups == 600);
+    CHECK(perf.wakeups_per_minute() == doctest::Approx(600.0));
+    CHECK(perf.cpu_percent() == doctest::Approx(2.0));
+
+    auto low = meter.usage(PowerProfile::LowPower, now, cpu);
+    CHECK(low.wakeups == 40);
+    CHECK(low.wakeups_per_minute() == doctest::Approx(20.0));
+    CHECK(low.cpu_percent() == doctest::Approx(0.5));
+  }
+
+  TEST_CASE("unused profile reports zero rates") {
+    PowerProfileMeter::Clock::time_point t{};
+    PowerProfileMeter meter(PowerProfile::Performance, t, PowerProfileMeter::CpuTime(0));
+    auto low = meter.usage(PowerProfile::LowPower, t + 10s, PowerProfileMeter::CpuTime(5));
+    CHECK(low.wakeups == 0);
+    CHECK(low.wakeups_per_minute() == 0.0);
+    CHECK(low.cpu_percent() == 0.0);
+  }
+}
+
+#endif // !DOCTEST_CONFIG_DISABLE
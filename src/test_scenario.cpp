@@ -0,0 +1,180 @@
+#ifndef DOCTEST_CONFIG_DISABLE
+
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "scenario.h"
+
+using namespace wintiler;
+
+namespace {
+
+// Two 1000x500 monitors side by side, empty
+std::vector<cells::ClusterInitInfo> two_monitors() {
+  return {{0.0f, 0.0f, 1000.0f, 500.0f, 0.0f, 0.0f, 1000.0f, 500.0f, {}},
+          {1000.0f, 0.0f, 1000.0f, 500.0f, 1000.0f, 0.0f, 1000.0f, 500.0f, {}}};
+}
+
+std::vector<ScenarioStep> parse(const std::string& script) {
+  auto steps = parse_scenario(script);
+  REQUIRE(steps.has_value());
+  return *steps;
+}
+
+std::vector<size_t> leaves(const ScenarioRunner& runner, size_t cluster_index) {
+  auto ids = cells::get_cluster_leaf_ids(runner.system().clusters[cluster_index].cluster);
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+
+} // namespace
+
+TEST_SUITE("scenario - parsing") {
+  TEST_CASE("steps, arguments, repeat and comments") {
+    auto steps = parse("# setup\n"
+                       "add\n"
+                       "  add 1   # second monitor\n"
+                       "\n"
+                       "repeat 5 navigate right\n"
+                       "ratio +0.05\n"
+                       "ratio 0.3\n"
+                       "drop 1500 250 swap\n");
+    REQUIRE(steps.size() == 6);
+    CHECK(steps[0].op == ScenarioOp::Add);
+    CHECK_FALSE(steps[0].index.has_value());
+    CHECK(steps[0].line == 2);
+    CHECK(steps[1].index == 1u);
+    CHECK(steps[1].text == "add 1");
+    CHECK(steps[2].op == ScenarioOp::Navigate);
+    CHECK(steps[2].direction == cells::Direction::Right);
+    CHECK(steps[2].repeat == 5);
+    CHECK(steps[3].relative);
+    CHECK(steps[3].value == doctest::Approx(0.05f));
+    CHECK_FALSE(steps[4].relative);
+    CHECK(steps[5].op == ScenarioOp::Drop);
+    CHECK(steps[5].x == 1500.0f);
+    CHECK(steps[5].exchange);
+  }
+
+  TEST_CASE("errors name the line") {
+    auto unknown = parse_scenario("add\nfly away\n");
+    REQUIRE_FALSE(unknown.has_value());
+    CHECK(unknown.error() == "line 2: unknown step 'fly'");
+
+    auto usage = parse_scenario("navigate sideways");
+    REQUIRE_FALSE(usage.has_value());
+    CHECK(usage.error().find("line 1: usage: navigate") == 0);
+
+    CHECK_FALSE(parse_scenario("select").has_value());
+    CHECK_FALSE(parse_scenario("point 10").has_value());
+    CHECK_FALSE(parse_scenario("zen now").has_value());
+    CHECK_FALSE(parse_scenario("repeat 0 add").has_value());
+    CHECK_FALSE(parse_scenario("repeat 3").has_value());
+  }
+}
+
+TEST_SUITE("scenario - runner") {
+  TEST_CASE("add fills the selected cluster and selects the new leaf") {
+    ScenarioRunner runner(two_monitors(), {});
+    auto report = runner.run(parse("add\nadd\nadd 1\nvalidate\n"));
+    CHECK(report.failures == 0);
+    CHECK(report.valid);
+    CHECK(leaves(runner, 0) == std::vector<size_t>{10, 11});
+    CHECK(leaves(runner, 1) == std::vector<size_t>{12});
+    REQUIRE(runner.system().selection.has_value());
+    CHECK(runner.system().selection->cluster_index == 1);
+    CHECK(report.steps[2].leaves == 3);
+  }
+
+  TEST_CASE("delete removes the selection or an explicit leaf") {
+    ScenarioRunner runner(two_monitors(), {});
+    auto report = runner.run(parse("repeat 3 add\ndelete\ndelete 10\ndelete 99\nvalidate\n"));
+    CHECK(leaves(runner, 0) == std::vector<size_t>{11});
+    CHECK(report.failures == 1); // Leaf 99 does not exist
+    CHECK(report.steps[3].failures == 1);
+    CHECK(report.valid);
+  }
+
+  TEST_CASE("point and navigate move the selection across monitors") {
+    ScenarioRunner runner(two_monitors(), {});
+    runner.run(parse("add\nadd 1\npoint 100 100\n"));
+    REQUIRE(runner.system().selection.has_value());
+    CHECK(runner.system().selection->cluster_index == 0);
+
+    auto report = runner.run(parse("navigate right\nnavigate right\n"));
+    CHECK(runner.system().selection->cluster_index == 1);
+    CHECK(report.steps[0].failures == 0);
+    CHECK(report.steps[1].failures == 1); // Nothing right of the second monitor
+  }
+
+  TEST_CASE("store then swap or move across clusters") {
+    ScenarioRunner runner(two_monitors(), {});
+    runner.run(parse("add\nadd\nadd 1\n"));
+
+    auto swapped = runner.run(parse("select 10\nstore\nselect 12\nswap\nvalidate\n"));
+    CHECK(swapped.failures == 0);
+    CHECK(leaves(runner, 0) == std::vector<size_t>{11, 12});
+    CHECK(leaves(runner, 1) == std::vector<size_t>{10});
+
+    auto moved = runner.run(parse("select 11\nstore\nselect 10\nmove\nvalidate\n"));
+    CHECK(moved.failures == 0);
+    CHECK(leaves(runner, 0) == std::vector<size_t>{12});
+    CHECK(leaves(runner, 1) == std::vector<size_t>{10, 11});
+
+    // Nothing stored any more
+    CHECK(runner.run(parse("swap\n")).failures == 1);
+  }
+
+  TEST_CASE("zen, ratio, toggle-split, split-mode and exchange-siblings") {
+    ScenarioRunner runner(two_monitors(), {});
+    const auto& cluster = runner.system().clusters[0].cluster;
+    CHECK(runner.run(parse("add\nadd\nratio 0.3\n")).failures == 0);
+    CHECK(cluster.cells[0].split_ratio == doctest::Approx(0.3f));
+    // Adjusting grows or shrinks the selected side, whichever child it is
+    CHECK(runner.run(parse("ratio +0.1\n")).failures == 0);
+    CHECK(cluster.cells[0].split_ratio != doctest::Approx(0.3f));
+
+    auto report = runner.run(parse("toggle-split\nsplit-mode\nexchange-siblings\nzen\nvalidate\n"));
+    CHECK(report.failures == 0);
+    CHECK(report.valid);
+    CHECK(cluster.zen_cell_index.has_value());
+    CHECK(runner.system().split_mode == cells::SplitMode::Vertical);
+  }
+
+  TEST_CASE("drop moves the selected leaf to another monitor") {
+    ScenarioRunner runner(two_monitors(), {});
+    auto report = runner.run(parse("add\nadd\nadd 1\nselect 10\ndrop 1500 250\nvalidate\n"));
+    CHECK(report.failures == 0);
+    CHECK(leaves(runner, 0) == std::vector<size_t>{11});
+    CHECK(leaves(runner, 1) == std::vector<size_t>{10, 12});
+  }
+
+  TEST_CASE("repeat times every run and initial leaves are kept") {
+    auto infos = two_monitors();
+    infos[0].initial_cell_ids = {40, 41};
+    ScenarioRunner runner(infos, {});
+    auto report = runner.run(parse("repeat 20 add\nrepeat 10 delete\nvalidate\n"));
+    REQUIRE(report.steps.size() == 3);
+    CHECK(report.steps[0].runs == 20);
+    CHECK(report.steps[0].min_ns <= report.steps[0].max_ns);
+    CHECK(report.steps[0].leaves == 22);
+    CHECK(report.steps[1].leaves == 12);
+    CHECK(report.valid);
+    // New ids do not collide with the initial ones
+    CHECK(cells::has_leaf_id(runner.system(), 42));
+  }
+
+  TEST_CASE("the report lists every step") {
+    ScenarioRunner runner(two_monitors(), {});
+    auto text = format_scenario_report(runner.run(parse("repeat 2 add\nselect 99\n")));
+    CHECK(text.find("repeat 2 add") != std::string::npos);
+    CHECK(text.find("select 99") != std::string::npos);
+    CHECK(text.find("2 steps") != std::string::npos);
+    CHECK(text.find("1 failed runs") != std::string::npos);
+  }
+}
+
+#endif // !DOCTEST_CONFIG_DISABLE
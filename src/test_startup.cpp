@@ -0,0 +1,133 @@
+#ifndef DOCTEST_CONFIG_DISABLE
+
+#include <doctest/doctest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "startup.h"
+
+using namespace wintiler;
+using namespace std::chrono_literals;
+
+namespace {
+
+// Simulated backend: records which step ran on which thread, in order
+struct SimulatedStartup {
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::vector<std::string> steps;
+  std::thread::id device_thread;
+  std::thread::id window_thread;
+  int gathers = 0;
+  bool devices_ok = true;
+
+  void log(const std::string& step) {
+    std::lock_guard lock(mutex);
+    steps.push_back(step);
+    changed.notify_all();
+  }
+
+  bool logged(const std::string& step) {
+    for (const auto& s : steps) {
+      if (s == step) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  size_t position(const std::string& step) {
+    for (size_t i = 0; i < steps.size(); ++i) {
+      if (steps[i] == step) {
+        return i;
+      }
+    }
+    return steps.size();
+  }
+
+  StartupHooks hooks(bool devices_wait_for_layout) {
+    StartupHooks h;
+    h.gather = [this] {
+      ++gathers;
+      log("gather");
+      winapi::LoopInputState state;
+      state.windows_per_monitor = {{{reinterpret_cast<winapi::HWND_T>(uintptr_t{0x10}), false}}};
+      return state;
+    };
+    h.first_layout = [this](const winapi::LoopInputState& state) {
+      log("layout " + std::to_string(state.windows_per_monitor[0].size()));
+    };
+    h.init_overlay_devices = [this, devices_wait_for_layout] {
+      device_thread = std::this_thread::get_id();
+      if (devices_wait_for_layout) {
+        // Only finishes if the first layout does not wait for the devices
+        std::unique_lock lock(mutex);
+        changed.wait_for(lock, 2s, [this] { return logged("layout 1"); });
+        steps.push_back(logged("layout 1") ? "devices after layout" : "devices timed out");
+        return devices_ok;
+      }
+      log("devices");
+      return devices_ok;
+    };
+    h.init_overlay_window = [this](bool ok) {
+      window_thread = std::this_thread::get_id();
+      log(ok ? "window" : "window skipped");
+      return ok;
+    };
+    return h;
+  }
+};
+
+} // namespace
+
+TEST_SUITE("startup - orchestration") {
+  TEST_CASE("enumerates once and reuses the state") {
+    SimulatedStartup sim;
+    auto report = run_startup(sim.hooks(false));
+    CHECK(sim.gathers == 1);
+    CHECK(report.input_state.windows_per_monitor.size() == 1);
+    CHECK(sim.logged("layout 1"));
+    CHECK(report.overlay_ok);
+  }
+
+  TEST_CASE("overlay devices are created on a worker thread, the window on the caller") {
+    SimulatedStartup sim;
+    (void)run_startup(sim.hooks(false));
+    CHECK(sim.device_thread != std::this_thread::get_id());
+    CHECK(sim.window_thread == std::this_thread::get_id());
+  }
+
+  TEST_CASE("first layout overlaps device creation") {
+    SimulatedStartup sim;
+    auto report = run_startup(sim.hooks(true));
+    CHECK(sim.logged("devices after layout"));
+    CHECK_FALSE(sim.logged("devices timed out"));
+    CHECK(report.time_to_first_tile <= report.total);
+  }
+
+  TEST_CASE("the window is finished after both the devices and the first layout") {
+    SimulatedStartup sim;
+    (void)run_startup(sim.hooks(false));
+    REQUIRE(sim.logged("window"));
+    CHECK(sim.position("devices") < sim.position("window"));
+    CHECK(sim.position("layout 1") < sim.position("window"));
+    CHECK(sim.position("gather") < sim.position("layout 1"));
+  }
+
+  TEST_CASE("a device failure is passed on and reported") {
+    SimulatedStartup sim;
+    sim.devices_ok = false;
+    auto report = run_startup(sim.hooks(false));
+    CHECK(sim.logged("window skipped"));
+    CHECK_FALSE(report.overlay_ok);
+    CHECK(sim.logged("layout 1"));
+  }
+}
+
+#endif
@@ -0,0 +1,204 @@
+#ifndef DOCTEST_CONFIG_DISABLE
+
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <set>
+#include <vector>
+
+#include "stress_workload.h"
+
+using namespace wintiler;
+
+namespace {
+
+// Pointer outside every monitor, so no empty cluster attracts the new windows
+constexpr std::pair<float, float> kNoPointer{-1.0f, -1.0f};
+
+size_t count_leaves(const cells::System& system) {
+  size_t count = 0;
+  for (const auto& pc : system.clusters) {
+    count += cells::get_cluster_leaf_ids(pc.cluster).size();
+  }
+  return count;
+}
+
+// Run the workload for seconds at 60 ticks per second
+void run_for(cells::System& system, StressWorkload& workload, double seconds) {
+  constexpr double kDt = 1.0 / 60.0;
+  for (int i = 0; i < static_cast<int>(seconds * 60.0 + 0.5); ++i) {
+    auto tick = workload.tick(system, kDt);
+    apply_stress_tick(system, tick, kNoPointer, 0.9f, 0.0f, 0.0f);
+  }
+}
+
+} // namespace
+
+TEST_SUITE("stress workload - monitors") {
+  TEST_CASE("monitors are laid out in a near-square grid") {
+    auto infos = make_stress_monitors(8, 100.0f, 50.0f);
+    REQUIRE(infos.size() == 8);
+    CHECK(infos[0].x == 0.0f);
+    CHECK(infos[2].x == 200.0f); // 3 columns
+    CHECK(infos[3].x == 0.0f);
+    CHECK(infos[3].y == 50.0f);
+    CHECK(infos[7].y == 100.0f);
+    CHECK(infos[7].monitor_width == 100.0f);
+  }
+}
+
+TEST_SUITE("stress workload - generator") {
+  TEST_CASE("ramps up at the spawn rate and stops at the target") {
+    StressOptions options;
+    options.monitors = 4;
+    options.target_windows = 100;
+    options.spawn_per_second = 60.0;
+    options.churn_per_second = 0.0;
+    auto system = cells::create_system(make_stress_monitors(4, 800.0f, 600.0f), 0.0f, 0.0f);
+    StressWorkload workload(options, 10);
+
+    run_for(system, workload, 1.0);
+    CHECK(count_leaves(system) == 60);
+    run_for(system, workload, 2.0);
+    CHECK(count_leaves(system) == 100);
+    CHECK(workload.total_spawned() == 100);
+    CHECK(workload.total_killed() == 0);
+    CHECK(cells::validate_system(system));
+  }
+
+  TEST_CASE("fractional rates carry over between ticks") {
+    StressOptions options;
+    options.target_windows = 10;
+    options.spawn_per_second = 1.5;
+    auto system = cells::create_system(make_stress_monitors(1, 800.0f, 600.0f), 0.0f, 0.0f);
+    StressWorkload workload(options, 10);
+    size_t spawned = 0;
+    for (int i = 0; i < 4; ++i) {
+      auto tick = workload.tick(system, 0.5);
+      spawned += tick.spawned;
+      apply_stress_tick(system, tick, kNoPointer, 0.9f, 0.0f, 0.0f);
+    }
+    CHECK(spawned == 3); // 2s at 1.5/s
+  }
+
+  TEST_CASE("a stalled frame does not cause a burst") {
+    StressOptions options;
+    options.target_windows = 1000;
+    options.spawn_per_second = 100.0;
+    auto system = cells::create_system(make_stress_monitors(2, 800.0f, 600.0f), 0.0f, 0.0f);
+    StressWorkload workload(options, 10);
+    auto tick = workload.tick(system, 30.0);
+    CHECK(tick.spawned == 100);
+  }
+
+  TEST_CASE("churn at the target keeps the count steady and spreads windows") {
+    StressOptions options;
+    options.monitors = 8;
+    options.target_windows = 500;
+    options.spawn_per_second = 1000.0;
+    options.churn_per_second = 30.0;
+    auto system = cells::create_system(make_stress_monitors(8, 1920.0f, 1080.0f), 0.0f, 0.0f);
+    StressWorkload workload(options, 10);
+
+    run_for(system, workload, 1.0);
+    CHECK(count_leaves(system) == 500);
+    auto killed = workload.total_killed();
+    auto spawned = workload.total_spawned();
+    run_for(system, workload, 2.0);
+    CHECK(count_leaves(system) == 500);
+    CHECK(workload.total_killed() - killed == 60);
+    CHECK(workload.total_spawned() - spawned == 60);
+    CHECK(cells::validate_system(system));
+
+    // Every monitor got a share
+    for (const auto& pc : system.clusters) {
+      CHECK(cells::get_cluster_leaf_ids(pc.cluster).size() > 20);
+    }
+  }
+
+  TEST_CASE("kills only name live windows and new ids are never reused") {
+    StressOptions options;
+    options.target_windows = 50;
+    options.spawn_per_second = 500.0;
+    options.churn_per_second = 120.0;
+    auto system = cells::create_system(make_stress_monitors(3, 800.0f, 600.0f), 0.0f, 0.0f);
+    StressWorkload workload(options, 10);
+    std::set<size_t> seen;
+    for (int i = 0; i < 240; ++i) {
+      auto tick = workload.tick(system, 1.0 / 60.0);
+      auto result = apply_stress_tick(system, tick, kNoPointer, 0.9f, 0.0f, 0.0f);
+      CHECK(result.errors.empty());
+      CHECK(result.deleted_leaf_ids.size() == tick.killed);
+      for (size_t id : result.added_leaf_ids) {
+        CHECK(seen.insert(id).second);
+      }
+    }
+    CHECK(cells::validate_system(system));
+  }
+
+  TEST_CASE("same seed, same workload") {
+    StressOptions options;
+    options.target_windows = 40;
+    options.churn_per_second = 60.0;
+    auto run = [&]() {
+      auto system = cells::create_system(make_stress_monitors(4, 800.0f, 600.0f), 0.0f, 0.0f);
+      StressWorkload workload(options, 10);
+      run_for(system, workload, 2.0);
+      std::vector<std::vector<size_t>> leaves;
+      for (const auto& pc : system.clusters) {
+        leaves.push_back(cells::get_cluster_leaf_ids(pc.cluster));
+      }
+      return leaves;
+    };
+    CHECK(run() == run());
+  }
+
+  TEST_CASE("benchmark: 500 windows on 8 monitors with churn" * doctest::skip()) {
+    using Clock = std::chrono::steady_clock;
+    StressOptions options;
+    options.churn_per_second = 60.0;
+    options.spawn_per_second = 100000.0;
+    auto system = cells::create_system(make_stress_monitors(8, 1920.0f, 1080.0f), 0.0f, 0.0f);
+    StressWorkload workload(options, 10);
+    run_for(system, workload, 1.0);
+    REQUIRE(count_leaves(system) == 500);
+
+    constexpr int kTicks = 600;
+    FrameTimeHistory history;
+    for (int i = 0; i < kTicks; ++i) {
+      auto start = Clock::now();
+      auto tick = workload.tick(system, 1.0 / 60.0);
+      apply_stress_tick(system, tick, kNoPointer, 0.9f, 0.0f, 0.0f);
+      auto ms = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+      history.push(ms, 0.0f);
+    }
+    auto summary = history.summary();
+    MESSAGE("update avg " << summary.update_avg_ms << "ms, max " << summary.update_max_ms
+                          << "ms per tick");
+    CHECK(summary.update_avg_ms < 16.0f);
+  }
+}
+
+TEST_SUITE("stress workload - frame history") {
+  TEST_CASE("keeps the last frames oldest first and summarizes them") {
+    FrameTimeHistory history;
+    CHECK(history.size() == 0);
+    CHECK(history.summary().update_max_ms == 0.0f);
+    for (size_t i = 0; i < FrameTimeHistory::kCapacity + 10; ++i) {
+      history.push(static_cast<float>(i), 1.0f);
+    }
+    CHECK(history.size() == FrameTimeHistory::kCapacity);
+    CHECK(history.at(0).update_ms == 10.0f);
+    CHECK(history.at(FrameTimeHistory::kCapacity - 1).update_ms ==
+          static_cast<float>(FrameTimeHistory::kCapacity + 9));
+    auto summary = history.summary();
+    CHECK(summary.update_max_ms == static_cast<float>(FrameTimeHistory::kCapacity + 9));
+    double expected_avg = 10.0 + (FrameTimeHistory::kCapacity - 1) / 2.0;
+    CHECK(summary.update_avg_ms == doctest::Approx(expected_avg));
+    CHECK(summary.draw_avg_ms == doctest::Approx(1.0));
+    CHECK(summary.draw_max_ms == 1.0f);
+  }
+}
+
+#endif // !DOCTEST_CONFIG_DISABLE
@@ -0,0 +1,262 @@
+#ifndef DOCTEST_CONFIG_DISABLE
+
+#include <doctest/doctest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "multi_cells.h"
+#include "thread_pool.h"
+
+using namespace wintiler;
+
+namespace {
+
+// 1920x1080 monitors side by side, like a trading desk
+cells::System make_desk(size_t monitors, size_t windows_per_monitor, size_t& next_id) {
+  std::vector<cells::ClusterInitInfo> infos;
+  for (size_t m = 0; m < monitors; ++m) {
+    float x = static_cast<float>(m) * 1920.0f;
+    std::vector<size_t> ids;
+    for (size_t w = 0; w < windows_per_monitor; ++w) {
+      ids.push_back(next_id++);
+    }
+    infos.push_back({x, 0.0f, 1920.0f, 1040.0f, x, 0.0f, 1920.0f, 1080.0f, ids});
+  }
+  return cells::create_system(infos, 10.0f, 10.0f);
+}
+
+std::vector<cells::ClusterCellUpdateInfo> current_state(const cells::System& system) {
+  std::vector<cells::ClusterCellUpdateInfo> state;
+  for (size_t ci = 0; ci < system.clusters.size(); ++ci) {
+    state.push_back({ci, cells::get_cluster_leaf_ids(system.clusters[ci].cluster), false});
+  }
+  return state;
+}
+
+// Mass open/close: each cluster drops close_count windows and gains open_count new ones
+void churn(std::vector<cells::ClusterCellUpdateInfo>& state, std::mt19937& rng,
+           size_t close_count, size_t open_count, size_t& next_id) {
+  for (auto& upd : state) {
+    for (size_t i = 0; i < close_count && !upd.leaf_ids.empty(); ++i) {
+      std::uniform_int_distribution<size_t> pick(0, upd.leaf_ids.size() - 1);
+      upd.leaf_ids.erase(upd.leaf_ids.begin() + static_cast<std::ptrdiff_t>(pick(rng)));
+    }
+    for (size_t i = 0; i < open_count; ++i) {
+      upd.leaf_ids.push_back(next_id++);
+    }
+  }
+}
+
+bool same_rect(const cells::Rect& a, const cells::Rect& b) {
+  return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+}
+
+bool same_system(const cells::System& a, const cells::System& b) {
+  if (a.clusters.size() != b.clusters.size() ||
+      a.selection.has_value() != b.selection.has_value()) {
+    return false;
+  }
+  if (a.selection.has_value() && (a.selection->cluster_index != b.selection->cluster_index ||
+                                  a.selection->cell_index != b.selection->cell_index)) {
+    return false;
+  }
+  for (size_t ci = 0; ci < a.clusters.size(); ++ci) {
+    const auto& ca = a.clusters[ci].cluster;
+    const auto& cb = b.clusters[ci].cluster;
+    if (ca.cells.size() != cb.cells.size() || ca.zen_cell_index != cb.zen_cell_index ||
+        ca.has_fullscreen_cell != cb.has_fullscreen_cell) {
+      return false;
+    }
+    for (size_t i = 0; i < ca.cells.size(); ++i) {
+      const auto& x = ca.cells[i];
+      const auto& y = cb.cells[i];
+      if (x.split_dir != y.split_dir || x.split_ratio != y.split_ratio || x.parent != y.parent ||
+          x.first_child != y.first_child || x.second_child != y.second_child ||
+          x.leaf_id != y.leaf_id || x.is_dead != y.is_dead || !same_rect(x.rect, y.rect)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool same_result(const cells::UpdateResult& a, const cells::UpdateResult& b) {
+  if (a.deleted_leaf_ids != b.deleted_leaf_ids || a.added_leaf_ids != b.added_leaf_ids ||
+      a.errors.size() != b.errors.size() || a.tile_updates.size() != b.tile_updates.size() ||
+      a.selection_updated != b.selection_updated) {
+    return false;
+  }
+  for (size_t i = 0; i < a.errors.size(); ++i) {
+    if (a.errors[i].type != b.errors[i].type ||
+        a.errors[i].cluster_index != b.errors[i].cluster_index ||
+        a.errors[i].leaf_id != b.errors[i].leaf_id) {
+      return false;
+    }
+  }
+  for (size_t i = 0; i < a.tile_updates.size(); ++i) {
+    const auto& x = a.tile_updates[i];
+    const auto& y = b.tile_updates[i];
+    if (x.leaf_id != y.leaf_id || x.x != y.x || x.y != y.y || x.width != y.width ||
+        x.height != y.height) {
+      return false;
+    }
+  }
+  return a.new_window_cursor_pos.has_value() == b.new_window_cursor_pos.has_value();
+}
+
+cells::UpdateResult run_update(cells::System& system,
+                               const std::vector<cells::ClusterCellUpdateInfo>& state,
+                               ThreadPool* pool) {
+  return cells::update(system, state, std::nullopt, {100.0f, 100.0f}, 0.85f, 0, 10.0f, 10.0f,
+                       pool);
+}
+
+} // namespace
+
+TEST_SUITE("thread pool - parallel_for") {
+  TEST_CASE("every item runs exactly once") {
+    ThreadPool pool(3);
+    CHECK(pool.worker_count() == 3);
+    for (size_t count : {0u, 1u, 2u, 7u, 1000u}) {
+      std::vector<std::atomic<int>> hits(count);
+      pool.parallel_for(count, [&](size_t i) { hits[i].fetch_add(1); });
+      for (size_t i = 0; i < count; ++i) {
+        CHECK(hits[i].load() == 1);
+      }
+    }
+  }
+
+  TEST_CASE("pool without workers runs inline in order") {
+    ThreadPool pool(0);
+    std::vector<size_t> order;
+    pool.parallel_for(5, [&](size_t i) { order.push_back(i); });
+    CHECK(order == std::vector<size_t>{0, 1, 2, 3, 4});
+  }
+
+  TEST_CASE("back to back jobs do not leak items between runs") {
+    ThreadPool pool(4);
+    for (int run = 0; run < 200; ++run) {
+      std::atomic<int> sum{0};
+      pool.parallel_for(16, [&](size_t i) { sum.fetch_add(static_cast<int>(i)); });
+      REQUIRE(sum.load() == 120);
+    }
+  }
+
+  TEST_CASE("workers_for never exceeds the requested parallelism") {
+    CHECK(ThreadPool::workers_for(0) == 0);
+    CHECK(ThreadPool::workers_for(1) == 0);
+    CHECK(ThreadPool::workers_for(6) <= 5);
+  }
+}
+
+TEST_SUITE("thread pool - parallel update") {
+  TEST_CASE("parallel per-cluster update matches the serial path") {
+    ThreadPool pool(3);
+    std::mt19937 rng(1234);
+
+    size_t next_id_serial = 1;
+    size_t next_id_parallel = 1;
+    auto serial = make_desk(6, 8, next_id_serial);
+    auto parallel = make_desk(6, 8, next_id_parallel);
+    REQUIRE(same_system(serial, parallel));
+
+    size_t next_id = next_id_serial;
+    for (int round = 0; round < 50; ++round) {
+      auto state = current_state(serial);
+      churn(state, rng, round % 5, (round * 7) % 4, next_id);
+      // Occasionally an unknown cluster index, which must be reported in input order
+      if (round % 10 == 3) {
+        state.push_back({99, {next_id++}, false});
+      }
+
+      auto serial_result = run_update(serial, state, nullptr);
+      auto parallel_result = run_update(parallel, state, &pool);
+
+      REQUIRE(same_result(serial_result, parallel_result));
+      REQUIRE(same_system(serial, parallel));
+    }
+  }
+
+  TEST_CASE("selection follows a deleted cell the same way in both paths") {
+    ThreadPool pool(2);
+    size_t id_a = 1;
+    size_t id_b = 1;
+    auto serial = make_desk(3, 4, id_a);
+    auto parallel = make_desk(3, 4, id_b);
+    serial.selection = cells::CellIndicatorByIndex{1, 0};
+    parallel.selection = serial.selection;
+    // Point the selection at a leaf in cluster 1
+    for (int i = 0; i < static_cast<int>(serial.clusters[1].cluster.cells.size()); ++i) {
+      if (cells::is_leaf(serial.clusters[1].cluster, i)) {
+        serial.selection->cell_index = i;
+        parallel.selection->cell_index = i;
+        break;
+      }
+    }
+
+    auto state = current_state(serial);
+    const auto& selected_cell =
+        serial.clusters[1].cluster.cells[static_cast<size_t>(serial.selection->cell_index)];
+    size_t selected_leaf = *selected_cell.leaf_id;
+    std::erase(state[1].leaf_ids, selected_leaf);
+    state[0].leaf_ids.push_back(1000);
+    state[2].leaf_ids.push_back(1001);
+
+    auto serial_result = run_update(serial, state, nullptr);
+    auto parallel_result = run_update(parallel, state, &pool);
+
+    CHECK(same_result(serial_result, parallel_result));
+    CHECK(same_system(serial, parallel));
+    CHECK(parallel_result.deleted_leaf_ids == std::vector<size_t>{selected_leaf});
+    CHECK(parallel_result.added_leaf_ids == std::vector<size_t>{1000, 1001});
+  }
+
+  TEST_CASE("duplicate cluster entries fall back to serial processing") {
+    ThreadPool pool(2);
+    size_t id_a = 1;
+    size_t id_b = 1;
+    auto serial = make_desk(2, 2, id_a);
+    auto parallel = make_desk(2, 2, id_b);
+
+    auto state = current_state(serial);
+    state.push_back({0, state[0].leaf_ids, false});
+    state.back().leaf_ids.push_back(500);
+
+    auto serial_result = run_update(serial, state, nullptr);
+    auto parallel_result = run_update(parallel, state, &pool);
+    CHECK(same_result(serial_result, parallel_result));
+    CHECK(same_system(serial, parallel));
+  }
+
+  TEST_CASE("benchmark: mass open/close on six monitors" * doctest::skip()) {
+    constexpr int kRounds = 200;
+    ThreadPool pool(ThreadPool::workers_for(6));
+
+    auto measure = [&](ThreadPool* use_pool) {
+      std::mt19937 rng(42);
+      size_t next_id = 1;
+      auto system = make_desk(6, 40, next_id);
+      auto start = std::chrono::steady_clock::now();
+      for (int round = 0; round < kRounds; ++round) {
+        auto state = current_state(system);
+        churn(state, rng, 20, 20, next_id);
+        run_update(system, state, use_pool);
+      }
+      return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+          .count();
+    };
+
+    double serial_ms = measure(nullptr);
+    double parallel_ms = measure(&pool);
+    MESSAGE("update x" << kRounds << " on 6 clusters: serial " << serial_ms << " ms, parallel ("
+                       << pool.worker_count() << " workers + caller) " << parallel_ms
+                       << " ms, speedup " << serial_ms / parallel_ms);
+    CHECK(parallel_ms > 0.0);
+  }
+}
+
+#endif // !DOCTEST_CONFIG_DISABLE
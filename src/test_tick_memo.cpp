@@ -0,0 +1,155 @@
+#ifndef DOCTEST_CONFIG_DISABLE
+
+#include <doctest/doctest.h>
+
+#include <cstdint>
+
+#include "tick_memo.h"
+
+using namespace wintiler;
+
+namespace {
+
+winapi::HWND_T hwnd(uintptr_t value) {
+  return reinterpret_cast<winapi::HWND_T>(value);
+}
+
+winapi::LoopInputState make_state() {
+  winapi::LoopInputState state;
+  state.cursor_pos = winapi::Point{100, 200};
+  state.is_ctrl_pressed = false;
+  state.foreground_window = hwnd(0x1010);
+  state.windows_per_monitor = {{{hwnd(0x1010), false}, {hwnd(0x2020), false}},
+                               {{hwnd(0x3030), false}}};
+  return state;
+}
+
+uint64_t digest(const winapi::LoopInputState& state) {
+  return digest_input_state(state, true);
+}
+
+} // namespace
+
+TEST_SUITE("tick memo - digest") {
+  TEST_CASE("equal inputs give equal digests") {
+    CHECK(digest(make_state()) == digest(make_state()));
+  }
+
+  TEST_CASE("every field a layout pass reads changes the digest") {
+    auto base = digest(make_state());
+
+    auto state = make_state();
+    state.windows_per_monitor[0].push_back({hwnd(0x4040), false});
+    CHECK(digest(state) != base);
+
+    state = make_state();
+    state.windows_per_monitor[0][1].is_fullscreen = true;
+    CHECK(digest(state) != base);
+
+    state = make_state();
+    std::swap(state.windows_per_monitor[0][0], state.windows_per_monitor[0][1]);
+    CHECK(digest(state) != base);
+
+    state = make_state();
+    state.cursor_pos->x += 1;
+    CHECK(digest(state) != base);
+
+    state = make_state();
+    state.cursor_pos.reset();
+    CHECK(digest(state) != base);
+
+    state = make_state();
+    state.foreground_window = hwnd(0x2020);
+    CHECK(digest(state) != base);
+
+    state = make_state();
+    state.is_any_window_being_moved = true;
+    CHECK(digest(state) != base);
+
+    state = make_state();
+    state.drag_info = winapi::DragInfo{hwnd(0x1010), true};
+    CHECK(digest(state) != base);
+  }
+
+  TEST_CASE("a window moving to the next monitor changes the digest") {
+    auto state = make_state();
+    auto base = digest(state);
+    state.windows_per_monitor[1].insert(state.windows_per_monitor[1].begin(),
+                                        state.windows_per_monitor[0].back());
+    state.windows_per_monitor[0].pop_back();
+    CHECK(digest(state) != base);
+  }
+
+  TEST_CASE("foreground is ignored without hover focus") {
+    auto state = make_state();
+    auto base = digest_input_state(state, false);
+    state.foreground_window = hwnd(0x3030);
+    CHECK(digest_input_state(state, false) == base);
+  }
+
+  TEST_CASE("cursor is ignored without hover focus") {
+    auto state = make_state();
+    auto base = digest_input_state(state, false);
+    state.cursor_pos->x += 50;
+    CHECK(digest_input_state(state, false) == base);
+    state.cursor_pos.reset();
+    CHECK(digest_input_state(state, false) == base);
+  }
+
+  TEST_CASE("ctrl state is not a layout input") {
+    auto state = make_state();
+    auto base = digest(state);
+    state.is_ctrl_pressed = true;
+    CHECK(digest(state) == base);
+  }
+}
+
+TEST_SUITE("tick memo - skipping") {
+  TEST_CASE("nothing is skipped before a quiet tick was recorded") {
+    TickMemo memo;
+    CHECK_FALSE(memo.should_skip(1, 0));
+    CHECK_FALSE(memo.should_skip(1, 0));
+    CHECK(memo.ticks() == 2);
+    CHECK(memo.skipped() == 0);
+  }
+
+  TEST_CASE("same digest and generation skip") {
+    TickMemo memo;
+    CHECK_FALSE(memo.should_skip(7, 3));
+    memo.record(7, 3);
+    CHECK(memo.should_skip(7, 3));
+    CHECK(memo.should_skip(7, 3));
+    CHECK(memo.skipped() == 2);
+    CHECK(memo.ticks() == 3);
+  }
+
+  TEST_CASE("a changed digest or generation runs the tick") {
+    TickMemo memo;
+    memo.record(7, 3);
+    CHECK_FALSE(memo.should_skip(8, 3));
+    memo.record(8, 3);
+    CHECK_FALSE(memo.should_skip(8, 4));
+    CHECK(memo.skipped() == 0);
+  }
+
+  TEST_CASE("invalidate forces the next tick") {
+    TickMemo memo;
+    memo.record(7, 3);
+    memo.invalidate();
+    CHECK_FALSE(memo.should_skip(7, 3));
+  }
+
+  TEST_CASE("a tick runs after the maximum number of consecutive skips") {
+    TickMemo memo;
+    memo.record(7, 3);
+    for (uint32_t i = 0; i < TickMemo::kMaxConsecutiveSkips; ++i) {
+      CHECK(memo.should_skip(7, 3));
+    }
+    CHECK_FALSE(memo.should_skip(7, 3));
+    memo.record(7, 3);
+    CHECK(memo.should_skip(7, 3));
+    CHECK(memo.skipped() == TickMemo::kMaxConsecutiveSkips + 1);
+  }
+}
+
+#endif
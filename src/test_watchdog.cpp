@@ -0,0 +1,188 @@
+#ifndef DOCTEST_CONFIG_DISABLE
+
+#include <doctest/doctest.h>
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "watchdog.h"
+
+using namespace wintiler;
+using namespace std::chrono_literals;
+
+namespace {
+
+struct ReportLog {
+  std::mutex mutex;
+  std::vector<StallReport> reports;
+
+  Watchdog::StallHandler handler() {
+    return [this](const StallReport& report) {
+      std::lock_guard lock(mutex);
+      reports.push_back(report);
+    };
+  }
+
+  std::vector<StallReport> copy() {
+    std::lock_guard lock(mutex);
+    return reports;
+  }
+};
+
+} // namespace
+
+TEST_SUITE("watchdog - check") {
+  TEST_CASE("idle marker never stalls") {
+    ReportLog log;
+    PhaseMarker marker;
+    Watchdog dog(100ms, 10ms, log.handler());
+    dog.watch("loop", marker);
+    CHECK(dog.check(Watchdog::Clock::now() + 10s) == 0);
+    CHECK(log.copy().empty());
+  }
+
+  TEST_CASE("phase within budget is not reported") {
+    ReportLog log;
+    PhaseMarker marker;
+    Watchdog dog(100ms, 10ms, log.handler());
+    dog.watch("loop", marker);
+    marker.enter(LoopPhase::Update);
+    auto started = marker.snapshot().started;
+    CHECK(dog.check(started + 50ms) == 0);
+    CHECK(log.copy().empty());
+  }
+
+  TEST_CASE("stall is reported once with phase and hwnd, then recovery") {
+    ReportLog log;
+    PhaseMarker marker;
+    Watchdog dog(100ms, 10ms, log.handler());
+    dog.watch("loop", marker);
+
+    marker.enter(LoopPhase::PlaceWindows);
+    marker.set_hwnd(0x1234);
+    auto started = marker.snapshot().started;
+    CHECK(dog.check(started + 150ms) == 1);
+    CHECK(dog.check(started + 300ms) == 0);
+    CHECK(dog.check(started + 900ms) == 0);
+
+    auto reports = log.copy();
+    REQUIRE(reports.size() == 1);
+    CHECK(reports[0].thread_name == "loop");
+    CHECK(reports[0].phase == LoopPhase::PlaceWindows);
+    CHECK(reports[0].hwnd == 0x1234);
+    CHECK(reports[0].elapsed == 150ms);
+    CHECK_FALSE(reports[0].recovered);
+
+    marker.leave();
+    CHECK(dog.check(started + 1000ms) == 0);
+    reports = log.copy();
+    REQUIRE(reports.size() == 2);
+    CHECK(reports[1].recovered);
+    CHECK(reports[1].phase == LoopPhase::PlaceWindows);
+    CHECK(reports[1].elapsed == 1000ms);
+  }
+
+  TEST_CASE("a new phase instance past the budget is a new stall") {
+    ReportLog log;
+    PhaseMarker marker;
+    Watchdog dog(100ms, 10ms, log.handler());
+    dog.watch("loop", marker);
+
+    marker.enter(LoopPhase::Render);
+    auto first = marker.snapshot().started;
+    CHECK(dog.check(first + 200ms) == 1);
+
+    // Moving straight into another phase both recovers the first and may stall again
+    marker.enter(LoopPhase::Config);
+    auto second = marker.snapshot().started;
+    CHECK(dog.check(second + 200ms) == 1);
+
+    auto reports = log.copy();
+    REQUIRE(reports.size() == 3);
+    CHECK(reports[0].phase == LoopPhase::Render);
+    CHECK(reports[1].recovered);
+    CHECK(reports[1].phase == LoopPhase::Render);
+    CHECK(reports[2].phase == LoopPhase::Config);
+    CHECK_FALSE(reports[2].recovered);
+  }
+
+  TEST_CASE("each marker is attributed to its own thread name") {
+    ReportLog log;
+    PhaseMarker loop_marker;
+    PhaseMarker gather_marker;
+    Watchdog dog(100ms, 10ms, log.handler());
+    dog.watch("loop", loop_marker);
+    dog.watch("gather", gather_marker);
+
+    gather_marker.enter(LoopPhase::Gather, 0x42);
+    loop_marker.enter(LoopPhase::Hotkeys);
+    auto started = gather_marker.snapshot().started;
+    loop_marker.leave();
+    CHECK(dog.check(started + 500ms) == 1);
+
+    auto reports = log.copy();
+    REQUIRE(reports.size() == 1);
+    CHECK(reports[0].thread_name == "gather");
+    CHECK(reports[0].hwnd == 0x42);
+  }
+
+  TEST_CASE("phase scope returns the marker to idle") {
+    PhaseMarker marker;
+    {
+      PhaseScope scope(marker, LoopPhase::Ipc, 7);
+      CHECK(marker.snapshot().phase == LoopPhase::Ipc);
+      CHECK(marker.snapshot().hwnd == 7);
+    }
+    CHECK(marker.snapshot().phase == LoopPhase::Idle);
+    CHECK(marker.snapshot().hwnd == 0);
+  }
+}
+
+TEST_SUITE("watchdog - thread") {
+  TEST_CASE("artificially stalled phase is detected by the watchdog thread") {
+    ReportLog log;
+    PhaseMarker marker;
+    Watchdog dog(50ms, 5ms, log.handler());
+    dog.watch("loop", marker);
+    dog.start();
+
+    // A few quick phases, then one that hangs well past the budget
+    for (int i = 0; i < 5; ++i) {
+      PhaseScope scope(marker, LoopPhase::Update);
+    }
+    {
+      PhaseScope scope(marker, LoopPhase::PlaceWindows, 0xBEEF);
+      std::this_thread::sleep_for(250ms);
+    }
+    // Give the watchdog a few intervals to notice the recovery
+    std::this_thread::sleep_for(50ms);
+    dog.stop();
+
+    auto reports = log.copy();
+    REQUIRE(reports.size() == 2);
+    CHECK(reports[0].phase == LoopPhase::PlaceWindows);
+    CHECK(reports[0].hwnd == 0xBEEF);
+    CHECK(reports[0].elapsed >= 50ms);
+    CHECK_FALSE(reports[0].recovered);
+    CHECK(reports[1].recovered);
+    CHECK(reports[1].elapsed >= 250ms);
+  }
+
+  TEST_CASE("stop without a stall reports nothing") {
+    ReportLog log;
+    PhaseMarker marker;
+    Watchdog dog(1s, 5ms, log.handler());
+    dog.watch("loop", marker);
+    dog.start();
+    for (int i = 0; i < 100; ++i) {
+      PhaseScope scope(marker, LoopPhase::Render);
+    }
+    std::this_thread::sleep_for(20ms);
+    dog.stop();
+    CHECK(log.copy().empty());
+  }
+}
+
+#endif // !DOCTEST_CONFIG_DISABLE
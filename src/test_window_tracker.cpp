@@ -0,0 +1,170 @@
+#ifndef DOCTEST_CONFIG_DISABLE
+
+#include <doctest/doctest.h>
+
+#include <string>
+#include <vector>
+
+#include "window_tracker.h"
+
+using namespace wintiler;
+
+namespace {
+
+TrackedWindow make_window(size_t hwnd, const std::string& title = "Editor") {
+  TrackedWindow window;
+  window.hwnd = hwnd;
+  window.pid = 42;
+  window.process = "editor.exe";
+  window.class_name = "EditorClass";
+  window.title = title;
+  window.x = 10;
+  window.y = 20;
+  window.width = 800;
+  window.height = 600;
+  window.style = 0x14CF0000;
+  return window;
+}
+
+std::vector<WindowChangeType> types(const std::vector<WindowChange>& changes) {
+  std::vector<WindowChangeType> out;
+  for (const auto& change : changes) {
+    out.push_back(change.type);
+  }
+  return out;
+}
+
+} // namespace
+
+TEST_SUITE("window tracker - diff") {
+  TEST_CASE("identical passes produce no changes") {
+    std::vector<TrackedWindow> windows{make_window(0x10), make_window(0x20)};
+    CHECK(diff_windows(windows, windows).empty());
+  }
+
+  TEST_CASE("order of enumeration alone is not a change") {
+    std::vector<TrackedWindow> before{make_window(0x10), make_window(0x20)};
+    std::vector<TrackedWindow> after{make_window(0x20), make_window(0x10)};
+    CHECK(diff_windows(before, after).empty());
+  }
+
+  TEST_CASE("appeared and disappeared windows") {
+    std::vector<TrackedWindow> before{make_window(0x10), make_window(0x20)};
+    std::vector<TrackedWindow> after{make_window(0x20), make_window(0x30)};
+    auto changes = diff_windows(before, after);
+    REQUIRE(changes.size() == 2);
+    CHECK(changes[0].type == WindowChangeType::Disappeared);
+    CHECK(changes[0].window.hwnd == 0x10);
+    CHECK(changes[1].type == WindowChangeType::Appeared);
+    CHECK(changes[1].window.hwnd == 0x30);
+  }
+
+  TEST_CASE("moved covers position, size and monitor") {
+    auto before = make_window(0x10);
+    for (int field = 0; field < 3; ++field) {
+      auto after = before;
+      if (field == 0) {
+        after.x += 5;
+      } else if (field == 1) {
+        after.height -= 5;
+      } else {
+        after.monitor = 1;
+      }
+      auto changes = diff_windows({before}, {after});
+      REQUIRE(changes.size() == 1);
+      CHECK(changes[0].type == WindowChangeType::Moved);
+      REQUIRE(changes[0].previous.has_value());
+      CHECK(changes[0].previous->x == before.x);
+    }
+  }
+
+  TEST_CASE("retitled and style changes are separate events") {
+    auto before = make_window(0x10);
+    auto after = make_window(0x10, "Editor - file.txt");
+    after.cloaked = true;
+    after.x = 0;
+    auto changes = diff_windows({before}, {after});
+    CHECK(types(changes) == std::vector<WindowChangeType>{WindowChangeType::Moved,
+                                                          WindowChangeType::Retitled,
+                                                          WindowChangeType::StyleChanged});
+  }
+
+  TEST_CASE("extended style and hung state count as style changes") {
+    auto before = make_window(0x10);
+    auto after = before;
+    after.ex_style = 0x100;
+    CHECK(types(diff_windows({before}, {after})) ==
+          std::vector<WindowChangeType>{WindowChangeType::StyleChanged});
+    after = before;
+    after.hung = true;
+    CHECK(types(diff_windows({before}, {after})) ==
+          std::vector<WindowChangeType>{WindowChangeType::StyleChanged});
+  }
+}
+
+TEST_SUITE("window tracker - tracker") {
+  TEST_CASE("first pass reports every window as appeared") {
+    WindowTracker tracker;
+    auto changes = tracker.update({make_window(0x10), make_window(0x20)});
+    CHECK(types(changes) == std::vector<WindowChangeType>{WindowChangeType::Appeared,
+                                                          WindowChangeType::Appeared});
+    CHECK(tracker.size() == 2);
+  }
+
+  TEST_CASE("later passes report only changes and keep the last state") {
+    WindowTracker tracker;
+    (void)tracker.update({make_window(0x10), make_window(0x20)});
+    CHECK(tracker.update({make_window(0x10), make_window(0x20)}).empty());
+
+    auto changes = tracker.update({make_window(0x20, "Renamed")});
+    CHECK(types(changes) == std::vector<WindowChangeType>{WindowChangeType::Disappeared,
+                                                          WindowChangeType::Retitled});
+    CHECK(tracker.find(0x10) == nullptr);
+    REQUIRE(tracker.find(0x20) != nullptr);
+    CHECK(tracker.find(0x20)->title == "Renamed");
+  }
+}
+
+TEST_SUITE("window tracker - json") {
+  TEST_CASE("appeared carries the full window") {
+    auto json = window_change_to_json({WindowChangeType::Appeared, make_window(0xabc), {}}, 1234);
+    CHECK(json["t_ms"] == 1234);
+    CHECK(json["event"] == "appeared");
+    CHECK(json["hwnd"] == "0xabc");
+    CHECK(json["process"] == "editor.exe");
+    CHECK(json["class"] == "EditorClass");
+    CHECK(json["width"] == 800);
+    CHECK(json["style"] == "0x14cf0000");
+    CHECK(json["cloaked"] == false);
+  }
+
+  TEST_CASE("changes carry the previous state under from") {
+    auto before = make_window(0x10);
+    auto after = before;
+    after.x = 50;
+    auto json = window_change_to_json({WindowChangeType::Moved, after, before}, 1);
+    CHECK(json["x"] == 50);
+    CHECK(json["from"]["x"] == 10);
+
+    after = make_window(0x10, "New");
+    json = window_change_to_json({WindowChangeType::Retitled, after, before}, 1);
+    CHECK(json["title"] == "New");
+    CHECK(json["from"] == "Editor");
+  }
+
+  TEST_CASE("one record per line") {
+    auto json = window_change_to_json(
+        {WindowChangeType::Appeared, make_window(0x10, "Line\nbreak"), {}}, 1);
+    CHECK(json.dump().find('\n') == std::string::npos);
+  }
+
+  TEST_CASE("titles that are not UTF-8 are replaced rather than throwing") {
+    // "Caf\xe9" is how GetWindowTextA returns "Café" under Windows-1252
+    WindowChange change{WindowChangeType::Appeared, make_window(0x10, "Caf\xe9"), {}};
+    auto line = window_change_to_line(change, 1);
+    CHECK(line.find("\"title\":\"Caf\xef\xbf\xbd\"") != std::string::npos);
+    CHECK(line.find('\n') == std::string::npos);
+  }
+}
+
+#endif
@@ -0,0 +1,103 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+namespace wintiler {
+
+ThreadPool::ThreadPool(size_t worker_count) {
+  workers_.reserve(worker_count);
+  for (size_t i = 0; i < worker_count; ++i) {
+    workers_.emplace_back([this] { worker_loop(); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard lock(mutex_);
+    stopping_ = true;
+  }
+  work_ready_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+size_t ThreadPool::worker_count() const {
+  return workers_.size();
+}
+
+size_t ThreadPool::workers_for(size_t max_parallelism) {
+  size_t hardware = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  return std::min(max_parallelism, hardware) - (max_parallelism > 0 ? 1 : 0);
+}
+
+void ThreadPool::parallel_for(size_t count, const std::function<void(size_t)>& fn) {
+  if (count == 0) {
+    return;
+  }
+  if (workers_.empty() || count == 1) {
+    for (size_t i = 0; i < count; ++i) {
+      fn(i);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard lock(mutex_);
+    job_ = &fn;
+    job_count_ = count;
+    next_item_.store(0, std::memory_order_relaxed);
+    ++generation_;
+  }
+  work_ready_.notify_all();
+
+  run_items(fn, count);
+
+  // Workers that picked up this job must finish before fn goes out of scope
+  std::unique_lock lock(mutex_);
+  work_done_.wait(lock, [this] { return active_workers_ == 0; });
+  job_ = nullptr;
+  job_count_ = 0;
+}
+
+void ThreadPool::run_items(const std::function<void(size_t)>& fn, size_t count) {
+  for (;;) {
+    size_t item = next_item_.fetch_add(1, std::memory_order_relaxed);
+    if (item >= count) {
+      return;
+    }
+    fn(item);
+  }
+}
+
+void ThreadPool::worker_loop() {
+  uint64_t seen_generation = 0;
+  for (;;) {
+    const std::function<void(size_t)>* job = nullptr;
+    size_t count = 0;
+    {
+      std::unique_lock lock(mutex_);
+      work_ready_.wait(lock, [&] { return stopping_ || generation_ != seen_generation; });
+      if (stopping_) {
+        return;
+      }
+      seen_generation = generation_;
+      if (job_ == nullptr) {
+        continue; // Woke up after the job already completed
+      }
+      job = job_;
+      count = job_count_;
+      ++active_workers_;
+    }
+
+    run_items(*job, count);
+
+    {
+      std::lock_guard lock(mutex_);
+      --active_workers_;
+    }
+    work_done_.notify_one();
+  }
+}
+
+} // namespace wintiler
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace wintiler {
+
+// Small fixed-size pool for fork/join loops. The calling thread takes part in the work, so a
+// pool with zero workers simply runs everything inline.
+class ThreadPool {
+public:
+  explicit ThreadPool(size_t worker_count);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  [[nodiscard]] size_t worker_count() const;
+
+  // Run fn(i) for every i in [0, count) and return once all calls have finished.
+  // Items are handed out dynamically; fn must not call parallel_for on the same pool.
+  void parallel_for(size_t count, const std::function<void(size_t)>& fn);
+
+  // Worker count for a pool serving up to max_parallelism concurrent items
+  // (the caller counts as one), capped by the hardware
+  static size_t workers_for(size_t max_parallelism);
+
+private:
+  void worker_loop();
+  void run_items(const std::function<void(size_t)>& fn, size_t count);
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable work_ready_;
+  std::condition_variable work_done_;
+  const std::function<void(size_t)>* job_ = nullptr;
+  size_t job_count_ = 0;
+  std::atomic<size_t> next_item_{0};
+  size_t active_workers_ = 0;
+  uint64_t generation_ = 0;
+  bool stopping_ = false;
+};
+
+} // namespace wintiler
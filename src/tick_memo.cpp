@@ -0,0 +1,82 @@
+#include "tick_memo.h"
+
+namespace wintiler {
+
+namespace {
+
+// splitmix64 step; order dependent, unlike the per-cluster leaf fingerprint
+uint64_t combine(uint64_t hash, uint64_t value) {
+  uint64_t x = hash ^ (value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2));
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+uint64_t handle_bits(const void* handle) {
+  return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(handle));
+}
+
+} // namespace
+
+uint64_t digest_input_state(const winapi::LoopInputState& state, bool hover_focus) {
+  uint64_t hash = combine(0, state.windows_per_monitor.size());
+  for (const auto& windows : state.windows_per_monitor) {
+    // The count separates monitors: moving a window to the next monitor changes the digest
+    hash = combine(hash, windows.size());
+    for (const auto& win : windows) {
+      hash = combine(hash, handle_bits(win.handle) << 1 | (win.is_fullscreen ? 1 : 0));
+    }
+  }
+
+  hash = combine(hash, state.is_any_window_being_moved ? 1 : 0);
+  if (state.drag_info.has_value()) {
+    hash = combine(hash, handle_bits(state.drag_info->hwnd) << 1 |
+                             (state.drag_info->move_ended ? 1 : 0));
+  } else {
+    hash = combine(hash, 0);
+  }
+
+  // Without hover focus a cursor move alone cannot change the layout, so it must not
+  // defeat the memo
+  if (hover_focus) {
+    if (state.cursor_pos.has_value()) {
+      hash = combine(hash, 1);
+      hash = combine(hash, static_cast<uint64_t>(state.cursor_pos->x));
+      hash = combine(hash, static_cast<uint64_t>(state.cursor_pos->y));
+    } else {
+      hash = combine(hash, 0);
+    }
+    hash = combine(hash, handle_bits(state.foreground_window));
+  }
+  return hash;
+}
+
+bool TickMemo::should_skip(uint64_t digest, uint64_t generation) {
+  ++ticks_;
+  if (!last_.has_value() || last_->digest != digest || last_->generation != generation ||
+      consecutive_skips_ >= kMaxConsecutiveSkips) {
+    consecutive_skips_ = 0;
+    return false;
+  }
+  ++consecutive_skips_;
+  ++skipped_;
+  return true;
+}
+
+void TickMemo::record(uint64_t digest, uint64_t generation) {
+  last_ = Key{digest, generation};
+}
+
+void TickMemo::invalidate() {
+  last_.reset();
+}
+
+uint64_t TickMemo::ticks() const {
+  return ticks_;
+}
+
+uint64_t TickMemo::skipped() const {
+  return skipped_;
+}
+
+} // namespace wintiler
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+#include "winapi.h"
+
+namespace wintiler {
+
+// Digest of the LoopInputState fields a layout pass reads: windows per monitor with their
+// fullscreen flags, drag state and, with hover focus, the cursor and foreground window (the
+// pass only looks at them to move the selection under the pointer). Equal digests mean the
+// pass would see the same inputs, barring a 64-bit collision.
+uint64_t digest_input_state(const winapi::LoopInputState& state, bool hover_focus);
+
+// Skips a layout tick (update, window placement, overlay redraw) whose inputs and layout
+// generation match the last quiet tick. The loop bumps the generation whenever something
+// other than the layout pass itself changes the cell tree or its settings (hotkeys, IPC,
+// drops, live resize, config and monitor changes).
+class TickMemo {
+public:
+  // After this many consecutive skips a tick runs anyway, so a window moved by something the
+  // loop cannot see (e.g. Win+Arrow) is put back into its cell within a bounded time
+  static constexpr uint32_t kMaxConsecutiveSkips = 16;
+
+  // Count one tick; true if it can be skipped
+  bool should_skip(uint64_t digest, uint64_t generation);
+
+  // A tick ran with these inputs and left nothing pending (no windows added or removed, no
+  // selection or focus change, no held hover change), so running it again would be a no-op
+  void record(uint64_t digest, uint64_t generation);
+
+  // The last tick changed something; the next one must run
+  void invalidate();
+
+  [[nodiscard]] uint64_t ticks() const;
+  [[nodiscard]] uint64_t skipped() const;
+
+private:
+  struct Key {
+    uint64_t digest;
+    uint64_t generation;
+  };
+
+  std::optional<Key> last_;
+  uint32_t consecutive_skips_ = 0;
+  uint64_t ticks_ = 0;
+  uint64_t skipped_ = 0;
+};
+
+} // namespace wintiler
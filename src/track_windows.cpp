@@ -5,8 +5,12 @@
 #include <Windows.h>
 
 #include <chrono>
-#include <thread>
+#include <fstream>
+#include <iostream>
+#include <vector>
 
+#include "enum_profile.h"
+#include "window_tracker.h"
 #include "winapi.h"
 
 namespace wintiler {
@@ -50,63 +54,222 @@ void unregister_exit_hotkey() {
   winapi::unregister_hotkey(EXIT_HOTKEY_ID);
 }
 
-} // namespace
+// Event mode: events arriving in a burst (a drag sends hundreds) fold into one pass
+constexpr auto kEventSettle = std::chrono::milliseconds(50);
 
-void run_track_windows_mode(GlobalOptionsProvider& optionsProvider) {
-  const auto& options = optionsProvider.options;
+// Event mode still runs a pass this often; no WinEvent reports a window becoming hung
+constexpr auto kEventFallback = std::chrono::milliseconds(5000);
 
-  // Register exit hotkey
-  bool hotkey_registered = register_exit_hotkey(options.keyboardOptions);
+// Set by window_event_proc. Out-of-context hooks are called on this thread while it retrieves
+// messages, so no synchronization is needed.
+bool g_window_event = false;
+
+void CALLBACK window_event_proc(HWINEVENTHOOK, DWORD, HWND hwnd, LONG id_object, LONG id_child,
+                                DWORD, DWORD) {
+  if (hwnd != nullptr && id_object == OBJID_WINDOW && id_child == CHILDID_SELF) {
+    g_window_event = true;
+  }
+}
+
+// Window created/destroyed/shown/hidden, state/location/name changed, cloaked/uncloaked
+std::vector<HWINEVENTHOOK> install_window_event_hooks() {
+  std::vector<HWINEVENTHOOK> hooks;
+  for (auto [first, last] : {std::pair{EVENT_OBJECT_CREATE, EVENT_OBJECT_HIDE},
+                             std::pair{EVENT_OBJECT_STATECHANGE, EVENT_OBJECT_NAMECHANGE},
+                             std::pair{EVENT_OBJECT_CLOAKED, EVENT_OBJECT_UNCLOAKED}}) {
+    auto hook = SetWinEventHook(first, last, nullptr, window_event_proc, 0, 0,
+                                WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+    if (hook == nullptr) {
+      spdlog::warn("Failed to install window event hook 0x{:X}-0x{:X}, error={}", first, last,
+                   GetLastError());
+      continue;
+    }
+    hooks.push_back(hook);
+  }
+  return hooks;
+}
 
-  spdlog::info("Track windows mode started. Press exit hotkey to quit.");
+// Dispatch pending messages (which runs the WinEvent callbacks). Returns false once the exit
+// hotkey was pressed.
+bool pump_track_messages() {
+  MSG msg;
+  while (PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE)) {
+    if (msg.message == WM_HOTKEY && static_cast<int>(msg.wParam) == EXIT_HOTKEY_ID) {
+      spdlog::info("Exit hotkey pressed, shutting down...");
+      return false;
+    }
+    TranslateMessage(&msg);
+    DispatchMessageW(&msg);
+  }
+  return true;
+}
 
-  while (true) {
-    // Check for exit hotkey
-    if (hotkey_registered) {
-      if (auto hotkey_id = winapi::check_keyboard_action()) {
-        if (*hotkey_id == EXIT_HOTKEY_ID) {
-          spdlog::info("Exit hotkey pressed, shutting down...");
-          break;
+// Wait until deadline, or (with until_event) until a window event arrives, while serving
+// messages. Returns false once the exit hotkey was pressed.
+bool wait_for_next_pass(std::chrono::steady_clock::time_point deadline, bool until_event) {
+  for (;;) {
+    if (!pump_track_messages()) {
+      return false;
+    }
+    if (until_event && g_window_event) {
+      return true;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (now >= deadline) {
+      return true;
+    }
+    auto ms = std::chrono::ceil<std::chrono::milliseconds>(deadline - now).count();
+    winapi::wait_for_messages_or_timeout(static_cast<unsigned long>(ms));
+  }
+}
+
+// Sample every managed window from one enumeration. Process name, pid and class cannot change
+// for a window, so they are only looked up for windows the tracker has not seen yet.
+std::vector<TrackedWindow> sample_windows(const IgnoreOptions& ignore_options,
+                                          const WindowTracker& tracker) {
+  auto state = winapi::gather_loop_input_state(ignore_options);
+  std::vector<TrackedWindow> windows;
+  for (size_t monitor = 0; monitor < state.windows_per_monitor.size(); ++monitor) {
+    for (const auto& managed : state.windows_per_monitor[monitor]) {
+      HWND hwnd = (HWND)managed.handle;
+      TrackedWindow window;
+      window.hwnd = reinterpret_cast<size_t>(managed.handle);
+      window.monitor = monitor;
+      if (const auto* known = tracker.find(window.hwnd)) {
+        window.pid = known->pid;
+        window.process = known->process;
+        window.class_name = known->class_name;
+        char title[256];
+        if (GetWindowTextA(hwnd, title, sizeof(title)) > 0) {
+          window.title = title;
         }
+      } else {
+        auto info = winapi::get_window_info(managed.handle);
+        window.pid = static_cast<uint32_t>(info.pid.value_or(0));
+        window.process = info.processName;
+        window.class_name = info.className;
+        window.title = info.title;
       }
+
+      RECT rect{};
+      GetWindowRect(hwnd, &rect);
+      window.x = rect.left;
+      window.y = rect.top;
+      window.width = rect.right - rect.left;
+      window.height = rect.bottom - rect.top;
+
+      window.style = static_cast<uint32_t>(GetWindowLong(hwnd, GWL_STYLE));
+      window.ex_style = static_cast<uint32_t>(GetWindowLong(hwnd, GWL_EXSTYLE));
+      window.hung = IsHungAppWindow(hwnd) != 0;
+      BOOL cloaked = FALSE;
+      DwmGetWindowAttribute(hwnd, DWMWA_CLOAKED, &cloaked, sizeof(cloaked));
+      window.cloaked = cloaked != FALSE;
+      windows.push_back(std::move(window));
     }
+  }
+  return windows;
+}
+
+// Profile mode rewrites the report this often, so it survives the process being killed
+constexpr uint64_t kProfileReportPasses = 60;
+
+// Time every query of one enumeration pass into the profiler
+void profile_pass(const IgnoreOptions& ignore_options, EnumProfiler& profiler) {
+  auto start = std::chrono::steady_clock::now();
+  auto samples = winapi::profile_window_enumeration(ignore_options);
+  auto pass_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  profiler.add_pass(samples, pass_ns);
+  spdlog::debug("Enumeration pass {}: {} windows in {:.2f}ms", profiler.passes(), samples.size(),
+                static_cast<double>(pass_ns) / 1e6);
+}
 
-    // Get monitors and windows
-    auto monitors = winapi::get_monitors();
-    for (size_t i = 0; i < monitors.size(); ++i) {
-      const auto& monitor = monitors[i];
-      auto hwnds = winapi::get_hwnds_for_monitor(i, options.ignoreOptions);
-      spdlog::info("--- Monitor {} ({} windows) ---", i, hwnds.size());
+int64_t unix_time_ms() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+} // namespace
+
+void run_track_windows_mode(GlobalOptionsProvider& optionsProvider,
+                            const TrackWindowsCommand& command) {
+  const auto& options = optionsProvider.options;
 
-      for (auto hwnd : hwnds) {
-        auto info = winapi::get_window_info(hwnd);
+  // Changes go to stdout or the given file as JSON Lines; in profile mode the report does
+  std::ofstream file;
+  std::ostream* out = &std::cout;
+  if (command.filepath) {
+    file.open(*command.filepath, std::ios::trunc);
+    if (!file) {
+      spdlog::error("Failed to open {} for writing", *command.filepath);
+      return;
+    }
+    out = &file;
+  }
 
-        // Get window rect for position and size
-        RECT rect;
-        GetWindowRect((HWND)hwnd, &rect);
-        int width = rect.right - rect.left;
-        int height = rect.bottom - rect.top;
+  // Register exit hotkey
+  bool hotkey_registered = register_exit_hotkey(options.keyboardOptions);
 
-        // Get extended window styles
-        LONG exStyle = GetWindowLong((HWND)hwnd, GWL_EXSTYLE);
+  std::vector<HWINEVENTHOOK> hooks;
+  if (command.events) {
+    hooks = install_window_event_hooks();
+  }
+  bool event_driven = !hooks.empty();
+  auto interval = std::chrono::milliseconds(
+      command.interval_ms.value_or(TrackWindowsCommand::kDefaultIntervalMs));
 
-        // Check if window is hung
-        bool isHung = IsHungAppWindow((HWND)hwnd) != 0;
+  spdlog::info("Track windows mode started ({}{}). Press exit hotkey to quit.",
+               event_driven ? "on window events"
+                            : fmt::format("every {}ms", interval.count()),
+               command.profile ? ", profiling enumeration" : "");
 
-        // Check if window is cloaked
-        BOOL cloaked = FALSE;
-        DwmGetWindowAttribute((HWND)hwnd, DWMWA_CLOAKED, &cloaked, sizeof(cloaked));
+  EnumProfiler profiler;
+  auto write_profile_report = [&]() {
+    auto report = format_enum_profile_report(profiler.report(options.ignoreOptions));
+    if (command.filepath) {
+      file.close();
+      file.open(*command.filepath, std::ios::trunc);
+    }
+    *out << report;
+    out->flush();
+  };
 
-        spdlog::info("  HWND: {}, PID: {}, Process: {}, Class: {}, Pos: ({},{}), Size: {}x{}, "
-                     "ExStyle: 0x{:08X}, Hung: {}, Cloaked: {}, Title: \"{}\"",
-                     info.handle, info.pid.value_or(0), info.processName, info.className, rect.left,
-                     rect.top, width, height, exStyle, isHung, cloaked != 0, info.title);
+  WindowTracker tracker;
+  for (;;) {
+    g_window_event = false;
+    if (command.profile) {
+      profile_pass(options.ignoreOptions, profiler);
+      if (profiler.passes() % kProfileReportPasses == 0) {
+        write_profile_report();
       }
+    } else if (auto changes = tracker.update(sample_windows(options.ignoreOptions, tracker));
+               !changes.empty()) {
+      auto t_ms = unix_time_ms();
+      for (const auto& change : changes) {
+        *out << window_change_to_line(change, t_ms) << '\n';
+      }
+      out->flush();
     }
 
-    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    auto now = std::chrono::steady_clock::now();
+    if (event_driven) {
+      if (!wait_for_next_pass(now + kEventFallback, true) ||
+          !wait_for_next_pass(std::chrono::steady_clock::now() + kEventSettle, false)) {
+        break;
+      }
+    } else if (!wait_for_next_pass(now + interval, false)) {
+      break;
+    }
   }
 
+  if (command.profile) {
+    write_profile_report();
+  }
+  for (auto hook : hooks) {
+    UnhookWinEvent(hook);
+  }
   if (hotkey_registered) {
     unregister_exit_hotkey();
   }
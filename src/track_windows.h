@@ -1,9 +1,14 @@
 #pragma once
 
+#include "argument_parser.h"
 #include "options.h"
 
 namespace wintiler {
 
-void run_track_windows_mode(GlobalOptionsProvider& optionsProvider);
+// Stream window changes (appeared, disappeared, moved, retitled, style changed) as JSON Lines,
+// one enumeration per pass, every interval or after window events. With --profile, time every
+// enumeration query instead and report the cost per process and per API.
+void run_track_windows_mode(GlobalOptionsProvider& optionsProvider,
+                            const TrackWindowsCommand& command);
 
 } // namespace wintiler
@@ -0,0 +1,148 @@
+#include "watchdog.h"
+
+#include <utility>
+
+namespace wintiler {
+
+const char* loop_phase_to_string(LoopPhase phase) {
+  switch (phase) {
+  case LoopPhase::Idle:
+    return "Idle";
+  case LoopPhase::Hotkeys:
+    return "Hotkeys";
+  case LoopPhase::Ipc:
+    return "Ipc";
+  case LoopPhase::WindowEvent:
+    return "WindowEvent";
+  case LoopPhase::Gather:
+    return "Gather";
+  case LoopPhase::Update:
+    return "Update";
+  case LoopPhase::PlaceWindows:
+    return "PlaceWindows";
+  case LoopPhase::Foreground:
+    return "Foreground";
+  case LoopPhase::Render:
+    return "Render";
+  case LoopPhase::Config:
+    return "Config";
+  case LoopPhase::Monitors:
+    return "Monitors";
+  }
+  return "Unknown";
+}
+
+// ============================================================================
+// PhaseMarker
+// ============================================================================
+
+void PhaseMarker::enter(LoopPhase phase, size_t hwnd) {
+  hwnd_.store(hwnd, std::memory_order_relaxed);
+  started_.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+  heartbeat_.fetch_add(1, std::memory_order_relaxed);
+  phase_.store(phase, std::memory_order_release);
+}
+
+void PhaseMarker::set_hwnd(size_t hwnd) {
+  hwnd_.store(hwnd, std::memory_order_relaxed);
+}
+
+void PhaseMarker::leave() {
+  phase_.store(LoopPhase::Idle, std::memory_order_release);
+  hwnd_.store(0, std::memory_order_relaxed);
+}
+
+PhaseMarker::Snapshot PhaseMarker::snapshot() const {
+  Snapshot snap;
+  snap.phase = phase_.load(std::memory_order_acquire);
+  snap.heartbeat = heartbeat_.load(std::memory_order_relaxed);
+  snap.started = Clock::time_point(Clock::duration(started_.load(std::memory_order_relaxed)));
+  snap.hwnd = hwnd_.load(std::memory_order_relaxed);
+  return snap;
+}
+
+// ============================================================================
+// Watchdog
+// ============================================================================
+
+Watchdog::Watchdog(std::chrono::milliseconds budget, std::chrono::milliseconds check_interval,
+                   StallHandler on_stall)
+    : budget_(budget), check_interval_(check_interval), on_stall_(std::move(on_stall)) {
+}
+
+Watchdog::~Watchdog() {
+  stop();
+}
+
+void Watchdog::watch(std::string thread_name, const PhaseMarker& marker) {
+  watched_.push_back(Watched{std::move(thread_name), &marker});
+}
+
+void Watchdog::start() {
+  if (thread_.joinable()) {
+    return;
+  }
+  stopping_ = false;
+  thread_ = std::thread([this] { run(); });
+}
+
+void Watchdog::stop() {
+  if (!thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_one();
+  thread_.join();
+}
+
+size_t Watchdog::check(Clock::time_point now) {
+  size_t new_stalls = 0;
+  for (auto& watched : watched_) {
+    auto snap = watched.marker->snapshot();
+
+    // A previously reported stall is over once the marker moved on to another phase instance
+    if (watched.stalled &&
+        (snap.phase == LoopPhase::Idle || snap.heartbeat != watched.stalled_heartbeat)) {
+      watched.stalled = false;
+      auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+          now - watched.stalled_since);
+      on_stall_(StallReport{watched.name, watched.stalled_phase, watched.stalled_hwnd, elapsed,
+                            true});
+    }
+
+    if (snap.phase == LoopPhase::Idle || watched.stalled) {
+      continue;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - snap.started);
+    if (elapsed <= budget_ || snap.heartbeat == watched.stalled_heartbeat) {
+      continue;
+    }
+
+    watched.stalled = true;
+    watched.stalled_heartbeat = snap.heartbeat;
+    watched.stalled_phase = snap.phase;
+    watched.stalled_hwnd = snap.hwnd;
+    watched.stalled_since = snap.started;
+    ++new_stalls;
+    on_stall_(StallReport{watched.name, snap.phase, snap.hwnd, elapsed, false});
+  }
+  return new_stalls;
+}
+
+void Watchdog::run() {
+  std::unique_lock lock(mutex_);
+  while (!stopping_) {
+    wake_.wait_for(lock, check_interval_, [this] { return stopping_; });
+    if (stopping_) {
+      break;
+    }
+    lock.unlock();
+    check(Clock::now());
+    lock.lock();
+  }
+}
+
+} // namespace wintiler
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace wintiler {
+
+// What a watched thread is doing right now
+enum class LoopPhase {
+  Idle,
+  Hotkeys,
+  Ipc,
+  WindowEvent,
+  Gather,
+  Update,
+  PlaceWindows, // SetWindowPos calls
+  Foreground,   // SetForegroundWindow / cursor moves
+  Render,       // Overlay drawing (D2D EndDraw / Present)
+  Config,
+  Monitors,
+};
+
+const char* loop_phase_to_string(LoopPhase phase);
+
+// ============================================================================
+// Phase marker
+// ============================================================================
+
+// Heartbeat plus current-phase marker published by a watched thread. Writes are lock-free
+// atomics, cheap enough to update around every phase and every window being processed.
+class PhaseMarker {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  void enter(LoopPhase phase, size_t hwnd = 0);
+  void set_hwnd(size_t hwnd);
+  void leave();
+
+  struct Snapshot {
+    LoopPhase phase;
+    size_t hwnd;
+    Clock::time_point started;
+    uint64_t heartbeat; // Incremented on every enter(), identifies a phase instance
+  };
+  [[nodiscard]] Snapshot snapshot() const;
+
+private:
+  std::atomic<LoopPhase> phase_{LoopPhase::Idle};
+  std::atomic<size_t> hwnd_{0};
+  std::atomic<Clock::rep> started_{0};
+  std::atomic<uint64_t> heartbeat_{0};
+};
+
+// RAII phase scope: enter on construction, back to Idle on destruction
+class PhaseScope {
+public:
+  PhaseScope(PhaseMarker& marker, LoopPhase phase, size_t hwnd = 0) : marker_(marker) {
+    marker_.enter(phase, hwnd);
+  }
+  ~PhaseScope() {
+    marker_.leave();
+  }
+
+  PhaseScope(const PhaseScope&) = delete;
+  PhaseScope& operator=(const PhaseScope&) = delete;
+
+private:
+  PhaseMarker& marker_;
+};
+
+// ============================================================================
+// Watchdog
+// ============================================================================
+
+struct StallReport {
+  std::string thread_name;
+  LoopPhase phase;
+  size_t hwnd; // 0 if the phase is not processing a specific window
+  std::chrono::milliseconds elapsed;
+  bool recovered; // false: stall detected, true: the stalled phase finally finished
+};
+
+// Watches one or more PhaseMarkers and reports a phase that runs longer than the budget.
+// Each stalled phase instance is reported once when detected and once when it recovers.
+class Watchdog {
+public:
+  using Clock = PhaseMarker::Clock;
+  using StallHandler = std::function<void(const StallReport&)>;
+
+  Watchdog(std::chrono::milliseconds budget, std::chrono::milliseconds check_interval,
+           StallHandler on_stall);
+  ~Watchdog();
+
+  Watchdog(const Watchdog&) = delete;
+  Watchdog& operator=(const Watchdog&) = delete;
+
+  // Register a marker before start(); the marker must outlive the watchdog
+  void watch(std::string thread_name, const PhaseMarker& marker);
+
+  void start();
+  void stop();
+
+  // One check pass against now; called by the watchdog thread, public for tests.
+  // Returns the number of new stalls detected.
+  size_t check(Clock::time_point now);
+
+private:
+  struct Watched {
+    std::string name;
+    const PhaseMarker* marker;
+    uint64_t stalled_heartbeat = 0; // Heartbeat of the phase instance already reported
+    bool stalled = false;
+    LoopPhase stalled_phase = LoopPhase::Idle;
+    size_t stalled_hwnd = 0;
+    Clock::time_point stalled_since{};
+  };
+
+  void run();
+
+  std::chrono::milliseconds budget_;
+  std::chrono::milliseconds check_interval_;
+  StallHandler on_stall_;
+  std::vector<Watched> watched_;
+
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  bool stopping_ = false;
+};
+
+} // namespace wintiler
@@ -6,14 +6,23 @@
 #include <windows.h>
 #include <wtsapi32.h>
 
+// dbghelp.h needs windows.h first
+#include <dbghelp.h>
+
 #include <algorithm>
 #include <atomic>
 #include <cctype>
+#include <chrono>
+#include <climits>
+#include <functional>
+#include <future>
+#include <thread>
 
 // Link with Psapi.lib
 #pragma comment(lib, "Psapi.lib")
 #pragma comment(lib, "Dwmapi.lib")
 #pragma comment(lib, "Wtsapi32.lib")
+#pragma comment(lib, "Dbghelp.lib")
 
 namespace winapi {
 
@@ -98,12 +107,32 @@ static std::optional<DWORD_T> get_window_pid(HWND_T hwnd) {
   return std::nullopt;
 }
 
-static std::string get_process_name_from_pid(DWORD_T pid) {
+// Run a Win32 query, timing it into sample when the enumeration is being profiled
+template <typename Query>
+static auto timed_query(wintiler::WindowQuerySample* sample, wintiler::EnumApi api,
+                        Query&& query) {
+  if (sample == nullptr) {
+    return query();
+  }
+  auto start = std::chrono::steady_clock::now();
+  auto result = query();
+  sample->add(api, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count());
+  return result;
+}
+
+static std::string get_process_name_from_pid(DWORD_T pid,
+                                             wintiler::WindowQuerySample* sample = nullptr) {
+  using wintiler::EnumApi;
   std::string processName;
-  HANDLE hProcess = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, pid);
+  HANDLE hProcess = timed_query(sample, EnumApi::OpenProcess, [&] {
+    return OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, pid);
+  });
   if (hProcess) {
     char buffer[MAX_PATH];
-    if (GetModuleBaseNameA(hProcess, NULL, buffer, MAX_PATH)) {
+    if (timed_query(sample, EnumApi::GetModuleBaseName,
+                    [&] { return GetModuleBaseNameA(hProcess, NULL, buffer, MAX_PATH); })) {
       processName = buffer;
     }
     CloseHandle(hProcess);
@@ -119,31 +148,42 @@ static bool is_window_maximized(HWND_T hwnd) {
 struct WindowEnumContext {
   std::vector<HWND_T>* handles;
   const wintiler::IgnoreOptions* ignore_options;
+  // Set only while profiling: receives the timing of every query for the current window
+  wintiler::WindowQuerySample* sample = nullptr;
 };
 
 BOOL CALLBACK WindowEnumProc(HWND hwnd, LPARAM lParam) {
+  using wintiler::EnumApi;
   auto* ctx = reinterpret_cast<WindowEnumContext*>(lParam);
+  auto* sample = ctx->sample;
 
-  if (!IsWindowVisible(hwnd)) {
+  if (!timed_query(sample, EnumApi::IsWindowVisible, [&] { return IsWindowVisible(hwnd); })) {
     return TRUE;
   }
 
   // Check if window is cloaked (hidden by shell/virtual desktops)
   BOOL cloaked = FALSE;
-  if (SUCCEEDED(DwmGetWindowAttribute(hwnd, DWMWA_CLOAKED, &cloaked, sizeof(cloaked)))) {
+  if (SUCCEEDED(timed_query(sample, EnumApi::DwmGetWindowAttribute, [&] {
+        return DwmGetWindowAttribute(hwnd, DWMWA_CLOAKED, &cloaked, sizeof(cloaked));
+      }))) {
     if (cloaked) {
       return TRUE;
     }
   }
 
   char title[256];
-  if (GetWindowTextA(hwnd, title, sizeof(title)) == 0) {
+  if (timed_query(sample, EnumApi::GetWindowText,
+                  [&] { return GetWindowTextA(hwnd, title, sizeof(title)); }) == 0) {
     return TRUE;
   }
+  if (sample != nullptr) {
+    sample->title = title;
+  }
 
   char classNameBuf[256];
   std::string className;
-  if (GetClassNameA(hwnd, classNameBuf, sizeof(classNameBuf)) > 0) {
+  if (timed_query(sample, EnumApi::GetClassName,
+                  [&] { return GetClassNameA(hwnd, classNameBuf, sizeof(classNameBuf)); }) > 0) {
     className = classNameBuf;
   }
 
@@ -158,7 +198,8 @@ BOOL CALLBACK WindowEnumProc(HWND hwnd, LPARAM lParam) {
   }
 
   // Check extended window styles
-  LONG exStyle = GetWindowLong(hwnd, GWL_EXSTYLE);
+  LONG exStyle =
+      timed_query(sample, EnumApi::GetWindowLong, [&] { return GetWindowLong(hwnd, GWL_EXSTYLE); });
   if (exStyle & WS_EX_TOOLWINDOW) {
     return TRUE; // Tool windows (floating panels, utility windows)
   }
@@ -173,14 +214,18 @@ BOOL CALLBACK WindowEnumProc(HWND hwnd, LPARAM lParam) {
   }
 
   // Skip unresponsive windows
-  if (IsHungAppWindow(hwnd)) {
+  if (timed_query(sample, EnumApi::IsHungAppWindow, [&] { return IsHungAppWindow(hwnd); })) {
     return TRUE;
   }
 
-  auto pid = get_window_pid((HWND_T)hwnd);
+  auto pid = timed_query(sample, EnumApi::GetWindowThreadProcessId,
+                         [&] { return get_window_pid((HWND_T)hwnd); });
   std::string processName;
   if (pid.has_value()) {
-    processName = get_process_name_from_pid(pid.value());
+    processName = get_process_name_from_pid(pid.value(), sample);
+  }
+  if (sample != nullptr) {
+    sample->process = processName;
   }
 
   // Skip windows with empty process name
@@ -214,7 +259,7 @@ BOOL CALLBACK WindowEnumProc(HWND hwnd, LPARAM lParam) {
   // Check small window barrier
   if (options.small_window_barrier.has_value()) {
     RECT rect;
-    if (GetWindowRect(hwnd, &rect)) {
+    if (timed_query(sample, EnumApi::GetWindowRect, [&] { return GetWindowRect(hwnd, &rect); })) {
       int width = rect.right - rect.left;
       int height = rect.bottom - rect.top;
       if (width < options.small_window_barrier->width ||
@@ -226,8 +271,9 @@ BOOL CALLBACK WindowEnumProc(HWND hwnd, LPARAM lParam) {
 
   // Check if this is a child/owned window of a process we want to ignore children for
   if (!options.ignore_children_of_processes.empty()) {
-    HWND owner = GetWindow(hwnd, GW_OWNER);
-    HWND parent = GetParent(hwnd);
+    HWND owner =
+        timed_query(sample, EnumApi::GetWindowOwner, [&] { return GetWindow(hwnd, GW_OWNER); });
+    HWND parent = timed_query(sample, EnumApi::GetWindowOwner, [&] { return GetParent(hwnd); });
 
     if (owner != NULL || parent != NULL) {
       // This is a child/owned window - check if process is in the ignore list
@@ -243,6 +289,49 @@ BOOL CALLBACK WindowEnumProc(HWND hwnd, LPARAM lParam) {
   return TRUE;
 }
 
+// Profiling wrapper around WindowEnumProc: records one sample per visible window. Windows
+// rejected before their title or process was queried get them looked up untimed, so the cost
+// can still be attributed.
+struct ProfiledEnumContext {
+  WindowEnumContext* ctx;
+  std::vector<wintiler::WindowQuerySample>* samples;
+};
+
+BOOL CALLBACK ProfiledWindowEnumProc(HWND hwnd, LPARAM lParam) {
+  auto* profiled = reinterpret_cast<ProfiledEnumContext*>(lParam);
+  auto* ctx = profiled->ctx;
+  wintiler::WindowQuerySample sample;
+  sample.hwnd = reinterpret_cast<size_t>(hwnd);
+
+  size_t accepted_before = ctx->handles->size();
+  ctx->sample = &sample;
+  WindowEnumProc(hwnd, (LPARAM)ctx);
+  ctx->sample = nullptr;
+  sample.accepted = ctx->handles->size() > accepted_before;
+
+  // Invisible windows are counted under no process; there are many and they are cheap
+  bool visible = sample.timings_ns.size() > 1 || sample.accepted;
+  if (visible) {
+    auto queried = [&](wintiler::EnumApi api) {
+      return std::any_of(sample.timings_ns.begin(), sample.timings_ns.end(),
+                         [&](const auto& timing) { return timing.first == api; });
+    };
+    if (!queried(wintiler::EnumApi::GetWindowText)) {
+      char title[256];
+      if (GetWindowTextA(hwnd, title, sizeof(title)) > 0) {
+        sample.title = title;
+      }
+    }
+    if (!queried(wintiler::EnumApi::OpenProcess)) {
+      if (auto pid = get_window_pid((HWND_T)hwnd)) {
+        sample.process = get_process_name_from_pid(*pid);
+      }
+    }
+  }
+  profiled->samples->push_back(std::move(sample));
+  return TRUE;
+}
+
 static std::vector<HWND_T> get_windows_list(const wintiler::IgnoreOptions& ignore_options) {
   std::vector<HWND_T> handles;
   WindowEnumContext ctx{&handles, &ignore_options};
@@ -259,6 +348,16 @@ static std::vector<HWND_T> gather_raw_window_data(const wintiler::IgnoreOptions&
   return handles;
 }
 
+std::vector<wintiler::WindowQuerySample>
+profile_window_enumeration(const wintiler::IgnoreOptions& ignore_options) {
+  std::vector<HWND_T> handles;
+  std::vector<wintiler::WindowQuerySample> samples;
+  WindowEnumContext ctx{&handles, &ignore_options};
+  ProfiledEnumContext profiled{&ctx, &samples};
+  EnumWindows(ProfiledWindowEnumProc, (LPARAM)&profiled);
+  return samples;
+}
+
 void log_windows_per_monitor(const wintiler::IgnoreOptions& ignore_options,
                              std::optional<size_t> monitor_index) {
   auto monitors = get_monitors();
@@ -299,7 +398,19 @@ void log_windows_per_monitor(const wintiler::IgnoreOptions& ignore_options,
   }
 }
 
-void update_window_position(const TileInfo& tile_info) {
+namespace {
+
+struct PlacementTarget {
+  HWND hwnd;
+  int x;
+  int y;
+  int width;
+  int height;
+};
+
+// Outer window rect that puts the visible frame at the tile, or nullopt if the window is
+// already there. Restores maximized or minimized windows first.
+std::optional<PlacementTarget> compute_placement_target(const TileInfo& tile_info) {
   HWND hwnd = (HWND)tile_info.handle;
 
   // Restore maximized or minimized windows to normal state before repositioning
@@ -307,7 +418,10 @@ void update_window_position(const TileInfo& tile_info) {
     ShowWindow(hwnd, SW_RESTORE);
   }
 
-  // Get DWM frame bounds to compensate for invisible borders
+  PlacementTarget target{hwnd, tile_info.window_position.x, tile_info.window_position.y,
+                         tile_info.window_position.width, tile_info.window_position.height};
+
+  // Get DWM frame bounds to compensate for invisible borders (fallback: use the tile as is)
   RECT windowRect, frameRect;
   GetWindowRect(hwnd, &windowRect);
   if (SUCCEEDED(DwmGetWindowAttribute(hwnd, DWMWA_EXTENDED_FRAME_BOUNDS, &frameRect,
@@ -317,33 +431,101 @@ void update_window_position(const TileInfo& tile_info) {
     int borderRight = windowRect.right - frameRect.right;
     int borderBottom = windowRect.bottom - frameRect.bottom;
 
-    int targetX = tile_info.window_position.x - borderLeft;
-    int targetY = tile_info.window_position.y - borderTop;
-    int targetW = tile_info.window_position.width + borderLeft + borderRight;
-    int targetH = tile_info.window_position.height + borderTop + borderBottom;
+    target.x -= borderLeft;
+    target.y -= borderTop;
+    target.width += borderLeft + borderRight;
+    target.height += borderTop + borderBottom;
+  }
+
+  // Skip if window is already at the correct position and size
+  if (windowRect.left == target.x && windowRect.top == target.y &&
+      (windowRect.right - windowRect.left) == target.width &&
+      (windowRect.bottom - windowRect.top) == target.height) {
+    return std::nullopt;
+  }
+  return target;
+}
+
+void set_window_pos(const PlacementTarget& target) {
+  SetWindowPos(target.hwnd, NULL, target.x, target.y, target.width, target.height,
+               SWP_NOZORDER | SWP_NOACTIVATE);
+}
+
+} // namespace
+
+void update_window_position(const TileInfo& tile_info) {
+  if (auto target = compute_placement_target(tile_info)) {
+    set_window_pos(*target);
+  }
+}
 
-    // Skip if window is already at the correct position and size
-    if (windowRect.left == targetX && windowRect.top == targetY &&
-        (windowRect.right - windowRect.left) == targetW &&
-        (windowRect.bottom - windowRect.top) == targetH) {
-      return;
+void update_window_positions(const std::vector<TileInfo>& tiles) {
+  std::vector<PlacementTarget> targets;
+  targets.reserve(tiles.size());
+  for (const auto& tile : tiles) {
+    if (auto target = compute_placement_target(tile)) {
+      targets.push_back(*target);
     }
+  }
+  if (targets.empty()) {
+    return;
+  }
+  if (targets.size() == 1) {
+    set_window_pos(targets.front());
+    return;
+  }
 
-    SetWindowPos(hwnd, NULL, targetX, targetY, targetW, targetH, SWP_NOZORDER | SWP_NOACTIVATE);
-  } else {
-    // Fallback if DWM query fails
-    int targetX = tile_info.window_position.x;
-    int targetY = tile_info.window_position.y;
-    int targetW = tile_info.window_position.width;
-    int targetH = tile_info.window_position.height;
-
-    if (windowRect.left == targetX && windowRect.top == targetY &&
-        (windowRect.right - windowRect.left) == targetW &&
-        (windowRect.bottom - windowRect.top) == targetH) {
-      return;
+  // One DeferWindowPos batch moves every window in a single pass (one repaint round).
+  // If any step fails the batch is gone, so fall back to moving windows one by one.
+  HDWP batch = BeginDeferWindowPos(static_cast<int>(targets.size()));
+  for (const auto& target : targets) {
+    if (!batch) {
+      break;
     }
+    batch = DeferWindowPos(batch, target.hwnd, NULL, target.x, target.y, target.width,
+                           target.height, SWP_NOZORDER | SWP_NOACTIVATE);
+  }
+  if (batch && EndDeferWindowPos(batch)) {
+    return;
+  }
 
-    SetWindowPos(hwnd, NULL, targetX, targetY, targetW, targetH, SWP_NOZORDER | SWP_NOACTIVATE);
+  spdlog::debug("DeferWindowPos batch of {} failed, error={}; placing individually",
+                targets.size(), GetLastError());
+  for (const auto& target : targets) {
+    set_window_pos(target);
+  }
+}
+
+void set_windows_visibility(const std::vector<HWND_T>& hide, const std::vector<HWND_T>& show) {
+  constexpr UINT kKeep = SWP_NOMOVE | SWP_NOSIZE | SWP_NOZORDER | SWP_NOACTIVATE;
+  std::vector<std::pair<HWND, UINT>> changes;
+  changes.reserve(hide.size() + show.size());
+  for (auto hwnd : hide) {
+    changes.push_back({(HWND)hwnd, kKeep | SWP_HIDEWINDOW});
+  }
+  for (auto hwnd : show) {
+    changes.push_back({(HWND)hwnd, kKeep | SWP_SHOWWINDOW});
+  }
+  if (changes.empty()) {
+    return;
+  }
+
+  HDWP batch = BeginDeferWindowPos(static_cast<int>(changes.size()));
+  for (const auto& [hwnd, flags] : changes) {
+    if (!batch) {
+      break;
+    }
+    batch = DeferWindowPos(batch, hwnd, NULL, 0, 0, 0, 0, flags);
+  }
+  if (batch && EndDeferWindowPos(batch)) {
+    return;
+  }
+
+  // A window closed since the caller listed it fails the whole batch
+  spdlog::debug("DeferWindowPos visibility batch of {} failed, error={}; applying individually",
+                changes.size(), GetLastError());
+  for (const auto& [hwnd, flags] : changes) {
+    SetWindowPos(hwnd, NULL, 0, 0, 0, 0, flags);
   }
 }
 
@@ -614,22 +796,6 @@ std::optional<HotKeyInfo> create_hotkey(const std::string& text, int id) {
   return HotKeyInfo{id, modifiers, key};
 }
 
-bool register_hotkey(const HotKeyInfo& hotkey) {
-  BOOL result = RegisterHotKey(nullptr, hotkey.id, hotkey.modifiers, hotkey.key);
-  if (result == 0) {
-    spdlog::error(
-        "register_hotkey: Failed to register hotkey id={}, key={}, modifiers={}, error={}",
-        hotkey.id, hotkey.key, hotkey.modifiers, GetLastError());
-    return false;
-  }
-  return true;
-}
-
-bool unregister_hotkey(int id) {
-  BOOL result = UnregisterHotKey(nullptr, id);
-  return result != 0;
-}
-
 std::optional<int> check_keyboard_action() {
   MSG msg;
   if (PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE)) {
@@ -642,6 +808,14 @@ std::optional<int> check_keyboard_action() {
   return std::nullopt;
 }
 
+void pump_messages() {
+  MSG msg;
+  while (PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE)) {
+    TranslateMessage(&msg);
+    DispatchMessageW(&msg);
+  }
+}
+
 bool wait_for_messages_or_timeout(unsigned long timeout_ms) {
   DWORD result =
       MsgWaitForMultipleObjectsEx(0,       // No handles to wait on
@@ -650,49 +824,209 @@ bool wait_for_messages_or_timeout(unsigned long timeout_ms) {
   return result == WAIT_OBJECT_0; // Messages available
 }
 
-// Window move/resize detection using SetWinEventHook
+DWORD_T get_current_thread_id() {
+  return GetCurrentThreadId();
+}
+
+bool wake_message_loop(DWORD_T thread_id) {
+  return PostThreadMessageW(thread_id, WM_NULL, 0, 0) != FALSE;
+}
+
+bool write_minidump(const std::string& path) {
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                            FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    spdlog::error("write_minidump: CreateFile failed for {}, error {}", path, GetLastError());
+    return false;
+  }
+  auto type = static_cast<MINIDUMP_TYPE>(MiniDumpWithThreadInfo | MiniDumpWithHandleData);
+  BOOL ok = MiniDumpWriteDump(GetCurrentProcess(), GetCurrentProcessId(), file, type, nullptr,
+                              nullptr, nullptr);
+  if (!ok) {
+    spdlog::error("write_minidump: MiniDumpWriteDump failed, error {}", GetLastError());
+  }
+  CloseHandle(file);
+  return ok != FALSE;
+}
+
+namespace {
+
+std::function<void()> g_crash_handler;
+
+LONG WINAPI unhandled_exception_filter(EXCEPTION_POINTERS* /*info*/) {
+  if (g_crash_handler) {
+    g_crash_handler();
+  }
+  return EXCEPTION_CONTINUE_SEARCH;
+}
+
+} // namespace
+
+void set_crash_handler(std::function<void()> handler) {
+  g_crash_handler = std::move(handler);
+  SetUnhandledExceptionFilter(g_crash_handler ? unhandled_exception_filter : nullptr);
+}
+
+// ============================================================================
+// Hook thread
+// ============================================================================
+
+// WinEvent hooks (WINEVENT_OUTOFCONTEXT) and hotkeys are delivered to the thread that
+// registered them, and only while it pumps messages. They live on a dedicated thread so
+// slow enumeration or rendering on the loop thread never delays them.
 namespace {
-std::atomic<bool> g_is_moving{false};
-std::atomic<HWND> g_moving_hwnd{nullptr};
-std::atomic<bool> g_move_just_ended{false};
+constexpr UINT kHookThreadCallMessage = WM_APP + 1;
+
+wintiler::InputEventQueue* g_event_queue = nullptr;
+std::function<void()> g_event_wake;
+std::thread g_hook_thread;
+std::atomic<DWORD> g_hook_thread_id{0};
+std::atomic<size_t> g_dropped_events{0};
 HWINEVENTHOOK g_move_start_hook = nullptr;
 HWINEVENTHOOK g_move_end_hook = nullptr;
+HWINEVENTHOOK g_location_hook = nullptr;
+
+// Window between MOVESIZESTART and MOVESIZEEND; only touched on the hook thread
+HWND g_dragged_window = nullptr;
+
+// Cursor events arrive at the pointer's report rate. Identical positions are dropped and the
+// loop is woken at most once per interval. A position queued inside the interval arms a
+// one-shot hook thread timer, so the last one of a burst still wakes the loop when the
+// interval ends.
+constexpr auto kCursorWakeInterval = std::chrono::milliseconds(16);
+POINT g_last_cursor_pos{LONG_MIN, LONG_MIN};
+std::chrono::steady_clock::time_point g_last_cursor_wake{};
+UINT_PTR g_cursor_wake_timer = 0;
+
+// Convert a message/event tick (GetTickCount based) into a steady_clock timestamp
+std::chrono::steady_clock::time_point timestamp_from_tick(DWORD tick) {
+  auto age = std::chrono::milliseconds(GetTickCount() - tick);
+  return std::chrono::steady_clock::now() - age;
+}
+
+void push_input_event(const wintiler::InputEvent& event, bool wake = true) {
+  if (g_event_queue == nullptr) {
+    return;
+  }
+  if (!g_event_queue->try_push(event)) {
+    g_dropped_events.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  if (wake && g_event_wake) {
+    g_event_wake();
+  }
+}
 
 void CALLBACK move_size_hook_proc(HWINEVENTHOOK /*hWinEventHook*/, DWORD event, HWND hwnd,
                                   LONG idObject, LONG idChild, DWORD /*idEventThread*/,
-                                  DWORD /*dwmsEventTime*/) {
+                                  DWORD dwmsEventTime) {
   // Only handle window events (OBJID_WINDOW == 0 and CHILDID_SELF == 0)
   if (idObject != OBJID_WINDOW || idChild != CHILDID_SELF) {
     return;
   }
 
+  wintiler::InputEvent input_event;
+  input_event.hwnd = reinterpret_cast<size_t>(hwnd);
+  input_event.timestamp = timestamp_from_tick(dwmsEventTime);
   if (event == EVENT_SYSTEM_MOVESIZESTART) {
-    g_moving_hwnd = hwnd;
-    g_is_moving = true;
-    g_move_just_ended = false;
+    input_event.type = wintiler::InputEventType::MoveSizeStart;
+    g_dragged_window = hwnd;
     spdlog::trace("Window move/resize started: hwnd={}", static_cast<void*>(hwnd));
   } else if (event == EVENT_SYSTEM_MOVESIZEEND) {
-    g_is_moving = false;
-    g_move_just_ended = true;
-    spdlog::trace("Window move/resize ended: hwnd={}", static_cast<void*>(g_moving_hwnd.load()));
+    input_event.type = wintiler::InputEventType::MoveSizeEnd;
+    g_dragged_window = nullptr;
+    spdlog::trace("Window move/resize ended: hwnd={}", static_cast<void*>(hwnd));
+  } else {
+    return;
   }
+  push_input_event(input_event);
 }
-} // namespace
 
-void register_move_size_hook() {
+void cancel_cursor_wake_timer() {
+  if (g_cursor_wake_timer != 0) {
+    KillTimer(nullptr, g_cursor_wake_timer);
+    g_cursor_wake_timer = 0;
+  }
+}
+
+// Trailing-edge wake for cursor positions queued without one
+void CALLBACK cursor_wake_timer_proc(HWND /*hwnd*/, UINT /*msg*/, UINT_PTR /*id*/,
+                                     DWORD /*time*/) {
+  cancel_cursor_wake_timer();
+  g_last_cursor_wake = std::chrono::steady_clock::now();
+  if (g_event_wake) {
+    g_event_wake();
+  }
+}
+
+void CALLBACK location_hook_proc(HWINEVENTHOOK /*hWinEventHook*/, DWORD /*event*/, HWND hwnd,
+                                 LONG idObject, LONG idChild, DWORD /*idEventThread*/,
+                                 DWORD dwmsEventTime) {
+  // The window being dragged: the loop reflows its neighbors (throttled on the loop side).
+  // Every change wakes the loop so the last one of a drag is never left in the queue.
+  if (hwnd != nullptr && hwnd == g_dragged_window && idObject == OBJID_WINDOW &&
+      idChild == CHILDID_SELF) {
+    wintiler::InputEvent input_event;
+    input_event.type = wintiler::InputEventType::WindowLocation;
+    input_event.hwnd = reinterpret_cast<size_t>(hwnd);
+    input_event.timestamp = timestamp_from_tick(dwmsEventTime);
+    push_input_event(input_event);
+    return;
+  }
+
+  // LOCATIONCHANGE also fires for every other moving window and caret; keep only the cursor
+  if (hwnd != nullptr || idObject != OBJID_CURSOR) {
+    return;
+  }
+  POINT pt;
+  if (!GetCursorPos(&pt) || (pt.x == g_last_cursor_pos.x && pt.y == g_last_cursor_pos.y)) {
+    return;
+  }
+  g_last_cursor_pos = pt;
+
+  wintiler::InputEvent input_event;
+  input_event.type = wintiler::InputEventType::CursorMove;
+  input_event.x = static_cast<int>(pt.x);
+  input_event.y = static_cast<int>(pt.y);
+  input_event.timestamp = timestamp_from_tick(dwmsEventTime);
+
+  auto now = std::chrono::steady_clock::now();
+  auto since_wake = now - g_last_cursor_wake;
+  bool wake = since_wake >= kCursorWakeInterval;
+  if (wake) {
+    g_last_cursor_wake = now;
+    cancel_cursor_wake_timer();
+  } else if (g_cursor_wake_timer == 0) {
+    auto remaining =
+        std::chrono::ceil<std::chrono::milliseconds>(kCursorWakeInterval - since_wake);
+    g_cursor_wake_timer =
+        SetTimer(nullptr, 0, static_cast<UINT>(remaining.count()), cursor_wake_timer_proc);
+  }
+  push_input_event(input_event, wake);
+}
+
+bool install_move_size_hooks() {
   g_move_start_hook = SetWinEventHook(EVENT_SYSTEM_MOVESIZESTART, EVENT_SYSTEM_MOVESIZESTART,
                                       nullptr, move_size_hook_proc, 0, 0, WINEVENT_OUTOFCONTEXT);
   g_move_end_hook = SetWinEventHook(EVENT_SYSTEM_MOVESIZEEND, EVENT_SYSTEM_MOVESIZEEND, nullptr,
                                     move_size_hook_proc, 0, 0, WINEVENT_OUTOFCONTEXT);
-
-  if (g_move_start_hook == nullptr || g_move_end_hook == nullptr) {
-    spdlog::error("Failed to register move/size hooks");
-  } else {
-    spdlog::info("Registered window move/size hooks");
-  }
+  // Mouse-move source for hover focus (without it the loop keeps sampling GetCursorPos) and
+  // location changes of the dragged window for live resize
+  g_location_hook = SetWinEventHook(EVENT_OBJECT_LOCATIONCHANGE, EVENT_OBJECT_LOCATIONCHANGE,
+                                    nullptr, location_hook_proc, 0, 0, WINEVENT_OUTOFCONTEXT);
+  if (g_location_hook == nullptr) {
+    spdlog::warn("Failed to install location change hook, error={}", GetLastError());
+  }
+  return g_move_start_hook != nullptr && g_move_end_hook != nullptr;
 }
 
-void unregister_move_size_hook() {
+void uninstall_move_size_hooks() {
+  if (g_location_hook != nullptr) {
+    UnhookWinEvent(g_location_hook);
+    g_location_hook = nullptr;
+  }
+  cancel_cursor_wake_timer();
+  g_dragged_window = nullptr;
   if (g_move_start_hook != nullptr) {
     UnhookWinEvent(g_move_start_hook);
     g_move_start_hook = nullptr;
@@ -701,24 +1035,111 @@ void unregister_move_size_hook() {
     UnhookWinEvent(g_move_end_hook);
     g_move_end_hook = nullptr;
   }
-  spdlog::info("Unregistered window move/size hooks");
 }
 
-static bool is_any_window_being_moved() {
-  return g_is_moving.load();
+void hook_thread_proc(std::promise<bool> ready) {
+  SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+
+  // Force creation of the thread message queue before anyone posts to it
+  MSG msg;
+  PeekMessageW(&msg, nullptr, WM_USER, WM_USER, PM_NOREMOVE);
+
+  bool hooks_installed = install_move_size_hooks();
+  g_hook_thread_id = GetCurrentThreadId();
+  ready.set_value(hooks_installed);
+
+  while (GetMessageW(&msg, nullptr, 0, 0) > 0) {
+    if (msg.message == WM_HOTKEY) {
+      wintiler::InputEvent input_event;
+      input_event.type = wintiler::InputEventType::Hotkey;
+      input_event.hotkey_id = static_cast<int>(msg.wParam);
+      input_event.timestamp = timestamp_from_tick(msg.time);
+      push_input_event(input_event);
+      continue;
+    }
+    if (msg.message == kHookThreadCallMessage) {
+      (*reinterpret_cast<std::packaged_task<bool()>*>(msg.lParam))();
+      continue;
+    }
+    TranslateMessage(&msg);
+    DispatchMessageW(&msg);
+  }
+
+  uninstall_move_size_hooks();
+  g_hook_thread_id = 0;
 }
 
-static std::optional<DragInfo> get_drag_info() {
-  HWND hwnd = g_moving_hwnd.load();
-  if (hwnd == nullptr) {
-    return std::nullopt;
+// Run fn on the hook thread and wait for its result (directly if no hook thread is running)
+bool run_on_hook_thread(const std::function<bool()>& fn) {
+  DWORD hook_thread_id = g_hook_thread_id.load();
+  if (hook_thread_id == 0 || hook_thread_id == GetCurrentThreadId()) {
+    return fn();
+  }
+  std::packaged_task<bool()> task(fn);
+  auto result = task.get_future();
+  if (!PostThreadMessageW(hook_thread_id, kHookThreadCallMessage, 0,
+                          reinterpret_cast<LPARAM>(&task))) {
+    spdlog::error("Failed to post to hook thread, error={}", GetLastError());
+    return false;
+  }
+  return result.get();
+}
+} // namespace
+
+bool start_hook_thread(wintiler::InputEventQueue& queue, std::function<void()> wake) {
+  if (g_hook_thread.joinable()) {
+    return true;
+  }
+  g_event_queue = &queue;
+  g_event_wake = std::move(wake);
+  g_dropped_events = 0;
+
+  std::promise<bool> ready;
+  auto hooks_installed = ready.get_future();
+  g_hook_thread = std::thread(hook_thread_proc, std::move(ready));
+  if (!hooks_installed.get()) {
+    spdlog::error("Failed to register move/size hooks");
+    stop_hook_thread();
+    return false;
+  }
+  spdlog::info("Hook thread started, registered window move/size hooks");
+  return true;
+}
+
+void stop_hook_thread() {
+  if (!g_hook_thread.joinable()) {
+    return;
+  }
+  PostThreadMessageW(g_hook_thread_id.load(), WM_QUIT, 0, 0);
+  g_hook_thread.join();
+  g_event_queue = nullptr;
+  g_event_wake = nullptr;
+  if (size_t dropped = g_dropped_events.load(); dropped > 0) {
+    spdlog::warn("Hook thread dropped {} events (queue full)", dropped);
   }
-  return DragInfo{reinterpret_cast<HWND_T>(hwnd), g_move_just_ended.load()};
+  spdlog::info("Hook thread stopped, unregistered window move/size hooks");
+}
+
+size_t get_dropped_input_events() {
+  return g_dropped_events.load(std::memory_order_relaxed);
+}
+
+// Hotkeys are posted to the registering thread, so register them on the hook thread if running
+bool register_hotkey(const HotKeyInfo& hotkey) {
+  return run_on_hook_thread([&hotkey] {
+    BOOL result = RegisterHotKey(nullptr, hotkey.id, hotkey.modifiers, hotkey.key);
+    if (result == 0) {
+      spdlog::error(
+          "register_hotkey: Failed to register hotkey id={}, key={}, modifiers={}, error={}",
+          hotkey.id, hotkey.key, hotkey.modifiers, GetLastError());
+      return false;
+    }
+    return true;
+  });
 }
 
-void clear_drag_ended() {
-  g_move_just_ended = false;
-  g_moving_hwnd = nullptr;
+bool unregister_hotkey(int id) {
+  return run_on_hook_thread([id] { return UnregisterHotKey(nullptr, id) != 0; });
 }
 
 // Session/Power notification handling
@@ -737,6 +1158,9 @@ std::atomic<bool> g_session_locked{false};
 std::atomic<bool> g_system_suspended{false};
 std::atomic<bool> g_display_off{false};
 
+// Power source: -1 unknown, 0 battery, 1 AC (updated on PBT_APMPOWERSTATUSCHANGE)
+std::atomic<int> g_ac_line_status{-1};
+
 // Track if we've received initial display state (to avoid spurious "resuming" on startup)
 std::atomic<bool> g_display_state_initialized{false};
 
@@ -745,6 +1169,19 @@ HANDLE g_resume_event = nullptr;
 
 const wchar_t* NOTIFICATION_WINDOW_CLASS = L"WinTilerNotificationWindow";
 
+void refresh_ac_line_status() {
+  SYSTEM_POWER_STATUS status;
+  int value = -1;
+  if (GetSystemPowerStatus(&status) && status.ACLineStatus != 255) {
+    value = status.ACLineStatus == 1 ? 1 : 0;
+  }
+  int previous = g_ac_line_status.exchange(value);
+  if (previous != -1 && previous != value) {
+    spdlog::info("Power source changed to {}",
+                 value == 1 ? "AC" : (value == 0 ? "battery" : "unknown"));
+  }
+}
+
 LRESULT CALLBACK notification_wnd_proc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
   switch (msg) {
   case WM_WTSSESSION_CHANGE:
@@ -776,6 +1213,8 @@ LRESULT CALLBACK notification_wnd_proc(HWND hwnd, UINT msg, WPARAM wParam, LPARA
         SetEvent(g_resume_event);
       }
       spdlog::info("System resumed - resuming");
+    } else if (wParam == PBT_APMPOWERSTATUSCHANGE) {
+      refresh_ac_line_status();
     } else if (wParam == PBT_POWERSETTINGCHANGE) {
       auto* setting = reinterpret_cast<POWERBROADCAST_SETTING*>(lParam);
       if (setting && IsEqualGUID(setting->PowerSetting, GUID_CONSOLE_DISPLAY_STATE_LOCAL)) {
@@ -862,6 +1301,8 @@ void register_session_power_notifications() {
     spdlog::error("Failed to register power setting notification, error={}", GetLastError());
   }
 
+  refresh_ac_line_status();
+
   spdlog::info("Registered session/power notifications");
 }
 
@@ -888,6 +1329,7 @@ void unregister_session_power_notifications() {
   g_system_suspended = false;
   g_display_off = false;
   g_display_state_initialized = false;
+  g_ac_line_status = -1;
 
   spdlog::info("Unregistered session/power notifications");
 }
@@ -919,6 +1361,40 @@ bool is_session_paused() {
   return g_session_locked || g_system_suspended || g_display_off;
 }
 
+std::optional<bool> is_on_ac_power() {
+  int status = g_ac_line_status.load();
+  if (status == -1) {
+    // Notifications not registered (or status unknown so far): ask directly
+    SYSTEM_POWER_STATUS power;
+    if (!GetSystemPowerStatus(&power) || power.ACLineStatus == 255) {
+      return std::nullopt;
+    }
+    return power.ACLineStatus == 1;
+  }
+  return status == 1;
+}
+
+std::optional<int> get_display_refresh_rate() {
+  DEVMODEW mode{};
+  mode.dmSize = sizeof(mode);
+  if (!EnumDisplaySettingsW(nullptr, ENUM_CURRENT_SETTINGS, &mode)) {
+    return std::nullopt;
+  }
+  return static_cast<int>(mode.dmDisplayFrequency);
+}
+
+std::chrono::microseconds get_process_cpu_time() {
+  FILETIME creation, exit, kernel, user;
+  if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+    return std::chrono::microseconds(0);
+  }
+  auto to_100ns = [](const FILETIME& ft) {
+    return (static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+  };
+  // FILETIME durations are in 100ns units
+  return std::chrono::microseconds((to_100ns(kernel) + to_100ns(user)) / 10);
+}
+
 bool is_context_menu_active() {
   // Check if the foreground thread has an active popup menu
   HWND foreground = GetForegroundWindow();
@@ -1028,13 +1504,17 @@ LoopInputState gather_loop_input_state(const wintiler::IgnoreOptions& ignore_opt
   }
 
   // Gather input state
-  state.is_any_window_being_moved = is_any_window_being_moved();
-  state.drag_info = get_drag_info();
-  state.cursor_pos = get_cursor_pos();
-  state.is_ctrl_pressed = is_ctrl_pressed();
-  state.foreground_window = get_foreground_window();
+  refresh_input_state(state);
 
   return state;
 }
 
+void refresh_input_state(LoopInputState& state, bool sample_cursor) {
+  if (sample_cursor) {
+    state.cursor_pos = get_cursor_pos();
+  }
+  state.is_ctrl_pressed = is_ctrl_pressed();
+  state.foreground_window = get_foreground_window();
+}
+
 } // namespace winapi
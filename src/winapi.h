@@ -1,10 +1,14 @@
 #pragma once
 
+#include <chrono>
+#include <functional>
 #include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "enum_profile.h"
+#include "input_events.h"
 #include "options.h"
 
 namespace winapi {
@@ -53,9 +57,17 @@ bool monitors_equal(const std::vector<MonitorInfo>& a, const std::vector<Monitor
 void log_windows_per_monitor(const wintiler::IgnoreOptions& ignore_options,
                              std::optional<size_t> monitor_index = std::nullopt);
 void update_window_position(const TileInfo& tile_info);
+// Place several windows in one DeferWindowPos batch (falls back to one by one on failure)
+void update_window_positions(const std::vector<TileInfo>& tiles);
+// Hide and show windows in one DeferWindowPos batch without moving or activating them (falls
+// back to one by one on failure). Hidden windows drop out of enumeration.
+void set_windows_visibility(const std::vector<HWND_T>& hide, const std::vector<HWND_T>& show);
 std::vector<HWND_T> get_hwnds_for_monitor(size_t monitor_index,
                                           const wintiler::IgnoreOptions& ignore_options);
 WindowInfo get_window_info(HWND_T hwnd);
+// Run the same enumeration as gather_loop_input_state, timing every query per visible window
+std::vector<wintiler::WindowQuerySample>
+profile_window_enumeration(const wintiler::IgnoreOptions& ignore_options);
 
 // Get window position and size (returns nullopt if window is invalid)
 std::optional<WindowPosition> get_window_rect(HWND_T hwnd);
@@ -80,7 +92,7 @@ struct HotKeyInfo {
 // Only single character keys are supported
 std::optional<HotKeyInfo> create_hotkey(const std::string& text, int id);
 
-// Register a hotkey with Windows
+// Register a hotkey with Windows (on the hook thread if it is running)
 bool register_hotkey(const HotKeyInfo& hotkey);
 
 // Unregister a previously registered hotkey
@@ -89,13 +101,39 @@ bool unregister_hotkey(int id);
 // Check for pending hotkey messages, returns the hotkey id if triggered
 std::optional<int> check_keyboard_action();
 
+// Dispatch all pending messages of the calling thread (session/power notifications, wakeups)
+void pump_messages();
+
+// Timeout value that waits until a message arrives
+constexpr unsigned long kInfiniteTimeout = 0xFFFFFFFF;
+
 // Wait for messages or timeout using MsgWaitForMultipleObjectsEx
 // Returns true if messages are available, false on timeout
 bool wait_for_messages_or_timeout(unsigned long timeout_ms);
 
-// Window move/resize detection (for pausing tiling during user drag operations)
-void register_move_size_hook();
-void unregister_move_size_hook();
+// Thread id of the calling thread (used to wake its message loop from other threads)
+DWORD_T get_current_thread_id();
+
+// Post an empty message to a thread so a pending wait_for_messages_or_timeout returns
+bool wake_message_loop(DWORD_T thread_id);
+
+// Write a minidump of this process (all thread stacks, no full memory) to path.
+// Safe to call from any thread; the calling thread's own stack is captured as well.
+bool write_minidump(const std::string& path);
+
+// Run handler from the unhandled-exception filter before the process dies (empty = remove).
+// The handler runs on the crashing thread and should only do simple file I/O.
+void set_crash_handler(std::function<void()> handler);
+
+// Dedicated high-priority thread that owns the window move/resize WinEvent hooks and the
+// hotkey registrations. Every hook callback and WM_HOTKEY is pushed as a timestamped
+// InputEvent into queue, then wake is called so the loop can drain it. Returns false, with
+// the thread already stopped, if the move/size hooks cannot be installed.
+bool start_hook_thread(wintiler::InputEventQueue& queue, std::function<void()> wake);
+void stop_hook_thread();
+
+// Number of events dropped because the queue was full
+size_t get_dropped_input_events();
 
 // Session/Power state management - pauses loop on lock/sleep/display-off
 void register_session_power_notifications();
@@ -108,6 +146,17 @@ void wait_for_session_active();
 // Check if session is currently paused (locked, sleeping, or display off)
 bool is_session_paused();
 
+// Whether the machine runs on AC power (nullopt if unknown). Kept up to date by the
+// session/power notification window, so call pump_messages regularly.
+std::optional<bool> is_on_ac_power();
+
+// Refresh rate of the primary display in Hz (nullopt if it cannot be queried; 0 or 1 mean
+// "hardware default")
+std::optional<int> get_display_refresh_rate();
+
+// Kernel + user CPU time consumed by this process so far
+std::chrono::microseconds get_process_cpu_time();
+
 // Detect if a context menu is currently the foreground window
 bool is_context_menu_active();
 
@@ -117,9 +166,6 @@ struct DragInfo {
   bool move_ended; // True when drag just ended (one-shot detection)
 };
 
-// Clear the drag ended flag after handling it
-void clear_drag_ended();
-
 // Per-window data for consolidated queries
 struct ManagedWindowInfo {
   HWND_T handle;
@@ -128,8 +174,8 @@ struct ManagedWindowInfo {
 
 // Consolidated input state for the main loop
 struct LoopInputState {
-  // Window movement state
-  bool is_any_window_being_moved;
+  // Window movement state (filled by the loop from hook thread events)
+  bool is_any_window_being_moved = false;
   std::optional<DragInfo> drag_info;
 
   // Cursor and keyboard state
@@ -149,4 +195,8 @@ struct LoopInputState {
 // Gather all input state for the main loop in a single call
 LoopInputState gather_loop_input_state(const wintiler::IgnoreOptions& ignore_options);
 
+// Refresh only the cheap fields (cursor, keyboard, foreground) without enumerating windows.
+// sample_cursor=false keeps cursor_pos for callers that track it from mouse-move events.
+void refresh_input_state(LoopInputState& state, bool sample_cursor = true);
+
 } // namespace winapi
@@ -0,0 +1,155 @@
+#include "window_tracker.h"
+
+#include <spdlog/spdlog.h>
+
+#include <utility>
+
+namespace wintiler {
+
+namespace {
+
+bool same_place(const TrackedWindow& a, const TrackedWindow& b) {
+  return a.monitor == b.monitor && a.x == b.x && a.y == b.y && a.width == b.width &&
+         a.height == b.height;
+}
+
+bool same_style(const TrackedWindow& a, const TrackedWindow& b) {
+  return a.style == b.style && a.ex_style == b.ex_style && a.hung == b.hung &&
+         a.cloaked == b.cloaked;
+}
+
+std::string hwnd_string(size_t hwnd) {
+  return fmt::format("{:#x}", hwnd);
+}
+
+nlohmann::json place_json(const TrackedWindow& window) {
+  return {{"monitor", window.monitor},
+          {"x", window.x},
+          {"y", window.y},
+          {"width", window.width},
+          {"height", window.height}};
+}
+
+nlohmann::json style_json(const TrackedWindow& window) {
+  return {{"style", fmt::format("{:#010x}", window.style)},
+          {"ex_style", fmt::format("{:#010x}", window.ex_style)},
+          {"hung", window.hung},
+          {"cloaked", window.cloaked}};
+}
+
+} // namespace
+
+const char* window_change_type_to_string(WindowChangeType type) {
+  switch (type) {
+  case WindowChangeType::Appeared:
+    return "appeared";
+  case WindowChangeType::Disappeared:
+    return "disappeared";
+  case WindowChangeType::Moved:
+    return "moved";
+  case WindowChangeType::Retitled:
+    return "retitled";
+  case WindowChangeType::StyleChanged:
+    return "style";
+  }
+  return "unknown";
+}
+
+std::vector<WindowChange> diff_windows(const std::vector<TrackedWindow>& previous,
+                                       const std::vector<TrackedWindow>& current) {
+  std::unordered_map<size_t, const TrackedWindow*> before;
+  before.reserve(previous.size());
+  for (const auto& window : previous) {
+    before.emplace(window.hwnd, &window);
+  }
+  std::unordered_map<size_t, const TrackedWindow*> after;
+  after.reserve(current.size());
+  for (const auto& window : current) {
+    after.emplace(window.hwnd, &window);
+  }
+
+  std::vector<WindowChange> changes;
+  for (const auto& window : previous) {
+    if (after.count(window.hwnd) == 0) {
+      changes.push_back({WindowChangeType::Disappeared, window, std::nullopt});
+    }
+  }
+  for (const auto& window : current) {
+    auto it = before.find(window.hwnd);
+    if (it == before.end()) {
+      changes.push_back({WindowChangeType::Appeared, window, std::nullopt});
+      continue;
+    }
+    const TrackedWindow& old = *it->second;
+    if (!same_place(old, window)) {
+      changes.push_back({WindowChangeType::Moved, window, old});
+    }
+    if (old.title != window.title) {
+      changes.push_back({WindowChangeType::Retitled, window, old});
+    }
+    if (!same_style(old, window)) {
+      changes.push_back({WindowChangeType::StyleChanged, window, old});
+    }
+  }
+  return changes;
+}
+
+std::vector<WindowChange> WindowTracker::update(std::vector<TrackedWindow> current) {
+  auto changes = diff_windows(windows_, current);
+  windows_ = std::move(current);
+  index_.clear();
+  for (size_t i = 0; i < windows_.size(); ++i) {
+    index_.emplace(windows_[i].hwnd, i);
+  }
+  return changes;
+}
+
+const TrackedWindow* WindowTracker::find(size_t hwnd) const {
+  auto it = index_.find(hwnd);
+  return it == index_.end() ? nullptr : &windows_[it->second];
+}
+
+size_t WindowTracker::size() const {
+  return windows_.size();
+}
+
+nlohmann::json window_change_to_json(const WindowChange& change, int64_t t_ms) {
+  const auto& window = change.window;
+  nlohmann::json out{{"t_ms", t_ms},
+                     {"event", window_change_type_to_string(change.type)},
+                     {"hwnd", hwnd_string(window.hwnd)}};
+  switch (change.type) {
+  case WindowChangeType::Appeared:
+    out["pid"] = window.pid;
+    out["process"] = window.process;
+    out["class"] = window.class_name;
+    out["title"] = window.title;
+    out.update(place_json(window));
+    out.update(style_json(window));
+    break;
+  case WindowChangeType::Disappeared:
+    out["process"] = window.process;
+    out["title"] = window.title;
+    break;
+  case WindowChangeType::Moved:
+    out.update(place_json(window));
+    out["from"] = place_json(*change.previous);
+    break;
+  case WindowChangeType::Retitled:
+    out["title"] = window.title;
+    out["from"] = change.previous->title;
+    break;
+  case WindowChangeType::StyleChanged:
+    out.update(style_json(window));
+    out["from"] = style_json(*change.previous);
+    break;
+  }
+  return out;
+}
+
+std::string window_change_to_line(const WindowChange& change, int64_t t_ms) {
+  return window_change_to_json(change, t_ms)
+      .dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+}
+
+} // namespace wintiler
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace wintiler {
+
+// One window as sampled by a track-windows pass
+struct TrackedWindow {
+  size_t hwnd = 0;
+  size_t monitor = 0;
+  uint32_t pid = 0;
+  std::string process;
+  std::string class_name;
+  std::string title;
+  int x = 0;
+  int y = 0;
+  int width = 0;
+  int height = 0;
+  uint32_t style = 0;
+  uint32_t ex_style = 0;
+  bool hung = false;
+  bool cloaked = false;
+};
+
+enum class WindowChangeType {
+  Appeared,
+  Disappeared,
+  Moved,        // Position, size or monitor changed
+  Retitled,
+  StyleChanged, // Style, extended style, hung or cloaked changed
+};
+
+const char* window_change_type_to_string(WindowChangeType type);
+
+struct WindowChange {
+  WindowChangeType type;
+  TrackedWindow window;                  // Current state (last known state if Disappeared)
+  std::optional<TrackedWindow> previous; // State before the change (Moved/Retitled/StyleChanged)
+};
+
+// Changes between two passes: Disappeared in previous order, then for each current window (in
+// current order) Appeared, or any of Moved, Retitled and StyleChanged in that order
+std::vector<WindowChange> diff_windows(const std::vector<TrackedWindow>& previous,
+                                       const std::vector<TrackedWindow>& current);
+
+// Keeps the last pass so each new one can be reported as changes. The first pass reports every
+// window as Appeared.
+class WindowTracker {
+public:
+  std::vector<WindowChange> update(std::vector<TrackedWindow> current);
+
+  // State of a window in the last pass (lets a sampler skip lookups that cannot change, such
+  // as the process name)
+  [[nodiscard]] const TrackedWindow* find(size_t hwnd) const;
+
+  [[nodiscard]] size_t size() const;
+
+private:
+  std::vector<TrackedWindow> windows_;
+  std::unordered_map<size_t, size_t> index_; // hwnd -> position in windows_
+};
+
+// One JSON Lines record per change; t_ms is the sample time in ms since the Unix epoch
+nlohmann::json window_change_to_json(const WindowChange& change, int64_t t_ms);
+
+// The record serialized as one line (no trailing newline). Titles come from GetWindowTextA in
+// the ANSI code page, so bytes that are not valid UTF-8 are replaced instead of throwing.
+std::string window_change_to_line(const WindowChange& change, int64_t t_ms);
+
+} // namespace wintiler